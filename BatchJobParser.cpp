@@ -0,0 +1,377 @@
+#include "BatchJobParser.h"
+#include "MaidenheadGrid.h"
+#include "GlotecSnapshotStore.h"
+#include <charconv>
+#include <cmath>
+#include <ctime>
+#include <stdexcept>
+
+namespace {
+    std::uint32_t bit(int field) {
+        return 1u << field;
+    }
+
+    std::string_view trim(std::string_view text) {
+        while (!text.empty() && (text.front() == ' ' || text.front() == '\t')) text.remove_prefix(1);
+        while (!text.empty() && (text.back() == ' ' || text.back() == '\t' || text.back() == '\r')) text.remove_suffix(1);
+        return text;
+    }
+
+    bool toDouble(std::string_view text, double& value) {
+        text = trim(text);
+        if (!text.empty() && text.front() == '+') text.remove_prefix(1);
+        auto result = std::from_chars(text.data(), text.data() + text.size(), value);
+        return result.ec == std::errc() && result.ptr == text.data() + text.size() && !text.empty();
+    }
+
+    // Fixed-width unsigned field, e.g. the "02" of a month.
+    bool digits(std::string_view text, std::size_t at, std::size_t count, int& value) {
+        if (at + count > text.size()) return false;
+        value = 0;
+        for (std::size_t i = at; i < at + count; ++i) {
+            if (text[i] < '0' || text[i] > '9') return false;
+            value = value * 10 + (text[i] - '0');
+        }
+        return true;
+    }
+}
+
+// ========== JSON Line Handler ==========
+
+class BatchJobParser::JsonHandler : public JsonSaxHandler {
+public:
+    JsonHandler(BatchJobParser& parser, BatchJob& job)
+        : m_parser(parser), m_job(job), m_depth(0), m_field(Field::UNKNOWN), m_failed(false) {}
+
+    bool startObject() override { return ++m_depth == 1 || nested(); }
+    bool endObject() override { --m_depth; return true; }
+    bool startArray() override { return nested(); }
+    bool key(std::string_view name) override {
+        m_field = lookup(name);
+        return true;
+    }
+    bool string(std::string_view value) override {
+        return m_parser.assign(m_field, value, m_job) || fail();
+    }
+    bool number(double value) override {
+        return m_parser.assign(m_field, value, m_job) || fail();
+    }
+    bool boolean(bool value) override {
+        return m_parser.assign(m_field, value ? 1.0 : 0.0, m_job) || fail();
+    }
+    bool null() override { return true; }
+
+    bool failed() const { return m_failed; }
+
+private:
+    BatchJobParser& m_parser;
+    BatchJob& m_job;
+    int m_depth;
+    Field m_field;
+    bool m_failed;
+
+    bool nested() {
+        m_parser.m_error = "Job fields must be flat";
+        return fail();
+    }
+    bool fail() {
+        m_failed = true;
+        return false;
+    }
+};
+
+// ========== Constructor ==========
+
+BatchJobParser::BatchJobParser()
+    : m_format(BatchFormat::JSONL), m_json(4), m_seen(0),
+      m_dxLat(0.0), m_dxLon(0.0), m_homeLat(0.0), m_homeLon(0.0) {
+}
+
+bool BatchJobParser::setFormat(BatchFormat format, std::string_view csvHeader) {
+    m_columns.clear();
+    if (format == BatchFormat::AUTO) {
+        m_error = "Format must be resolved before parsing";
+        return false;
+    }
+    if (format == BatchFormat::COLUMNAR) {
+        m_error = "Columnar is an output format only";
+        return false;
+    }
+    m_format = format;
+    if (format == BatchFormat::JSONL) {
+        return true;
+    }
+
+    bool located = false;
+    while (true) {
+        std::size_t comma = csvHeader.find(',');
+        std::string_view name = trim(csvHeader.substr(0, comma));
+        if (name.size() >= 2 && name.front() == '"' && name.back() == '"') {
+            name = name.substr(1, name.size() - 2);
+        }
+        m_columns.push_back(lookup(name));
+        located = located || m_columns.back() == Field::TIME;
+        if (comma == std::string_view::npos) break;
+        csvHeader.remove_prefix(comma + 1);
+    }
+    if (!located) {
+        m_error = "CSV header has no time column";
+        return false;
+    }
+    return true;
+}
+
+// ========== Field Names ==========
+
+BatchJobParser::Field BatchJobParser::lookup(std::string_view name) {
+    struct Entry { const char* name; Field field; };
+    static const Entry TABLE[] = {
+        { "id", Field::ID },
+        { "time", Field::TIME },
+        { "freq_MHz", Field::FREQUENCY },
+        { "frequency_MHz", Field::FREQUENCY },
+        { "dx_grid", Field::DX_GRID },
+        { "dx_lat", Field::DX_LAT },
+        { "dx_lon", Field::DX_LON },
+        { "dx_psi", Field::DX_PSI },
+        { "dx_chi", Field::DX_CHI },
+        { "home_grid", Field::HOME_GRID },
+        { "home_lat", Field::HOME_LAT },
+        { "home_lon", Field::HOME_LON },
+        { "home_psi", Field::HOME_PSI },
+        { "home_chi", Field::HOME_CHI },
+        { "faraday", Field::FARADAY },
+    };
+    for (const Entry& entry : TABLE) {
+        if (name == entry.name) return entry.field;
+    }
+    return Field::UNKNOWN;
+}
+
+// ========== Field Assignment ==========
+
+void BatchJobParser::begin(BatchJob& job) {
+    job.id.clear();
+    job.time = 0.0;
+    job.frequency_MHz = 0.0;
+    job.dx.psi = job.dx.chi = 0.0;
+    job.home.psi = job.home.chi = 0.0;
+    job.dx.gridLocator.clear();
+    job.home.gridLocator.clear();
+    job.includeFaradayRotation = true;
+    m_seen = 0;
+    m_error.clear();
+}
+
+bool BatchJobParser::assign(Field field, std::string_view text, BatchJob& job) {
+    switch (field) {
+    case Field::ID:
+        job.id.assign(text.data(), text.size());
+        break;
+    case Field::TIME:
+        if (!parseTime(text, job.time)) {
+            m_error = "Bad time: " + std::string(text);
+            return false;
+        }
+        break;
+    case Field::DX_GRID:
+        job.dx.gridLocator.assign(trim(text));
+        break;
+    case Field::HOME_GRID:
+        job.home.gridLocator.assign(trim(text));
+        break;
+    case Field::FARADAY:
+        text = trim(text);
+        if (text == "true" || text == "1") return assign(field, 1.0, job);
+        if (text == "false" || text == "0") return assign(field, 0.0, job);
+        m_error = "Bad faraday flag: " + std::string(text);
+        return false;
+    case Field::UNKNOWN:
+        return true;
+    default: {
+        double value;
+        if (!toDouble(text, value)) {
+            m_error = "Bad number: " + std::string(text);
+            return false;
+        }
+        return assign(field, value, job);
+    }
+    }
+    m_seen |= bit(static_cast<int>(field));
+    return true;
+}
+
+bool BatchJobParser::assign(Field field, double value, BatchJob& job) {
+    switch (field) {
+    case Field::TIME:      job.time = value; break;
+    case Field::FREQUENCY: job.frequency_MHz = value; break;
+    case Field::DX_LAT:    m_dxLat = value; break;
+    case Field::DX_LON:    m_dxLon = value; break;
+    case Field::DX_PSI:    job.dx.psi = ParameterUtils::deg2rad(value); break;
+    case Field::DX_CHI:    job.dx.chi = ParameterUtils::deg2rad(value); break;
+    case Field::HOME_LAT:  m_homeLat = value; break;
+    case Field::HOME_LON:  m_homeLon = value; break;
+    case Field::HOME_PSI:  job.home.psi = ParameterUtils::deg2rad(value); break;
+    case Field::HOME_CHI:  job.home.chi = ParameterUtils::deg2rad(value); break;
+    case Field::FARADAY:   job.includeFaradayRotation = value != 0.0; break;
+    case Field::UNKNOWN:   return true;
+    default:
+        m_error = "Field needs a string value";
+        return false;
+    }
+    if (!std::isfinite(value)) {
+        m_error = "Non-finite value";
+        return false;
+    }
+    m_seen |= bit(static_cast<int>(field));
+    return true;
+}
+
+bool BatchJobParser::locate(const char* station, Field gridField, Field latField, Field lonField,
+                            double lat, double lon, SiteParameters& site) {
+    if (m_seen & bit(static_cast<int>(gridField))) {
+        try {
+            MaidenheadGrid::gridToLatLon(site.gridLocator, lat, lon);
+        } catch (const std::exception& e) {
+            m_error = std::string(station) + " grid " + site.gridLocator + ": " + e.what();
+            return false;
+        }
+    } else if (!(m_seen & bit(static_cast<int>(latField))) || !(m_seen & bit(static_cast<int>(lonField)))) {
+        m_error = std::string("Missing ") + station + " grid or lat/lon";
+        return false;
+    } else if (std::abs(lat) > 90.0) {
+        m_error = std::string(station) + " latitude out of range";
+        return false;
+    }
+    site.latitude = ParameterUtils::deg2rad(lat);
+    site.longitude = ParameterUtils::deg2rad(lon);
+    return true;
+}
+
+bool BatchJobParser::finish(BatchJob& job) {
+    if (!(m_seen & bit(static_cast<int>(Field::TIME)))) {
+        m_error = "Missing time";
+        return false;
+    }
+    if (!(m_seen & bit(static_cast<int>(Field::FREQUENCY))) || !(job.frequency_MHz > 0.0)) {
+        m_error = "Missing or invalid freq_MHz";
+        return false;
+    }
+    return locate("DX", Field::DX_GRID, Field::DX_LAT, Field::DX_LON, m_dxLat, m_dxLon, job.dx) &&
+           locate("Home", Field::HOME_GRID, Field::HOME_LAT, Field::HOME_LON, m_homeLat, m_homeLon, job.home);
+}
+
+// ========== Line Parsing ==========
+
+bool BatchJobParser::parse(std::string_view line, BatchJob& job) {
+    begin(job);
+    bool ok = (m_format == BatchFormat::CSV) ? parseCsv(line, job) : parseJson(line, job);
+    return ok && finish(job);
+}
+
+bool BatchJobParser::parseJson(std::string_view line, BatchJob& job) {
+    JsonHandler handler(*this, job);
+    if (!m_json.parse(line, handler)) {
+        if (!handler.failed()) {
+            m_error = m_json.getError();
+        }
+        return false;
+    }
+    return true;
+}
+
+bool BatchJobParser::parseCsv(std::string_view line, BatchJob& job) {
+    std::size_t column = 0;
+    std::size_t pos = 0;
+    while (true) {
+        if (column >= m_columns.size()) {
+            m_error = "More values than columns";
+            return false;
+        }
+
+        std::string_view value;
+        while (pos < line.size() && (line[pos] == ' ' || line[pos] == '\t')) ++pos;
+        if (pos < line.size() && line[pos] == '"') {
+            // Quoted: "" stands for one quote.
+            m_scratch.clear();
+            ++pos;
+            while (true) {
+                std::size_t quote = line.find('"', pos);
+                if (quote == std::string_view::npos) {
+                    m_error = "Unterminated quote";
+                    return false;
+                }
+                m_scratch.append(line.data() + pos, quote - pos);
+                pos = quote + 1;
+                if (pos < line.size() && line[pos] == '"') {
+                    m_scratch.push_back('"');
+                    ++pos;
+                    continue;
+                }
+                break;
+            }
+            value = m_scratch;
+            while (pos < line.size() && line[pos] != ',') ++pos;
+        } else {
+            std::size_t comma = line.find(',', pos);
+            if (comma == std::string_view::npos) comma = line.size();
+            value = trim(line.substr(pos, comma - pos));
+            pos = comma;
+        }
+
+        // Empty cells leave the default.
+        if (!value.empty() && !assign(m_columns[column], value, job)) {
+            return false;
+        }
+        ++column;
+        if (pos >= line.size()) break;
+        ++pos;
+    }
+    return true;
+}
+
+// ========== Time Parsing ==========
+
+bool BatchJobParser::parseTime(std::string_view text, double& utcSeconds) {
+    text = trim(text);
+    if (toDouble(text, utcSeconds)) {
+        return true;
+    }
+
+    // YYYY-MM-DD[T ]HH:MM[:SS[.fff]][Z]
+    std::tm time = {};
+    int year, month, day, hour, minute, second = 0;
+    if (!digits(text, 0, 4, year) || text.size() < 16 || text[4] != '-' ||
+        !digits(text, 5, 2, month) || text[7] != '-' || !digits(text, 8, 2, day) ||
+        (text[10] != 'T' && text[10] != ' ') ||
+        !digits(text, 11, 2, hour) || text[13] != ':' || !digits(text, 14, 2, minute)) {
+        return false;
+    }
+
+    std::size_t pos = 16;
+    double fraction = 0.0;
+    if (pos < text.size() && text[pos] == ':') {
+        if (!digits(text, pos + 1, 2, second)) return false;
+        pos += 3;
+        if (pos < text.size() && text[pos] == '.') {
+            std::size_t end = pos + 1;
+            while (end < text.size() && text[end] >= '0' && text[end] <= '9') ++end;
+            if (end == pos + 1 || !toDouble(text.substr(pos, end - pos), fraction)) return false;
+            pos = end;
+        }
+    }
+    if (pos < text.size() && text[pos] == 'Z') ++pos;
+    if (pos != text.size() || month < 1 || month > 12 || day < 1 || day > 31 ||
+        hour > 23 || minute > 59 || second > 60) {
+        return false;
+    }
+
+    time.tm_year = year - 1900;
+    time.tm_mon = month - 1;
+    time.tm_mday = day;
+    time.tm_hour = hour;
+    time.tm_min = minute;
+    time.tm_sec = second;
+    utcSeconds = static_cast<double>(GlotecSnapshotStore::toEpochSeconds(time)) + fraction;
+    return true;
+}
@@ -0,0 +1,95 @@
+#pragma once
+
+#include "Parameters.h"
+#include "JsonSaxReader.h"
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <vector>
+
+// ========== Batch Format ==========
+
+enum class BatchFormat {
+    AUTO,       // JSONL if the first line opens an object, CSV otherwise
+    JSONL,
+    CSV,
+    COLUMNAR    // binary result chunks, output only (see ColumnarResultWriter)
+};
+
+// ========== Batch Job ==========
+// One link to evaluate. Stations carry radians like everywhere else; the job
+// file gives degrees or Maidenhead grids.
+
+struct BatchJob {
+    std::string id;                 // echoed; the line number when absent
+    double time;                    // UTC seconds since 1970
+    double frequency_MHz;
+    SiteParameters dx;
+    SiteParameters home;
+    bool includeFaradayRotation;
+
+    BatchJob()
+        : time(0.0), frequency_MHz(0.0), includeFaradayRotation(true) {}
+};
+
+// ========== Batch Job Parser ==========
+// Turns one line of a job file into a BatchJob. JSONL lines are flat objects,
+// CSV lines follow the column names of a header line; both use the same field
+// names:
+//
+//   id, time, freq_MHz, dx_grid | dx_lat + dx_lon, dx_psi, dx_chi,
+//   home_grid | home_lat + home_lon, home_psi, home_chi, faraday
+//
+// time is ISO 8601 UTC ("2026-02-09T12:30:00Z", the T, seconds and Z optional)
+// or seconds since 1970. Angles are degrees, psi and chi default to 0 and
+// faraday to true. Unknown fields are ignored. Each worker owns its own parser.
+
+class BatchJobParser {
+public:
+    BatchJobParser();
+
+    // JSONL needs no header; CSV needs the header line naming the columns.
+    bool setFormat(BatchFormat format, std::string_view csvHeader = std::string_view());
+    BatchFormat getFormat() const { return m_format; }
+
+    bool parse(std::string_view line, BatchJob& job);
+
+    const std::string& getError() const { return m_error; }
+
+    static bool parseTime(std::string_view text, double& utcSeconds);
+
+private:
+    enum class Field {
+        ID,
+        TIME,
+        FREQUENCY,
+        DX_GRID, DX_LAT, DX_LON, DX_PSI, DX_CHI,
+        HOME_GRID, HOME_LAT, HOME_LON, HOME_PSI, HOME_CHI,
+        FARADAY,
+        UNKNOWN
+    };
+
+    class JsonHandler;
+
+    BatchFormat m_format;
+    std::vector<Field> m_columns;
+    JsonSaxReader m_json;
+    std::string m_scratch;
+    std::string m_error;
+
+    // Per-line state: which fields were given, and positions in degrees.
+    std::uint32_t m_seen;
+    double m_dxLat, m_dxLon, m_homeLat, m_homeLon;
+
+    static Field lookup(std::string_view name);
+    void begin(BatchJob& job);
+    bool assign(Field field, std::string_view text, BatchJob& job);
+    bool assign(Field field, double value, BatchJob& job);
+    bool finish(BatchJob& job);
+    bool locate(const char* station, Field gridField, Field latField, Field lonField,
+                double lat, double lon, SiteParameters& site);
+
+    bool parseJson(std::string_view line, BatchJob& job);
+    bool parseCsv(std::string_view line, BatchJob& job);
+};
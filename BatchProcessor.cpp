@@ -0,0 +1,440 @@
+#include "BatchProcessor.h"
+#include "FaradayRotation.h"
+#include "IonosphereDataProvider.h"
+#include "GlotecSnapshotStore.h"
+#include "LunarChebyshevCache.h"
+#include <algorithm>
+#include <cmath>
+#include <condition_variable>
+#include <ctime>
+#include <deque>
+#include <map>
+#include <memory>
+#include <thread>
+
+namespace {
+    // Same fallback as the interactive front end.
+    IonosphereData defaultIonosphere() {
+        IonosphereData iono;
+        iono.vTEC_DX = 25.0;
+        iono.vTEC_Home = 25.0;
+        iono.hmF2_DX = 350.0;
+        iono.hmF2_Home = 350.0;
+        iono.B_magnitude_DX = 5.0e-5;
+        iono.B_magnitude_Home = 5.0e-5;
+        iono.B_inclination_DX = ParameterUtils::deg2rad(60.0);
+        iono.B_inclination_Home = ParameterUtils::deg2rad(60.0);
+        iono.dataSource = "Default";
+        return iono;
+    }
+
+    bool blank(const std::string& line) {
+        return line.find_first_not_of(" \t\r") == std::string::npos;
+    }
+}
+
+// ========== Constructor ==========
+
+BatchProcessor::BatchProcessor()
+    : m_provider(nullptr), m_input(BatchFormat::JSONL), m_output(BatchFormat::JSONL),
+      m_jobs(0), m_failed(0) {
+}
+
+// ========== Output ==========
+
+void BatchProcessor::writeHeader(std::string& out) const {
+    if (m_output == BatchFormat::COLUMNAR) {
+        ColumnarResultWriter::writeHeader(out, m_options.passbandBins > 0, m_options.solvePolarization,
+                                          m_options.sensitivity);
+    } else {
+        m_text.writeHeader(out);
+    }
+}
+
+void BatchProcessor::writeResult(Workspace& work, std::string& out, std::size_t index) const {
+    const BatchJob& job = work.jobs[index];
+    const PassbandResult* passband = m_options.passbandBins > 0 ? &work.passbands[index] : nullptr;
+    const PolarizationSolution* polarization = m_options.solvePolarization ? &work.polarizations[index] : nullptr;
+    const PLFSensitivity* sensitivity = m_options.sensitivity ? &work.sensitivities[index] : nullptr;
+    if (m_output == BatchFormat::COLUMNAR) {
+        work.columns.addResult(job.id, job.time, job.frequency_MHz, work.results[index],
+                               work.moons[index], work.iono[index], work.faraday[index] != 0,
+                               passband, polarization, sensitivity);
+    } else {
+        m_text.writeResult(out, job.id, job.time, job.frequency_MHz, work.results[index],
+                           work.moons[index], work.iono[index], work.faraday[index] != 0,
+                           passband, polarization, sensitivity);
+    }
+}
+
+void BatchProcessor::writeFailure(Workspace& work, std::string& out, std::size_t index, std::size_t line,
+                                  const std::string& message) const {
+    const BatchJob& job = work.jobs[index];
+    if (m_output == BatchFormat::COLUMNAR) {
+        work.columns.addFailure(job.id, job.time, job.frequency_MHz, "line " + std::to_string(line) + ": " + message);
+    } else {
+        m_text.writeFailure(out, job.id, line, message);
+    }
+}
+
+// ========== Block Processing ==========
+
+void BatchProcessor::processLines(Workspace& work, const std::string* lines, std::size_t count,
+                                  std::size_t firstLine, std::string& output,
+                                  std::size_t& jobs, std::size_t& failed) {
+    work.jobs.resize(std::max(work.jobs.size(), count));
+    work.status.assign(count, 0);
+    work.errors.resize(std::max(work.errors.size(), count));
+    work.columns.setPassband(m_options.passbandBins > 0);
+    work.columns.setPolarization(m_options.solvePolarization);
+    work.columns.setSensitivity(m_options.sensitivity);
+
+    // Parse; independent of the other workers.
+    for (std::size_t i = 0; i < count; ++i) {
+        if (blank(lines[i])) continue;
+        BatchJob& job = work.jobs[i];
+        if (!work.parser.parse(lines[i], job)) {
+            work.status[i] = 2;
+            work.errors[i] = work.parser.getError();
+        } else {
+            work.status[i] = 1;
+        }
+        if (job.id.empty()) {
+            job.id = std::to_string(firstLine + i);
+        }
+    }
+
+    computeJobs(work, count);
+
+    jobs = 0;
+    failed = 0;
+    for (std::size_t i = 0; i < count; ++i) {
+        if (work.status[i] == 0) continue;
+        ++jobs;
+        if (work.status[i] == 2) {
+            ++failed;
+            writeFailure(work, output, i, firstLine + i, work.errors[i]);
+        } else if (!work.results[i].calculationSuccess) {
+            ++failed;
+            writeFailure(work, output, i, firstLine + i, work.results[i].errorMessage);
+        } else {
+            writeResult(work, output, i);
+        }
+    }
+    // Columnar output: the block becomes one chunk.
+    work.columns.flush(output);
+}
+
+void BatchProcessor::computeJobs(Workspace& work, std::size_t count) {
+    if (!work.prepared) {
+        work.ephemeris = m_ephemeris;
+        work.prepared = true;
+    }
+    work.moons.resize(count);
+    work.iono.assign(count, defaultIonosphere());
+    work.faraday.assign(count, 0);
+    work.results.resize(std::max(work.results.size(), count));
+    if (m_options.passbandBins > 0) {
+        work.passbands.resize(std::max(work.passbands.size(), count));
+    }
+    if (m_options.solvePolarization) {
+        work.polarizations.resize(std::max(work.polarizations.size(), count));
+    }
+    if (m_options.sensitivity) {
+        work.sensitivities.resize(std::max(work.sensitivities.size(), count));
+    }
+    const double crossGain = std::pow(10.0, m_options.crossGain_dB / 10.0);
+
+    double first = 0.0, last = 0.0;
+    std::size_t parsed = 0;
+    for (std::size_t i = 0; i < count; ++i) {
+        if (work.status[i] != 1) continue;
+        const BatchJob& job = work.jobs[i];
+        work.faraday[i] = job.includeFaradayRotation && m_config.includeFaradayRotation;
+        first = parsed ? std::min(first, job.time) : job.time;
+        last = parsed ? std::max(last, job.time) : job.time;
+        ++parsed;
+    }
+
+    // A Chebyshev fit costs about a dozen series evaluations per day, so when the
+    // block's jobs are that dense in time, fit once and serve the block from it.
+    if (parsed > 0) {
+        const auto& cache = work.ephemeris.getCache();
+        const double days = std::floor((last - first) / LunarChebyshevCache::DEFAULT_SEGMENT_S) + 2.0;
+        if ((!cache || !cache->covers(first, last + 1.0)) && days * 12.0 < static_cast<double>(parsed)) {
+            auto fitted = std::make_shared<LunarChebyshevCache>();
+            if (fitted->build(m_ephemeris, first, last + 1.0)) {
+                work.ephemeris.attachCache(fitted);
+            }
+        }
+    }
+    for (std::size_t i = 0; i < count; ++i) {
+        if (work.status[i] == 1) {
+            const BatchJob& job = work.jobs[i];
+            work.moons[i] = work.ephemeris.computeMoonEphemeris(job.time, job.dx, job.home);
+        }
+    }
+
+    // Piercing-point TEC and field for the whole block under one lock.
+    const bool chapman = m_config.ionoModel == SystemConfiguration::IonosphereModel::CHAPMAN;
+    std::vector<PreparedMagneticField> fields;
+    if (m_provider && m_provider->hasTecData()) {
+        if (chapman) fields.resize(count);
+        std::lock_guard<std::mutex> lock(m_providerMutex);
+        for (std::size_t i = 0; i < count; ++i) {
+            const MoonEphemeris& moon = work.moons[i];
+            if (work.status[i] != 1 || !work.faraday[i] || moon.elevation_DX < 0.0 || moon.elevation_Home < 0.0) {
+                continue;
+            }
+            const BatchJob& job = work.jobs[i];
+            const std::tm stamp = GlotecSnapshotStore::fromEpochSeconds(static_cast<std::int64_t>(std::floor(job.time)));
+            if (!m_provider->getIonosphereDataAtIPP(stamp,
+                    ParameterUtils::rad2deg(job.dx.latitude), ParameterUtils::rad2deg(job.dx.longitude),
+                    moon.elevation_DX, moon.azimuth_DX,
+                    ParameterUtils::rad2deg(job.home.latitude), ParameterUtils::rad2deg(job.home.longitude),
+                    moon.elevation_Home, moon.azimuth_Home, work.iono[i])) {
+                work.iono[i] = defaultIonosphere();
+                work.faraday[i] = 0;
+            } else if (chapman) {
+                fields[i] = m_provider->prepareMagneticField(stamp);
+            }
+        }
+    }
+
+    SystemConfiguration config = m_config;
+    for (std::size_t i = 0; i < count; ++i) {
+        if (work.status[i] != 1) continue;
+        const BatchJob& job = work.jobs[i];
+        config.frequency_MHz = job.frequency_MHz;
+        config.includeFaradayRotation = work.faraday[i] != 0;
+        config.ionoModel = chapman && !fields.empty() && work.faraday[i]
+            ? SystemConfiguration::IonosphereModel::CHAPMAN : SystemConfiguration::IonosphereModel::SIMPLE;
+        work.calculator.setConfiguration(config);
+        if (config.ionoModel == SystemConfiguration::IonosphereModel::CHAPMAN) {
+            work.calculator.setMagneticField(fields[i]);
+        }
+        work.calculator.setDXStation(job.dx);
+        work.calculator.setHomeStation(job.home);
+        work.calculator.setIonosphereData(work.iono[i]);
+        work.calculator.setMoonEphemeris(work.moons[i]);
+        work.results[i] = m_options.passbandBins > 0
+            ? work.calculator.calculatePassband(m_options.passbandBins, work.passbands[i])
+            : work.calculator.calculate();
+        if (m_options.solvePolarization) {
+            work.polarizations[i] = work.calculator.solvePolarization(work.results[i], crossGain);
+        }
+        if (m_options.sensitivity && work.results[i].calculationSuccess) {
+            const MoonEphemeris rate = work.ephemeris.computeMoonEphemerisRate(job.time, job.dx, job.home);
+            work.calculator.calculateSensitivity(rate, work.sensitivities[i]);
+        } else if (m_options.sensitivity) {
+            work.sensitivities[i] = PLFSensitivity();
+        }
+    }
+}
+
+std::size_t BatchProcessor::evaluate(Workspace& work, const std::string& request, std::string& output) {
+    std::size_t jobs, failed;
+    processLines(work, &request, 1, 1, output, jobs, failed);
+    return failed;
+}
+
+std::size_t BatchProcessor::evaluate(Workspace& work, const BatchJob* jobs, std::size_t count) {
+    work.jobs.resize(std::max(work.jobs.size(), count));
+    std::copy(jobs, jobs + count, work.jobs.begin());
+    work.status.assign(count, 1);
+    computeJobs(work, count);
+
+    std::size_t failed = 0;
+    for (std::size_t i = 0; i < count; ++i) {
+        failed += work.results[i].calculationSuccess ? 0 : 1;
+    }
+    return failed;
+}
+
+// ========== Pipeline ==========
+
+bool BatchProcessor::run(std::istream& in, std::ostream& out) {
+    m_jobs = 0;
+    m_failed = 0;
+    m_error.clear();
+    if (m_options.blockSize == 0) {
+        m_error = "Block size must be positive";
+        return false;
+    }
+
+    // The first non-blank line decides the format; a CSV header is not a job.
+    std::string first;
+    std::size_t lineNumber = 0;
+    bool haveFirst = false;
+    while (std::getline(in, first)) {
+        ++lineNumber;
+        if (!blank(first)) {
+            haveFirst = true;
+            break;
+        }
+    }
+    if (!haveFirst) {
+        return true;
+    }
+
+    m_input = m_options.input;
+    if (m_input == BatchFormat::AUTO) {
+        m_input = first[first.find_first_not_of(" \t")] == '{' ? BatchFormat::JSONL : BatchFormat::CSV;
+    }
+    m_output = m_options.output == BatchFormat::AUTO ? m_input : m_options.output;
+    if (m_input == BatchFormat::COLUMNAR) {
+        m_error = "Columnar is an output format only";
+        return false;
+    }
+    m_text.setFormat(m_output);
+
+    BatchJobParser prototype;
+    if (!prototype.setFormat(m_input, first)) {
+        m_error = prototype.getError();
+        return false;
+    }
+    const bool firstIsJob = m_input == BatchFormat::JSONL;
+
+    {
+        std::string header;
+        writeHeader(header);
+        out.write(header.data(), static_cast<std::streamsize>(header.size()));
+    }
+
+    unsigned threads = m_options.threads ? m_options.threads : std::thread::hardware_concurrency();
+    threads = std::max(threads, 1u);
+    const std::size_t blockCount = std::max<std::size_t>(
+        m_options.blocksInFlight ? m_options.blocksInFlight : 2 * threads + 2, 2);
+
+    std::vector<Block> blocks(blockCount);
+    std::deque<std::size_t> freeBlocks, pending;
+    std::map<std::size_t, std::size_t> finished;    // sequence -> block
+    for (std::size_t i = 0; i < blockCount; ++i) {
+        freeBlocks.push_back(i);
+    }
+
+    std::mutex mutex;
+    std::condition_variable freeReady, workReady, doneReady;
+    bool readingDone = false;
+    bool writeFailed = false;
+    std::size_t totalBlocks = 0;
+
+    auto worker = [&]() {
+        Workspace work;
+        work.parser = prototype;
+        while (true) {
+            std::size_t index;
+            {
+                std::unique_lock<std::mutex> lock(mutex);
+                workReady.wait(lock, [&] { return !pending.empty() || readingDone; });
+                if (pending.empty()) return;
+                index = pending.front();
+                pending.pop_front();
+            }
+            Block& block = blocks[index];
+            block.output.clear();
+            processLines(work, block.lines.data(), block.count, block.firstLine,
+                         block.output, block.jobs, block.failed);
+            {
+                std::lock_guard<std::mutex> lock(mutex);
+                finished.emplace(block.sequence, index);
+            }
+            doneReady.notify_one();
+        }
+    };
+
+    // Writes blocks strictly in sequence; a block out of order waits in `finished`.
+    auto writer = [&]() {
+        for (std::size_t next = 0;; ++next) {
+            std::size_t index;
+            {
+                std::unique_lock<std::mutex> lock(mutex);
+                doneReady.wait(lock, [&] { return finished.count(next) || (readingDone && next == totalBlocks); });
+                auto it = finished.find(next);
+                if (it == finished.end()) return;
+                index = it->second;
+                finished.erase(it);
+            }
+            const Block& block = blocks[index];
+            out.write(block.output.data(), static_cast<std::streamsize>(block.output.size()));
+            {
+                std::lock_guard<std::mutex> lock(mutex);
+                m_jobs += block.jobs;
+                m_failed += block.failed;
+                writeFailed = writeFailed || !out;
+                freeBlocks.push_back(index);
+            }
+            freeReady.notify_one();
+        }
+    };
+
+    std::vector<std::thread> pool;
+    for (unsigned i = 0; i < threads; ++i) {
+        pool.emplace_back(worker);
+    }
+    std::thread output(writer);
+
+    // Reader: fill a free block, hand it to the workers.
+    std::size_t sequence = 0;
+    bool carry = firstIsJob;
+    while (true) {
+        std::size_t index;
+        {
+            std::unique_lock<std::mutex> lock(mutex);
+            freeReady.wait(lock, [&] { return !freeBlocks.empty() || writeFailed; });
+            if (writeFailed) break;
+            index = freeBlocks.front();
+            freeBlocks.pop_front();
+        }
+
+        Block& block = blocks[index];
+        block.sequence = sequence;
+        block.count = 0;
+        if (block.lines.size() < m_options.blockSize) {
+            block.lines.resize(m_options.blockSize);
+        }
+        if (carry) {
+            block.firstLine = lineNumber;
+            block.lines[block.count++].swap(first);
+            carry = false;
+        } else {
+            block.firstLine = lineNumber + 1;
+        }
+        while (block.count < m_options.blockSize && std::getline(in, block.lines[block.count])) {
+            ++block.count;
+            ++lineNumber;
+        }
+
+        std::lock_guard<std::mutex> lock(mutex);
+        if (block.count == 0) {
+            freeBlocks.push_back(index);
+            break;
+        }
+        pending.push_back(index);
+        ++sequence;
+        workReady.notify_one();
+    }
+
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        readingDone = true;
+        totalBlocks = sequence;
+    }
+    workReady.notify_all();
+    doneReady.notify_all();
+    for (std::thread& thread : pool) {
+        thread.join();
+    }
+    output.join();
+
+    out.flush();
+    if (writeFailed || !out) {
+        m_error = "Cannot write results";
+        return false;
+    }
+    if (in.bad()) {
+        m_error = "Cannot read jobs";
+        return false;
+    }
+    return true;
+}
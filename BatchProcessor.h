@@ -0,0 +1,141 @@
+#pragma once
+
+#include "Parameters.h"
+#include "LunarEphemeris.h"
+#include "BatchJobParser.h"
+#include "FaradayRotation.h"
+#include "ResultTextWriter.h"
+#include "ColumnarResultWriter.h"
+#include <cstddef>
+#include <istream>
+#include <mutex>
+#include <ostream>
+#include <string>
+#include <vector>
+
+class IonosphereDataProvider;
+
+// ========== Batch Options ==========
+
+struct BatchOptions {
+    unsigned threads;               // 0 uses every hardware thread
+    std::size_t blockSize;          // lines handed to a worker at once
+    std::size_t blocksInFlight;     // memory bound; 0 picks 2 per thread + 2
+    BatchFormat input;
+    BatchFormat output;             // AUTO mirrors the input; COLUMNAR is output only
+    int passbandBins;               // 0 off; else sample bandwidth_Hz on this many bins
+    bool solvePolarization;         // best receive psi/chi and dual-pol combining per job
+    double crossGain_dB;            // cross-polarized branch relative to the co-polarized one
+    bool sensitivity;               // PLF gradient in vTEC, |B| and time; SIMPLE model only
+
+    BatchOptions()
+        : threads(0), blockSize(1024), blocksInFlight(0),
+          input(BatchFormat::AUTO), output(BatchFormat::AUTO), passbandBins(0),
+          solvePolarization(false), crossGain_dB(0.0), sensitivity(false) {}
+};
+
+// ========== Batch Processor ==========
+// Streams a job file through a three-stage pipeline: the calling thread reads
+// blocks of lines, a pool of workers parses and computes them, and a writer
+// thread emits the results in input order. Only blocksInFlight blocks exist at
+// any time, so memory stays bounded however long the input is and a slow
+// consumer stalls the reader instead of piling up output.
+//
+// Models are loaded once by the caller and shared. The moon comes from the
+// ephemeris (thread-safe); TEC and field at the piercing points come from the
+// ionosphere provider, which is not, so each worker takes its lock once per
+// block. Jobs the provider cannot serve run without Faraday rotation and say so.
+// Without a provider the interactive defaults (25 TECU, 50 uT, 60 deg dip) are
+// used.
+
+class BatchProcessor {
+public:
+    BatchProcessor();
+
+    void setOptions(const BatchOptions& options) {
+        m_options = options;
+        m_text.setPassband(options.passbandBins > 0);
+        m_text.setPolarization(options.solvePolarization);
+        m_text.setSensitivity(options.sensitivity);
+    }
+    const BatchOptions& getOptions() const { return m_options; }
+    void setConfiguration(const SystemConfiguration& config) { m_config = config; }
+    void setIonosphereProvider(IonosphereDataProvider* provider) { m_provider = provider; }
+    void setEphemeris(const LunarEphemeris& ephemeris) { m_ephemeris = ephemeris; }
+
+    // False only when the stream itself cannot be processed (bad header, write
+    // failure); individual bad jobs are reported in the output.
+    bool run(std::istream& in, std::ostream& out);
+
+    // ========== Single Requests ==========
+    // Per-thread scratch. Workers in run() own one each; servers such as
+    // QueryDaemon keep one per worker thread and call evaluate().
+    struct Workspace {
+        BatchJobParser parser;
+        LunarEphemeris ephemeris;
+        FaradayRotation calculator;
+        std::vector<BatchJob> jobs;
+        std::vector<char> status;       // 0 blank, 1 parsed, 2 rejected
+        std::vector<std::string> errors;
+        std::vector<MoonEphemeris> moons;
+        std::vector<IonosphereData> iono;
+        std::vector<char> faraday;
+        std::vector<CalculationResults> results;
+        std::vector<PassbandResult> passbands;  // with passbandBins only
+        std::vector<PolarizationSolution> polarizations;    // with solvePolarization only
+        std::vector<PLFSensitivity> sensitivities;          // with sensitivity only
+        ColumnarResultWriter columns;
+        bool prepared;
+
+        Workspace() : prepared(false) {}
+    };
+
+    // One JSONL job in, one JSONL result line appended to output. Thread-safe
+    // with one Workspace per thread. Returns the number of failed jobs (0 or 1).
+    std::size_t evaluate(Workspace& work, const std::string& request, std::string& output);
+
+    // Parsed jobs in; job i leaves its result in work.results[i] and the moon,
+    // ionosphere and Faraday flag it used in work.moons, work.iono and
+    // work.faraday (and its passband, polarization solution and sensitivities in
+    // work.passbands, work.polarizations and work.sensitivities when enabled).
+    // Returns the number of failed jobs.
+    std::size_t evaluate(Workspace& work, const BatchJob* jobs, std::size_t count);
+
+    std::size_t getJobCount() const { return m_jobs; }
+    std::size_t getFailedCount() const { return m_failed; }
+    const std::string& getError() const { return m_error; }
+
+private:
+    struct Block {
+        std::size_t sequence;
+        std::size_t firstLine;      // 1-based line number of lines[0]
+        std::size_t count;          // lines in use; capacity is kept
+        std::vector<std::string> lines;
+        std::string output;
+        std::size_t jobs;
+        std::size_t failed;
+    };
+
+    BatchOptions m_options;
+    SystemConfiguration m_config;
+    IonosphereDataProvider* m_provider;
+    LunarEphemeris m_ephemeris;
+    std::mutex m_providerMutex;
+
+    BatchFormat m_input;
+    BatchFormat m_output;
+    ResultTextWriter m_text;
+
+    std::size_t m_jobs;
+    std::size_t m_failed;
+    std::string m_error;
+
+    void processLines(Workspace& work, const std::string* lines, std::size_t count,
+                      std::size_t firstLine, std::string& output,
+                      std::size_t& jobs, std::size_t& failed);
+    void computeJobs(Workspace& work, std::size_t count);
+    void writeHeader(std::string& out) const;
+    void writeResult(Workspace& work, std::string& out, std::size_t index) const;
+    void writeFailure(Workspace& work, std::string& out, std::size_t index, std::size_t line,
+                      const std::string& message) const;
+};
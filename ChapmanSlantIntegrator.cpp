@@ -0,0 +1,300 @@
+#define _USE_MATH_DEFINES
+#include "ChapmanSlantIntegrator.h"
+#include "Parameters.h"
+#include <cmath>
+#include <algorithm>
+
+#ifndef M_PI
+#define M_PI 3.14159265358979323846
+#endif
+
+namespace {
+    constexpr double MIN_NODE_HEIGHT_KM = 60.0;
+    constexpr size_t MAX_CACHED_PROFILES = 16;
+}
+
+// ========== Constructor ==========
+
+ChapmanSlantIntegrator::ChapmanSlantIntegrator(
+    int numNodes, double elevationStep_deg, double scaleHeight_km)
+    : m_numNodes(std::max(2, numNodes)),
+      m_numBins(0),
+      m_elevationStep(std::max(0.01, elevationStep_deg) * M_PI / 180.0),
+      m_scaleHeight(scaleHeight_km) {
+    m_numBins = static_cast<int>(std::ceil((M_PI / 2.0) / m_elevationStep)) + 1;
+    buildProfileNodes();
+}
+
+// ========== Profile Quadrature ==========
+
+void ChapmanSlantIntegrator::buildProfileNodes() {
+    // Gauss rule for the weight exp(0.5 * (1 - z - exp(-z))) in the reduced height z.
+    // Recurrence coefficients come from the Stieltjes procedure on a fine discretised
+    // measure; nodes and weights from the Jacobi matrix (Golub-Welsch, implicit QL).
+    const int n = m_numNodes;
+    const int samples = 4000;
+    const double zMin = -6.0, zMax = 60.0;
+    const double dz = (zMax - zMin) / (samples - 1);
+
+    std::vector<double> zs(samples), ws(samples);
+    for (int k = 0; k < samples; ++k) {
+        zs[k] = zMin + k * dz;
+        ws[k] = std::exp(0.5 * (1.0 - zs[k] - std::exp(-zs[k]))) * dz;
+    }
+
+    std::vector<double> alpha(n), beta(n);
+    std::vector<double> pPrev(samples, 0.0), pCurr(samples, 1.0), pNext(samples);
+    double normPrev = 1.0;
+
+    for (int j = 0; j < n; ++j) {
+        double norm = 0.0, moment = 0.0;
+        for (int k = 0; k < samples; ++k) {
+            double w = ws[k] * pCurr[k] * pCurr[k];
+            norm += w;
+            moment += w * zs[k];
+        }
+        alpha[j] = moment / norm;
+        beta[j] = (j == 0) ? norm : norm / normPrev;
+
+        for (int k = 0; k < samples; ++k) {
+            pNext[k] = (zs[k] - alpha[j]) * pCurr[k] - ((j == 0) ? 0.0 : beta[j] * pPrev[k]);
+        }
+        pPrev.swap(pCurr);
+        pCurr.swap(pNext);
+        normPrev = norm;
+    }
+
+    // Symmetric tridiagonal eigenproblem; only the first eigenvector row is tracked.
+    std::vector<double> d(alpha), e(n, 0.0), v(n, 0.0);
+    for (int j = 1; j < n; ++j) {
+        e[j - 1] = std::sqrt(beta[j]);
+    }
+    v[0] = 1.0;
+
+    for (int l = 0; l < n; ++l) {
+        for (int iter = 0; iter < 60; ++iter) {
+            int m = l;
+            for (; m < n - 1; ++m) {
+                double dd = std::abs(d[m]) + std::abs(d[m + 1]);
+                if (std::abs(e[m]) <= 1e-15 * dd) break;
+            }
+            if (m == l) break;
+
+            double g = (d[l + 1] - d[l]) / (2.0 * e[l]);
+            double r = std::hypot(g, 1.0);
+            g = d[m] - d[l] + e[l] / (g + (g >= 0.0 ? r : -r));
+
+            double s = 1.0, c = 1.0, p = 0.0;
+            int i = m - 1;
+            for (; i >= l; --i) {
+                double f = s * e[i];
+                double b = c * e[i];
+                r = std::hypot(f, g);
+                e[i + 1] = r;
+                if (r == 0.0) {
+                    d[i + 1] -= p;
+                    e[m] = 0.0;
+                    break;
+                }
+                s = f / r;
+                c = g / r;
+                g = d[i + 1] - p;
+                r = (d[i] - g) * s + 2.0 * c * b;
+                p = s * r;
+                d[i + 1] = g + p;
+                g = c * r - b;
+
+                double vt = v[i + 1];
+                v[i + 1] = s * v[i] + c * vt;
+                v[i] = c * v[i] - s * vt;
+            }
+            if (r == 0.0 && i >= l) continue;
+            d[l] -= p;
+            e[l] = g;
+            e[m] = 0.0;
+        }
+    }
+
+    m_nodeZ = d;
+    m_nodeFraction.resize(n);
+    for (int i = 0; i < n; ++i) {
+        m_nodeFraction[i] = v[i] * v[i];
+    }
+}
+
+// ========== Elevation Tables ==========
+
+const ChapmanSlantIntegrator::ElevationTable& ChapmanSlantIntegrator::tableFor(double hmF2) {
+    long key = std::lround(hmF2 * 10.0);
+
+    auto it = m_tables.find(key);
+    if (it != m_tables.end()) {
+        return it->second;
+    }
+
+    if (m_tables.size() >= MAX_CACHED_PROFILES) {
+        m_tables.clear();
+    }
+
+    const double R = SystemConstants::EARTH_RADIUS_KM;
+    ElevationTable table;
+    table.range_km.resize(static_cast<size_t>(m_numBins) * m_numNodes);
+    table.weight.resize(table.range_km.size());
+
+    for (int b = 0; b < m_numBins; ++b) {
+        double elevation = std::min(b * m_elevationStep, M_PI / 2.0);
+        double R_sinE = R * std::sin(elevation);
+
+        for (int i = 0; i < m_numNodes; ++i) {
+            double h = std::max(MIN_NODE_HEIGHT_KM, hmF2 + m_scaleHeight * m_nodeZ[i]);
+            double root = std::sqrt(R_sinE * R_sinE + h * (2.0 * R + h));
+
+            size_t idx = static_cast<size_t>(b) * m_numNodes + i;
+            table.range_km[idx] = root - R_sinE;
+            table.weight[idx] = m_nodeFraction[i] * (R + h) / root;
+        }
+    }
+
+    return m_tables.emplace(key, std::move(table)).first->second;
+}
+
+void ChapmanSlantIntegrator::lookupBin(double elevation, int& bin, double& fraction) const {
+    double position = std::max(0.0, std::min(elevation, M_PI / 2.0)) / m_elevationStep;
+    bin = std::min(static_cast<int>(position), m_numBins - 2);
+    fraction = position - bin;
+}
+
+// ========== Slant Factor ==========
+
+double ChapmanSlantIntegrator::calculateSlantFactor(double elevation, double hmF2) {
+    const ElevationTable& table = tableFor(hmF2);
+
+    int bin;
+    double t;
+    lookupBin(elevation, bin, t);
+
+    const double* w0 = &table.weight[static_cast<size_t>(bin) * m_numNodes];
+    const double* w1 = w0 + m_numNodes;
+
+    double factor = 0.0;
+    for (int i = 0; i < m_numNodes; ++i) {
+        factor += w0[i] + t * (w1[i] - w0[i]);
+    }
+    return factor;
+}
+
+// ========== Slant Path Integration ==========
+
+void ChapmanSlantIntegrator::integrate(
+    const SlantRay* rays,
+    std::size_t count,
+    const PreparedMagneticField& field,
+    double frequency_MHz,
+    double* rotation_rad,
+    double* slantFactor) {
+
+    const double R = SystemConstants::EARTH_RADIUS_KM;
+    const size_t totalNodes = count * static_cast<size_t>(m_numNodes);
+
+    m_x.resize(totalNodes);
+    m_y.resize(totalNodes);
+    m_z.resize(totalNodes);
+    m_kNorth.resize(totalNodes);
+    m_kEast.resize(totalNodes);
+    m_kUp.resize(totalNodes);
+    m_weight.resize(totalNodes);
+    m_bNorth.resize(totalNodes);
+    m_bEast.resize(totalNodes);
+    m_bDown.resize(totalNodes);
+
+    // ---- Gather node positions and local ray directions ----
+    for (size_t r = 0; r < count; ++r) {
+        const SlantRay& ray = rays[r];
+        const ElevationTable& table = tableFor(ray.hmF2);
+
+        int bin;
+        double t;
+        lookupBin(ray.elevation, bin, t);
+
+        double sinLat = std::sin(ray.latitude), cosLat = std::cos(ray.latitude);
+        double sinLon = std::sin(ray.longitude), cosLon = std::cos(ray.longitude);
+        double sinEl = std::sin(ray.elevation), cosEl = std::cos(ray.elevation);
+        double sinAz = std::sin(ray.azimuth), cosAz = std::cos(ray.azimuth);
+
+        double up[3] = { cosLat * cosLon, cosLat * sinLon, sinLat };
+        double north[3] = { -sinLat * cosLon, -sinLat * sinLon, cosLat };
+        double east[3] = { -sinLon, cosLon, 0.0 };
+
+        double k[3];
+        for (int c = 0; c < 3; ++c) {
+            k[c] = cosEl * cosAz * north[c] + cosEl * sinAz * east[c] + sinEl * up[c];
+        }
+
+        const double* s0 = &table.range_km[static_cast<size_t>(bin) * m_numNodes];
+        const double* s1 = s0 + m_numNodes;
+        const double* w0 = &table.weight[static_cast<size_t>(bin) * m_numNodes];
+        const double* w1 = w0 + m_numNodes;
+
+        for (int i = 0; i < m_numNodes; ++i) {
+            size_t idx = r * m_numNodes + i;
+            double s = s0[i] + t * (s1[i] - s0[i]);
+
+            double px = R * up[0] + s * k[0];
+            double py = R * up[1] + s * k[1];
+            double pz = R * up[2] + s * k[2];
+
+            double rho = std::sqrt(px * px + py * py);
+            double radius = std::sqrt(rho * rho + pz * pz);
+            double nSinLat = pz / radius, nCosLat = rho / radius;
+            double nCosLon = rho > 0.0 ? px / rho : 1.0;
+            double nSinLon = rho > 0.0 ? py / rho : 0.0;
+
+            m_x[idx] = px;
+            m_y[idx] = py;
+            m_z[idx] = pz;
+
+            m_kUp[idx] = (k[0] * nCosLon + k[1] * nSinLon) * nCosLat + k[2] * nSinLat;
+            m_kNorth[idx] = -(k[0] * nCosLon + k[1] * nSinLon) * nSinLat + k[2] * nCosLat;
+            m_kEast[idx] = -k[0] * nSinLon + k[1] * nCosLon;
+            m_weight[idx] = w0[i] + t * (w1[i] - w0[i]);
+        }
+    }
+
+    // ---- One batch field evaluation for every node ----
+    field.evaluateCartesianBatch(m_x.data(), m_y.data(), m_z.data(), totalNodes,
+                                 m_bNorth.data(), m_bEast.data(), m_bDown.data());
+
+    // ---- Reduce per ray ----
+    const double scale = SystemConstants::FARADAY_CONSTANT / (frequency_MHz * frequency_MHz);
+
+    for (size_t r = 0; r < count; ++r) {
+        double integral = 0.0;
+        double factor = 0.0;
+
+        for (int i = 0; i < m_numNodes; ++i) {
+            size_t idx = r * m_numNodes + i;
+            double B_parallel = m_bNorth[idx] * m_kNorth[idx] +
+                                m_bEast[idx] * m_kEast[idx] -
+                                m_bDown[idx] * m_kUp[idx];
+            integral += m_weight[idx] * B_parallel;
+            factor += m_weight[idx];
+        }
+
+        if (rotation_rad) {
+            rotation_rad[r] = scale * rays[r].vTEC * integral;
+        }
+        if (slantFactor) {
+            slantFactor[r] = factor;
+        }
+    }
+}
+
+double ChapmanSlantIntegrator::calculateRotation(
+    const SlantRay& ray,
+    const PreparedMagneticField& field,
+    double frequency_MHz) {
+
+    double rotation = 0.0;
+    integrate(&ray, 1, field, frequency_MHz, &rotation, nullptr);
+    return rotation;
+}
@@ -0,0 +1,74 @@
+#pragma once
+
+#include "GeomagneticField.h"
+#include <cstddef>
+#include <map>
+#include <vector>
+
+// ========== Slant Ray ==========
+
+struct SlantRay {
+    double latitude;
+    double longitude;
+    double elevation;
+    double azimuth;
+    double vTEC;
+    double hmF2;
+};
+
+// ========== Chapman Slant-Path Integrator ==========
+// Integrates N_e * (B . k) along the straight ray from a station through a Chapman
+// layer scaled to the station vTEC. The Chapman profile itself is the quadrature
+// weight in the reduced height z = (h - hmF2) / H, so a short Gauss rule built for
+// it is enough. Node ranges and weights are tabulated per elevation bin and hmF2.
+
+class ChapmanSlantIntegrator {
+public:
+    explicit ChapmanSlantIntegrator(
+        int numNodes = 8,
+        double elevationStep_deg = 0.25,
+        double scaleHeight_km = 60.0);
+
+    // All nodes of all rays are evaluated in a single batch field call.
+    void integrate(
+        const SlantRay* rays,
+        std::size_t count,
+        const PreparedMagneticField& field,
+        double frequency_MHz,
+        double* rotation_rad,
+        double* slantFactor);
+
+    double calculateRotation(
+        const SlantRay& ray,
+        const PreparedMagneticField& field,
+        double frequency_MHz);
+
+    // Ratio of slant to vertical TEC through the Chapman layer.
+    double calculateSlantFactor(double elevation, double hmF2);
+
+    int getNumNodes() const { return m_numNodes; }
+    double getScaleHeight() const { return m_scaleHeight; }
+
+private:
+    struct ElevationTable {
+        std::vector<double> range_km;
+        std::vector<double> weight;
+    };
+
+    int m_numNodes;
+    int m_numBins;
+    double m_elevationStep;
+    double m_scaleHeight;
+
+    std::vector<double> m_nodeZ;
+    std::vector<double> m_nodeFraction;
+    std::map<long, ElevationTable> m_tables;
+
+    std::vector<double> m_x, m_y, m_z;
+    std::vector<double> m_kNorth, m_kEast, m_kUp, m_weight;
+    std::vector<double> m_bNorth, m_bEast, m_bDown;
+
+    void buildProfileNodes();
+    const ElevationTable& tableFor(double hmF2);
+    void lookupBin(double elevation, int& bin, double& fraction) const;
+};
@@ -0,0 +1,63 @@
+#include "ClimatologyTecSource.h"
+#include <cmath>
+
+namespace {
+    constexpr double SEMICIRCLE_PER_DEG = 1.0 / 180.0;
+    constexpr double PI = 3.14159265358979323846;
+
+    // TECU per second of L1 group delay: c f1^2 / (40.3 * 1e16).
+    constexpr double L1_HZ = 1575.42e6;
+    constexpr double TECU_PER_SECOND = 299792458.0 * L1_HZ * L1_HZ / (40.3 * 1e16);
+}
+
+// ========== Constructor ==========
+
+ClimatologyTecSource::ClimatologyTecSource() {
+    const double alpha[4] = { 1.1176e-08, 7.4506e-09, -5.9605e-08, -5.9605e-08 };
+    const double beta[4] = { 9.0112e+04, 4.9152e+04, -1.3107e+05, -3.2768e+05 };
+    setCoefficients(alpha, beta);
+}
+
+void ClimatologyTecSource::setCoefficients(const double alpha[4], const double beta[4]) {
+    for (int i = 0; i < 4; ++i) {
+        m_alpha[i] = alpha[i];
+        m_beta[i] = beta[i];
+    }
+}
+
+// ========== Evaluation ==========
+
+double ClimatologyTecSource::evaluate(double lat_deg, double lon_deg, double secondOfDay) const {
+    const double phi = lat_deg * SEMICIRCLE_PER_DEG;
+    const double lambda = lon_deg * SEMICIRCLE_PER_DEG;
+
+    // Geomagnetic latitude of the point, in semicircles.
+    double phiM = phi + 0.064 * std::cos((lambda - 1.617) * PI);
+
+    double localTime = 43200.0 * lambda + secondOfDay;
+    localTime -= std::floor(localTime / 86400.0) * 86400.0;
+
+    double amplitude = m_alpha[0] + phiM * (m_alpha[1] + phiM * (m_alpha[2] + phiM * m_alpha[3]));
+    double period = m_beta[0] + phiM * (m_beta[1] + phiM * (m_beta[2] + phiM * m_beta[3]));
+    if (amplitude < 0.0) amplitude = 0.0;
+    if (period < 72000.0) period = 72000.0;
+
+    double x = 2.0 * PI * (localTime - 50400.0) / period;
+    double delay = 5.0e-9;
+    if (std::fabs(x) < 1.57) {
+        double x2 = x * x;
+        delay += amplitude * (1.0 - x2 / 2.0 + x2 * x2 / 24.0);
+    }
+
+    return delay * TECU_PER_SECOND;
+}
+
+bool ClimatologyTecSource::getTecBatch(const std::int64_t* times, const double* lat, const double* lon,
+                                       std::size_t count, double* tec) {
+    for (std::size_t i = 0; i < count; ++i) {
+        std::int64_t secondOfDay = times[i] % 86400;
+        if (secondOfDay < 0) secondOfDay += 86400;
+        tec[i] = evaluate(lat[i], lon[i], static_cast<double>(secondOfDay));
+    }
+    return true;
+}
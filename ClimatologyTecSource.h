@@ -0,0 +1,31 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+// ========== Climatological TEC Source ==========
+// Klobuchar broadcast model (IS-GPS-200 20.3.3.5.2.5) evaluated at the vertical and
+// converted from L1 group delay to TECU. A half-cosine daytime bulge peaking at
+// 14:00 local time over a constant night-time floor, with amplitude and period as
+// cubics in geomagnetic latitude. Crude (roughly 50% RMS) but defined everywhere
+// and at all times, which makes it the last layer of a blend.
+
+class ClimatologyTecSource {
+public:
+    // Starts with typical mid-cycle coefficients.
+    ClimatologyTecSource();
+
+    // Alpha in s/semicircle^n, beta in s/semicircle^n, as broadcast in GPS navigation data.
+    void setCoefficients(const double alpha[4], const double beta[4]);
+
+    bool getTecBatch(const std::int64_t* times, const double* lat, const double* lon,
+                     std::size_t count, double* tec);
+    const char* getName() const { return "Klobuchar"; }
+
+    // Vertical TEC in TECU at one point and second of the UTC day.
+    double evaluate(double lat_deg, double lon_deg, double secondOfDay) const;
+
+private:
+    double m_alpha[4];
+    double m_beta[4];
+};
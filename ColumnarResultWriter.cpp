@@ -0,0 +1,413 @@
+#include "ColumnarResultWriter.h"
+#include <cmath>
+#include <cstring>
+#include <limits>
+
+namespace {
+    const char FILE_MAGIC[7] = { 'F', 'R', 'C', 'O', 'L', 0, 0 };
+    const char CHUNK_MAGIC[8] = { 'F', 'R', 'C', 'H', 'U', 'N', 'K', 0 };
+
+    // Numeric columns in file order, after id.
+    const char* NUMBER_NAMES[] = {
+        "time", "freq_MHz",
+        "PLF", "loss_dB", "efficiency",
+        "spatial_deg", "faraday_DX_deg", "faraday_Home_deg", "total_deg",
+        "parallactic_DX_deg", "parallactic_Home_deg",
+        "slant_DX", "slant_Home", "path_km", "delay_ms",
+        "elevation_DX_deg", "azimuth_DX_deg", "elevation_Home_deg", "azimuth_Home_deg",
+        "vTEC_DX", "vTEC_Home",
+    };
+
+    const char* PASSBAND_NAMES[] = {
+        "PLF_avg", "PLF_min", "PLF_max", "depolarization", "spread_deg",
+    };
+
+    const char* POLARIZATION_NAMES[] = {
+        "psi_opt_deg", "PLF_opt", "arrival_psi_deg", "arrival_chi_deg", "PLF_cross", "PLF_dual",
+    };
+
+    const char* SENSITIVITY_NAMES[] = {
+        "dPLF_dvTEC_DX", "dPLF_dvTEC_Home", "dPLF_dB_DX", "dPLF_dB_Home", "dPLF_dt",
+    };
+
+    template <typename T>
+    void appendRaw(std::string& out, const T& value) {
+        out.append(reinterpret_cast<const char*>(&value), sizeof(T));
+    }
+
+    // Zero-fill to the next multiple of 8 bytes counted from base.
+    void pad(std::string& out, std::size_t base) {
+        out.append((8 - (out.size() - base) % 8) % 8, '\0');
+    }
+
+    void appendColumn(std::string& out, std::size_t base, const void* data, std::size_t bytes) {
+        appendRaw(out, static_cast<std::uint64_t>(bytes));
+        out.append(static_cast<const char*>(data), bytes);
+        pad(out, base);
+    }
+
+    void appendStrings(std::string& out, std::size_t base,
+                       const std::vector<std::uint64_t>& ends, const std::string& text) {
+        const std::uint64_t bytes = (ends.size() + 1) * sizeof(std::uint64_t) + text.size();
+        const std::uint64_t start = 0;
+        appendRaw(out, bytes);
+        appendRaw(out, start);
+        out.append(reinterpret_cast<const char*>(ends.data()), ends.size() * sizeof(std::uint64_t));
+        out.append(text);
+        pad(out, base);
+    }
+}
+
+// ========== Writer ==========
+
+ColumnarResultWriter::ColumnarResultWriter()
+    : m_passband(false), m_polarization(false), m_sensitivity(false) {
+    static_assert(sizeof(NUMBER_NAMES) / sizeof(NUMBER_NAMES[0]) == NUMBER_COLUMNS, "column table");
+    static_assert(sizeof(PASSBAND_NAMES) / sizeof(PASSBAND_NAMES[0]) == PASSBAND_COLUMNS, "column table");
+    static_assert(sizeof(POLARIZATION_NAMES) / sizeof(POLARIZATION_NAMES[0]) == POLARIZATION_COLUMNS, "column table");
+    static_assert(sizeof(SENSITIVITY_NAMES) / sizeof(SENSITIVITY_NAMES[0]) == SENSITIVITY_COLUMNS, "column table");
+}
+
+const std::vector<ColumnInfo>& ColumnarResultWriter::getSchema(bool passband, bool polarization,
+                                                               bool sensitivity) {
+    auto build = [](bool withPassband, bool withPolarization, bool withSensitivity) {
+        std::vector<ColumnInfo> columns;
+        columns.emplace_back("id", ColumnType::STRING);
+        for (const char* name : NUMBER_NAMES) {
+            columns.emplace_back(name, ColumnType::F64);
+        }
+        if (withPassband) {
+            for (const char* name : PASSBAND_NAMES) {
+                columns.emplace_back(name, ColumnType::F64);
+            }
+        }
+        if (withPolarization) {
+            for (const char* name : POLARIZATION_NAMES) {
+                columns.emplace_back(name, ColumnType::F64);
+            }
+        }
+        if (withSensitivity) {
+            for (const char* name : SENSITIVITY_NAMES) {
+                columns.emplace_back(name, ColumnType::F64);
+            }
+        }
+        columns.emplace_back("faraday", ColumnType::U8);
+        columns.emplace_back("ok", ColumnType::U8);
+        columns.emplace_back("error", ColumnType::STRING);
+        return columns;
+    };
+    static const std::vector<ColumnInfo> schemas[8] = {
+        build(false, false, false), build(true, false, false),
+        build(false, true, false), build(true, true, false),
+        build(false, false, true), build(true, false, true),
+        build(false, true, true), build(true, true, true)
+    };
+    return schemas[(passband ? 1 : 0) + (polarization ? 2 : 0) + (sensitivity ? 4 : 0)];
+}
+
+void ColumnarResultWriter::writeHeader(std::string& out, bool passband, bool polarization,
+                                       bool sensitivity) {
+    const std::size_t start = out.size();
+    out.append(FILE_MAGIC, sizeof(FILE_MAGIC));
+    out.push_back(static_cast<char>(VERSION));
+    const std::vector<ColumnInfo>& schema = getSchema(passband, polarization, sensitivity);
+    appendRaw(out, static_cast<std::uint32_t>(schema.size()));
+    appendRaw(out, static_cast<std::uint32_t>(0));
+    for (const ColumnInfo& column : schema) {
+        out.push_back(static_cast<char>(column.type));
+        out.push_back(static_cast<char>(column.name.size()));
+        out.append(column.name);
+    }
+    pad(out, start);
+}
+
+void ColumnarResultWriter::addResult(const std::string& id, double time, double frequency_MHz,
+                                     const CalculationResults& result, const MoonEphemeris& moon,
+                                     const IonosphereData& iono, bool faraday,
+                                     const PassbandResult* passband,
+                                     const PolarizationSolution* polarization,
+                                     const PLFSensitivity* sensitivity) {
+    const double values[NUMBER_COLUMNS] = {
+        time, frequency_MHz,
+        result.PLF, result.polarizationLoss_dB, result.polarizationEfficiency,
+        result.spatialRotation_deg, result.faradayRotation_DX_deg,
+        result.faradayRotation_Home_deg, result.totalRotation_deg,
+        result.parallacticAngle_DX_deg, result.parallacticAngle_Home_deg,
+        result.slantFactor_DX, result.slantFactor_Home,
+        result.pathLength_km, result.propagationDelay_ms,
+        ParameterUtils::rad2deg(moon.elevation_DX), ParameterUtils::rad2deg(moon.azimuth_DX),
+        ParameterUtils::rad2deg(moon.elevation_Home), ParameterUtils::rad2deg(moon.azimuth_Home),
+        iono.vTEC_DX, iono.vTEC_Home,
+    };
+    for (int i = 0; i < NUMBER_COLUMNS; ++i) {
+        m_numbers[i].push_back(values[i]);
+    }
+    if (m_passband) {
+        const double nan = std::numeric_limits<double>::quiet_NaN();
+        const double metrics[PASSBAND_COLUMNS] = {
+            passband ? passband->averagePLF : nan,
+            passband ? passband->minPLF : nan,
+            passband ? passband->maxPLF : nan,
+            passband ? passband->depolarization : nan,
+            passband ? passband->rotationSpread_deg : nan,
+        };
+        for (int i = 0; i < PASSBAND_COLUMNS; ++i) {
+            m_passbandNumbers[i].push_back(metrics[i]);
+        }
+    }
+    if (m_polarization) {
+        const double nan = std::numeric_limits<double>::quiet_NaN();
+        const double metrics[POLARIZATION_COLUMNS] = {
+            polarization ? polarization->optimalPsi_deg : nan,
+            polarization ? polarization->optimalPLF : nan,
+            polarization ? polarization->arrivalPsi_deg : nan,
+            polarization ? polarization->arrivalChi_deg : nan,
+            polarization ? polarization->crossPLF : nan,
+            polarization ? polarization->combinedPLF : nan,
+        };
+        for (int i = 0; i < POLARIZATION_COLUMNS; ++i) {
+            m_polarizationNumbers[i].push_back(metrics[i]);
+        }
+    }
+    if (m_sensitivity) {
+        const double nan = std::numeric_limits<double>::quiet_NaN();
+        const double metrics[SENSITIVITY_COLUMNS] = {
+            sensitivity ? sensitivity->dPLF_dvTEC_DX : nan,
+            sensitivity ? sensitivity->dPLF_dvTEC_Home : nan,
+            sensitivity ? sensitivity->dPLF_dB_DX : nan,
+            sensitivity ? sensitivity->dPLF_dB_Home : nan,
+            sensitivity ? sensitivity->dPLF_dTime : nan,
+        };
+        for (int i = 0; i < SENSITIVITY_COLUMNS; ++i) {
+            m_sensitivityNumbers[i].push_back(metrics[i]);
+        }
+    }
+    m_faraday.push_back(faraday ? 1 : 0);
+    m_ok.push_back(1);
+    m_ids.append(id);
+    m_idEnds.push_back(m_ids.size());
+    m_errorEnds.push_back(m_errors.size());
+}
+
+void ColumnarResultWriter::addFailure(const std::string& id, double time, double frequency_MHz,
+                                      const std::string& message) {
+    m_numbers[0].push_back(time);
+    m_numbers[1].push_back(frequency_MHz);
+    for (int i = 2; i < NUMBER_COLUMNS; ++i) {
+        m_numbers[i].push_back(std::numeric_limits<double>::quiet_NaN());
+    }
+    if (m_passband) {
+        for (auto& column : m_passbandNumbers) column.push_back(std::numeric_limits<double>::quiet_NaN());
+    }
+    if (m_polarization) {
+        for (auto& column : m_polarizationNumbers) column.push_back(std::numeric_limits<double>::quiet_NaN());
+    }
+    if (m_sensitivity) {
+        for (auto& column : m_sensitivityNumbers) column.push_back(std::numeric_limits<double>::quiet_NaN());
+    }
+    m_faraday.push_back(0);
+    m_ok.push_back(0);
+    m_ids.append(id);
+    m_idEnds.push_back(m_ids.size());
+    m_errors.append(message);
+    m_errorEnds.push_back(m_errors.size());
+}
+
+void ColumnarResultWriter::flush(std::string& out) {
+    const std::size_t rows = getRowCount();
+    if (rows == 0) {
+        return;
+    }
+
+    // Chunks are whole multiples of 8 bytes, so padding is counted from the chunk start.
+    const std::size_t base = out.size();
+    const int numbers = NUMBER_COLUMNS + (m_passband ? PASSBAND_COLUMNS : 0) +
+                        (m_polarization ? POLARIZATION_COLUMNS : 0) +
+                        (m_sensitivity ? SENSITIVITY_COLUMNS : 0);
+    out.reserve(base + 64 + 8 * (numbers + 4) +
+                rows * (numbers * sizeof(double) + 2 + 2 * sizeof(std::uint64_t)) +
+                m_ids.size() + m_errors.size());
+    out.append(CHUNK_MAGIC, sizeof(CHUNK_MAGIC));
+    appendRaw(out, static_cast<std::uint64_t>(rows));
+    appendStrings(out, base, m_idEnds, m_ids);
+    for (int i = 0; i < NUMBER_COLUMNS; ++i) {
+        appendColumn(out, base, m_numbers[i].data(), rows * sizeof(double));
+    }
+    if (m_passband) {
+        for (int i = 0; i < PASSBAND_COLUMNS; ++i) {
+            appendColumn(out, base, m_passbandNumbers[i].data(), rows * sizeof(double));
+        }
+    }
+    if (m_polarization) {
+        for (int i = 0; i < POLARIZATION_COLUMNS; ++i) {
+            appendColumn(out, base, m_polarizationNumbers[i].data(), rows * sizeof(double));
+        }
+    }
+    if (m_sensitivity) {
+        for (int i = 0; i < SENSITIVITY_COLUMNS; ++i) {
+            appendColumn(out, base, m_sensitivityNumbers[i].data(), rows * sizeof(double));
+        }
+    }
+    appendColumn(out, base, m_faraday.data(), rows);
+    appendColumn(out, base, m_ok.data(), rows);
+    appendStrings(out, base, m_errorEnds, m_errors);
+
+    for (auto& column : m_numbers) column.clear();
+    for (auto& column : m_passbandNumbers) column.clear();
+    for (auto& column : m_polarizationNumbers) column.clear();
+    for (auto& column : m_sensitivityNumbers) column.clear();
+    m_faraday.clear();
+    m_ok.clear();
+    m_ids.clear();
+    m_idEnds.clear();
+    m_errors.clear();
+    m_errorEnds.clear();
+}
+
+// ========== Reader ==========
+
+bool ColumnarResultReader::open(const std::string& filename) {
+    m_file.close();
+    m_file.clear();
+    m_columns.clear();
+    m_rows = 0;
+    m_file.open(filename, std::ios::binary);
+    if (!m_file.is_open()) {
+        m_error = "Cannot open " + filename;
+        return false;
+    }
+
+    char magic[8];
+    std::uint32_t count = 0, reserved = 0;
+    if (!m_file.read(magic, 8) || std::memcmp(magic, FILE_MAGIC, sizeof(FILE_MAGIC)) != 0 ||
+        magic[7] != static_cast<char>(ColumnarResultWriter::VERSION) ||
+        !m_file.read(reinterpret_cast<char*>(&count), 4) || !m_file.read(reinterpret_cast<char*>(&reserved), 4)) {
+        m_error = filename + " is not a version 1 columnar result file";
+        return false;
+    }
+
+    std::size_t headerBytes = 16;
+    for (std::uint32_t i = 0; i < count; ++i) {
+        unsigned char typeAndLength[2];
+        if (!m_file.read(reinterpret_cast<char*>(typeAndLength), 2)) {
+            m_error = "Truncated header in " + filename;
+            return false;
+        }
+        std::string name(typeAndLength[1], '\0');
+        if (!m_file.read(name.data(), static_cast<std::streamsize>(name.size())) ||
+            typeAndLength[0] < 1 || typeAndLength[0] > 3) {
+            m_error = "Bad column in " + filename;
+            return false;
+        }
+        m_columns.emplace_back(name, static_cast<ColumnType>(typeAndLength[0]));
+        headerBytes += 2 + name.size();
+    }
+    m_file.ignore(static_cast<std::streamsize>((8 - headerBytes % 8) % 8));
+    m_data.assign(m_columns.size(), {});
+    m_lengths.assign(m_columns.size(), 0);
+    m_error.clear();
+    return true;
+}
+
+int ColumnarResultReader::findColumn(const std::string& name) const {
+    for (std::size_t i = 0; i < m_columns.size(); ++i) {
+        if (m_columns[i].name == name) return static_cast<int>(i);
+    }
+    return -1;
+}
+
+bool ColumnarResultReader::nextChunk() {
+    m_rows = 0;
+    char magic[8];
+    std::uint64_t rows = 0;
+    if (!m_file.read(magic, 8)) {
+        return false;   // clean end of file
+    }
+    if (std::memcmp(magic, CHUNK_MAGIC, 8) != 0 || !m_file.read(reinterpret_cast<char*>(&rows), 8)) {
+        m_error = "Damaged chunk";
+        return false;
+    }
+
+    // Lengths are checked against the rows and the bytes left in the file before
+    // anything is allocated, so a damaged length cannot ask for gigabytes.
+    const std::streamoff position = m_file.tellg();
+    m_file.seekg(0, std::ios::end);
+    const std::uint64_t fileEnd = static_cast<std::uint64_t>(m_file.tellg());
+    m_file.seekg(position);
+    std::uint64_t remaining = fileEnd - static_cast<std::uint64_t>(position);
+
+    for (std::size_t i = 0; i < m_columns.size(); ++i) {
+        std::uint64_t bytes = 0;
+        if (remaining < 8 || !m_file.read(reinterpret_cast<char*>(&bytes), 8)) {
+            m_error = "Truncated chunk";
+            return false;
+        }
+        remaining -= 8;
+
+        bool sized = false;
+        switch (m_columns[i].type) {
+        case ColumnType::F64:    sized = bytes % sizeof(double) == 0 && bytes / sizeof(double) == rows; break;
+        case ColumnType::U8:     sized = bytes == rows; break;
+        case ColumnType::STRING: sized = bytes / sizeof(std::uint64_t) > rows; break;
+        }
+        if (!sized) {
+            m_error = "Column " + m_columns[i].name + " has the wrong size";
+            return false;
+        }
+        if (bytes > remaining) {
+            m_error = "Truncated chunk";
+            return false;
+        }
+        const std::uint64_t padded = (bytes + 7) / 8 * 8;
+        m_data[i].resize(static_cast<std::size_t>(padded / 8));
+        m_lengths[i] = bytes;
+        if (padded > remaining ||
+            !m_file.read(reinterpret_cast<char*>(m_data[i].data()), static_cast<std::streamsize>(padded))) {
+            m_error = "Truncated chunk";
+            return false;
+        }
+        remaining -= padded;
+
+        // String offsets must run from 0 to the text length without going back.
+        if (m_columns[i].type == ColumnType::STRING) {
+            const std::uint64_t* ends = m_data[i].data();
+            const std::uint64_t textLength = bytes - (rows + 1) * sizeof(std::uint64_t);
+            bool ordered = ends[0] == 0 && ends[rows] == textLength;
+            for (std::uint64_t row = 0; ordered && row < rows; ++row) {
+                ordered = ends[row] <= ends[row + 1];
+            }
+            if (!ordered) {
+                m_error = "Column " + m_columns[i].name + " has bad string offsets";
+                return false;
+            }
+        }
+    }
+    m_rows = static_cast<std::size_t>(rows);
+    return true;
+}
+
+const double* ColumnarResultReader::getDoubles(int column) const {
+    if (column < 0 || static_cast<std::size_t>(column) >= m_columns.size() ||
+        m_columns[column].type != ColumnType::F64) {
+        return nullptr;
+    }
+    return reinterpret_cast<const double*>(m_data[column].data());
+}
+
+const std::uint8_t* ColumnarResultReader::getBytes(int column) const {
+    if (column < 0 || static_cast<std::size_t>(column) >= m_columns.size() ||
+        m_columns[column].type != ColumnType::U8) {
+        return nullptr;
+    }
+    return reinterpret_cast<const std::uint8_t*>(m_data[column].data());
+}
+
+std::string_view ColumnarResultReader::getString(int column, std::size_t row) const {
+    if (column < 0 || static_cast<std::size_t>(column) >= m_columns.size() ||
+        m_columns[column].type != ColumnType::STRING || row >= m_rows) {
+        return std::string_view();
+    }
+    const std::uint64_t* ends = m_data[column].data();
+    const char* text = reinterpret_cast<const char*>(ends + m_rows + 1);
+    return std::string_view(text + ends[row], static_cast<std::size_t>(ends[row + 1] - ends[row]));
+}
@@ -0,0 +1,133 @@
+#pragma once
+
+#include "Parameters.h"
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <fstream>
+#include <string>
+#include <string_view>
+#include <vector>
+
+// ========== Columnar Result Format ==========
+// Binary result files for sweeps and maps, one contiguous column per field:
+//
+//   header  "FRCOL\0\0" + version byte, uint32 column count, uint32 reserved,
+//           then per column: uint8 type, uint8 name length, name;
+//           zero-padded to a multiple of 8 bytes
+//   chunk*  "FRCHUNK\0", uint64 rows, then per column: uint64 byte length,
+//           the column data, zero-padded to a multiple of 8 bytes
+//
+// F64 columns hold `rows` doubles, U8 columns `rows` bytes, and STRING columns
+// rows + 1 uint64 end offsets (starting with 0) followed by the text. A file is
+// a header followed by any number of chunks, so more chunks can be appended to
+// an existing file at any time. Values are in host byte order, as in the lunar
+// cache files. Failed rows have ok = 0, an error text and NaN values.
+
+enum class ColumnType : std::uint8_t {
+    F64 = 1,
+    U8 = 2,
+    STRING = 3
+};
+
+struct ColumnInfo {
+    std::string name;
+    ColumnType type;
+
+    ColumnInfo() : type(ColumnType::F64) {}
+    ColumnInfo(const std::string& columnName, ColumnType columnType)
+        : name(columnName), type(columnType) {}
+};
+
+// ========== Columnar Result Writer ==========
+// Gathers rows column by column; flush() encodes them as one chunk. Each
+// thread keeps its own writer and the chunks are written in order. With
+// passband metrics on, PLF_avg, PLF_min, PLF_max, depolarization and
+// spread_deg follow vTEC_Home; with polarization on, psi_opt_deg, PLF_opt,
+// arrival_psi_deg, arrival_chi_deg, PLF_cross and PLF_dual come next; with
+// sensitivities on, dPLF_dvTEC_DX, dPLF_dvTEC_Home, dPLF_dB_DX, dPLF_dB_Home
+// and dPLF_dt close the numeric columns.
+
+class ColumnarResultWriter {
+public:
+    static constexpr std::uint8_t VERSION = 1;
+
+    ColumnarResultWriter();
+
+    static const std::vector<ColumnInfo>& getSchema(bool passband = false, bool polarization = false,
+                                                    bool sensitivity = false);
+    static void writeHeader(std::string& out, bool passband = false, bool polarization = false,
+                            bool sensitivity = false);
+
+    // Set before the first row; every chunk of a file must agree with its header.
+    void setPassband(bool passband) { m_passband = passband; }
+    bool getPassband() const { return m_passband; }
+    void setPolarization(bool polarization) { m_polarization = polarization; }
+    bool getPolarization() const { return m_polarization; }
+    void setSensitivity(bool sensitivity) { m_sensitivity = sensitivity; }
+    bool getSensitivity() const { return m_sensitivity; }
+
+    void addResult(const std::string& id, double time, double frequency_MHz,
+                   const CalculationResults& result, const MoonEphemeris& moon,
+                   const IonosphereData& iono, bool faraday,
+                   const PassbandResult* passband = nullptr,
+                   const PolarizationSolution* polarization = nullptr,
+                   const PLFSensitivity* sensitivity = nullptr);
+    void addFailure(const std::string& id, double time, double frequency_MHz,
+                    const std::string& message);
+
+    std::size_t getRowCount() const { return m_ok.size(); }
+
+    // Appends the gathered rows as one chunk and starts the next; nothing when
+    // there are no rows.
+    void flush(std::string& out);
+
+private:
+    static constexpr int NUMBER_COLUMNS = 21;
+    static constexpr int PASSBAND_COLUMNS = 5;
+    static constexpr int POLARIZATION_COLUMNS = 6;
+    static constexpr int SENSITIVITY_COLUMNS = 5;
+
+    bool m_passband;
+    bool m_polarization;
+    bool m_sensitivity;
+    std::array<std::vector<double>, NUMBER_COLUMNS> m_numbers;
+    std::array<std::vector<double>, PASSBAND_COLUMNS> m_passbandNumbers;
+    std::array<std::vector<double>, POLARIZATION_COLUMNS> m_polarizationNumbers;
+    std::array<std::vector<double>, SENSITIVITY_COLUMNS> m_sensitivityNumbers;
+    std::vector<std::uint8_t> m_faraday;
+    std::vector<std::uint8_t> m_ok;
+    std::string m_ids;
+    std::vector<std::uint64_t> m_idEnds;
+    std::string m_errors;
+    std::vector<std::uint64_t> m_errorEnds;
+};
+
+// ========== Columnar Result Reader ==========
+
+class ColumnarResultReader {
+public:
+    bool open(const std::string& filename);
+    const std::vector<ColumnInfo>& getColumns() const { return m_columns; }
+    int findColumn(const std::string& name) const;
+
+    // Loads the next chunk; false at the end of the file or on a damaged chunk
+    // (then getError() is set).
+    bool nextChunk();
+    std::size_t getRowCount() const { return m_rows; }
+
+    const double* getDoubles(int column) const;
+    const std::uint8_t* getBytes(int column) const;
+    std::string_view getString(int column, std::size_t row) const;
+
+    const std::string& getError() const { return m_error; }
+
+private:
+    std::ifstream m_file;
+    std::vector<ColumnInfo> m_columns;
+    // Column data, kept 8-byte aligned so F64 columns can be used in place.
+    std::vector<std::vector<std::uint64_t>> m_data;
+    std::vector<std::uint64_t> m_lengths;
+    std::size_t m_rows = 0;
+    std::string m_error;
+};
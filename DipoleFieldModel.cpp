@@ -0,0 +1,31 @@
+#include "DipoleFieldModel.h"
+#include "WMMModel.h"
+
+// ========== Constructors ==========
+
+DipoleFieldModel::DipoleFieldModel()
+    : DipoleFieldModel(std::make_shared<WMMModel>()) {
+}
+
+DipoleFieldModel::DipoleFieldModel(std::shared_ptr<const GeomagneticModel> source)
+    : m_source(std::move(source)), m_fixed(),
+      m_modelName(m_source ? "Dipole (" + m_source->getModelName() + ")" : "Dipole") {
+}
+
+DipoleFieldModel::DipoleFieldModel(double g10, double g11, double h11)
+    : m_source(nullptr), m_fixed(PreparedMagneticField::tiltedDipole(g10, g11, h11)),
+      m_modelName("Dipole") {
+}
+
+// ========== Evaluation ==========
+
+PreparedMagneticField DipoleFieldModel::prepare(double decimal_year) const {
+    if (m_source) {
+        return m_source->prepare(decimal_year).truncated(1);
+    }
+    return m_fixed;
+}
+
+bool DipoleFieldModel::isLoaded() const {
+    return m_source ? m_source->isLoaded() : m_fixed.isValid();
+}
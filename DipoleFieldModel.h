@@ -0,0 +1,25 @@
+#pragma once
+
+#include "GeomagneticField.h"
+#include <memory>
+#include <string>
+
+// ========== Tilted Dipole Model ==========
+// Degree-1 truncation of a full model (or fixed Gauss coefficients) evaluated in
+// closed form. Intended for bulk screening runs where the full expansion is not needed.
+
+class DipoleFieldModel : public GeomagneticModel {
+public:
+    DipoleFieldModel();
+    explicit DipoleFieldModel(std::shared_ptr<const GeomagneticModel> source);
+    DipoleFieldModel(double g10, double g11, double h11);
+
+    PreparedMagneticField prepare(double decimal_year) const override;
+    bool isLoaded() const override;
+    const std::string& getModelName() const override { return m_modelName; }
+
+private:
+    std::shared_ptr<const GeomagneticModel> m_source;
+    PreparedMagneticField m_fixed;
+    std::string m_modelName;
+};
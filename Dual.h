@@ -0,0 +1,120 @@
+#pragma once
+
+#include <cmath>
+
+// ========== Dual Numbers ==========
+// Forward-mode automatic differentiation. A Dual carries a value and its
+// derivatives with respect to N inputs; seeding input i with variable(x, i) and
+// running ordinary arithmetic on it yields the value and the whole gradient in
+// one pass, exact to rounding. Code written as a template over its scalar type
+// (see IonospherePhysics) runs unchanged on double or Dual<N>.
+//
+// Comparisons look at the value only, so branches follow the same path as the
+// double code; derivatives are those of the branch taken.
+
+template <int N>
+struct Dual {
+    double value;
+    double d[N];
+
+    Dual() : value(0.0), d() {}
+    Dual(double v) : value(v), d() {}
+
+    static Dual variable(double v, int index) {
+        Dual x(v);
+        x.d[index] = 1.0;
+        return x;
+    }
+
+    Dual& operator+=(const Dual& b) {
+        value += b.value;
+        for (int i = 0; i < N; ++i) d[i] += b.d[i];
+        return *this;
+    }
+    Dual& operator-=(const Dual& b) {
+        value -= b.value;
+        for (int i = 0; i < N; ++i) d[i] -= b.d[i];
+        return *this;
+    }
+    Dual& operator*=(const Dual& b) {
+        for (int i = 0; i < N; ++i) d[i] = d[i] * b.value + value * b.d[i];
+        value *= b.value;
+        return *this;
+    }
+    Dual& operator/=(const Dual& b) {
+        const double inverse = 1.0 / b.value;
+        value *= inverse;
+        for (int i = 0; i < N; ++i) d[i] = (d[i] - value * b.d[i]) * inverse;
+        return *this;
+    }
+};
+
+// ========== Arithmetic ==========
+
+template <int N> Dual<N> operator+(Dual<N> a, const Dual<N>& b) { return a += b; }
+template <int N> Dual<N> operator-(Dual<N> a, const Dual<N>& b) { return a -= b; }
+template <int N> Dual<N> operator*(Dual<N> a, const Dual<N>& b) { return a *= b; }
+template <int N> Dual<N> operator/(Dual<N> a, const Dual<N>& b) { return a /= b; }
+
+template <int N> Dual<N> operator+(Dual<N> a, double b) { a.value += b; return a; }
+template <int N> Dual<N> operator+(double a, Dual<N> b) { b.value += a; return b; }
+template <int N> Dual<N> operator-(Dual<N> a, double b) { a.value -= b; return a; }
+template <int N> Dual<N> operator-(double a, const Dual<N>& b) { return Dual<N>(a) - b; }
+
+template <int N> Dual<N> operator*(Dual<N> a, double b) {
+    a.value *= b;
+    for (int i = 0; i < N; ++i) a.d[i] *= b;
+    return a;
+}
+template <int N> Dual<N> operator*(double a, const Dual<N>& b) { return b * a; }
+template <int N> Dual<N> operator/(const Dual<N>& a, double b) { return a * (1.0 / b); }
+template <int N> Dual<N> operator/(double a, const Dual<N>& b) { return Dual<N>(a) / b; }
+
+template <int N> Dual<N> operator-(Dual<N> a) {
+    a.value = -a.value;
+    for (int i = 0; i < N; ++i) a.d[i] = -a.d[i];
+    return a;
+}
+
+template <int N> bool operator<(const Dual<N>& a, double b) { return a.value < b; }
+template <int N> bool operator>(const Dual<N>& a, double b) { return a.value > b; }
+template <int N> bool operator<(const Dual<N>& a, const Dual<N>& b) { return a.value < b.value; }
+template <int N> bool operator>(const Dual<N>& a, const Dual<N>& b) { return a.value > b.value; }
+
+// ========== Functions ==========
+// Each applies the chain rule with the derivative of the function at the value.
+
+template <int N> Dual<N> chain(double value, double slope, Dual<N> x) {
+    x.value = value;
+    for (int i = 0; i < N; ++i) x.d[i] *= slope;
+    return x;
+}
+
+template <int N> Dual<N> sin(const Dual<N>& x) { return chain(std::sin(x.value), std::cos(x.value), x); }
+template <int N> Dual<N> cos(const Dual<N>& x) { return chain(std::cos(x.value), -std::sin(x.value), x); }
+
+template <int N> Dual<N> sqrt(const Dual<N>& x) {
+    const double root = std::sqrt(x.value);
+    return chain(root, 0.5 / root, x);
+}
+
+template <int N> Dual<N> asin(const Dual<N>& x) {
+    return chain(std::asin(x.value), 1.0 / std::sqrt(1.0 - x.value * x.value), x);
+}
+
+template <int N> Dual<N> log10(const Dual<N>& x) {
+    return chain(std::log10(x.value), 1.0 / (x.value * 2.302585092994046), x);
+}
+
+template <int N> Dual<N> abs(const Dual<N>& x) { return x.value < 0.0 ? -x : x; }
+
+template <int N> Dual<N> atan2(const Dual<N>& y, const Dual<N>& x) {
+    const double scale = 1.0 / (x.value * x.value + y.value * y.value);
+    Dual<N> result(std::atan2(y.value, x.value));
+    for (int i = 0; i < N; ++i) result.d[i] = (x.value * y.d[i] - y.value * x.d[i]) * scale;
+    return result;
+}
+
+// Value of a double or a Dual, for code templated over both.
+inline double valueOf(double x) { return x; }
+template <int N> double valueOf(const Dual<N>& x) { return x.value; }
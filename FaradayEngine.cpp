@@ -0,0 +1,244 @@
+#include "FaradayEngine.h"
+#include "BatchProcessor.h"
+#include "IonosphereDataProvider.h"
+#include "MaidenheadGrid.h"
+#include <cmath>
+#include <cstring>
+#include <exception>
+#include <mutex>
+#include <new>
+#include <string>
+#include <vector>
+
+// ========== Engine ==========
+// The engine drives a BatchProcessor over its own provider, so a job takes the
+// same path as in FaradayBatch and the daemon.
+
+struct fr_engine {
+    IonosphereDataProvider provider;
+    SystemConfiguration config;
+    BatchProcessor processor;
+    BatchProcessor::Workspace work;
+    std::vector<BatchJob> jobs;
+    std::vector<std::size_t> slots;     // index into the caller's arrays per job
+    std::string error;
+    mutable std::mutex mutex;
+
+    fr_engine() {
+        processor.setConfiguration(config);
+        processor.setIonosphereProvider(&provider);
+    }
+};
+
+namespace {
+    fr_status fail(fr_engine* engine, fr_status status, const std::string& message) {
+        engine->error = message;
+        return status;
+    }
+
+    // Every entry point funnels through here so no exception reaches C callers.
+    template <typename Call>
+    fr_status guarded(fr_engine* engine, Call&& call) {
+        try {
+            return call();
+        } catch (const std::bad_alloc&) {
+            return fail(engine, FR_ERROR_INTERNAL, "Out of memory");
+        } catch (const std::exception& e) {
+            return fail(engine, FR_ERROR_INTERNAL, e.what());
+        } catch (...) {
+            return fail(engine, FR_ERROR_INTERNAL, "Unknown error");
+        }
+    }
+
+    bool validStation(const fr_station& station) {
+        return std::isfinite(station.latitude_deg) && std::fabs(station.latitude_deg) <= 90.0 &&
+               std::isfinite(station.longitude_deg) &&
+               std::isfinite(station.psi_deg) && std::isfinite(station.chi_deg);
+    }
+
+    void toSite(const fr_station& station, SiteParameters& site) {
+        site.latitude = ParameterUtils::deg2rad(station.latitude_deg);
+        site.longitude = ParameterUtils::deg2rad(station.longitude_deg);
+        site.psi = ParameterUtils::deg2rad(station.psi_deg);
+        site.chi = ParameterUtils::deg2rad(station.chi_deg);
+    }
+
+    void clearResult(fr_result& result, fr_status status) {
+        std::memset(&result, 0, sizeof(result));
+        result.status = status;
+    }
+}
+
+// ========== Library ==========
+
+int fr_abi_version(void) {
+    return FR_ABI_VERSION;
+}
+
+const char* fr_status_string(fr_status status) {
+    switch (status) {
+    case FR_OK:                  return "OK";
+    case FR_ERROR_ARGUMENT:      return "Invalid argument";
+    case FR_ERROR_FILE:          return "Data file could not be loaded";
+    case FR_ERROR_BELOW_HORIZON: return "Moon is below horizon at one or both stations";
+    case FR_ERROR_CALCULATION:   return "Calculation failed";
+    case FR_ERROR_INTERNAL:      return "Internal error";
+    }
+    return "Unknown status";
+}
+
+fr_status fr_grid_to_location(const char* grid, double* latitude_deg, double* longitude_deg) {
+    if (!grid || !latitude_deg || !longitude_deg) {
+        return FR_ERROR_ARGUMENT;
+    }
+    try {
+        MaidenheadGrid::gridToLatLon(grid, *latitude_deg, *longitude_deg);
+        return FR_OK;
+    } catch (...) {
+        return FR_ERROR_ARGUMENT;
+    }
+}
+
+// ========== Lifecycle ==========
+
+fr_engine* fr_engine_create(void) {
+    try {
+        return new fr_engine();
+    } catch (...) {
+        return nullptr;
+    }
+}
+
+void fr_engine_destroy(fr_engine* engine) {
+    delete engine;
+}
+
+// ========== Data ==========
+
+fr_status fr_engine_load_ionex(fr_engine* engine, const char* path) {
+    if (!engine) return FR_ERROR_ARGUMENT;
+    std::lock_guard<std::mutex> lock(engine->mutex);
+    return guarded(engine, [&] {
+        if (!path) return fail(engine, FR_ERROR_ARGUMENT, "No IONEX path");
+        if (!engine->provider.loadIonexFile(path)) {
+            return fail(engine, FR_ERROR_FILE, std::string("Could not load ") + path);
+        }
+        return FR_OK;
+    });
+}
+
+fr_status fr_engine_load_wmm(fr_engine* engine, const char* path) {
+    if (!engine) return FR_ERROR_ARGUMENT;
+    std::lock_guard<std::mutex> lock(engine->mutex);
+    return guarded(engine, [&] {
+        if (!path) return fail(engine, FR_ERROR_ARGUMENT, "No WMM path");
+        if (!engine->provider.loadWMMFile(path)) {
+            return fail(engine, FR_ERROR_FILE, std::string("Could not load ") + path);
+        }
+        return FR_OK;
+    });
+}
+
+fr_status fr_engine_set_ionosphere_model(fr_engine* engine, fr_ionosphere_model model) {
+    if (!engine) return FR_ERROR_ARGUMENT;
+    std::lock_guard<std::mutex> lock(engine->mutex);
+    if (model != FR_IONOSPHERE_SIMPLE && model != FR_IONOSPHERE_CHAPMAN) {
+        return fail(engine, FR_ERROR_ARGUMENT, "Unknown ionosphere model");
+    }
+    engine->config.ionoModel = (model == FR_IONOSPHERE_CHAPMAN)
+        ? SystemConfiguration::IonosphereModel::CHAPMAN
+        : SystemConfiguration::IonosphereModel::SIMPLE;
+    engine->processor.setConfiguration(engine->config);
+    return FR_OK;
+}
+
+size_t fr_engine_get_error(const fr_engine* engine, char* buffer, size_t size) {
+    if (!engine) return 0;
+    std::lock_guard<std::mutex> lock(engine->mutex);
+    const std::string& error = engine->error;
+    if (buffer && size > 0) {
+        const std::size_t copied = std::min(error.size(), size - 1);
+        std::memcpy(buffer, error.data(), copied);
+        buffer[copied] = '\0';
+    }
+    return error.size();
+}
+
+// ========== Computation ==========
+
+fr_status fr_engine_compute_batch(fr_engine* engine, const fr_job* jobs, size_t count,
+                                  fr_result* results, size_t* failed) {
+    if (!engine) return FR_ERROR_ARGUMENT;
+    if (failed) *failed = 0;
+    if (count == 0) return FR_OK;
+    if (!jobs || !results) return FR_ERROR_ARGUMENT;
+
+    std::lock_guard<std::mutex> lock(engine->mutex);
+    return guarded(engine, [&] {
+        // Invalid jobs are answered here; the rest go through in one pass.
+        engine->jobs.resize(std::max(engine->jobs.size(), count));
+        engine->slots.clear();
+        std::size_t rejected = 0;
+        for (std::size_t i = 0; i < count; ++i) {
+            const fr_job& job = jobs[i];
+            if (!std::isfinite(job.time_utc) || !(job.frequency_MHz > 0.0) || !std::isfinite(job.frequency_MHz) ||
+                !validStation(job.dx) || !validStation(job.home)) {
+                clearResult(results[i], FR_ERROR_ARGUMENT);
+                engine->error = "Job " + std::to_string(i) + ": invalid time, frequency or station";
+                ++rejected;
+                continue;
+            }
+            BatchJob& target = engine->jobs[engine->slots.size()];
+            target.time = job.time_utc;
+            target.frequency_MHz = job.frequency_MHz;
+            target.includeFaradayRotation = job.include_faraday != 0;
+            toSite(job.dx, target.dx);
+            toSite(job.home, target.home);
+            engine->slots.push_back(i);
+        }
+
+        BatchProcessor::Workspace& work = engine->work;
+        engine->processor.evaluate(work, engine->jobs.data(), engine->slots.size());
+
+        std::size_t unsuccessful = rejected;
+        for (std::size_t k = 0; k < engine->slots.size(); ++k) {
+            fr_result& out = results[engine->slots[k]];
+            const CalculationResults& result = work.results[k];
+            const MoonEphemeris& moon = work.moons[k];
+            const IonosphereData& iono = work.iono[k];
+
+            fr_status status = FR_OK;
+            if (moon.elevation_DX < 0.0 || moon.elevation_Home < 0.0) {
+                status = FR_ERROR_BELOW_HORIZON;
+            } else if (!result.calculationSuccess) {
+                status = FR_ERROR_CALCULATION;
+                engine->error = result.errorMessage;
+            }
+            if (status != FR_OK) ++unsuccessful;
+
+            out.status = status;
+            out.faraday_applied = work.faraday[k] ? 1 : 0;
+            out.plf = result.PLF;
+            out.loss_dB = result.polarizationLoss_dB;
+            out.spatial_deg = result.spatialRotation_deg;
+            out.faraday_dx_deg = result.faradayRotation_DX_deg;
+            out.faraday_home_deg = result.faradayRotation_Home_deg;
+            out.total_deg = result.totalRotation_deg;
+            out.elevation_dx_deg = ParameterUtils::rad2deg(moon.elevation_DX);
+            out.azimuth_dx_deg = ParameterUtils::rad2deg(moon.azimuth_DX);
+            out.elevation_home_deg = ParameterUtils::rad2deg(moon.elevation_Home);
+            out.azimuth_home_deg = ParameterUtils::rad2deg(moon.azimuth_Home);
+            out.vtec_dx = iono.vTEC_DX;
+            out.vtec_home = iono.vTEC_Home;
+        }
+
+        if (failed) *failed = unsuccessful;
+        return FR_OK;
+    });
+}
+
+fr_status fr_engine_compute(fr_engine* engine, const fr_job* job, fr_result* result) {
+    if (!engine || !job || !result) return FR_ERROR_ARGUMENT;
+    const fr_status status = fr_engine_compute_batch(engine, job, 1, result, nullptr);
+    return status != FR_OK ? status : static_cast<fr_status>(result->status);
+}
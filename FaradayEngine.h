@@ -0,0 +1,116 @@
+#pragma once
+
+/*
+ * ========== Faraday Engine C ABI ==========
+ * Stable C interface to the calculator and its data providers, built as a
+ * shared library (FaradayEngine.vcxproj, or libfaradayengine.so, see README).
+ *
+ *  - Engines are opaque handles. Each one owns its TEC maps, field model and
+ *    ephemeris. Calls on one engine are serialised, so an engine may be shared
+ *    between threads; use one engine per thread for parallel work.
+ *  - Every output goes into caller-owned memory. The library never hands out
+ *    pointers that the caller must free, apart from the engine itself.
+ *  - No exception crosses the boundary. Failures come back as fr_status codes,
+ *    and fr_engine_get_error() has the text of the last one.
+ *
+ * Angles are in degrees, times in UTC seconds since 1970, TEC in TECU.
+ */
+
+#include <stddef.h>
+
+#if defined(_WIN32)
+#  if defined(FR_BUILD_DLL)
+#    define FR_API __declspec(dllexport)
+#  else
+#    define FR_API __declspec(dllimport)
+#  endif
+#else
+#  define FR_API __attribute__((visibility("default")))
+#endif
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* Bumped whenever a struct layout or signature below changes. */
+#define FR_ABI_VERSION 1
+
+typedef struct fr_engine fr_engine;
+
+typedef enum fr_status {
+    FR_OK = 0,
+    FR_ERROR_ARGUMENT = 1,          /* null pointer, bad grid, frequency <= 0, ... */
+    FR_ERROR_FILE = 2,              /* data file missing or unreadable */
+    FR_ERROR_BELOW_HORIZON = 3,     /* moon below the horizon at a station */
+    FR_ERROR_CALCULATION = 4,       /* calculator rejected the job */
+    FR_ERROR_INTERNAL = 5           /* unexpected failure, e.g. out of memory */
+} fr_status;
+
+typedef enum fr_ionosphere_model {
+    FR_IONOSPHERE_SIMPLE = 0,       /* thin shell at the piercing point */
+    FR_IONOSPHERE_CHAPMAN = 1       /* Chapman slant-path integration */
+} fr_ionosphere_model;
+
+typedef struct fr_station {
+    double latitude_deg;
+    double longitude_deg;
+    double psi_deg;                 /* polarization angle */
+    double chi_deg;                 /* ellipticity angle */
+} fr_station;
+
+typedef struct fr_job {
+    double time_utc;
+    double frequency_MHz;
+    fr_station dx;
+    fr_station home;
+    int include_faraday;            /* 0 computes spatial rotation only */
+} fr_job;
+
+typedef struct fr_result {
+    int status;                     /* fr_status of this job */
+    int faraday_applied;            /* 0 when no TEC covered the piercing points */
+    double plf;
+    double loss_dB;
+    double spatial_deg;
+    double faraday_dx_deg;
+    double faraday_home_deg;
+    double total_deg;
+    double elevation_dx_deg;
+    double azimuth_dx_deg;
+    double elevation_home_deg;
+    double azimuth_home_deg;
+    double vtec_dx;
+    double vtec_home;
+} fr_result;
+
+FR_API int fr_abi_version(void);
+FR_API const char* fr_status_string(fr_status status);
+
+/* Returns NULL when out of memory. Without TEC data the interactive defaults
+ * (25 TECU, 50 uT, 60 deg dip) are used. */
+FR_API fr_engine* fr_engine_create(void);
+FR_API void fr_engine_destroy(fr_engine* engine);
+
+FR_API fr_status fr_engine_load_ionex(fr_engine* engine, const char* path);
+FR_API fr_status fr_engine_load_wmm(fr_engine* engine, const char* path);
+FR_API fr_status fr_engine_set_ionosphere_model(fr_engine* engine, fr_ionosphere_model model);
+
+/* Copies the last error message into buffer (truncated, always terminated when
+ * size > 0) and returns its full length. */
+FR_API size_t fr_engine_get_error(const fr_engine* engine, char* buffer, size_t size);
+
+/* One job; returns the job's status, also stored in result->status. */
+FR_API fr_status fr_engine_compute(fr_engine* engine, const fr_job* job, fr_result* result);
+
+/* count jobs into results[0..count). Returns FR_OK when every job was
+ * attempted; per-job outcomes are in results[i].status, and failed (may be
+ * NULL) receives the number of jobs that did not succeed. */
+FR_API fr_status fr_engine_compute_batch(fr_engine* engine, const fr_job* jobs, size_t count,
+                                         fr_result* results, size_t* failed);
+
+/* Maidenhead locator (4 or 6 characters) to the centre of the square. */
+FR_API fr_status fr_grid_to_location(const char* grid, double* latitude_deg, double* longitude_deg);
+
+#ifdef __cplusplus
+}
+#endif
@@ -1,4 +1,7 @@
 #include "FaradayRotation.h"
+#include "Dual.h"
+#include "MappingFunctionTable.h"
+#include <algorithm>
 #include <cmath>
 #include <stdexcept>
 #include <sstream>
@@ -77,6 +80,10 @@ void FaradayRotation::setMoonEphemeris(const MoonEphemeris& moon) {
     m_moonEphem = moon;
 }
 
+void FaradayRotation::setMagneticField(const PreparedMagneticField& field) {
+    m_magneticField = field;
+}
+
 // ========== Helper Functions ==========
 
 double FaradayRotation::deg2rad(double degrees) const {
@@ -160,37 +167,47 @@ void FaradayRotation::calculateMoonElevation() {
         sinLat_Home * sinDec + cosLat_Home * cosDec * cosH_Home
     );
 
+    // atan2 gives the azimuth from South (Meeus); everything downstream measures
+    // it from North through East.
     double sinH_DX = std::sin(m_moonEphem.hourAngle_DX);
     double tanDec = std::tan(m_moonEphem.declination);
 
     m_moonEphem.azimuth_DX = std::atan2(
         sinH_DX,
         cosH_DX * sinLat_DX - tanDec * cosLat_DX
-    );
+    ) + SystemConstants::PI;
 
     double sinH_Home = std::sin(m_moonEphem.hourAngle_Home);
     m_moonEphem.azimuth_Home = std::atan2(
         sinH_Home,
         cosH_Home * sinLat_Home - tanDec * cosLat_Home
-    );
+    ) + SystemConstants::PI;
 }
 
 // ========== Parallactic Angle Calculation ==========
 
-double FaradayRotation::calculateParallacticAngle(
-    double latitude, double declination, double hourAngle) const {
+template <typename T>
+T FaradayRotation::parallacticAngle(const T& latitude, const T& declination, const T& hourAngle) {
+    using std::sin;
+    using std::cos;
+    using std::atan2;
+
+    T sinH = sin(hourAngle);
+    T cosH = cos(hourAngle);
+    T sinLat = sin(latitude);
+    T cosLat = cos(latitude);
+    T sinDec = sin(declination);
+    T cosDec = cos(declination);
 
-    double sinH = std::sin(hourAngle);
-    double cosH = std::cos(hourAngle);
-    double sinLat = std::sin(latitude);
-    double cosLat = std::cos(latitude);
-    double sinDec = std::sin(declination);
-    double cosDec = std::cos(declination);
+    T numerator = sinH * cosLat;
+    T denominator = sinLat * cosDec - cosLat * sinDec * cosH;
 
-    double numerator = sinH * cosLat;
-    double denominator = sinLat * cosDec - cosLat * sinDec * cosH;
+    return atan2(numerator, denominator);
+}
 
-    return std::atan2(numerator, denominator);
+double FaradayRotation::calculateParallacticAngle(
+    double latitude, double declination, double hourAngle) const {
+    return parallacticAngle(latitude, declination, hourAngle);
 }
 
 // ========== Slant Factor Calculation ==========
@@ -200,8 +217,53 @@ double FaradayRotation::calculateSlantFactor(double elevation) const {
         return 1.0;
     }
 
-    double hmF2 = SystemConstants::IONOSPHERE_HEIGHT_KM;
-    return IonospherePhysics::calculateMappingFunction(elevation, hmF2);
+    // The shell height is fixed here, so one tabulated slice serves every call
+    // at about half the closed-form cost (relative error below 1e-6).
+    static const MappingFunctionSlice slice =
+        MappingFunctionTable::standard().slice(SystemConstants::IONOSPHERE_HEIGHT_KM);
+    return slice.evaluate(elevation);
+}
+
+// ========== Chapman Slant-Path Rotation ==========
+
+void FaradayRotation::calculateChapmanRotation(double& rotation_DX, double& rotation_Home) {
+    SlantRay rays[2] = {
+        { m_dxSite.latitude, m_dxSite.longitude,
+          m_moonEphem.elevation_DX, m_moonEphem.azimuth_DX,
+          m_ionoData.vTEC_DX, m_ionoData.hmF2_DX },
+        { m_homeSite.latitude, m_homeSite.longitude,
+          m_moonEphem.elevation_Home, m_moonEphem.azimuth_Home,
+          m_ionoData.vTEC_Home, m_ionoData.hmF2_Home }
+    };
+
+    double rotation[2] = { 0.0, 0.0 };
+    double slantFactor[2] = { 1.0, 1.0 };
+
+    if (m_magneticField.isValid()) {
+        m_chapman.integrate(rays, 2, m_magneticField, m_config.frequency_MHz,
+                            rotation, slantFactor);
+    } else {
+        // No field model: station field projection, Chapman slant factor.
+        const double B_magnitude[2] = { m_ionoData.B_magnitude_DX, m_ionoData.B_magnitude_Home };
+        const double B_inclination[2] = { m_ionoData.B_inclination_DX, m_ionoData.B_inclination_Home };
+        const double B_declination[2] = { m_ionoData.B_declination_DX, m_ionoData.B_declination_Home };
+        double f_squared_MHz = m_config.frequency_MHz * m_config.frequency_MHz;
+
+        for (int i = 0; i < 2; ++i) {
+            slantFactor[i] = m_chapman.calculateSlantFactor(rays[i].elevation, rays[i].hmF2);
+            double B_proj = IonospherePhysics::calculateMagneticFieldProjection(
+                B_magnitude[i], B_inclination[i], B_declination[i],
+                rays[i].elevation, rays[i].azimuth);
+            rotation[i] = (SystemConstants::FARADAY_CONSTANT / f_squared_MHz) *
+                          rays[i].vTEC * slantFactor[i] * B_proj * 1e9;
+        }
+    }
+
+    m_lastResults.slantFactor_DX = slantFactor[0];
+    m_lastResults.slantFactor_Home = slantFactor[1];
+
+    rotation_DX = rotation[0];
+    rotation_Home = rotation[1];
 }
 
 // ========== Magnetic Angle Calculation ==========
@@ -358,7 +420,10 @@ CalculationResults FaradayRotation::calculate() {
         double faradayRotation_DX = 0.0;
         double faradayRotation_Home = 0.0;
 
-        if (m_config.includeFaradayRotation) {
+        if (m_config.includeFaradayRotation &&
+            m_config.ionoModel == SystemConfiguration::IonosphereModel::CHAPMAN) {
+            calculateChapmanRotation(faradayRotation_DX, faradayRotation_Home);
+        } else if (m_config.includeFaradayRotation) {
             faradayRotation_DX = IonospherePhysics::calculateFaradayRotationPrecise(
                 m_ionoData.vTEC_DX,
                 m_ionoData.hmF2_DX,
@@ -425,3 +490,271 @@ CalculationResults FaradayRotation::calculate() {
     return m_lastResults;
 }
 
+
+// ========== Multi-Band Calculation ==========
+
+// The Jones chain R(down) M R(up) collapses to one rotation: with the moon's
+// reflection M R(a) = R(-a) M, so the link turns the wave by Phi_down - Phi_up,
+// and by Phi_down + Phi_up without it. PLF is then |a cos(theta) + b sin(theta)|^2
+// with a and b fixed by the antennas, which is linear in cos(2 theta) and
+// sin(2 theta).
+FaradayRotation::LinkTerms FaradayRotation::prepareLinkTerms(const CalculationResults& base) const {
+    const double sign = m_config.includeMoonReflection ? -1.0 : 1.0;
+    const Matrix2x2 M = m_config.includeMoonReflection ?
+                        createMoonReflectionMatrix() :
+                        createRotationMatrix(0.0);
+    const JonesVector J_RX = createJonesVector(m_homeSite.psi, m_homeSite.chi);
+    const JonesVector v = matrixVectorMultiply(M, createJonesVector(m_dxSite.psi, m_dxSite.chi));
+    const JonesVector Qv = { -v[1], v[0] };
+    const std::complex<double> a = vectorDotProduct(J_RX, v);
+    const std::complex<double> b = vectorDotProduct(J_RX, Qv);
+
+    LinkTerms terms;
+    terms.PLF_mean = 0.5 * (std::norm(a) + std::norm(b));
+    terms.PLF_cos = 0.5 * (std::norm(a) - std::norm(b));
+    terms.PLF_sin = std::real(std::conj(a) * b);
+    terms.theta_geometry = deg2rad(base.parallacticAngle_Home_deg) +
+                           sign * deg2rad(base.parallacticAngle_DX_deg);
+
+    // Rotation * f^2 is the frequency-independent part of each ray.
+    const double f0_squared = m_config.frequency_MHz * m_config.frequency_MHz;
+    terms.K_DX = deg2rad(base.faradayRotation_DX_deg) * f0_squared;
+    terms.K_Home = deg2rad(base.faradayRotation_Home_deg) * f0_squared;
+    terms.K_theta = terms.K_Home + sign * terms.K_DX;
+    terms.spatial = deg2rad(base.spatialRotation_deg);
+    return terms;
+}
+
+CalculationResults FaradayRotation::calculateBands(
+    const std::vector<double>& frequencies_MHz, std::vector<BandResult>& bands) {
+    bands.clear();
+    for (double f : frequencies_MHz) {
+        if (!(f > 0.0)) {
+            m_lastResults = CalculationResults();
+            m_lastResults.calculationTime = std::time(nullptr);
+            m_lastResults.errorMessage = "Invalid band frequency";
+            return m_lastResults;
+        }
+    }
+
+    CalculationResults base = calculate();
+    if (!base.calculationSuccess) {
+        return base;
+    }
+    const LinkTerms terms = prepareLinkTerms(base);
+
+    bands.resize(frequencies_MHz.size());
+    for (std::size_t i = 0; i < frequencies_MHz.size(); ++i) {
+        const double f = frequencies_MHz[i];
+        const double inverse_f_squared = 1.0 / (f * f);
+        const double rotation_DX = terms.K_DX * inverse_f_squared;
+        const double rotation_Home = terms.K_Home * inverse_f_squared;
+        const double twoTheta = 2.0 * (terms.theta_geometry + terms.K_theta * inverse_f_squared);
+        const double PLF = terms.PLF_mean + terms.PLF_cos * std::cos(twoTheta) +
+                           terms.PLF_sin * std::sin(twoTheta);
+
+        BandResult& band = bands[i];
+        band.frequency_MHz = f;
+        band.faradayRotation_DX_deg = rad2deg(rotation_DX);
+        band.faradayRotation_Home_deg = rad2deg(rotation_Home);
+        band.totalRotation_deg = rad2deg(terms.spatial + rotation_DX + rotation_Home);
+        band.PLF = PLF;
+        band.polarizationLoss_dB = 10.0 * std::log10(PLF);
+    }
+
+    m_lastResults = base;
+    return base;
+}
+
+// ========== Passband Calculation ==========
+
+CalculationResults FaradayRotation::calculatePassband(int bins, PassbandResult& passband) {
+    passband = PassbandResult();
+    const double f0 = m_config.frequency_MHz;
+    const double bandwidth_MHz = m_config.bandwidth_Hz * 1e-6;
+    if (bins < 1 || !(m_config.bandwidth_Hz >= 0.0) || !(bandwidth_MHz < f0)) {
+        m_lastResults = CalculationResults();
+        m_lastResults.calculationTime = std::time(nullptr);
+        m_lastResults.errorMessage = "Invalid passband: need at least one bin and a bandwidth below the frequency";
+        return m_lastResults;
+    }
+
+    CalculationResults base = calculate();
+    if (!base.calculationSuccess) {
+        return base;
+    }
+    const LinkTerms terms = prepareLinkTerms(base);
+
+    // Bin centres, evenly spaced across the passband. cos(2 theta) and
+    // sin(2 theta) give each bin's PLF and also the mean polarization
+    // direction, whose length is what survives the smearing.
+    const double step_MHz = bandwidth_MHz / bins;
+    const double low_MHz = f0 - 0.5 * bandwidth_MHz + 0.5 * step_MHz;
+    double sumPLF = 0.0, sumCos = 0.0, sumSin = 0.0;
+    double minPLF = 1.0, maxPLF = 0.0;
+    for (int k = 0; k < bins; ++k) {
+        const double f = low_MHz + k * step_MHz;
+        const double twoTheta = 2.0 * (terms.theta_geometry + terms.K_theta / (f * f));
+        const double c = std::cos(twoTheta);
+        const double s = std::sin(twoTheta);
+        const double PLF = terms.PLF_mean + terms.PLF_cos * c + terms.PLF_sin * s;
+        sumPLF += PLF;
+        sumCos += c;
+        sumSin += s;
+        minPLF = std::min(minPLF, PLF);
+        maxPLF = std::max(maxPLF, PLF);
+    }
+
+    const double f_low = f0 - 0.5 * bandwidth_MHz;
+    const double f_high = f0 + 0.5 * bandwidth_MHz;
+    passband.bins = bins;
+    passband.bandwidth_Hz = m_config.bandwidth_Hz;
+    passband.averagePLF = sumPLF / bins;
+    passband.minPLF = minPLF;
+    passband.maxPLF = maxPLF;
+    passband.averageLoss_dB = 10.0 * std::log10(passband.averagePLF);
+    passband.rotationSpread_deg = rad2deg(std::fabs(
+        (terms.K_DX + terms.K_Home) * (1.0 / (f_low * f_low) - 1.0 / (f_high * f_high))));
+    passband.depolarization = 1.0 - std::hypot(sumCos, sumSin) / bins;
+
+    m_lastResults = base;
+    return base;
+}
+
+// ========== Receive Polarization ==========
+
+PolarizationSolution FaradayRotation::solvePolarization(
+    const CalculationResults& base, double crossGain) const {
+    PolarizationSolution solution;
+    if (!base.calculationSuccess) {
+        return solution;
+    }
+
+    // The wave arriving at Home, as calculate() builds it.
+    const double Phi_up = deg2rad(base.parallacticAngle_DX_deg + base.faradayRotation_DX_deg);
+    const double Phi_down = deg2rad(base.parallacticAngle_Home_deg + base.faradayRotation_Home_deg);
+    const Matrix2x2 M_moon = m_config.includeMoonReflection ?
+                             createMoonReflectionMatrix() :
+                             createRotationMatrix(0.0);
+    const JonesVector E = matrixVectorMultiply(createRotationMatrix(Phi_down),
+        matrixVectorMultiply(M_moon,
+            matrixVectorMultiply(createRotationMatrix(Phi_up),
+                createJonesVector(m_dxSite.psi, m_dxSite.chi))));
+
+    // Its polarization ellipse from the Stokes parameters.
+    const double S0 = std::norm(E[0]) + std::norm(E[1]);
+    const double S1 = std::norm(E[0]) - std::norm(E[1]);
+    const std::complex<double> cross = std::conj(E[0]) * E[1];
+    solution.arrivalPsi_deg = rad2deg(0.5 * std::atan2(2.0 * cross.real(), S1));
+    solution.arrivalChi_deg = rad2deg(0.5 * std::asin(std::max(-1.0, std::min(1.0, 2.0 * cross.imag() / S0))));
+
+    // With chi fixed, the receive antenna is linear in cos(psi) and sin(psi),
+    // so PLF(psi) = A + B cos(2 psi) + C sin(2 psi); three angles fix it.
+    const double chi = m_homeSite.chi;
+    auto receivedPLF = [&](double psi, double receiveChi) {
+        return std::norm(vectorDotProduct(createJonesVector(psi, receiveChi), E));
+    };
+    const double P0 = receivedPLF(0.0, chi);
+    const double P45 = receivedPLF(SystemConstants::PI / 4.0, chi);
+    const double P90 = receivedPLF(SystemConstants::PI / 2.0, chi);
+    const double A = 0.5 * (P0 + P90);
+    const double B = 0.5 * (P0 - P90);
+    const double C = P45 - A;
+    double psi = 0.5 * std::atan2(C, B);
+    if (psi <= -SystemConstants::PI / 2.0) psi += SystemConstants::PI;
+    solution.optimalPsi_deg = rad2deg(psi);
+    solution.optimalPLF = A + std::hypot(B, C);
+
+    // Orthogonal pair: psi + 90 deg with the opposite hand.
+    solution.coPLF = base.PLF;
+    solution.crossPLF = receivedPLF(m_homeSite.psi + SystemConstants::PI / 2.0, -chi);
+    solution.combinedPLF = solution.coPLF + crossGain * solution.crossPLF;
+    solution.combined_dB = 10.0 * std::log10(solution.combinedPLF);
+    return solution;
+}
+
+// ========== Sensitivities ==========
+
+CalculationResults FaradayRotation::calculateSensitivity(
+    const MoonEphemeris& moonRate, PLFSensitivity& sensitivity, const IonosphereData* ionoRate) {
+    sensitivity = PLFSensitivity();
+    if (m_config.includeFaradayRotation &&
+        m_config.ionoModel == SystemConfiguration::IonosphereModel::CHAPMAN) {
+        m_lastResults = CalculationResults();
+        m_lastResults.calculationTime = std::time(nullptr);
+        m_lastResults.errorMessage = "Sensitivities need the thin-shell (SIMPLE) ionosphere model";
+        return m_lastResults;
+    }
+
+    CalculationResults base = calculate();
+    if (!base.calculationSuccess) {
+        return base;
+    }
+
+    // Inputs 0-3 are seeded directly; time enters through the moon and the
+    // ionosphere, each field moving at its rate from an offset of zero seconds.
+    using D = Dual<PLFSensitivity::INPUTS>;
+    const D time = D::variable(0.0, 4);
+    auto moving = [&](double value, double rate) { return value + rate * time; };
+
+    IonosphereData still;
+    still.vTEC_DX = still.vTEC_Home = 0.0;
+    still.hmF2_DX = still.hmF2_Home = 0.0;
+    still.B_magnitude_DX = still.B_magnitude_Home = 0.0;
+    still.B_inclination_DX = still.B_inclination_Home = 0.0;
+    still.B_declination_DX = still.B_declination_Home = 0.0;
+    const IonosphereData& drift = ionoRate ? *ionoRate : still;
+
+    const D declination = moving(m_moonEphem.declination, moonRate.declination);
+    const D nu_DX = parallacticAngle<D>(m_dxSite.latitude, declination,
+                                        moving(m_moonEphem.hourAngle_DX, moonRate.hourAngle_DX));
+    const D nu_Home = parallacticAngle<D>(m_homeSite.latitude, declination,
+                                          moving(m_moonEphem.hourAngle_Home, moonRate.hourAngle_Home));
+
+    D faraday_DX, faraday_Home;
+    if (m_config.includeFaradayRotation) {
+        // Field magnitude is seeded in nT so its derivative reads per nT.
+        faraday_DX = IonospherePhysics::faradayRotation<D>(
+            D::variable(m_ionoData.vTEC_DX, 0) + drift.vTEC_DX * time,
+            moving(m_ionoData.hmF2_DX, drift.hmF2_DX),
+            (D::variable(m_ionoData.B_magnitude_DX * 1e9, 2) + drift.B_magnitude_DX * 1e9 * time) * 1e-9,
+            moving(m_ionoData.B_inclination_DX, drift.B_inclination_DX),
+            moving(m_ionoData.B_declination_DX, drift.B_declination_DX),
+            moving(m_moonEphem.elevation_DX, moonRate.elevation_DX),
+            moving(m_moonEphem.azimuth_DX, moonRate.azimuth_DX),
+            m_config.frequency_MHz);
+        faraday_Home = IonospherePhysics::faradayRotation<D>(
+            D::variable(m_ionoData.vTEC_Home, 1) + drift.vTEC_Home * time,
+            moving(m_ionoData.hmF2_Home, drift.hmF2_Home),
+            (D::variable(m_ionoData.B_magnitude_Home * 1e9, 3) + drift.B_magnitude_Home * 1e9 * time) * 1e-9,
+            moving(m_ionoData.B_inclination_Home, drift.B_inclination_Home),
+            moving(m_ionoData.B_declination_Home, drift.B_declination_Home),
+            moving(m_moonEphem.elevation_Home, moonRate.elevation_Home),
+            moving(m_moonEphem.azimuth_Home, moonRate.azimuth_Home),
+            m_config.frequency_MHz);
+    }
+
+    // The Jones chain with the antennas fixed is a function of the link
+    // rotation alone (see prepareLinkTerms).
+    const LinkTerms terms = prepareLinkTerms(base);
+    const D up = nu_DX + faraday_DX;
+    const D down = nu_Home + faraday_Home;
+    const D twoTheta = 2.0 * (m_config.includeMoonReflection ? down - up : down + up);
+    const D PLF = terms.PLF_mean + terms.PLF_cos * cos(twoTheta) + terms.PLF_sin * sin(twoTheta);
+
+    sensitivity.PLF = PLF.value;
+    sensitivity.dPLF_dvTEC_DX = PLF.d[0];
+    sensitivity.dPLF_dvTEC_Home = PLF.d[1];
+    sensitivity.dPLF_dB_DX = PLF.d[2];
+    sensitivity.dPLF_dB_Home = PLF.d[3];
+    sensitivity.dPLF_dTime = PLF.d[4];
+
+    D rotation = faraday_DX + faraday_Home;
+    if (m_config.includeSpatialRotation) {
+        rotation += nu_DX + nu_Home;
+    }
+    sensitivity.dRotation_dTime = rad2deg(rotation.d[4]);
+
+    m_lastResults = base;
+    return base;
+}
@@ -3,9 +3,11 @@
 #include "Parameters.h"
 #include "MaidenheadGrid.h"
 #include "IonospherePhysics.h"
+#include "ChapmanSlantIntegrator.h"
 #include <complex>
 #include <array>
 #include <memory>
+#include <vector>
 
 using JonesVector = std::array<std::complex<double>, 2>;
 using Matrix2x2 = std::array<std::array<std::complex<double>, 2>, 2>;
@@ -26,11 +28,47 @@ public:
     void setHomeStation(const SiteParameters& site);
     void setIonosphereData(const IonosphereData& iono);
     void setMoonEphemeris(const MoonEphemeris& moon);
+    void setMagneticField(const PreparedMagneticField& field);
 
     // ========== Main Calculation ==========
     CalculationResults calculate();
     const CalculationResults& getLastResults() const { return m_lastResults; }
 
+    // ========== Multi-Band Calculation ==========
+    // Evaluates several frequencies for the current link in one pass. The
+    // geometry and the sTEC * B_parallel product are computed once by
+    // calculate() at the configured frequency; each band then scales the
+    // rotation by 1/f^2 and evaluates the PLF in closed form. Returns the
+    // results at the configured frequency; bands is empty on failure.
+    CalculationResults calculateBands(const std::vector<double>& frequencies_MHz,
+                                      std::vector<BandResult>& bands);
+
+    // Samples the configured bandwidth_Hz around the configured frequency on
+    // bins evenly spaced frequencies, the same way, and sums the PLF and the
+    // polarization direction over them. Returns the results at the centre.
+    CalculationResults calculatePassband(int bins, PassbandResult& passband);
+
+    // ========== Receive Polarization ==========
+    // Best Home antenna for a successful result of this link (from calculate(),
+    // calculateBands() or calculatePassband()), in closed form from the Jones
+    // chain: no calculate() per trial angle. crossGain is the power gain of the
+    // cross-polarized branch relative to the co-polarized one.
+    PolarizationSolution solvePolarization(const CalculationResults& base,
+                                           double crossGain = 1.0) const;
+
+    // ========== Sensitivities ==========
+    // PLF and its gradient with respect to vTEC and |B| at both stations and to
+    // time, in one pass: the thin-shell physics and the link rotation run on
+    // Dual numbers (Dual.h). moonRate holds the time derivatives of the moon
+    // fields (LunarEphemeris::computeMoonEphemerisRate); a default-constructed
+    // one gives dPLF_dTime = 0. ionoRate, when given, holds the time derivatives
+    // of the ionosphere fields at the piercing points, so that the time
+    // derivatives include the drift of TEC and field. The Chapman integrator is
+    // not differentiated, so the CHAPMAN model is rejected.
+    CalculationResults calculateSensitivity(const MoonEphemeris& moonRate,
+                                            PLFSensitivity& sensitivity,
+                                            const IonosphereData* ionoRate = nullptr);
+
     // ========== Helper Calculations ==========
     double calculateParallacticAngle(
         double latitude, double declination, double hourAngle) const;
@@ -66,8 +104,25 @@ private:
     IonosphereData m_ionoData;
     MoonEphemeris m_moonEphem;
     CalculationResults m_lastResults;
+    PreparedMagneticField m_magneticField;
+    ChapmanSlantIntegrator m_chapman;
+
+    // Frequency-independent terms of a successful calculate(). The link turns
+    // the wave by theta = theta_geometry + K_theta / f^2, and
+    // PLF = PLF_mean + PLF_cos cos(2 theta) + PLF_sin sin(2 theta).
+    struct LinkTerms {
+        double PLF_mean, PLF_cos, PLF_sin;
+        double theta_geometry;
+        double K_DX, K_Home, K_theta;   // Faraday rotation * f^2 (rad MHz^2)
+        double spatial;                 // rad
+    };
+    LinkTerms prepareLinkTerms(const CalculationResults& base) const;
+
+    template <typename T>
+    static T parallacticAngle(const T& latitude, const T& declination, const T& hourAngle);
 
     void calculateMoonElevation();
+    void calculateChapmanRotation(double& rotation_DX, double& rotation_Home);
     double calculatePathLength() const;
     double normalizeAngle(double angle) const;
     double deg2rad(double degrees) const;
@@ -0,0 +1,51 @@
+# Converts a WMM/WMMHR .COF coefficient file into WMMCoefficients.h, a constexpr
+# table compiled into the binary so WMMModel can start without any file I/O.
+#
+# Usage: powershell -NoProfile -ExecutionPolicy Bypass -File GenerateWMMCoefficients.ps1 `
+#            -InputFile WMMHR.COF -OutputFile WMMCoefficients.h [-MaxDegree 12]
+
+param(
+    [Parameter(Mandatory = $true)][string]$InputFile,
+    [Parameter(Mandatory = $true)][string]$OutputFile,
+    [int]$MaxDegree = 12
+)
+
+$ErrorActionPreference = 'Stop'
+$culture = [System.Globalization.CultureInfo]::InvariantCulture
+
+$lines = Get-Content -LiteralPath $InputFile
+$header = ($lines | Where-Object { $_.Trim() -ne '' } | Select-Object -First 1).Trim() -split '\s+'
+$epoch = [double]::Parse($header[0], $culture)
+$modelName = if ($header.Length -gt 1) { $header[1] } else { 'WMM' }
+
+$rows = New-Object System.Collections.Generic.List[string]
+foreach ($line in $lines) {
+    $fields = $line.Trim() -split '\s+'
+    if ($fields.Length -lt 6 -or $fields[0].StartsWith('9999')) { continue }
+
+    $n = 0; $m = 0
+    if (-not [int]::TryParse($fields[0], [ref]$n) -or -not [int]::TryParse($fields[1], [ref]$m)) { continue }
+    if ($n -lt 1 -or $n -gt $MaxDegree) { continue }
+
+    $values = $fields[2..5] | ForEach-Object { [double]::Parse($_, $culture).ToString('R', $culture) }
+    $rows.Add("    { $n, $m, $($values -join ', ') },")
+}
+
+$out = New-Object System.Text.StringBuilder
+[void]$out.AppendLine('#pragma once')
+[void]$out.AppendLine('')
+[void]$out.AppendLine("// Generated from $(Split-Path -Leaf $InputFile) by GenerateWMMCoefficients.ps1. Do not edit.")
+[void]$out.AppendLine('')
+[void]$out.AppendLine('#include "WMMModel.h"')
+[void]$out.AppendLine('')
+[void]$out.AppendLine('namespace WMMEmbedded {')
+[void]$out.AppendLine("    constexpr double EPOCH = $($epoch.ToString('0.0###', $culture));")
+[void]$out.AppendLine("    constexpr const char* MODEL_NAME = `"$modelName`";")
+[void]$out.AppendLine("    constexpr int MAX_DEGREE = $MaxDegree;")
+[void]$out.AppendLine('')
+[void]$out.AppendLine('    constexpr GaussCoefficient COEFFICIENTS[] = {')
+foreach ($row in $rows) { [void]$out.AppendLine("    $row") }
+[void]$out.AppendLine('    };')
+[void]$out.AppendLine('}')
+
+[System.IO.File]::WriteAllText($OutputFile, $out.ToString().Replace("`r`n", "`n"))
@@ -0,0 +1,388 @@
+#define _USE_MATH_DEFINES
+#include "GeomagneticField.h"
+#include <cmath>
+#include <algorithm>
+
+#ifndef M_PI
+#define M_PI 3.14159265358979323846
+#endif
+
+// ========== Compile-time Normalization Tables ==========
+
+namespace {
+    constexpr double constexprSqrt(double x) {
+        if (x <= 0.0) {
+            return 0.0;
+        }
+        double guess = x > 1.0 ? x : 1.0;
+        for (int i = 0; i < 64; ++i) {
+            double next = 0.5 * (guess + x / guess);
+            if (next == guess) {
+                break;
+            }
+            guess = next;
+        }
+        return guess;
+    }
+
+    struct NormalizationTables {
+        std::array<double, GeomagneticConstants::NUM_COEFFICIENTS> schmidt{};
+        std::array<double, GeomagneticConstants::NUM_COEFFICIENTS> recursion{};
+    };
+
+    // Schmidt quasi-normalization factors and the Gauss recursion constants
+    // K(n,m) = ((n-1)^2 - m^2) / ((2n-1)(2n-3)) used by the Legendre recursion.
+    constexpr NormalizationTables makeNormalizationTables() {
+        NormalizationTables tables;
+        const int nMax = GeomagneticConstants::MAX_DEGREE;
+
+        tables.schmidt[PreparedMagneticField::getIndex(0, 0)] = 1.0;
+        for (int n = 1; n <= nMax; ++n) {
+            tables.schmidt[PreparedMagneticField::getIndex(n, 0)] =
+                tables.schmidt[PreparedMagneticField::getIndex(n - 1, 0)] * (2.0 * n - 1) / n;
+
+            for (int m = 1; m <= n; ++m) {
+                tables.schmidt[PreparedMagneticField::getIndex(n, m)] =
+                    tables.schmidt[PreparedMagneticField::getIndex(n, m - 1)] *
+                    constexprSqrt((n - m + 1) * (m == 1 ? 2.0 : 1.0) / (n + m));
+            }
+        }
+
+        for (int n = 2; n <= nMax; ++n) {
+            for (int m = 0; m < n; ++m) {
+                tables.recursion[PreparedMagneticField::getIndex(n, m)] =
+                    ((n - 1) * (n - 1) - m * m) / ((2.0 * n - 1) * (2.0 * n - 3));
+            }
+        }
+
+        return tables;
+    }
+
+    constexpr NormalizationTables NORMALIZATION = makeNormalizationTables();
+
+    constexpr double DEG_TO_RAD = M_PI / 180.0;
+    constexpr double RAD_TO_DEG = 180.0 / M_PI;
+}
+
+// ========== Constructors ==========
+
+PreparedMagneticField::PreparedMagneticField()
+    : m_maxDegree(0), m_g{}, m_h{} {
+}
+
+PreparedMagneticField::PreparedMagneticField(
+    int maxDegree, const CoefficientArray& g, const CoefficientArray& h)
+    : m_maxDegree(std::max(0, std::min(maxDegree, GeomagneticConstants::MAX_DEGREE))),
+      m_g(g), m_h(h) {
+}
+
+PreparedMagneticField PreparedMagneticField::tiltedDipole(double g10, double g11, double h11) {
+    CoefficientArray g{}, h{};
+    g[getIndex(1, 0)] = g10;
+    g[getIndex(1, 1)] = g11;
+    h[getIndex(1, 1)] = h11;
+    return PreparedMagneticField(1, g, h);
+}
+
+PreparedMagneticField PreparedMagneticField::truncated(int maxDegree) const {
+    PreparedMagneticField result(std::min(maxDegree, m_maxDegree), m_g, m_h);
+
+    int first = getIndex(result.m_maxDegree + 1, 0);
+    for (int idx = first; idx < GeomagneticConstants::NUM_COEFFICIENTS; ++idx) {
+        result.m_g[idx] = 0.0;
+        result.m_h[idx] = 0.0;
+    }
+
+    return result;
+}
+
+// ========== Field Synthesis ==========
+
+void PreparedMagneticField::fieldComponents(
+    double a_over_r, double cos_theta, double sin_theta,
+    double cos_phi, double sin_phi,
+    double& X, double& Y, double& Z) const {
+
+    const int nMax = m_maxDegree;
+
+    if (std::abs(sin_theta) < 1e-10) {
+        sin_theta = 1e-10;
+    }
+
+    std::array<double, GeomagneticConstants::NUM_COEFFICIENTS> P;
+    std::array<double, GeomagneticConstants::NUM_COEFFICIENTS> dP;
+
+    P[getIndex(0, 0)] = 1.0;
+    dP[getIndex(0, 0)] = 0.0;
+
+    P[getIndex(1, 0)] = cos_theta;
+    dP[getIndex(1, 0)] = -sin_theta;
+
+    P[getIndex(1, 1)] = sin_theta;
+    dP[getIndex(1, 1)] = cos_theta;
+
+    for (int n = 2; n <= nMax; ++n) {
+        for (int m = 0; m <= n; ++m) {
+            int idx = getIndex(n, m);
+
+            if (n == m) {
+                int prev = getIndex(n - 1, n - 1);
+                P[idx] = sin_theta * P[prev];
+                dP[idx] = sin_theta * dP[prev] + cos_theta * P[prev];
+            } else if (m == n - 1) {
+                int prev = getIndex(n - 1, m);
+                P[idx] = cos_theta * P[prev];
+                dP[idx] = cos_theta * dP[prev] - sin_theta * P[prev];
+            } else {
+                int prev = getIndex(n - 1, m);
+                int prev2 = getIndex(n - 2, m);
+                double k = NORMALIZATION.recursion[idx];
+                P[idx] = cos_theta * P[prev] - k * P[prev2];
+                dP[idx] = cos_theta * dP[prev] - sin_theta * P[prev] - k * dP[prev2];
+            }
+        }
+    }
+
+    std::array<double, GeomagneticConstants::MAX_DEGREE + 1> cos_m_phi;
+    std::array<double, GeomagneticConstants::MAX_DEGREE + 1> sin_m_phi;
+
+    cos_m_phi[0] = 1.0;
+    sin_m_phi[0] = 0.0;
+    cos_m_phi[1] = cos_phi;
+    sin_m_phi[1] = sin_phi;
+
+    for (int m = 2; m <= nMax; ++m) {
+        cos_m_phi[m] = cos_m_phi[m-1] * cos_phi - sin_m_phi[m-1] * sin_phi;
+        sin_m_phi[m] = sin_m_phi[m-1] * cos_phi + cos_m_phi[m-1] * sin_phi;
+    }
+
+    double Br = 0.0;
+    double Btheta = 0.0;
+    double Bphi = 0.0;
+    double ratio = a_over_r * a_over_r;
+
+    for (int n = 1; n <= nMax; ++n) {
+        ratio *= a_over_r;
+
+        double sum_r = 0.0;
+        double sum_theta = 0.0;
+        double sum_phi = 0.0;
+        int base = getIndex(n, 0);
+
+        for (int m = 0; m <= n; ++m) {
+            int idx = base + m;
+            double schmidt = NORMALIZATION.schmidt[idx];
+            double gnm = m_g[idx];
+            double hnm = m_h[idx];
+
+            double cos_term = gnm * cos_m_phi[m] + hnm * sin_m_phi[m];
+            double d_lambda_term = hnm * cos_m_phi[m] - gnm * sin_m_phi[m];
+
+            sum_r += schmidt * P[idx] * cos_term;
+            sum_theta += schmidt * dP[idx] * cos_term;
+            sum_phi += m * schmidt * P[idx] * d_lambda_term;
+        }
+
+        Br += ratio * (n + 1) * sum_r;
+        Btheta += ratio * sum_theta;
+        Bphi += ratio * sum_phi;
+    }
+
+    Bphi /= sin_theta;
+
+    X = Btheta;
+    Y = -Bphi;
+    Z = -Br;
+}
+
+void PreparedMagneticField::dipoleComponents(
+    double a_over_r, double cos_theta, double sin_theta,
+    double cos_phi, double sin_phi,
+    double& X, double& Y, double& Z) const {
+
+    double ratio = a_over_r * a_over_r * a_over_r;
+    double g10 = m_g[getIndex(1, 0)];
+    double g11 = m_g[getIndex(1, 1)];
+    double h11 = m_h[getIndex(1, 1)];
+
+    double equatorial = g11 * cos_phi + h11 * sin_phi;
+
+    X = ratio * (equatorial * cos_theta - g10 * sin_theta);
+    Y = ratio * (g11 * sin_phi - h11 * cos_phi);
+    Z = -2.0 * ratio * (g10 * cos_theta + equatorial * sin_theta);
+}
+
+// ========== Geodetic Evaluation ==========
+
+MagneticFieldResult PreparedMagneticField::evaluate(
+    double latitude_deg,
+    double longitude_deg,
+    double height_km) const {
+
+    MagneticFieldResult result = {};
+
+    if (m_maxDegree <= 0) {
+        return result;
+    }
+
+    if (std::abs(latitude_deg) > 89.9) {
+        latitude_deg = (latitude_deg > 0) ? 89.9 : -89.9;
+    }
+
+    double lat_rad = latitude_deg * DEG_TO_RAD;
+    double phi = longitude_deg * DEG_TO_RAD;
+    double sin_lat = std::sin(lat_rad);
+    double cos_lat = std::cos(lat_rad);
+
+    double e2 = GeomagneticConstants::WGS84_E2;
+    double N = GeomagneticConstants::WGS84_A / std::sqrt(1.0 - e2 * sin_lat * sin_lat);
+
+    double x = (N + height_km) * cos_lat;
+    double z = (N * (1.0 - e2) + height_km) * sin_lat;
+    double r = std::sqrt(x * x + z * z);
+
+    // Colatitude terms come straight from the geocentric position, no trig needed.
+    double cos_theta = z / r;
+    double sin_theta = x / r;
+
+    double X_gc, Y, Z_gc;
+    if (isDipole()) {
+        dipoleComponents(GeomagneticConstants::REFERENCE_RADIUS_KM / r,
+                         cos_theta, sin_theta, std::cos(phi), std::sin(phi),
+                         X_gc, Y, Z_gc);
+    } else {
+        fieldComponents(GeomagneticConstants::REFERENCE_RADIUS_KM / r,
+                        cos_theta, sin_theta, std::cos(phi), std::sin(phi),
+                        X_gc, Y, Z_gc);
+    }
+
+    // Rotate by the geodetic/geocentric latitude difference.
+    double cos_psi = cos_lat * sin_theta + sin_lat * cos_theta;
+    double sin_psi = sin_lat * sin_theta - cos_lat * cos_theta;
+
+    double X = X_gc * cos_psi - Z_gc * sin_psi;
+    double Z = X_gc * sin_psi + Z_gc * cos_psi;
+
+    result.X = X;
+    result.Y = Y;
+    result.Z = Z;
+    result.H = std::sqrt(X * X + Y * Y);
+    result.F = std::sqrt(X * X + Y * Y + Z * Z);
+    result.inclination = std::atan2(Z, result.H) * RAD_TO_DEG;
+    result.declination = std::atan2(Y, X) * RAD_TO_DEG;
+
+    return result;
+}
+
+void PreparedMagneticField::evaluateBatch(
+    const double* latitude_deg,
+    const double* longitude_deg,
+    const double* height_km,
+    std::size_t count,
+    MagneticFieldResult* results) const {
+
+    for (std::size_t i = 0; i < count; ++i) {
+        results[i] = evaluate(latitude_deg[i], longitude_deg[i], height_km[i]);
+    }
+}
+
+// ========== Geocentric Evaluation ==========
+
+void PreparedMagneticField::evaluateGeocentric(
+    double latitude_gc_deg, double longitude_deg, double radius_km,
+    double& north, double& east, double& down) const {
+
+    north = east = down = 0.0;
+    if (m_maxDegree <= 0) {
+        return;
+    }
+
+    double lat_rad = latitude_gc_deg * DEG_TO_RAD;
+    double phi = longitude_deg * DEG_TO_RAD;
+    double a_over_r = GeomagneticConstants::REFERENCE_RADIUS_KM / radius_km;
+
+    if (isDipole()) {
+        dipoleComponents(a_over_r, std::sin(lat_rad), std::cos(lat_rad),
+                         std::cos(phi), std::sin(phi), north, east, down);
+    } else {
+        fieldComponents(a_over_r, std::sin(lat_rad), std::cos(lat_rad),
+                        std::cos(phi), std::sin(phi), north, east, down);
+    }
+}
+
+void PreparedMagneticField::evaluateGeocentricBatch(
+    const double* latitude_gc_deg,
+    const double* longitude_deg,
+    const double* radius_km,
+    std::size_t count,
+    double* north, double* east, double* down) const {
+
+    for (std::size_t i = 0; i < count; ++i) {
+        evaluateGeocentric(latitude_gc_deg[i], longitude_deg[i], radius_km[i],
+                           north[i], east[i], down[i]);
+    }
+}
+
+void PreparedMagneticField::evaluateCartesianBatch(
+    const double* x_km,
+    const double* y_km,
+    const double* z_km,
+    std::size_t count,
+    double* north, double* east, double* down) const {
+
+    for (std::size_t i = 0; i < count; ++i) {
+        if (m_maxDegree <= 0) {
+            north[i] = east[i] = down[i] = 0.0;
+            continue;
+        }
+
+        double rho2 = x_km[i] * x_km[i] + y_km[i] * y_km[i];
+        double rho = std::sqrt(rho2);
+        double r = std::sqrt(rho2 + z_km[i] * z_km[i]);
+
+        double cos_theta = z_km[i] / r;
+        double sin_theta = rho / r;
+        double cos_phi = rho > 0.0 ? x_km[i] / rho : 1.0;
+        double sin_phi = rho > 0.0 ? y_km[i] / rho : 0.0;
+        double a_over_r = GeomagneticConstants::REFERENCE_RADIUS_KM / r;
+
+        if (isDipole()) {
+            dipoleComponents(a_over_r, cos_theta, sin_theta, cos_phi, sin_phi,
+                             north[i], east[i], down[i]);
+        } else {
+            fieldComponents(a_over_r, cos_theta, sin_theta, cos_phi, sin_phi,
+                            north[i], east[i], down[i]);
+        }
+    }
+}
+
+// ========== Geomagnetic Model ==========
+
+MagneticFieldResult GeomagneticModel::calculate(
+    double latitude_deg,
+    double longitude_deg,
+    double height_km,
+    double decimal_year) const {
+
+    if (!isLoaded()) {
+        return MagneticFieldResult{};
+    }
+
+    return prepare(decimal_year).evaluate(latitude_deg, longitude_deg, height_km);
+}
+
+void GeomagneticModel::calculateBatch(
+    const double* latitude_deg,
+    const double* longitude_deg,
+    const double* height_km,
+    std::size_t count,
+    double decimal_year,
+    MagneticFieldResult* results) const {
+
+    if (!isLoaded()) {
+        std::fill(results, results + count, MagneticFieldResult{});
+        return;
+    }
+
+    prepare(decimal_year).evaluateBatch(latitude_deg, longitude_deg, height_km, count, results);
+}
@@ -0,0 +1,123 @@
+#pragma once
+
+#include <array>
+#include <cstddef>
+#include <string>
+
+// ========== Geomagnetic Constants ==========
+
+namespace GeomagneticConstants {
+    constexpr double WGS84_A = 6378.137;
+    constexpr double WGS84_F = 1.0 / 298.257223563;
+    constexpr double WGS84_E2 = 2.0 * WGS84_F - WGS84_F * WGS84_F;
+    constexpr double REFERENCE_RADIUS_KM = 6371.2;
+    constexpr int MAX_DEGREE = 13;
+    constexpr int NUM_COEFFICIENTS = (MAX_DEGREE + 1) * (MAX_DEGREE + 2) / 2;
+}
+
+// ========== Magnetic Field Result ==========
+
+struct MagneticFieldResult {
+    double X;
+    double Y;
+    double Z;
+    double H;
+    double F;
+    double inclination;
+    double declination;
+};
+
+// ========== Prepared Magnetic Field ==========
+// Spherical harmonic coefficients already evolved to a single epoch. Evaluation
+// is non-virtual and allocation-free; degree 1 takes a closed-form tilted-dipole path.
+
+class PreparedMagneticField {
+public:
+    using CoefficientArray = std::array<double, GeomagneticConstants::NUM_COEFFICIENTS>;
+
+    PreparedMagneticField();
+    PreparedMagneticField(int maxDegree, const CoefficientArray& g, const CoefficientArray& h);
+
+    static PreparedMagneticField tiltedDipole(double g10, double g11, double h11);
+    PreparedMagneticField truncated(int maxDegree) const;
+
+    MagneticFieldResult evaluate(
+        double latitude_deg,
+        double longitude_deg,
+        double height_km) const;
+
+    void evaluateBatch(
+        const double* latitude_deg,
+        const double* longitude_deg,
+        const double* height_km,
+        std::size_t count,
+        MagneticFieldResult* results) const;
+
+    // Geocentric spherical position; returns north/east/down components in nT.
+    void evaluateGeocentric(
+        double latitude_gc_deg, double longitude_deg, double radius_km,
+        double& north, double& east, double& down) const;
+
+    void evaluateGeocentricBatch(
+        const double* latitude_gc_deg,
+        const double* longitude_deg,
+        const double* radius_km,
+        std::size_t count,
+        double* north, double* east, double* down) const;
+
+    // Earth-centred Cartesian positions (km); no trigonometry is needed per point.
+    void evaluateCartesianBatch(
+        const double* x_km,
+        const double* y_km,
+        const double* z_km,
+        std::size_t count,
+        double* north, double* east, double* down) const;
+
+    bool isValid() const { return m_maxDegree > 0; }
+    bool isDipole() const { return m_maxDegree == 1; }
+    int getMaxDegree() const { return m_maxDegree; }
+    double getG(int n, int m) const { return m_g[getIndex(n, m)]; }
+    double getH(int n, int m) const { return m_h[getIndex(n, m)]; }
+
+    static constexpr int getIndex(int n, int m) { return n * (n + 1) / 2 + m; }
+
+private:
+    int m_maxDegree;
+    CoefficientArray m_g;
+    CoefficientArray m_h;
+
+    void fieldComponents(double a_over_r, double cos_theta, double sin_theta,
+                         double cos_phi, double sin_phi,
+                         double& X, double& Y, double& Z) const;
+
+    void dipoleComponents(double a_over_r, double cos_theta, double sin_theta,
+                          double cos_phi, double sin_phi,
+                          double& X, double& Y, double& Z) const;
+};
+
+// ========== Geomagnetic Model Interface ==========
+// Common front end for WMM, IGRF and dipole models. prepare() is called once per
+// epoch; hot loops then work on the returned PreparedMagneticField directly.
+
+class GeomagneticModel {
+public:
+    virtual ~GeomagneticModel() = default;
+
+    virtual PreparedMagneticField prepare(double decimal_year) const = 0;
+    virtual bool isLoaded() const = 0;
+    virtual const std::string& getModelName() const = 0;
+
+    MagneticFieldResult calculate(
+        double latitude_deg,
+        double longitude_deg,
+        double height_km,
+        double decimal_year) const;
+
+    void calculateBatch(
+        const double* latitude_deg,
+        const double* longitude_deg,
+        const double* height_km,
+        std::size_t count,
+        double decimal_year,
+        MagneticFieldResult* results) const;
+};
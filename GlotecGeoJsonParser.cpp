@@ -0,0 +1,291 @@
+#include "GlotecGeoJsonParser.h"
+#include "NOAAGlotecReader.h"
+#include <cmath>
+#include <algorithm>
+
+namespace {
+    // Coordinates further than this fraction of a cell from a grid node are rejected.
+    constexpr double GRID_TOLERANCE = 1e-3;
+}
+
+// ========== Constructor ==========
+
+GlotecGeoJsonParser::GlotecGeoJsonParser()
+    : m_reader(64), m_data(nullptr), m_numLon(0), m_numLat(0),
+      m_lonStart(0.0), m_latStart(0.0), m_lonStep(0.0), m_latStep(0.0),
+      m_key(Key::Other), m_sawFeatures(false),
+      m_featureIndex(0), m_coordCount(0), m_lon(0.0), m_lat(0.0), m_tec(0.0),
+      m_hasTec(false), m_tecInvalid(false), m_badGeometry(false),
+      m_validCount(0), m_errorCount(0), m_minRow(0), m_maxRow(-1) {
+
+    const GlotecData nominal;
+    m_numLon = nominal.numLon;
+    m_lonStart = nominal.lonStart;
+    m_latStart = nominal.latStart;
+    m_lonStep = nominal.lonStep;
+    m_latStep = nominal.latStep;
+
+    // The GloTEC grid is symmetric about the equator: rows run from latStart to -latStart.
+    m_numLat = static_cast<int>(std::lround(-2.0 * m_latStart / m_latStep)) + 1;
+}
+
+// ========== Parsing ==========
+
+void GlotecGeoJsonParser::begin(GlotecData& data) {
+    m_data = &data;
+    m_reader.reset();
+
+    data.numLon = m_numLon;
+    data.numLat = m_numLat;
+    data.lonStart = m_lonStart;
+    data.latStart = m_latStart;
+    data.lonStep = m_lonStep;
+    data.latStep = m_latStep;
+    data.tecValues.assign(static_cast<size_t>(data.numLon) * data.numLat, 0.0f);
+    data.isValid = false;
+
+    m_roles.clear();
+    m_key = Key::Other;
+    m_sawFeatures = false;
+    m_featureIndex = 0;
+    m_validCount = 0;
+    m_errorCount = 0;
+    m_minRow = m_numLat;
+    m_maxRow = -1;
+    m_featureErrors.clear();
+    m_error.clear();
+}
+
+bool GlotecGeoJsonParser::feed(const char* bytes, std::size_t length) {
+    if (!m_data) {
+        m_error = "feed() called before begin()";
+        return false;
+    }
+
+    if (!m_reader.feed(std::string_view(bytes, length), *this)) {
+        m_error = "JSON error at byte " + std::to_string(m_reader.getErrorOffset()) +
+                  ": " + m_reader.getError();
+        return false;
+    }
+    return true;
+}
+
+bool GlotecGeoJsonParser::finish() {
+    if (!m_data) {
+        m_error = "finish() called before begin()";
+        return false;
+    }
+
+    if (!m_reader.finish(*this)) {
+        m_error = "JSON error at byte " + std::to_string(m_reader.getErrorOffset()) +
+                  ": " + m_reader.getError();
+        return false;
+    }
+    if (!m_sawFeatures) {
+        m_error = "No \"features\" array in document";
+        return false;
+    }
+    if (m_validCount == 0) {
+        m_error = "No valid features";
+        return false;
+    }
+
+    // Crop to the latitude rows actually present.
+    GlotecData& data = *m_data;
+    size_t rowLength = static_cast<size_t>(data.numLon);
+    data.tecValues.erase(data.tecValues.begin() + (m_maxRow + 1) * rowLength, data.tecValues.end());
+    data.tecValues.erase(data.tecValues.begin(), data.tecValues.begin() + m_minRow * rowLength);
+    data.latStart = m_latStart + m_minRow * m_latStep;
+    data.numLat = m_maxRow - m_minRow + 1;
+    data.isValid = true;
+
+    return true;
+}
+
+bool GlotecGeoJsonParser::parse(std::string_view json, GlotecData& data) {
+    begin(data);
+    return feed(json.data(), json.size()) && finish();
+}
+
+// ========== Document Structure ==========
+
+GlotecGeoJsonParser::Role GlotecGeoJsonParser::childRole(bool isObject) const {
+    if (m_roles.empty()) {
+        return isObject ? Role::Root : Role::Other;
+    }
+
+    switch (m_roles.back()) {
+        case Role::Root:
+            if (!isObject && m_key == Key::Features) return Role::Features;
+            break;
+        case Role::Features:
+            if (isObject) return Role::Feature;
+            break;
+        case Role::Feature:
+            if (isObject && m_key == Key::Geometry) return Role::Geometry;
+            if (isObject && m_key == Key::Properties) return Role::Properties;
+            break;
+        case Role::Geometry:
+            if (!isObject && m_key == Key::Coordinates) return Role::Coordinates;
+            break;
+        default:
+            break;
+    }
+    return Role::Other;
+}
+
+bool GlotecGeoJsonParser::startObject() {
+    Role role = childRole(true);
+    scalarValue();
+
+    if (role == Role::Feature) {
+        m_coordCount = 0;
+        m_hasTec = false;
+        m_tecInvalid = false;
+        m_badGeometry = false;
+    }
+
+    m_roles.push_back(role);
+    return true;
+}
+
+bool GlotecGeoJsonParser::endObject() {
+    Role role = m_roles.back();
+    m_roles.pop_back();
+
+    if (role == Role::Feature) {
+        finishFeature();
+    }
+    return true;
+}
+
+bool GlotecGeoJsonParser::startArray() {
+    Role role = childRole(false);
+    scalarValue();
+
+    if (role == Role::Features) {
+        m_sawFeatures = true;
+    }
+
+    m_roles.push_back(role);
+    return true;
+}
+
+bool GlotecGeoJsonParser::endArray() {
+    m_roles.pop_back();
+    return true;
+}
+
+bool GlotecGeoJsonParser::key(std::string_view name) {
+    if (name == "tec") m_key = Key::Tec;
+    else if (name == "coordinates") m_key = Key::Coordinates;
+    else if (name == "geometry") m_key = Key::Geometry;
+    else if (name == "properties") m_key = Key::Properties;
+    else if (name == "features") m_key = Key::Features;
+    else m_key = Key::Other;
+    return true;
+}
+
+bool GlotecGeoJsonParser::number(double value) {
+    if (m_roles.empty()) {
+        return true;
+    }
+
+    Role role = m_roles.back();
+    if (role == Role::Coordinates) {
+        // [lon, lat] with an optional altitude, which is ignored.
+        if (m_coordCount == 0) m_lon = value;
+        else if (m_coordCount == 1) m_lat = value;
+        ++m_coordCount;
+    } else if (role == Role::Properties && m_key == Key::Tec) {
+        m_tec = value;
+        m_hasTec = true;
+        m_tecInvalid = false;
+    }
+    return true;
+}
+
+bool GlotecGeoJsonParser::string(std::string_view value) {
+    (void)value;
+    scalarValue();
+    return true;
+}
+
+bool GlotecGeoJsonParser::boolean(bool value) {
+    (void)value;
+    scalarValue();
+    return true;
+}
+
+bool GlotecGeoJsonParser::null() {
+    scalarValue();
+    return true;
+}
+
+void GlotecGeoJsonParser::scalarValue() {
+    // Anything other than a number where a coordinate or tec value belongs.
+    if (m_roles.empty()) {
+        return;
+    }
+
+    Role role = m_roles.back();
+    if (role == Role::Coordinates) {
+        m_badGeometry = true;
+    } else if (role == Role::Properties && m_key == Key::Tec) {
+        m_tecInvalid = true;
+    }
+}
+
+// ========== Grid Placement ==========
+
+void GlotecGeoJsonParser::finishFeature() {
+    if (m_badGeometry || m_coordCount < 2) {
+        featureError("Missing or malformed Point coordinates");
+        return;
+    }
+    if (m_tecInvalid) {
+        featureError("Non-numeric tec value");
+        return;
+    }
+    if (!m_hasTec) {
+        featureError("Missing tec property");
+        return;
+    }
+    if (!std::isfinite(m_lon) || !std::isfinite(m_lat) || !std::isfinite(m_tec)) {
+        featureError("Non-finite coordinate or tec value");
+        return;
+    }
+
+    double lon = m_lon - 360.0 * std::floor((m_lon + 180.0) / 360.0);
+
+    double colFloat = (lon - m_lonStart) / m_lonStep;
+    double rowFloat = (m_lat - m_latStart) / m_latStep;
+    double col = std::round(colFloat);
+    double row = std::round(rowFloat);
+
+    if (std::abs(colFloat - col) > GRID_TOLERANCE || std::abs(rowFloat - row) > GRID_TOLERANCE) {
+        featureError("Point is not on the GloTEC grid");
+        return;
+    }
+    if (row < 0 || row >= m_numLat) {
+        featureError("Latitude outside the GloTEC grid");
+        return;
+    }
+
+    int c = (static_cast<int>(col) % m_numLon + m_numLon) % m_numLon;
+    int r = static_cast<int>(row);
+
+    m_data->tecValues[static_cast<size_t>(r) * m_numLon + c] = static_cast<float>(m_tec);
+    m_minRow = std::min(m_minRow, r);
+    m_maxRow = std::max(m_maxRow, r);
+    ++m_validCount;
+    ++m_featureIndex;
+}
+
+void GlotecGeoJsonParser::featureError(const char* message) {
+    if (m_featureErrors.size() < MAX_STORED_ERRORS) {
+        m_featureErrors.push_back({ m_featureIndex, message });
+    }
+    ++m_errorCount;
+    ++m_featureIndex;
+}
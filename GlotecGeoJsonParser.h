@@ -0,0 +1,91 @@
+#pragma once
+
+#include "JsonSaxReader.h"
+#include <cstddef>
+#include <string>
+#include <string_view>
+#include <vector>
+
+struct GlotecData;
+
+struct GlotecFeatureError {
+    std::size_t featureIndex;
+    std::string message;
+};
+
+// ========== GloTEC GeoJSON Parser ==========
+// Single pass over a GloTEC FeatureCollection. Each Point feature's coordinates and
+// "tec" property are paired inside the feature and written straight into the
+// GlotecData grid; features that cannot be placed are recorded and skipped.
+// Input can be pushed in arbitrary chunks as it arrives from the network.
+
+class GlotecGeoJsonParser : private JsonSaxHandler {
+public:
+    GlotecGeoJsonParser();
+
+    void begin(GlotecData& data);
+    bool feed(const char* bytes, std::size_t length);
+    bool finish();
+
+    // begin() + feed() + finish() over a complete document.
+    bool parse(std::string_view json, GlotecData& data);
+
+    std::size_t getFeatureCount() const { return m_featureIndex; }
+    std::size_t getValidFeatureCount() const { return m_validCount; }
+    std::size_t getFeatureErrorCount() const { return m_errorCount; }
+    const std::vector<GlotecFeatureError>& getFeatureErrors() const { return m_featureErrors; }
+    const std::string& getError() const { return m_error; }
+
+private:
+    enum class Role { Root, Features, Feature, Geometry, Coordinates, Properties, Other };
+    enum class Key { Features, Geometry, Coordinates, Properties, Tec, Other };
+
+    static constexpr std::size_t MAX_STORED_ERRORS = 100;
+
+    JsonSaxReader m_reader;
+    GlotecData* m_data;
+
+    // Nominal grid geometry before row cropping.
+    int m_numLon;
+    int m_numLat;
+    double m_lonStart;
+    double m_latStart;
+    double m_lonStep;
+    double m_latStep;
+
+    std::vector<Role> m_roles;
+    Key m_key;
+    bool m_sawFeatures;
+
+    // Current feature
+    std::size_t m_featureIndex;
+    int m_coordCount;
+    double m_lon;
+    double m_lat;
+    double m_tec;
+    bool m_hasTec;
+    bool m_tecInvalid;
+    bool m_badGeometry;
+
+    std::size_t m_validCount;
+    std::size_t m_errorCount;
+    int m_minRow;
+    int m_maxRow;
+    std::vector<GlotecFeatureError> m_featureErrors;
+    std::string m_error;
+
+    bool startObject() override;
+    bool endObject() override;
+    bool startArray() override;
+    bool endArray() override;
+    bool key(std::string_view name) override;
+    bool string(std::string_view value) override;
+    bool number(double value) override;
+    bool boolean(bool value) override;
+    bool null() override;
+
+    Role childRole(bool isObject) const;
+    void scalarValue();
+    void finishFeature();
+    void featureError(const char* message);
+};
@@ -0,0 +1,302 @@
+#define _CRT_SECURE_NO_WARNINGS
+#include "GlotecSnapshotStore.h"
+#include "NOAAGlotecReader.h"
+#include <cstdio>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+
+namespace {
+    constexpr char MAGIC[4] = { 'G', 'T', 'E', 'C' };
+    constexpr std::uint32_t FORMAT_VERSION = 1;
+
+    // magic, version, epoch, numLon, numLat, lonStart, latStart, lonStep, latStep
+    constexpr std::size_t HEADER_SIZE = 4 + 4 + 8 + 4 + 4 + 4 * 8;
+    constexpr std::int64_t MAX_GRID_POINTS = 1 << 22;
+
+    // The header is written in host byte order; all supported targets are little-endian.
+    template <typename T>
+    void put(char*& out, const T& value) {
+        std::memcpy(out, &value, sizeof(T));
+        out += sizeof(T);
+    }
+
+    template <typename T>
+    void get(const char*& in, T& value) {
+        std::memcpy(&value, in, sizeof(T));
+        in += sizeof(T);
+    }
+
+    // Days since 1970-01-01 in the proleptic Gregorian calendar.
+    std::int64_t daysFromCivil(std::int64_t year, std::int64_t month, std::int64_t day) {
+        year -= (month <= 2) ? 1 : 0;
+        std::int64_t era = (year >= 0 ? year : year - 399) / 400;
+        std::int64_t yearOfEra = year - era * 400;
+        std::int64_t dayOfYear = (153 * (month > 2 ? month - 3 : month + 9) + 2) / 5 + day - 1;
+        std::int64_t dayOfEra = yearOfEra * 365 + yearOfEra / 4 - yearOfEra / 100 + dayOfYear;
+        return era * 146097 + dayOfEra - 719468;
+    }
+
+    std::int64_t floorDiv(std::int64_t a, std::int64_t b) {
+        std::int64_t q = a / b;
+        return (a % b != 0 && ((a < 0) != (b < 0))) ? q - 1 : q;
+    }
+}
+
+// ========== Constructor ==========
+
+GlotecSnapshotStore::GlotecSnapshotStore(const std::string& directory)
+    : m_directory(directory), m_open(false) {
+}
+
+bool GlotecSnapshotStore::open() {
+    namespace fs = std::filesystem;
+
+    m_epochs.clear();
+    m_open = false;
+
+    std::error_code ec;
+    fs::create_directories(m_directory, ec);
+    if (!fs::is_directory(m_directory, ec)) {
+        m_error = "Cannot create snapshot directory " + m_directory;
+        return false;
+    }
+
+    for (const fs::directory_entry& entry : fs::directory_iterator(m_directory, ec)) {
+        std::string name = entry.path().filename().string();
+        std::int64_t epoch;
+        if (name.rfind("glotec_", 0) == 0 && entry.path().extension() == ".grid" &&
+            parseStamp(name, epoch)) {
+            m_epochs.insert(epoch);
+        }
+    }
+
+    m_open = true;
+    return true;
+}
+
+// ========== Snapshot I/O ==========
+
+std::string GlotecSnapshotStore::pathFor(std::int64_t epoch) const {
+    return (std::filesystem::path(m_directory) / ("glotec_" + formatStamp(epoch) + ".grid")).string();
+}
+
+bool GlotecSnapshotStore::save(const GlotecData& data) {
+    if (!m_open) {
+        m_error = "Snapshot store is not open";
+        return false;
+    }
+
+    const size_t count = static_cast<size_t>(data.numLon) * static_cast<size_t>(data.numLat);
+    if (!data.isValid || data.numLon <= 0 || data.numLat <= 0 || data.tecValues.size() != count) {
+        m_error = "Refusing to store an invalid grid";
+        return false;
+    }
+
+    const std::int64_t epoch = toEpochSeconds(data.timestamp);
+
+    char header[HEADER_SIZE];
+    char* out = header;
+    std::memcpy(out, MAGIC, sizeof(MAGIC));
+    out += sizeof(MAGIC);
+    put(out, FORMAT_VERSION);
+    put(out, epoch);
+    put(out, static_cast<std::int32_t>(data.numLon));
+    put(out, static_cast<std::int32_t>(data.numLat));
+    put(out, data.lonStart);
+    put(out, data.latStart);
+    put(out, data.lonStep);
+    put(out, data.latStep);
+
+    // Write beside the target and rename, so readers never see a partial file.
+    const std::string path = pathFor(epoch);
+    const std::string temporary = path + ".tmp";
+    {
+        std::ofstream file(temporary, std::ios::binary | std::ios::trunc);
+        file.write(header, HEADER_SIZE);
+        file.write(reinterpret_cast<const char*>(data.tecValues.data()),
+                   static_cast<std::streamsize>(count * sizeof(float)));
+        if (!file) {
+            m_error = "Cannot write " + temporary;
+            return false;
+        }
+    }
+
+    std::error_code ec;
+    std::filesystem::rename(temporary, path, ec);
+    if (ec) {
+        m_error = "Cannot rename " + temporary + ": " + ec.message();
+        std::filesystem::remove(temporary, ec);
+        return false;
+    }
+
+    m_epochs.insert(epoch);
+    return true;
+}
+
+bool GlotecSnapshotStore::load(std::int64_t epoch, GlotecData& data) const {
+    if (!contains(epoch)) {
+        m_error = "No snapshot for " + formatStamp(epoch);
+        return false;
+    }
+
+    const std::string path = pathFor(epoch);
+    std::ifstream file(path, std::ios::binary);
+    char header[HEADER_SIZE];
+    if (!file.read(header, HEADER_SIZE)) {
+        m_error = "Cannot read " + path;
+        return false;
+    }
+
+    const char* in = header;
+    std::uint32_t version;
+    std::int64_t storedEpoch;
+    std::int32_t numLon, numLat;
+    double lonStart, latStart, lonStep, latStep;
+
+    if (std::memcmp(in, MAGIC, sizeof(MAGIC)) != 0) {
+        m_error = "Not a GloTEC snapshot: " + path;
+        return false;
+    }
+    in += sizeof(MAGIC);
+    get(in, version);
+    get(in, storedEpoch);
+    get(in, numLon);
+    get(in, numLat);
+    get(in, lonStart);
+    get(in, latStart);
+    get(in, lonStep);
+    get(in, latStep);
+
+    const std::int64_t count = static_cast<std::int64_t>(numLon) * numLat;
+    if (version != FORMAT_VERSION || storedEpoch != epoch ||
+        numLon <= 0 || numLat <= 0 || count > MAX_GRID_POINTS) {
+        m_error = "Corrupt snapshot header: " + path;
+        return false;
+    }
+
+    data.tecValues.resize(static_cast<size_t>(count));
+    if (!file.read(reinterpret_cast<char*>(data.tecValues.data()),
+                   static_cast<std::streamsize>(count * sizeof(float)))) {
+        m_error = "Truncated snapshot: " + path;
+        data.isValid = false;
+        return false;
+    }
+
+    data.numLon = numLon;
+    data.numLat = numLat;
+    data.lonStart = lonStart;
+    data.latStart = latStart;
+    data.lonStep = lonStep;
+    data.latStep = latStep;
+    data.timestamp = fromEpochSeconds(epoch);
+    data.isValid = true;
+
+    return true;
+}
+
+bool GlotecSnapshotStore::contains(std::int64_t epoch) const {
+    return m_epochs.count(epoch) != 0;
+}
+
+bool GlotecSnapshotStore::findAtOrBefore(std::int64_t time, std::int64_t maxAge_s, GlotecData& data) const {
+    auto it = m_epochs.upper_bound(time);
+    if (it == m_epochs.begin()) {
+        m_error = "No snapshot at or before " + formatStamp(time);
+        return false;
+    }
+    --it;
+
+    if (time - *it > maxAge_s) {
+        m_error = "Latest snapshot before " + formatStamp(time) + " is too old";
+        return false;
+    }
+    return load(*it, data);
+}
+
+std::vector<std::int64_t> GlotecSnapshotStore::getEpochs() const {
+    return std::vector<std::int64_t>(m_epochs.begin(), m_epochs.end());
+}
+
+// ========== Time Conversion ==========
+
+std::int64_t GlotecSnapshotStore::toEpochSeconds(const std::tm& time) {
+    std::int64_t month = time.tm_mon;
+    std::int64_t year = time.tm_year + 1900 + floorDiv(month, 12);
+    month -= floorDiv(month, 12) * 12;
+
+    std::int64_t days = daysFromCivil(year, month + 1, 1) + (time.tm_mday - 1);
+    return days * 86400 + time.tm_hour * 3600LL + time.tm_min * 60LL + time.tm_sec;
+}
+
+std::tm GlotecSnapshotStore::fromEpochSeconds(std::int64_t seconds) {
+    std::int64_t days = floorDiv(seconds, 86400);
+    std::int64_t secondOfDay = seconds - days * 86400;
+
+    std::int64_t z = days + 719468;
+    std::int64_t era = (z >= 0 ? z : z - 146096) / 146097;
+    std::int64_t dayOfEra = z - era * 146097;
+    std::int64_t yearOfEra = (dayOfEra - dayOfEra / 1460 + dayOfEra / 36524 - dayOfEra / 146096) / 365;
+    std::int64_t dayOfYear = dayOfEra - (365 * yearOfEra + yearOfEra / 4 - yearOfEra / 100);
+    std::int64_t mp = (5 * dayOfYear + 2) / 153;
+    std::int64_t day = dayOfYear - (153 * mp + 2) / 5 + 1;
+    std::int64_t month = (mp < 10) ? mp + 3 : mp - 9;
+    std::int64_t year = yearOfEra + era * 400 + (month <= 2 ? 1 : 0);
+
+    std::tm result = {};
+    result.tm_year = static_cast<int>(year - 1900);
+    result.tm_mon = static_cast<int>(month - 1);
+    result.tm_mday = static_cast<int>(day);
+    result.tm_hour = static_cast<int>(secondOfDay / 3600);
+    result.tm_min = static_cast<int>((secondOfDay / 60) % 60);
+    result.tm_sec = static_cast<int>(secondOfDay % 60);
+    result.tm_wday = static_cast<int>((days + 4) - floorDiv(days + 4, 7) * 7);   // 1970-01-01 was a Thursday
+    result.tm_yday = static_cast<int>(days - daysFromCivil(year, 1, 1));
+    result.tm_isdst = 0;
+    return result;
+}
+
+std::string GlotecSnapshotStore::formatStamp(std::int64_t epoch) {
+    std::tm t = fromEpochSeconds(epoch);
+    char text[64];
+    std::snprintf(text, sizeof(text), "%04d%02d%02dT%02d%02d%02dZ",
+                  t.tm_year + 1900, t.tm_mon + 1, t.tm_mday, t.tm_hour, t.tm_min, t.tm_sec);
+    return text;
+}
+
+bool GlotecSnapshotStore::parseStamp(const std::string& text, std::int64_t& epoch) {
+    // Locate the first "dddddddd'T'dddddd'Z'" run.
+    auto digits = [&text](size_t from, size_t count) {
+        for (size_t i = from; i < from + count; ++i) {
+            if (text[i] < '0' || text[i] > '9') return false;
+        }
+        return true;
+    };
+    auto number = [&text](size_t from, size_t count) {
+        int value = 0;
+        for (size_t i = from; i < from + count; ++i) value = value * 10 + (text[i] - '0');
+        return value;
+    };
+
+    for (size_t i = 0; i + 16 <= text.size(); ++i) {
+        if (text[i + 8] != 'T' || text[i + 15] != 'Z' || !digits(i, 8) || !digits(i + 9, 6)) {
+            continue;
+        }
+
+        std::tm t = {};
+        t.tm_year = number(i, 4) - 1900;
+        t.tm_mon = number(i + 4, 2) - 1;
+        t.tm_mday = number(i + 6, 2);
+        t.tm_hour = number(i + 9, 2);
+        t.tm_min = number(i + 11, 2);
+        t.tm_sec = number(i + 13, 2);
+
+        if (t.tm_mon < 0 || t.tm_mon > 11 || t.tm_mday < 1 || t.tm_mday > 31 ||
+            t.tm_hour > 23 || t.tm_min > 59 || t.tm_sec > 60) {
+            return false;
+        }
+        epoch = toEpochSeconds(t);
+        return true;
+    }
+    return false;
+}
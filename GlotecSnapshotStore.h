@@ -0,0 +1,55 @@
+#pragma once
+
+#include <cstdint>
+#include <ctime>
+#include <set>
+#include <string>
+#include <vector>
+
+struct GlotecData;
+
+// ========== GloTEC Snapshot Store ==========
+// Directory of binary GloTEC grids, one file per product epoch
+// (glotec_YYYYMMDDTHHMMSSZ.grid), indexed by UTC seconds. Each file holds a fixed
+// header with the grid geometry followed by the float TEC values in GlotecData
+// order, so loading is a single read with no parsing. Everything is in host byte
+// order, as in the lunar and columnar formats; a store is not portable between
+// machines of different endianness.
+
+class GlotecSnapshotStore {
+public:
+    explicit GlotecSnapshotStore(const std::string& directory);
+
+    // Creates the directory if needed and indexes the snapshots already present.
+    bool open();
+    bool isOpen() const { return m_open; }
+
+    bool save(const GlotecData& data);
+    bool load(std::int64_t epoch, GlotecData& data) const;
+    bool contains(std::int64_t epoch) const;
+
+    // Most recent snapshot at or before `time` and not older than maxAge_s.
+    bool findAtOrBefore(std::int64_t time, std::int64_t maxAge_s, GlotecData& data) const;
+
+    std::vector<std::int64_t> getEpochs() const;
+    std::size_t size() const { return m_epochs.size(); }
+    const std::string& getDirectory() const { return m_directory; }
+    const std::string& getError() const { return m_error; }
+
+    // UTC calendar <-> seconds since 1970, independent of the local time zone.
+    // Out-of-range tm fields (minute 60, day 32, ...) are carried over.
+    static std::int64_t toEpochSeconds(const std::tm& time);
+    static std::tm fromEpochSeconds(std::int64_t seconds);
+
+    // "YYYYMMDDTHHMMSSZ", the stamp used in GloTEC product names.
+    static std::string formatStamp(std::int64_t epoch);
+    static bool parseStamp(const std::string& text, std::int64_t& epoch);
+
+private:
+    std::string m_directory;
+    std::set<std::int64_t> m_epochs;
+    bool m_open;
+    mutable std::string m_error;
+
+    std::string pathFor(std::int64_t epoch) const;
+};
@@ -0,0 +1,18 @@
+#include "GlotecTecSource.h"
+#include "GlotecTimeSeries.h"
+#include <limits>
+
+GlotecTecSource::GlotecTecSource(std::shared_ptr<const GlotecTimeSeries> series)
+    : m_series(std::move(series)) {
+}
+
+bool GlotecTecSource::getTecBatch(const std::int64_t* times, const double* lat, const double* lon,
+                                  std::size_t count, double* tec) {
+    if (!m_series) {
+        for (std::size_t i = 0; i < count; ++i) {
+            tec[i] = std::numeric_limits<double>::quiet_NaN();
+        }
+        return false;
+    }
+    return m_series->getTecBatch(times, lat, lon, count, tec);
+}
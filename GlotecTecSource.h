@@ -0,0 +1,25 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+
+class GlotecTimeSeries;
+
+// ========== GloTEC TEC Source ==========
+// TecSource adapter over a GlotecTimeSeries. Queries go straight to the series'
+// lock-free window, so the adapter can be used while the prefetcher runs.
+
+class GlotecTecSource {
+public:
+    explicit GlotecTecSource(std::shared_ptr<const GlotecTimeSeries> series);
+
+    bool getTecBatch(const std::int64_t* times, const double* lat, const double* lon,
+                     std::size_t count, double* tec);
+    const char* getName() const { return "GloTEC"; }
+
+    const GlotecTimeSeries* getSeries() const { return m_series.get(); }
+
+private:
+    std::shared_ptr<const GlotecTimeSeries> m_series;
+};
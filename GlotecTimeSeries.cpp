@@ -0,0 +1,314 @@
+#include "GlotecTimeSeries.h"
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <limits>
+
+namespace {
+    // Larger gaps between consecutive grids (missing products) are not bridged.
+    constexpr std::int64_t MAX_GAP_S = 3 * GlotecTimeSeries::CADENCE_S;
+
+    std::int64_t floorToCadence(std::int64_t t) {
+        std::int64_t q = t / GlotecTimeSeries::CADENCE_S;
+        if (t % GlotecTimeSeries::CADENCE_S < 0) --q;
+        return q * GlotecTimeSeries::CADENCE_S;
+    }
+}
+
+// ========== Constructor ==========
+
+GlotecTimeSeries::GlotecTimeSeries(std::size_t capacity)
+    : m_capacity(std::max<std::size_t>(capacity, 2)),
+      m_ring(m_capacity), m_ringEpochs(m_capacity, 0), m_head(0), m_count(0),
+      m_current(0), m_publishDelay(120), m_retryInterval(30), m_pollInterval_ms(1000),
+      m_stopRequested(false) {
+
+    for (int i = 0; i < NUM_SLOTS; ++i) {
+        m_readers[i] = 0;
+    }
+
+    m_clock = []() {
+        return static_cast<std::int64_t>(std::chrono::duration_cast<std::chrono::seconds>(
+            std::chrono::system_clock::now().time_since_epoch()).count());
+    };
+}
+
+GlotecTimeSeries::~GlotecTimeSeries() {
+    stop();
+}
+
+void GlotecTimeSeries::setClock(std::function<std::int64_t()> clock) {
+    m_clock = std::move(clock);
+}
+
+// ========== Loading ==========
+
+bool GlotecTimeSeries::fetchEpoch(std::int64_t epoch) {
+    std::lock_guard<std::mutex> lock(m_writeMutex);
+
+    auto data = std::make_shared<GlotecData>();
+    if (!m_reader.fetchTecData(GlotecSnapshotStore::fromEpochSeconds(epoch), *data)) {
+        return false;
+    }
+
+    // The reader may fall back to the following product.
+    std::int64_t actual = GlotecSnapshotStore::toEpochSeconds(data->timestamp);
+    insert(actual, std::move(data));
+    publish();
+    return true;
+}
+
+std::size_t GlotecTimeSeries::fill(std::int64_t from, std::int64_t to) {
+    std::size_t loaded = 0;
+    for (std::int64_t epoch = floorToCadence(from); epoch <= to; epoch += CADENCE_S) {
+        if (fetchEpoch(epoch)) {
+            ++loaded;
+        }
+    }
+    return loaded;
+}
+
+// ========== Ring Buffer ==========
+
+void GlotecTimeSeries::insert(std::int64_t epoch, std::shared_ptr<const GlotecData> grid) {
+    auto slot = [this](std::size_t i) { return (m_head + i) % m_capacity; };
+
+    // Replace an epoch already held.
+    for (std::size_t i = 0; i < m_count; ++i) {
+        if (m_ringEpochs[slot(i)] == epoch) {
+            m_ring[slot(i)] = std::move(grid);
+            return;
+        }
+    }
+
+    if (m_count == m_capacity) {
+        if (epoch < m_ringEpochs[slot(0)]) {
+            return;     // Older than everything retained.
+        }
+        m_ring[slot(0)].reset();
+        m_head = slot(1);
+        --m_count;
+    }
+
+    // Append, then bubble back into chronological position (usually zero steps).
+    std::size_t position = m_count++;
+    m_ring[slot(position)] = std::move(grid);
+    m_ringEpochs[slot(position)] = epoch;
+
+    while (position > 0 && m_ringEpochs[slot(position - 1)] > epoch) {
+        std::swap(m_ring[slot(position - 1)], m_ring[slot(position)]);
+        std::swap(m_ringEpochs[slot(position - 1)], m_ringEpochs[slot(position)]);
+        --position;
+    }
+}
+
+// ========== Publication ==========
+
+void GlotecTimeSeries::publish() {
+    int current = m_current.load();
+
+    // Pick a slot nobody is reading. Readers that pinned the old current slot keep it.
+    int target = -1;
+    while (target < 0) {
+        for (int i = 1; i < NUM_SLOTS && target < 0; ++i) {
+            int candidate = (current + i) % NUM_SLOTS;
+            if (m_readers[candidate].load() == 0) {
+                target = candidate;
+            }
+        }
+        if (target < 0) {
+            std::this_thread::yield();
+        }
+    }
+
+    Window& window = m_slots[target];
+    window.grids.clear();
+    window.epochs.clear();
+    for (std::size_t i = 0; i < m_count; ++i) {
+        std::size_t s = (m_head + i) % m_capacity;
+        window.grids.push_back(m_ring[s]);
+        window.epochs.push_back(m_ringEpochs[s]);
+    }
+
+    m_current.store(target);
+}
+
+int GlotecTimeSeries::acquire() const {
+    while (true) {
+        int slot = m_current.load();
+        m_readers[slot].fetch_add(1);
+        // Still current after pinning: the writer will not touch it until release().
+        if (m_current.load() == slot) {
+            return slot;
+        }
+        m_readers[slot].fetch_sub(1);
+    }
+}
+
+void GlotecTimeSeries::release(int slot) const {
+    m_readers[slot].fetch_sub(1);
+}
+
+GlotecTimeSeries::Window GlotecTimeSeries::snapshot() const {
+    int slot = acquire();
+    Window copy = m_slots[slot];
+    release(slot);
+    return copy;
+}
+
+std::size_t GlotecTimeSeries::size() const {
+    int slot = acquire();
+    std::size_t count = m_slots[slot].epochs.size();
+    release(slot);
+    return count;
+}
+
+std::int64_t GlotecTimeSeries::getLatestEpoch() const {
+    int slot = acquire();
+    const Window& window = m_slots[slot];
+    std::int64_t latest = window.epochs.empty() ? 0 : window.epochs.back();
+    release(slot);
+    return latest;
+}
+
+// ========== Queries ==========
+
+double GlotecTimeSeries::sampleGrid(const GlotecData& data, double lat, double lon) {
+    const int numLon = data.numLon;
+    const int numLat = data.numLat;
+
+    double col = (lon - data.lonStart) / data.lonStep;
+    col -= std::floor(col / numLon) * numLon;
+    int c0 = std::min(static_cast<int>(col), numLon - 1);
+    int c1 = (c0 + 1) % numLon;
+    double dx = col - c0;
+
+    double row = std::max(0.0, std::min((lat - data.latStart) / data.latStep, numLat - 1.0));
+    int r0 = std::min(static_cast<int>(row), std::max(numLat - 2, 0));
+    int r1 = std::min(r0 + 1, numLat - 1);
+    double dy = row - r0;
+
+    const float* base = data.tecValues.data();
+    double q00 = base[r0 * numLon + c0];
+    double q10 = base[r0 * numLon + c1];
+    double q01 = base[r1 * numLon + c0];
+    double q11 = base[r1 * numLon + c1];
+
+    return (q00 * (1 - dx) + q10 * dx) * (1 - dy) + (q01 * (1 - dx) + q11 * dx) * dy;
+}
+
+bool GlotecTimeSeries::getTec(std::int64_t time, double lat, double lon, double& tec) const {
+    return getTecBatch(&time, &lat, &lon, 1, &tec);
+}
+
+bool GlotecTimeSeries::getTecBatch(
+    const std::int64_t* times, const double* lat, const double* lon,
+    std::size_t count, double* tec) const {
+
+    const double NaN = std::numeric_limits<double>::quiet_NaN();
+
+    int slot = acquire();
+    const Window& window = m_slots[slot];
+    const std::vector<std::int64_t>& epochs = window.epochs;
+    bool allServed = !epochs.empty();
+
+    for (std::size_t n = 0; n < count; ++n) {
+        if (epochs.empty()) {
+            tec[n] = NaN;
+            continue;
+        }
+
+        const std::int64_t t = times[n];
+        auto upper = std::upper_bound(epochs.begin(), epochs.end(), t);
+
+        if (upper == epochs.begin()) {
+            tec[n] = NaN;
+            allServed = false;
+            continue;
+        }
+
+        std::size_t i1 = static_cast<std::size_t>(upper - epochs.begin());
+        std::size_t i0 = i1 - 1;
+
+        if (i1 == epochs.size() || t == epochs[i0]) {
+            // At an epoch, or holding the newest grid until the next one is due.
+            if (t - epochs[i0] > CADENCE_S) {
+                tec[n] = NaN;
+                allServed = false;
+                continue;
+            }
+            tec[n] = sampleGrid(*window.grids[i0], lat[n], lon[n]);
+            continue;
+        }
+
+        std::int64_t gap = epochs[i1] - epochs[i0];
+        if (gap > MAX_GAP_S) {
+            tec[n] = NaN;
+            allServed = false;
+            continue;
+        }
+
+        double w = static_cast<double>(t - epochs[i0]) / static_cast<double>(gap);
+        double v0 = sampleGrid(*window.grids[i0], lat[n], lon[n]);
+        double v1 = sampleGrid(*window.grids[i1], lat[n], lon[n]);
+        tec[n] = v0 + w * (v1 - v0);
+    }
+
+    release(slot);
+    return allServed;
+}
+
+// ========== Background Prefetch ==========
+
+void GlotecTimeSeries::start() {
+    if (m_thread.joinable()) {
+        return;
+    }
+
+    {
+        std::lock_guard<std::mutex> lock(m_wakeMutex);
+        m_stopRequested = false;
+    }
+    m_thread = std::thread(&GlotecTimeSeries::prefetchLoop, this);
+}
+
+void GlotecTimeSeries::stop() {
+    if (!m_thread.joinable()) {
+        return;
+    }
+
+    {
+        std::lock_guard<std::mutex> lock(m_wakeMutex);
+        m_stopRequested = true;
+    }
+    m_wake.notify_all();
+    m_thread.join();
+}
+
+void GlotecTimeSeries::prefetchLoop() {
+    std::int64_t retryAt = 0;
+
+    while (true) {
+        const std::int64_t now = m_clock();
+        const std::int64_t newestDue = floorToCadence(now - m_publishDelay);
+        // Never chase products older than the window could hold.
+        const std::int64_t oldestUseful = newestDue - static_cast<std::int64_t>(m_capacity - 1) * CADENCE_S;
+
+        std::int64_t latest = getLatestEpoch();
+        std::int64_t target = (latest == 0) ? newestDue : std::max(latest + CADENCE_S, oldestUseful);
+
+        if (target <= newestDue && now >= retryAt) {
+            if (fetchEpoch(target)) {
+                retryAt = 0;
+                continue;       // Catch up without waiting.
+            }
+            retryAt = now + m_retryInterval;
+        }
+
+        std::unique_lock<std::mutex> lock(m_wakeMutex);
+        if (m_wake.wait_for(lock, std::chrono::milliseconds(m_pollInterval_ms),
+                            [this]() { return m_stopRequested; })) {
+            return;
+        }
+    }
+}
@@ -0,0 +1,110 @@
+#pragma once
+
+#include "NOAAGlotecReader.h"
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+// ========== GloTEC Time Series ==========
+// Rolling window of the last N GloTEC grids with time-interpolated TEC queries.
+// Grids live in a fixed-capacity ring owned by the writer (fill() or the prefetch
+// thread). After each change the writer publishes an immutable chronological view
+// into one of a few window slots and flips an atomic index. Readers pin the current
+// slot with an atomic counter and never take a lock or wait for I/O; the writer
+// only reuses a slot once no reader holds it.
+//
+// Times are UTC seconds since 1970 (see GlotecSnapshotStore::toEpochSeconds).
+
+class GlotecTimeSeries {
+public:
+    static constexpr std::int64_t CADENCE_S = 300;
+
+    struct Window {
+        std::vector<std::shared_ptr<const GlotecData>> grids;
+        std::vector<std::int64_t> epochs;
+    };
+
+    explicit GlotecTimeSeries(std::size_t capacity = 12);
+    ~GlotecTimeSeries();
+
+    GlotecTimeSeries(const GlotecTimeSeries&) = delete;
+    GlotecTimeSeries& operator=(const GlotecTimeSeries&) = delete;
+
+    // Configure (base URL, snapshot store, replay) before start().
+    NOAAGlotecReader& getReader() { return m_reader; }
+
+    // Time source for the prefetcher; defaults to the system clock. A simulated
+    // clock lets replays run faster than real time.
+    void setClock(std::function<std::int64_t()> clock);
+    // Seconds after an epoch before its product is expected to be available.
+    void setPublishDelay(std::int64_t seconds) { m_publishDelay = seconds; }
+    void setRetryInterval(std::int64_t seconds) { m_retryInterval = seconds; }
+    void setPollInterval(int milliseconds) { m_pollInterval_ms = milliseconds; }
+
+    // Synchronous loading. Safe while the prefetcher runs; writers are serialised.
+    bool fetchEpoch(std::int64_t epoch);
+    std::size_t fill(std::int64_t from, std::int64_t to);
+
+    // Background prefetch: fetches each new product as soon as it is due.
+    void start();
+    void stop();
+    bool isRunning() const { return m_thread.joinable(); }
+
+    // Copy of the current window; grids are shared, not copied.
+    Window snapshot() const;
+    std::size_t size() const;
+    std::int64_t getLatestEpoch() const;
+
+    // Bilinear in space, linear in time between the bracketing epochs. Times after
+    // the newest grid use it for up to one cadence. Points that cannot be served are
+    // set to NaN and make the call return false.
+    bool getTec(std::int64_t time, double lat, double lon, double& tec) const;
+    bool getTecBatch(
+        const std::int64_t* times,
+        const double* lat,
+        const double* lon,
+        std::size_t count,
+        double* tec) const;
+
+    // Bilinear lookup with longitude wrap-around; latitude is clamped to the grid.
+    static double sampleGrid(const GlotecData& data, double lat, double lon);
+
+private:
+    static constexpr int NUM_SLOTS = 4;
+
+    NOAAGlotecReader m_reader;
+    std::size_t m_capacity;
+
+    // Writer state, guarded by m_writeMutex.
+    std::mutex m_writeMutex;
+    std::vector<std::shared_ptr<const GlotecData>> m_ring;
+    std::vector<std::int64_t> m_ringEpochs;
+    std::size_t m_head;
+    std::size_t m_count;
+
+    // Published windows.
+    Window m_slots[NUM_SLOTS];
+    mutable std::atomic<int> m_readers[NUM_SLOTS];
+    std::atomic<int> m_current;
+
+    // Prefetcher
+    std::function<std::int64_t()> m_clock;
+    std::int64_t m_publishDelay;
+    std::int64_t m_retryInterval;
+    int m_pollInterval_ms;
+    std::thread m_thread;
+    std::mutex m_wakeMutex;
+    std::condition_variable m_wake;
+    bool m_stopRequested;
+
+    void insert(std::int64_t epoch, std::shared_ptr<const GlotecData> grid);
+    void publish();
+    int acquire() const;
+    void release(int slot) const;
+    void prefetchLoop();
+};
@@ -0,0 +1,143 @@
+#include "IGRFModel.h"
+#include <fstream>
+#include <sstream>
+#include <algorithm>
+#include <cstdlib>
+
+// ========== Constructor ==========
+
+IGRFModel::IGRFModel()
+    : m_svG{}, m_svH{}, m_modelName("IGRF"), m_loaded(false) {
+}
+
+// ========== Coefficient File Parsing ==========
+
+bool IGRFModel::parseEpochRow(const std::string& line) {
+    std::istringstream iss(line);
+    std::string token;
+
+    // "g/h n m 1900.0 1905.0 ... 2025.0 2025-30"
+    iss >> token >> token >> token;
+
+    m_epochs.clear();
+    while (iss >> token) {
+        if (token.find('-') != std::string::npos) {
+            break;
+        }
+        m_epochs.push_back(std::strtod(token.c_str(), nullptr));
+    }
+
+    return !m_epochs.empty();
+}
+
+bool IGRFModel::loadCoefficientFile(const std::string& filename) {
+    std::ifstream file(filename);
+    if (!file.is_open()) {
+        return false;
+    }
+
+    m_loaded = false;
+    m_epochs.clear();
+    m_coefficients.clear();
+    m_svG.fill(0.0);
+    m_svH.fill(0.0);
+    m_modelName = "IGRF";
+
+    std::string line;
+    bool haveEpochs = false;
+
+    while (std::getline(file, line)) {
+        if (line.empty()) continue;
+
+        if (line[0] == '#') {
+            size_t pos = line.find("th Generation");
+            if (pos != std::string::npos) {
+                size_t start = line.find_last_not_of("0123456789", pos - 1);
+                start = (start == std::string::npos) ? 0 : start + 1;
+                if (start < pos) {
+                    m_modelName = "IGRF-" + line.substr(start, pos - start);
+                }
+            }
+            continue;
+        }
+
+        if (line.compare(0, 3, "c/s") == 0) continue;
+
+        if (line.compare(0, 3, "g/h") == 0) {
+            haveEpochs = parseEpochRow(line);
+            m_coefficients.assign(m_epochs.size(), EpochCoefficients{ {}, {}, 0 });
+            continue;
+        }
+
+        if (!haveEpochs || (line[0] != 'g' && line[0] != 'h')) continue;
+
+        std::istringstream iss(line);
+        std::string kind;
+        int n, m;
+        if (!(iss >> kind >> n >> m)) continue;
+        if (n < 1 || n > GeomagneticConstants::MAX_DEGREE || m < 0 || m > n) continue;
+
+        int idx = PreparedMagneticField::getIndex(n, m);
+
+        for (size_t e = 0; e < m_epochs.size(); ++e) {
+            double value;
+            if (!(iss >> value)) {
+                return false;
+            }
+            EpochCoefficients& epoch = m_coefficients[e];
+            (kind == "g" ? epoch.g : epoch.h)[idx] = value;
+            if (value != 0.0) {
+                epoch.maxDegree = std::max(epoch.maxDegree, n);
+            }
+        }
+
+        double sv = 0.0;
+        iss >> sv;
+        (kind == "g" ? m_svG : m_svH)[idx] = sv;
+    }
+
+    m_loaded = haveEpochs && !m_coefficients.empty() && m_coefficients.back().maxDegree > 0;
+    return m_loaded;
+}
+
+// ========== Epoch Interpolation ==========
+
+PreparedMagneticField IGRFModel::prepare(double decimal_year) const {
+    if (!m_loaded) {
+        return PreparedMagneticField();
+    }
+
+    CoefficientArray g, h;
+
+    if (decimal_year >= m_epochs.back()) {
+        const EpochCoefficients& last = m_coefficients.back();
+        double dt = decimal_year - m_epochs.back();
+
+        for (int idx = 0; idx < GeomagneticConstants::NUM_COEFFICIENTS; ++idx) {
+            g[idx] = last.g[idx] + dt * m_svG[idx];
+            h[idx] = last.h[idx] + dt * m_svH[idx];
+        }
+
+        return PreparedMagneticField(last.maxDegree, g, h);
+    }
+
+    if (decimal_year <= m_epochs.front()) {
+        const EpochCoefficients& first = m_coefficients.front();
+        return PreparedMagneticField(first.maxDegree, first.g, first.h);
+    }
+
+    size_t upper = static_cast<size_t>(
+        std::upper_bound(m_epochs.begin(), m_epochs.end(), decimal_year) - m_epochs.begin());
+    size_t lower = upper - 1;
+
+    const EpochCoefficients& c0 = m_coefficients[lower];
+    const EpochCoefficients& c1 = m_coefficients[upper];
+    double ratio = (decimal_year - m_epochs[lower]) / (m_epochs[upper] - m_epochs[lower]);
+
+    for (int idx = 0; idx < GeomagneticConstants::NUM_COEFFICIENTS; ++idx) {
+        g[idx] = c0.g[idx] + ratio * (c1.g[idx] - c0.g[idx]);
+        h[idx] = c0.h[idx] + ratio * (c1.h[idx] - c0.h[idx]);
+    }
+
+    return PreparedMagneticField(std::max(c0.maxDegree, c1.maxDegree), g, h);
+}
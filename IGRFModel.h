@@ -0,0 +1,44 @@
+#pragma once
+
+#include "GeomagneticField.h"
+#include <string>
+#include <vector>
+
+// ========== IGRF Model ==========
+// Reads the multi-epoch IGRF coefficient table (igrfNNcoeffs.txt). Coefficients
+// are interpolated linearly between 5-year epochs and extrapolated with the
+// secular variation column after the last epoch.
+
+class IGRFModel : public GeomagneticModel {
+public:
+    IGRFModel();
+
+    // Returns false if the file cannot be opened (the model is unchanged) or
+    // holds no usable epoch table (the model is left unloaded).
+    bool loadCoefficientFile(const std::string& filename);
+
+    PreparedMagneticField prepare(double decimal_year) const override;
+    bool isLoaded() const override { return m_loaded; }
+    const std::string& getModelName() const override { return m_modelName; }
+
+    double getFirstEpoch() const { return m_epochs.empty() ? 0.0 : m_epochs.front(); }
+    double getLastEpoch() const { return m_epochs.empty() ? 0.0 : m_epochs.back(); }
+
+private:
+    using CoefficientArray = PreparedMagneticField::CoefficientArray;
+
+    struct EpochCoefficients {
+        CoefficientArray g;
+        CoefficientArray h;
+        int maxDegree;
+    };
+
+    std::vector<double> m_epochs;
+    std::vector<EpochCoefficients> m_coefficients;
+    CoefficientArray m_svG;
+    CoefficientArray m_svH;
+    std::string m_modelName;
+    bool m_loaded;
+
+    bool parseEpochRow(const std::string& line);
+};
@@ -3,6 +3,7 @@
 #include <cmath>
 #include <algorithm>
 #include <iomanip>
+#include <limits>
 
 // ========== Constructors ==========
 
@@ -21,6 +22,7 @@ bool IonexReader::open(const std::string& filename) {
     m_filename = filename;
     m_isOpen = false;
     m_mapPositions.clear();
+    m_mapCache.clear();
 
     std::ifstream file(filename);
     if (!file.is_open()) {
@@ -248,50 +250,92 @@ bool IonexReader::getTecValue(const std::tm& time, double lat, double lon, doubl
 // ========== Interpolated TEC Value ==========
 
 bool IonexReader::getTecValueInterpolated(const std::tm& time, double lat, double lon, double& vtec) {
+    return getTecValuesInterpolated(&time, &lat, &lon, 1, &vtec);
+}
+
+bool IonexReader::getTecValuesInterpolated(const std::tm* times, const double* lat,
+                                           const double* lon, std::size_t count, double* vtec) {
     if (!m_isOpen) {
         return false;
     }
 
-    std::time_t targetTime = tmToTime(time);
-    std::time_t t1, t2;
+    const double NaN = std::numeric_limits<double>::quiet_NaN();
+    bool allServed = true;
 
-    if (!findClosestMaps(time, t1, t2)) {
-        return false;
-    }
+    for (std::size_t i = 0; i < count; ++i) {
+        std::time_t targetTime = tmToTime(times[i]);
+        std::time_t t1, t2;
 
-    std::ifstream file(m_filename);
-    if (!file.is_open()) {
-        return false;
-    }
+        if (!findClosestMaps(times[i], t1, t2)) {
+            vtec[i] = NaN;
+            allServed = false;
+            continue;
+        }
 
-    TecMap map1, map2;
-    if (!loadTecMap(file, m_mapPositions[t1], map1)) {
-        return false;
+        const TecMap* map1 = getCachedMap(t1);
+        const TecMap* map2 = (t1 == t2) ? map1 : getCachedMap(t2);
+        if (!map1 || !map2) {
+            vtec[i] = NaN;
+            allServed = false;
+            continue;
+        }
+
+        double vtec1 = bilinearInterpolate(map1->data, lat[i], lon[i]);
+        double vtec2 = (t1 == t2) ? vtec1 : bilinearInterpolate(map2->data, lat[i], lon[i]);
+        if (vtec1 == 9999.0 || vtec2 == 9999.0) {
+            vtec[i] = NaN;
+            allServed = false;
+            continue;
+        }
+
+        if (t1 == t2) {
+            vtec[i] = vtec1;
+            continue;
+        }
+
+        double ratio = static_cast<double>(targetTime - t1) / static_cast<double>(t2 - t1);
+        vtec[i] = vtec1 + ratio * (vtec2 - vtec1);
     }
 
-    double vtec1 = bilinearInterpolate(map1.data, lat, lon);
-    if (vtec1 == 9999.0) {
-        return false;
+    return allServed;
+}
+
+const TecMap* IonexReader::getCachedMap(std::time_t mapTime) {
+    auto cached = m_mapCache.find(mapTime);
+    if (cached != m_mapCache.end()) {
+        return &cached->second;
     }
 
-    if (t1 == t2) {
-        vtec = vtec1;
-        return true;
+    auto position = m_mapPositions.find(mapTime);
+    if (position == m_mapPositions.end()) {
+        return nullptr;
     }
 
-    if (!loadTecMap(file, m_mapPositions[t2], map2)) {
-        return false;
+    std::ifstream file(m_filename);
+    if (!file.is_open()) {
+        return nullptr;
     }
 
-    double vtec2 = bilinearInterpolate(map2.data, lat, lon);
-    if (vtec2 == 9999.0) {
-        return false;
+    TecMap tecMap;
+    if (!loadTecMap(file, position->second, tecMap)) {
+        return nullptr;
     }
 
-    double ratio = static_cast<double>(targetTime - t1) / static_cast<double>(t2 - t1);
-    vtec = vtec1 + ratio * (vtec2 - vtec1);
+    // A sweep only needs the maps bracketing it, but planners revisit the same
+    // day once per station, so keep two days of hourly maps (about 2 MB).
+    // Evicting the farthest entry never drops the neighbour of mapTime that the
+    // caller may still hold.
+    const size_t MAX_CACHED_MAPS = 48;
+    if (m_mapCache.size() >= MAX_CACHED_MAPS) {
+        auto farthest = std::max_element(m_mapCache.begin(), m_mapCache.end(),
+            [mapTime](const auto& a, const auto& b) {
+                return std::abs(static_cast<double>(a.first - mapTime)) <
+                       std::abs(static_cast<double>(b.first - mapTime));
+            });
+        m_mapCache.erase(farthest);
+    }
 
-    return true;
+    return &m_mapCache.emplace(mapTime, std::move(tecMap)).first->second;
 }
 
 // ========== Helper Functions ==========
@@ -4,6 +4,7 @@
 #include <vector>
 #include <map>
 #include <fstream>
+#include <cstddef>
 #include <ctime>
 
 // ========== IONEX Data Structures ==========
@@ -49,16 +50,23 @@ public:
 
     bool getTecValueInterpolated(const std::tm& time, double lat, double lon, double& vtec);
 
+    // One entry per point; each map is parsed once per batch and kept in a small cache.
+    // Points that cannot be served are set to NaN and make the call return false.
+    bool getTecValuesInterpolated(const std::tm* times, const double* lat, const double* lon,
+                                  std::size_t count, double* vtec);
+
 private:
     std::string m_filename;
     bool m_isOpen;
     IonexHeader m_header;
 
     std::map<std::time_t, long> m_mapPositions;
+    std::map<std::time_t, TecMap> m_mapCache;
 
     bool parseHeader(std::ifstream& file);
     bool buildMapIndex(std::ifstream& file);
     bool loadTecMap(std::ifstream& file, long position, TecMap& tecMap);
+    const TecMap* getCachedMap(std::time_t mapTime);
 
     std::time_t tmToTime(const std::tm& tm) const;
     bool findClosestMaps(const std::tm& time, std::time_t& t1, std::time_t& t2);
@@ -0,0 +1,67 @@
+#include "IonexTecSource.h"
+#include "GlotecSnapshotStore.h"
+#include <cmath>
+#include <limits>
+
+// ========== Constructor ==========
+
+IonexTecSource::IonexTecSource(std::shared_ptr<IonexReader> reader)
+    : m_reader(std::move(reader)), m_first(0), m_last(0), m_tolerance(0) {
+
+    if (m_reader && m_reader->isOpen()) {
+        const IonexHeader& header = m_reader->getHeader();
+        m_first = GlotecSnapshotStore::toEpochSeconds(header.epochFirst);
+        m_last = GlotecSnapshotStore::toEpochSeconds(header.epochLast);
+    }
+    setEdgeTolerance(-1);
+}
+
+void IonexTecSource::setEdgeTolerance(std::int64_t seconds) {
+    if (seconds >= 0) {
+        m_tolerance = seconds;
+    } else {
+        m_tolerance = (m_reader && m_reader->getHeader().interval > 0)
+            ? m_reader->getHeader().interval : 0;
+    }
+}
+
+// ========== Queries ==========
+
+bool IonexTecSource::getTecBatch(const std::int64_t* times, const double* lat, const double* lon,
+                                 std::size_t count, double* tec) {
+    const double NaN = std::numeric_limits<double>::quiet_NaN();
+
+    if (!m_reader || !m_reader->isOpen()) {
+        for (std::size_t i = 0; i < count; ++i) {
+            tec[i] = NaN;
+        }
+        return false;
+    }
+
+    // Hand the reader only the points inside its span.
+    m_index.clear();
+    m_times.clear();
+    m_lat.clear();
+    m_lon.clear();
+    for (std::size_t i = 0; i < count; ++i) {
+        if (times[i] < m_first - m_tolerance || times[i] > m_last + m_tolerance) {
+            tec[i] = NaN;
+            continue;
+        }
+        m_index.push_back(i);
+        m_times.push_back(GlotecSnapshotStore::fromEpochSeconds(times[i]));
+        m_lat.push_back(lat[i]);
+        m_lon.push_back(lon[i]);
+    }
+
+    m_values.resize(m_index.size());
+    m_reader->getTecValuesInterpolated(m_times.data(), m_lat.data(), m_lon.data(),
+                                       m_index.size(), m_values.data());
+
+    bool allServed = (m_index.size() == count);
+    for (std::size_t k = 0; k < m_index.size(); ++k) {
+        tec[m_index[k]] = m_values[k];
+        allServed = allServed && !std::isnan(m_values[k]);
+    }
+    return allServed;
+}
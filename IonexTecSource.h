@@ -0,0 +1,38 @@
+#pragma once
+
+#include "IonexReader.h"
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+// ========== IONEX TEC Source ==========
+// TecSource adapter over an IonexReader. Serves the span between the first and
+// last map of the file, extended by one map interval on either side; the reader
+// itself would hold the edge maps indefinitely. The reader is shared, so copies of
+// the adapter see the same map cache.
+
+class IonexTecSource {
+public:
+    explicit IonexTecSource(std::shared_ptr<IonexReader> reader);
+
+    bool getTecBatch(const std::int64_t* times, const double* lat, const double* lon,
+                     std::size_t count, double* tec);
+    const char* getName() const { return "IONEX"; }
+
+    // Seconds beyond the first/last map still served; negative restores the default.
+    void setEdgeTolerance(std::int64_t seconds);
+
+    std::int64_t getFirstEpoch() const { return m_first; }
+    std::int64_t getLastEpoch() const { return m_last; }
+
+private:
+    std::shared_ptr<IonexReader> m_reader;
+    std::int64_t m_first;
+    std::int64_t m_last;
+    std::int64_t m_tolerance;
+
+    std::vector<std::tm> m_times;
+    std::vector<std::size_t> m_index;
+    std::vector<double> m_lat, m_lon, m_values;
+};
@@ -1,6 +1,9 @@
 #define _USE_MATH_DEFINES
 #include "IonosphereDataProvider.h"
+#include "IonospherePhysics.h"
+#include "GlotecSnapshotStore.h"
 #include <cmath>
+#include <algorithm>
 
 #ifndef M_PI
 #define M_PI 3.14159265358979323846
@@ -9,22 +12,105 @@
 // ========== Constructor ==========
 
 IonosphereDataProvider::IonosphereDataProvider()
-    : m_reader(nullptr), m_wmm(nullptr),
-      m_ionexLoaded(false), m_wmmLoaded(false) {
+    : m_reader(nullptr), m_wmm(std::make_shared<WMMModel>()),
+      m_igrf(nullptr), m_dipole(std::make_unique<DipoleFieldModel>(m_wmm)),
+      m_customField(nullptr),
+      m_fieldModel(SystemConfiguration::MagneticFieldModel::WMM),
+      m_ionexLoaded(false), m_wmmLoaded(m_wmm->isLoaded()) {
 }
 
 // ========== File Loading ==========
 
 bool IonosphereDataProvider::loadIonexFile(const std::string& filename) {
-    m_reader = std::make_unique<IonexReader>(filename);
+    m_reader = std::make_shared<IonexReader>(filename);
     m_ionexLoaded = m_reader->isOpen();
     return m_ionexLoaded;
 }
 
 bool IonosphereDataProvider::loadWMMFile(const std::string& filename) {
-    m_wmm = std::make_unique<WMMModel>();
-    m_wmmLoaded = m_wmm->loadCoefficientFile(filename);
-    return m_wmmLoaded;
+    auto wmm = std::make_shared<WMMModel>();
+    if (!wmm->loadCoefficientFile(filename)) {
+        return false;
+    }
+
+    m_wmm = std::move(wmm);
+    m_dipole = std::make_unique<DipoleFieldModel>(m_wmm);
+    m_wmmLoaded = true;
+    return true;
+}
+
+bool IonosphereDataProvider::loadIGRFFile(const std::string& filename) {
+    auto igrf = std::make_unique<IGRFModel>();
+    if (!igrf->loadCoefficientFile(filename)) {
+        return false;
+    }
+
+    m_igrf = std::move(igrf);
+    return true;
+}
+
+// ========== TEC Sources ==========
+
+void IonosphereDataProvider::addTecSource(TecSourceVariant source, std::int64_t from, std::int64_t to,
+                                          std::int64_t blend_s) {
+    m_tecSources.addLayer(std::move(source), from, to, blend_s);
+}
+
+bool IonosphereDataProvider::sampleTec(const std::tm* times, const double* lat, const double* lon,
+                                       std::size_t count, double* tec) {
+    if (m_tecSources.empty()) {
+        return m_ionexLoaded && m_reader &&
+               m_reader->getTecValuesInterpolated(times, lat, lon, count, tec);
+    }
+
+    m_ippEpochs.resize(count);
+    for (size_t i = 0; i < count; ++i) {
+        m_ippEpochs[i] = GlotecSnapshotStore::toEpochSeconds(times[i]);
+    }
+    return m_tecSources.getTecBatch(m_ippEpochs.data(), lat, lon, count, tec);
+}
+
+std::string IonosphereDataProvider::getTecSourceName() const {
+    return m_tecSources.empty() ? std::string("IONEX") : m_tecSources.getName();
+}
+
+// ========== Magnetic Field Model Selection ==========
+
+void IonosphereDataProvider::setMagneticFieldModel(SystemConfiguration::MagneticFieldModel model) {
+    m_fieldModel = model;
+}
+
+void IonosphereDataProvider::setCustomFieldModel(std::shared_ptr<const GeomagneticModel> model) {
+    m_customField = std::move(model);
+}
+
+const GeomagneticModel* IonosphereDataProvider::getActiveFieldModel() const {
+    const GeomagneticModel* model = nullptr;
+
+    switch (m_fieldModel) {
+        case SystemConfiguration::MagneticFieldModel::DIPOLE:
+            model = m_dipole.get();
+            break;
+        case SystemConfiguration::MagneticFieldModel::IGRF:
+            model = m_igrf.get();
+            break;
+        case SystemConfiguration::MagneticFieldModel::WMM:
+            model = m_wmm.get();
+            break;
+        case SystemConfiguration::MagneticFieldModel::CUSTOM:
+            model = m_customField.get();
+            break;
+    }
+
+    return (model && model->isLoaded()) ? model : nullptr;
+}
+
+PreparedMagneticField IonosphereDataProvider::prepareMagneticField(const std::tm& time) const {
+    const GeomagneticModel* model = getActiveFieldModel();
+    if (!model) {
+        return PreparedMagneticField();
+    }
+    return model->prepare(tmToDecimalYear(time));
 }
 
 // ========== Time Conversion ==========
@@ -59,34 +145,40 @@ bool IonosphereDataProvider::getIonosphereData(
     double lat_home, double lon_home, double height_home_km,
     IonosphereData& ionoData) {
 
-    if (!m_ionexLoaded || !m_reader) {
+    if (!hasTecData()) {
         return false;
     }
 
-    double vtec_dx, vtec_home;
+    const std::tm times[2] = { time, time };
+    const double tecLats[2] = { lat_dx, lat_home };
+    const double tecLons[2] = { lon_dx, lon_home };
+    double vtec[2];
 
-    bool success_dx = m_reader->getTecValueInterpolated(time, lat_dx, lon_dx, vtec_dx);
-    bool success_home = m_reader->getTecValueInterpolated(time, lat_home, lon_home, vtec_home);
-
-    if (!success_dx || !success_home) {
+    if (!sampleTec(times, tecLats, tecLons, 2, vtec)) {
         return false;
     }
 
-    ionoData.vTEC_DX = vtec_dx;
-    ionoData.vTEC_Home = vtec_home;
+    ionoData.vTEC_DX = vtec[0];
+    ionoData.vTEC_Home = vtec[1];
+
+    const GeomagneticModel* fieldModel = getActiveFieldModel();
 
-    if (m_wmmLoaded && m_wmm) {
-        double decimal_year = tmToDecimalYear(time);
+    if (fieldModel) {
+        PreparedMagneticField field = fieldModel->prepare(tmToDecimalYear(time));
 
-        MagneticFieldResult mag_dx = m_wmm->calculate(lat_dx, lon_dx, height_dx_km, decimal_year);
-        MagneticFieldResult mag_home = m_wmm->calculate(lat_home, lon_home, height_home_km, decimal_year);
+        const double lats[2] = { lat_dx, lat_home };
+        const double lons[2] = { lon_dx, lon_home };
+        const double heights[2] = { height_dx_km, height_home_km };
+        MagneticFieldResult mag[2];
+        field.evaluateBatch(lats, lons, heights, 2, mag);
 
-        ionoData.B_magnitude_DX = mag_dx.F * 1e-9;
-        ionoData.B_magnitude_Home = mag_home.F * 1e-9;
-        ionoData.B_inclination_DX = mag_dx.inclination * M_PI / 180.0;
-        ionoData.B_inclination_Home = mag_home.inclination * M_PI / 180.0;
-        ionoData.B_declination_DX = mag_dx.declination * M_PI / 180.0;
-        ionoData.B_declination_Home = mag_home.declination * M_PI / 180.0;
+        ionoData.B_magnitude_DX = mag[0].F * 1e-9;
+        ionoData.B_magnitude_Home = mag[1].F * 1e-9;
+        ionoData.B_inclination_DX = mag[0].inclination * M_PI / 180.0;
+        ionoData.B_inclination_Home = mag[1].inclination * M_PI / 180.0;
+        ionoData.B_declination_DX = mag[0].declination * M_PI / 180.0;
+        ionoData.B_declination_Home = mag[1].declination * M_PI / 180.0;
+        ionoData.dataSource = getTecSourceName() + " + " + fieldModel->getModelName();
     } else {
         ionoData.B_magnitude_DX = 5.0e-5;
         ionoData.B_magnitude_Home = 5.0e-5;
@@ -94,10 +186,116 @@ bool IonosphereDataProvider::getIonosphereData(
         ionoData.B_inclination_Home = 1.047;
         ionoData.B_declination_DX = 0.0;
         ionoData.B_declination_Home = 0.0;
+        ionoData.dataSource = getTecSourceName() + " + Default Magnetic";
     }
 
-    ionoData.dataSource = m_wmmLoaded ? "IONEX + WMM" : "IONEX + Default Magnetic";
     ionoData.timestamp = std::mktime(const_cast<std::tm*>(&time));
 
     return true;
 }
+
+// ========== Piercing Point Sampling ==========
+
+double IonosphereDataProvider::getShellHeight() const {
+    if (m_reader && m_reader->isOpen() && m_reader->getHeader().hgt1 > 0.0) {
+        return m_reader->getHeader().hgt1;
+    }
+    return SystemConstants::IONOSPHERE_HEIGHT_KM;
+}
+
+bool IonosphereDataProvider::getIonosphereDataAtIPP(
+    const std::tm& time,
+    double lat_dx, double lon_dx, double elevation_dx, double azimuth_dx,
+    double lat_home, double lon_home, double elevation_home, double azimuth_home,
+    IonosphereData& ionoData) {
+
+    return getIonosphereDataAtIPPBatch(
+        &time,
+        lat_dx, lon_dx, &elevation_dx, &azimuth_dx,
+        lat_home, lon_home, &elevation_home, &azimuth_home,
+        1, &ionoData);
+}
+
+bool IonosphereDataProvider::getIonosphereDataAtIPPBatch(
+    const std::tm* times,
+    double lat_dx, double lon_dx, const double* elevation_dx, const double* azimuth_dx,
+    double lat_home, double lon_home, const double* elevation_home, const double* azimuth_home,
+    std::size_t count,
+    IonosphereData* results) {
+
+    if (!hasTecData() || count == 0) {
+        return false;
+    }
+
+    const double shellHeight = getShellHeight();
+    const double DEG = M_PI / 180.0;
+    const size_t total = 2 * count;
+
+    m_ippLat.resize(total);
+    m_ippLon.resize(total);
+    m_ippHeight.assign(total, shellHeight);
+    m_ippMapping.resize(total);
+    m_ippTec.resize(total);
+    m_ippTimes.resize(total);
+    m_ippField.resize(total);
+
+    // DX piercing points occupy [0, count), Home points [count, 2 * count).
+    IonospherePhysics::calculateIPPBatch(
+        lat_dx * DEG, lon_dx * DEG, elevation_dx, azimuth_dx, count, shellHeight,
+        m_ippLat.data(), m_ippLon.data(), m_ippMapping.data());
+    IonospherePhysics::calculateIPPBatch(
+        lat_home * DEG, lon_home * DEG, elevation_home, azimuth_home, count, shellHeight,
+        m_ippLat.data() + count, m_ippLon.data() + count, m_ippMapping.data() + count);
+
+    for (size_t i = 0; i < total; ++i) {
+        m_ippLat[i] /= DEG;
+        m_ippLon[i] /= DEG;
+    }
+    std::copy(times, times + count, m_ippTimes.begin());
+    std::copy(times, times + count, m_ippTimes.begin() + count);
+
+    if (!sampleTec(m_ippTimes.data(), m_ippLat.data(), m_ippLon.data(), total, m_ippTec.data())) {
+        return false;
+    }
+
+    // Secular variation over a sweep is negligible, so one prepared epoch serves all entries.
+    const GeomagneticModel* fieldModel = getActiveFieldModel();
+    if (fieldModel) {
+        PreparedMagneticField field = fieldModel->prepare(tmToDecimalYear(times[0]));
+        field.evaluateBatch(m_ippLat.data(), m_ippLon.data(), m_ippHeight.data(),
+                            total, m_ippField.data());
+    }
+
+    const std::string tecName = getTecSourceName() + " IPP";
+    for (size_t i = 0; i < count; ++i) {
+        IonosphereData& ionoData = results[i];
+        const size_t dx = i;
+        const size_t home = count + i;
+
+        ionoData.vTEC_DX = m_ippTec[dx];
+        ionoData.vTEC_Home = m_ippTec[home];
+
+        if (fieldModel) {
+            ionoData.B_magnitude_DX = m_ippField[dx].F * 1e-9;
+            ionoData.B_magnitude_Home = m_ippField[home].F * 1e-9;
+            ionoData.B_inclination_DX = m_ippField[dx].inclination * DEG;
+            ionoData.B_inclination_Home = m_ippField[home].inclination * DEG;
+            ionoData.B_declination_DX = m_ippField[dx].declination * DEG;
+            ionoData.B_declination_Home = m_ippField[home].declination * DEG;
+            ionoData.dataSource = tecName + " + " + fieldModel->getModelName();
+        } else {
+            ionoData.B_magnitude_DX = 5.0e-5;
+            ionoData.B_magnitude_Home = 5.0e-5;
+            ionoData.B_inclination_DX = 1.047;
+            ionoData.B_inclination_Home = 1.047;
+            ionoData.B_declination_DX = 0.0;
+            ionoData.B_declination_Home = 0.0;
+            ionoData.dataSource = tecName + " + Default Magnetic";
+        }
+
+        std::tm stamp = times[i];
+        ionoData.timestamp = std::mktime(&stamp);
+    }
+
+    return true;
+}
@@ -1,10 +1,15 @@
 #pragma once
 
 #include "IonexReader.h"
+#include "TecSource.h"
 #include "WMMModel.h"
+#include "IGRFModel.h"
+#include "DipoleFieldModel.h"
 #include "Parameters.h"
 #include <string>
 #include <memory>
+#include <vector>
+#include <cstddef>
 
 // ========== Ionosphere Data Provider ==========
 
@@ -14,6 +19,26 @@ public:
 
     bool loadIonexFile(const std::string& filename);
     bool loadWMMFile(const std::string& filename);
+    bool loadIGRFFile(const std::string& filename);
+
+    // ========== TEC Sources ==========
+    // Without layers TEC comes from the loaded IONEX file. Layers are consulted in
+    // the order added over their UTC windows (see TecSourceBlend), e.g. GloTEC over
+    // the last hour, then the IONEX forecast, then climatology.
+    void addTecSource(TecSourceVariant source,
+                      std::int64_t from = TecSourceBlend::ALWAYS_FROM,
+                      std::int64_t to = TecSourceBlend::ALWAYS_TO,
+                      std::int64_t blend_s = 0);
+    void clearTecSources() { m_tecSources.clear(); }
+    const TecSourceBlend& getTecSources() const { return m_tecSources; }
+    std::shared_ptr<IonexReader> getIonexReader() const { return m_reader; }
+    bool hasTecData() const { return !m_tecSources.empty() || m_ionexLoaded; }
+
+    void setMagneticFieldModel(SystemConfiguration::MagneticFieldModel model);
+    void setCustomFieldModel(std::shared_ptr<const GeomagneticModel> model);
+    SystemConfiguration::MagneticFieldModel getMagneticFieldModel() const { return m_fieldModel; }
+    const GeomagneticModel* getActiveFieldModel() const;
+    PreparedMagneticField prepareMagneticField(const std::tm& time) const;
 
     bool getIonosphereData(
         const std::tm& time,
@@ -21,14 +46,48 @@ public:
         double lat_home, double lon_home, double height_home_km,
         IonosphereData& ionoData);
 
+    // ========== Piercing Point Sampling ==========
+    // Station positions in degrees, moon elevation/azimuth in radians. TEC and B are
+    // taken where each ray crosses the IONEX shell rather than above the station.
+    bool getIonosphereDataAtIPP(
+        const std::tm& time,
+        double lat_dx, double lon_dx, double elevation_dx, double azimuth_dx,
+        double lat_home, double lon_home, double elevation_home, double azimuth_home,
+        IonosphereData& ionoData);
+
+    // Sweep form: one time step and one elevation/azimuth pair per entry.
+    bool getIonosphereDataAtIPPBatch(
+        const std::tm* times,
+        double lat_dx, double lon_dx, const double* elevation_dx, const double* azimuth_dx,
+        double lat_home, double lon_home, const double* elevation_home, const double* azimuth_home,
+        std::size_t count,
+        IonosphereData* results);
+
+    double getShellHeight() const;
+
     bool isIonexLoaded() const { return m_ionexLoaded; }
     bool isWMMLoaded() const { return m_wmmLoaded; }
+    bool isIGRFLoaded() const { return m_igrf && m_igrf->isLoaded(); }
+    const std::string& getWMMModelName() const { return m_wmm->getModelName(); }
 
 private:
-    std::unique_ptr<IonexReader> m_reader;
-    std::unique_ptr<WMMModel> m_wmm;
+    std::shared_ptr<IonexReader> m_reader;
+    TecSourceBlend m_tecSources;
+    std::shared_ptr<WMMModel> m_wmm;
+    std::unique_ptr<IGRFModel> m_igrf;
+    std::unique_ptr<DipoleFieldModel> m_dipole;
+    std::shared_ptr<const GeomagneticModel> m_customField;
+    SystemConfiguration::MagneticFieldModel m_fieldModel;
     bool m_ionexLoaded;
     bool m_wmmLoaded;
 
+    std::vector<double> m_ippLat, m_ippLon, m_ippHeight, m_ippMapping, m_ippTec;
+    std::vector<std::tm> m_ippTimes;
+    std::vector<std::int64_t> m_ippEpochs;
+    std::vector<MagneticFieldResult> m_ippField;
+
     double tmToDecimalYear(const std::tm& time) const;
+    bool sampleTec(const std::tm* times, const double* lat, const double* lon,
+                   std::size_t count, double* tec);
+    std::string getTecSourceName() const;
 };
@@ -14,55 +14,54 @@ IonosphericPiercingPoint IonospherePhysics::calculateIPP(
 
     IonosphericPiercingPoint ipp;
     ipp.height = hmF2;
+    ipp.slantTEC = 0.0;
 
-    const double R_e = 6371.0;
-
-    double sinChi = (R_e * std::cos(elevation)) / (R_e + hmF2);
-    sinChi = std::max(-1.0, std::min(1.0, sinChi));
-    double chi = std::asin(sinChi);
+    calculateIPPBatch(stationLat, stationLon, &elevation, &azimuth, 1, hmF2,
+                      &ipp.latitude, &ipp.longitude, &ipp.mappingFactor);
 
-    ipp.mappingFactor = 1.0 / std::cos(chi);
+    return ipp;
+}
 
-    double psi = (M_PI / 2.0) - elevation - chi;
+void IonospherePhysics::calculateIPPBatch(
+    double stationLat, double stationLon,
+    const double* elevation, const double* azimuth,
+    std::size_t count, double hmF2,
+    double* ippLat, double* ippLon, double* mappingFactor) {
 
-    double sinLat = std::sin(stationLat);
-    double cosLat = std::cos(stationLat);
-    double sinPsi = std::sin(psi);
-    double cosPsi = std::cos(psi);
-    double cosAz = std::cos(azimuth);
+    const double R_e = 6371.0;
+    const double shellRatio = R_e / (R_e + hmF2);
 
-    double sinLatIPP = sinLat * cosPsi + cosLat * sinPsi * cosAz;
-    sinLatIPP = std::max(-1.0, std::min(1.0, sinLatIPP));
-    ipp.latitude = std::asin(sinLatIPP);
+    const double sinLat = std::sin(stationLat);
+    const double cosLat = std::cos(stationLat);
 
-    double cosLatIPP = std::cos(ipp.latitude);
+    for (std::size_t i = 0; i < count; ++i) {
+        double sinE = std::sin(elevation[i]);
+        double cosE = std::cos(elevation[i]);
+        double sinAz = std::sin(azimuth[i]);
+        double cosAz = std::cos(azimuth[i]);
 
-    double numerator = sinPsi * std::sin(azimuth);
-    double denominator = cosLat * cosPsi - sinLat * sinPsi * cosAz;
+        // Zenith angle chi at the shell; psi = pi/2 - E - chi is the Earth-central angle.
+        double sinChi = std::min(1.0, shellRatio * std::abs(cosE));
+        double cosChi = std::sqrt(1.0 - sinChi * sinChi);
+        double sinPsi = cosE * cosChi - sinE * sinChi;
+        double cosPsi = sinE * cosChi + cosE * sinChi;
 
-    double deltaLon = std::atan2(numerator, denominator);
-    ipp.longitude = stationLon + deltaLon;
+        double sinLatIPP = sinLat * cosPsi + cosLat * sinPsi * cosAz;
+        sinLatIPP = std::max(-1.0, std::min(1.0, sinLatIPP));
 
-    while (ipp.longitude > M_PI) ipp.longitude -= 2.0 * M_PI;
-    while (ipp.longitude < -M_PI) ipp.longitude += 2.0 * M_PI;
+        double deltaLon = std::atan2(sinPsi * sinAz, cosLat * cosPsi - sinLat * sinPsi * cosAz);
+        double lon = stationLon + deltaLon;
 
-    return ipp;
+        ippLat[i] = std::asin(sinLatIPP);
+        ippLon[i] = lon - 2.0 * M_PI * std::floor((lon + M_PI) / (2.0 * M_PI));
+        mappingFactor[i] = 1.0 / std::max(cosChi, 1e-12);
+    }
 }
 
 double IonospherePhysics::calculateMappingFunction(
     double elevation, double hmF2, double earthRadius) {
 
-    if (elevation < 0) {
-        return 1.0;
-    }
-
-    double sinChi = (earthRadius * std::cos(elevation)) / (earthRadius + hmF2);
-    sinChi = std::max(-1.0, std::min(1.0, sinChi));
-
-    double chi = std::asin(sinChi);
-    double mappingFactor = 1.0 / std::cos(chi);
-
-    return mappingFactor;
+    return mappingFunction(elevation, hmF2, earthRadius);
 }
 
 double IonospherePhysics::calculateSlantTEC(
@@ -76,19 +75,7 @@ double IonospherePhysics::calculateMagneticFieldProjection(
     double B_magnitude, double B_inclination, double B_declination,
     double elevation, double azimuth) {
 
-    double prop_x = std::cos(elevation) * std::cos(azimuth);
-    double prop_y = std::cos(elevation) * std::sin(azimuth);
-    double prop_z = std::sin(elevation);
-
-    double B_x = std::cos(B_inclination) * std::cos(B_declination);
-    double B_y = std::cos(B_inclination) * std::sin(B_declination);
-    double B_z = -std::sin(B_inclination);
-
-    double dotProduct = prop_x * B_x + prop_y * B_y + prop_z * B_z;
-
-    double B_proj = B_magnitude * dotProduct;
-
-    return B_proj;
+    return magneticFieldProjection(B_magnitude, B_inclination, B_declination, elevation, azimuth);
 }
 
 double IonospherePhysics::calculateFaradayRotationPrecise(
@@ -97,20 +84,6 @@ double IonospherePhysics::calculateFaradayRotationPrecise(
     double elevation, double azimuth,
     double frequency_MHz) {
 
-    double sTEC = calculateSlantTEC(vTEC, elevation, hmF2);
-
-    double B_proj = calculateMagneticFieldProjection(
-        B_magnitude, B_inclination, B_declination,
-        elevation, azimuth);
-
-    double f_MHz = frequency_MHz;
-    double f_squared_MHz = f_MHz * f_MHz;
-
-    double B_proj_nanoTesla = B_proj * 1e9;
-
-    double sTEC_TECU = sTEC;
-
-    double omega_rad = (0.23647 / f_squared_MHz) * sTEC_TECU * B_proj_nanoTesla;
-
-    return omega_rad;
+    return faradayRotation(vTEC, hmF2, B_magnitude, B_inclination, B_declination,
+                           elevation, azimuth, frequency_MHz);
 }
@@ -1,6 +1,7 @@
 #pragma once
 
 #include <cmath>
+#include <cstddef>
 
 struct IonosphericPiercingPoint {
     double latitude;
@@ -17,6 +18,14 @@ public:
         double elevation, double azimuth,
         double hmF2);
 
+    // Structure-of-arrays form for sweeps from one station (angles in radians).
+    // The loop body is branch-free so it vectorises over elevation/azimuth.
+    static void calculateIPPBatch(
+        double stationLat, double stationLon,
+        const double* elevation, const double* azimuth,
+        std::size_t count, double hmF2,
+        double* ippLat, double* ippLon, double* mappingFactor);
+
     static double calculateMappingFunction(
         double elevation, double hmF2, double earthRadius = 6371.0);
 
@@ -33,7 +42,77 @@ public:
         double elevation, double azimuth,
         double frequency_MHz);
 
+    // ========== Generic Scalar Forms ==========
+    // The thin-shell Faraday chain for any scalar type: double, or Dual<N> for
+    // derivatives in one pass (see Dual.h). The double functions above use them.
+    template <typename T>
+    static T mappingFunction(const T& elevation, const T& hmF2, double earthRadius = 6371.0);
+
+    template <typename T>
+    static T magneticFieldProjection(
+        const T& B_magnitude, const T& B_inclination, const T& B_declination,
+        const T& elevation, const T& azimuth);
+
+    template <typename T>
+    static T faradayRotation(
+        const T& vTEC, const T& hmF2,
+        const T& B_magnitude, const T& B_inclination, const T& B_declination,
+        const T& elevation, const T& azimuth,
+        double frequency_MHz);
+
 private:
     static constexpr double DEG_TO_RAD = 0.017453292519943295;
     static constexpr double RAD_TO_DEG = 57.29577951308232;
 };
+
+// ========== Generic Scalar Forms ==========
+
+template <typename T>
+T IonospherePhysics::mappingFunction(const T& elevation, const T& hmF2, double earthRadius) {
+    using std::cos;
+    using std::sqrt;
+    if (elevation < 0.0) {
+        return T(1.0);
+    }
+
+    T sinChi = (earthRadius * cos(elevation)) / (earthRadius + hmF2);
+    if (sinChi > 1.0) sinChi = T(1.0);
+    if (sinChi < -1.0) sinChi = T(-1.0);
+
+    return 1.0 / sqrt(1.0 - sinChi * sinChi);
+}
+
+template <typename T>
+T IonospherePhysics::magneticFieldProjection(
+    const T& B_magnitude, const T& B_inclination, const T& B_declination,
+    const T& elevation, const T& azimuth) {
+    using std::cos;
+    using std::sin;
+
+    T prop_x = cos(elevation) * cos(azimuth);
+    T prop_y = cos(elevation) * sin(azimuth);
+    T prop_z = sin(elevation);
+
+    T B_x = cos(B_inclination) * cos(B_declination);
+    T B_y = cos(B_inclination) * sin(B_declination);
+    T B_z = -sin(B_inclination);
+
+    T dotProduct = prop_x * B_x + prop_y * B_y + prop_z * B_z;
+
+    return B_magnitude * dotProduct;
+}
+
+template <typename T>
+T IonospherePhysics::faradayRotation(
+    const T& vTEC, const T& hmF2,
+    const T& B_magnitude, const T& B_inclination, const T& B_declination,
+    const T& elevation, const T& azimuth,
+    double frequency_MHz) {
+
+    T sTEC_TECU = vTEC * mappingFunction(elevation, hmF2);
+    T B_proj_nanoTesla = magneticFieldProjection(
+        B_magnitude, B_inclination, B_declination, elevation, azimuth) * 1e9;
+
+    double f_squared_MHz = frequency_MHz * frequency_MHz;
+    return (0.23647 / f_squared_MHz) * sTEC_TECU * B_proj_nanoTesla;
+}
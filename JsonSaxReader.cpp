@@ -0,0 +1,464 @@
+#include "JsonSaxReader.h"
+#include <charconv>
+#include <cstdlib>
+#include <algorithm>
+
+// ========== Constructor ==========
+
+JsonSaxReader::JsonSaxReader(std::size_t maxDepth)
+    : m_maxDepth(maxDepth), m_expect(Expect::Value), m_final(false), m_failed(false),
+      m_pos(0), m_offset(0), m_errorOffset(0) {
+}
+
+void JsonSaxReader::reset() {
+    m_expect = Expect::Value;
+    m_stack.clear();
+    m_final = false;
+    m_failed = false;
+    m_carry.clear();
+    m_json = std::string_view();
+    m_pos = 0;
+    m_offset = 0;
+    m_error.clear();
+    m_errorOffset = 0;
+}
+
+// ========== Chunked Input ==========
+
+bool JsonSaxReader::feed(std::string_view chunk, JsonSaxHandler& handler) {
+    if (m_failed) {
+        return false;
+    }
+
+    size_t chunkPos = 0;
+
+    if (!m_carry.empty()) {
+        // Finish the token split at the previous boundary using a small, growing
+        // window of the new chunk, so the chunk itself is not copied.
+        const size_t carried = m_carry.size();
+        size_t window = 64;
+
+        while (true) {
+            size_t take = std::min(window, chunk.size());
+            m_carry.resize(carried);
+            m_carry.append(chunk.data(), take);
+            m_json = m_carry;
+            m_pos = 0;
+
+            if (!run(handler)) {
+                m_json = std::string_view();
+                return false;
+            }
+            if (m_pos >= carried || take == chunk.size()) {
+                break;
+            }
+            window *= 4;
+        }
+
+        if (m_pos < carried) {
+            m_carry.erase(0, m_pos);
+            m_offset += m_pos;
+            m_json = std::string_view();
+            return true;
+        }
+
+        chunkPos = m_pos - carried;
+        m_offset += carried;
+        m_carry.clear();
+    }
+
+    m_json = chunk;
+    m_pos = chunkPos;
+
+    bool ok = run(handler);
+
+    // Keep the unfinished token (if any) for the next chunk.
+    if (ok) {
+        m_carry.assign(chunk.data() + m_pos, chunk.size() - m_pos);
+    }
+    m_offset += m_pos;
+    m_json = std::string_view();
+
+    return ok;
+}
+
+bool JsonSaxReader::finish(JsonSaxHandler& handler) {
+    if (m_failed) {
+        return false;
+    }
+
+    m_final = true;
+    if (!feed(std::string_view(), handler)) {
+        return false;
+    }
+
+    if (m_expect != Expect::Done) {
+        m_pos = 0;
+        fail("Unexpected end of input");
+        return false;
+    }
+    return true;
+}
+
+bool JsonSaxReader::parse(std::string_view json, JsonSaxHandler& handler) {
+    reset();
+    return feed(json, handler) && finish(handler);
+}
+
+// ========== State Machine ==========
+
+bool JsonSaxReader::run(JsonSaxHandler& handler) {
+    while (true) {
+        skipWhitespace();
+        if (m_pos >= m_json.size()) {
+            return true;
+        }
+
+        char c = m_json[m_pos];
+        size_t tokenStart = m_pos;
+        Token token = Token::Ok;
+
+        switch (m_expect) {
+            case Expect::Done:
+                fail("Trailing characters after JSON value");
+                return false;
+
+            case Expect::ValueOrArrayEnd:
+                if (c == ']') {
+                    ++m_pos;
+                    m_stack.pop_back();
+                    if (!handler.endArray()) token = fail("Stopped by handler");
+                    else valueCompleted();
+                    break;
+                }
+                [[fallthrough]];
+
+            case Expect::Value:
+                if (c == '{' || c == '[') {
+                    if (m_stack.size() >= m_maxDepth) {
+                        token = fail("Nesting too deep");
+                        break;
+                    }
+                    ++m_pos;
+                    m_stack.push_back(c);
+                    bool ok = (c == '{') ? handler.startObject() : handler.startArray();
+                    if (!ok) token = fail("Stopped by handler");
+                    m_expect = (c == '{') ? Expect::KeyOrObjectEnd : Expect::ValueOrArrayEnd;
+                } else {
+                    token = parseScalar(handler);
+                    if (token == Token::Ok) valueCompleted();
+                }
+                break;
+
+            case Expect::KeyOrObjectEnd:
+                if (c == '}') {
+                    ++m_pos;
+                    m_stack.pop_back();
+                    if (!handler.endObject()) token = fail("Stopped by handler");
+                    else valueCompleted();
+                    break;
+                }
+                [[fallthrough]];
+
+            case Expect::Key: {
+                if (c != '"') {
+                    token = fail("Expected object key");
+                    break;
+                }
+                std::string_view name;
+                token = parseString(name);
+                if (token == Token::Ok) {
+                    if (!handler.key(name)) token = fail("Stopped by handler");
+                    m_expect = Expect::Colon;
+                }
+                break;
+            }
+
+            case Expect::Colon:
+                if (c != ':') {
+                    token = fail("Expected ':' after object key");
+                    break;
+                }
+                ++m_pos;
+                m_expect = Expect::Value;
+                break;
+
+            case Expect::CommaOrEnd: {
+                char open = m_stack.back();
+                char close = (open == '{') ? '}' : ']';
+
+                if (c == ',') {
+                    ++m_pos;
+                    m_expect = (open == '{') ? Expect::Key : Expect::Value;
+                } else if (c == close) {
+                    ++m_pos;
+                    m_stack.pop_back();
+                    bool ok = (open == '{') ? handler.endObject() : handler.endArray();
+                    if (!ok) token = fail("Stopped by handler");
+                    else valueCompleted();
+                } else {
+                    token = fail((open == '{') ? "Expected ',' or '}'" : "Expected ',' or ']'");
+                }
+                break;
+            }
+        }
+
+        if (token == Token::NeedMore) {
+            m_pos = tokenStart;
+            return true;
+        }
+        if (token == Token::Error) {
+            return false;
+        }
+    }
+}
+
+void JsonSaxReader::valueCompleted() {
+    m_expect = m_stack.empty() ? Expect::Done : Expect::CommaOrEnd;
+}
+
+JsonSaxReader::Token JsonSaxReader::parseScalar(JsonSaxHandler& handler) {
+    char c = m_json[m_pos];
+    Token token;
+    bool ok = true;
+
+    if (c == '"') {
+        std::string_view value;
+        token = parseString(value);
+        if (token == Token::Ok) ok = handler.string(value);
+    } else if (c == '-' || (c >= '0' && c <= '9')) {
+        double value;
+        token = parseNumber(value);
+        if (token == Token::Ok) ok = handler.number(value);
+    } else if (c == 't') {
+        token = parseLiteral("true");
+        if (token == Token::Ok) ok = handler.boolean(true);
+    } else if (c == 'f') {
+        token = parseLiteral("false");
+        if (token == Token::Ok) ok = handler.boolean(false);
+    } else if (c == 'n') {
+        token = parseLiteral("null");
+        if (token == Token::Ok) ok = handler.null();
+    } else {
+        return fail("Unexpected character");
+    }
+
+    return ok ? token : fail("Stopped by handler");
+}
+
+// ========== Strings ==========
+
+JsonSaxReader::Token JsonSaxReader::parseString(std::string_view& value) {
+    const size_t end = m_json.size();
+    size_t start = ++m_pos;
+
+    // Fast path: no escapes, the view points straight into the input.
+    while (m_pos < end) {
+        unsigned char c = static_cast<unsigned char>(m_json[m_pos]);
+        if (c == '"') {
+            value = m_json.substr(start, m_pos - start);
+            ++m_pos;
+            return Token::Ok;
+        }
+        if (c == '\\') break;
+        if (c < 0x20) return fail("Control character in string");
+        ++m_pos;
+    }
+
+    m_scratch.assign(m_json.data() + start, m_pos - start);
+
+    while (m_pos < end) {
+        unsigned char c = static_cast<unsigned char>(m_json[m_pos]);
+
+        if (c == '"') {
+            ++m_pos;
+            value = m_scratch;
+            return Token::Ok;
+        }
+        if (c < 0x20) {
+            return fail("Control character in string");
+        }
+        if (c != '\\') {
+            m_scratch.push_back(static_cast<char>(c));
+            ++m_pos;
+            continue;
+        }
+
+        if (m_pos + 1 >= end) break;
+        char escape = m_json[m_pos + 1];
+        m_pos += 2;
+
+        switch (escape) {
+            case '"':  m_scratch.push_back('"'); break;
+            case '\\': m_scratch.push_back('\\'); break;
+            case '/':  m_scratch.push_back('/'); break;
+            case 'b':  m_scratch.push_back('\b'); break;
+            case 'f':  m_scratch.push_back('\f'); break;
+            case 'n':  m_scratch.push_back('\n'); break;
+            case 'r':  m_scratch.push_back('\r'); break;
+            case 't':  m_scratch.push_back('\t'); break;
+            case 'u': {
+                unsigned codePoint;
+                Token token = readHex4(codePoint);
+                if (token != Token::Ok) return token;
+
+                if (codePoint >= 0xD800 && codePoint <= 0xDBFF) {
+                    if (m_pos + 2 > end) {
+                        return m_final ? fail("Unpaired surrogate in string") : Token::NeedMore;
+                    }
+                    if (m_json[m_pos] != '\\' || m_json[m_pos + 1] != 'u') {
+                        return fail("Unpaired surrogate in string");
+                    }
+                    m_pos += 2;
+
+                    unsigned low;
+                    token = readHex4(low);
+                    if (token != Token::Ok) return token;
+                    if (low < 0xDC00 || low > 0xDFFF) {
+                        return fail("Invalid surrogate pair in string");
+                    }
+                    codePoint = 0x10000 + ((codePoint - 0xD800) << 10) + (low - 0xDC00);
+                } else if (codePoint >= 0xDC00 && codePoint <= 0xDFFF) {
+                    return fail("Unpaired surrogate in string");
+                }
+
+                appendCodePoint(codePoint);
+                break;
+            }
+            default:
+                m_pos -= 1;
+                return fail("Invalid escape sequence");
+        }
+    }
+
+    return m_final ? fail("Unterminated string") : Token::NeedMore;
+}
+
+JsonSaxReader::Token JsonSaxReader::readHex4(unsigned& value) {
+    if (m_pos + 4 > m_json.size()) {
+        return m_final ? fail("Truncated \\u escape") : Token::NeedMore;
+    }
+
+    value = 0;
+    for (int i = 0; i < 4; ++i) {
+        char c = m_json[m_pos++];
+        value <<= 4;
+        if (c >= '0' && c <= '9') value |= static_cast<unsigned>(c - '0');
+        else if (c >= 'a' && c <= 'f') value |= static_cast<unsigned>(c - 'a' + 10);
+        else if (c >= 'A' && c <= 'F') value |= static_cast<unsigned>(c - 'A' + 10);
+        else return fail("Invalid hex digit in \\u escape");
+    }
+    return Token::Ok;
+}
+
+void JsonSaxReader::appendCodePoint(unsigned codePoint) {
+    if (codePoint < 0x80) {
+        m_scratch.push_back(static_cast<char>(codePoint));
+    } else if (codePoint < 0x800) {
+        m_scratch.push_back(static_cast<char>(0xC0 | (codePoint >> 6)));
+        m_scratch.push_back(static_cast<char>(0x80 | (codePoint & 0x3F)));
+    } else if (codePoint < 0x10000) {
+        m_scratch.push_back(static_cast<char>(0xE0 | (codePoint >> 12)));
+        m_scratch.push_back(static_cast<char>(0x80 | ((codePoint >> 6) & 0x3F)));
+        m_scratch.push_back(static_cast<char>(0x80 | (codePoint & 0x3F)));
+    } else {
+        m_scratch.push_back(static_cast<char>(0xF0 | (codePoint >> 18)));
+        m_scratch.push_back(static_cast<char>(0x80 | ((codePoint >> 12) & 0x3F)));
+        m_scratch.push_back(static_cast<char>(0x80 | ((codePoint >> 6) & 0x3F)));
+        m_scratch.push_back(static_cast<char>(0x80 | (codePoint & 0x3F)));
+    }
+}
+
+// ========== Numbers and Literals ==========
+
+JsonSaxReader::Token JsonSaxReader::parseNumber(double& value) {
+    // number = [ "-" ] ( "0" / 1-9 *DIGIT ) [ "." 1*DIGIT ] [ ( "e" / "E" ) [ "+" / "-" ] 1*DIGIT ]
+    // Running into the end of a chunk means more digits may follow.
+    const size_t start = m_pos;
+    const size_t end = m_json.size();
+    auto isDigit = [](char c) { return c >= '0' && c <= '9'; };
+
+    if (m_json[m_pos] == '-') ++m_pos;
+
+    if (m_pos >= end) return m_final ? fail("Invalid number") : Token::NeedMore;
+    if (!isDigit(m_json[m_pos])) return fail("Invalid number");
+
+    if (m_json[m_pos] == '0') {
+        ++m_pos;
+        if (m_pos < end && isDigit(m_json[m_pos])) {
+            return fail("Leading zero in number");
+        }
+    } else {
+        while (m_pos < end && isDigit(m_json[m_pos])) ++m_pos;
+    }
+
+    if (m_pos < end && m_json[m_pos] == '.') {
+        ++m_pos;
+        if (m_pos >= end) return m_final ? fail("Expected digit after decimal point") : Token::NeedMore;
+        if (!isDigit(m_json[m_pos])) return fail("Expected digit after decimal point");
+        while (m_pos < end && isDigit(m_json[m_pos])) ++m_pos;
+    }
+
+    if (m_pos < end && (m_json[m_pos] == 'e' || m_json[m_pos] == 'E')) {
+        ++m_pos;
+        if (m_pos < end && (m_json[m_pos] == '+' || m_json[m_pos] == '-')) ++m_pos;
+        if (m_pos >= end) return m_final ? fail("Expected digit in exponent") : Token::NeedMore;
+        if (!isDigit(m_json[m_pos])) return fail("Expected digit in exponent");
+        while (m_pos < end && isDigit(m_json[m_pos])) ++m_pos;
+    }
+
+    if (m_pos >= end && !m_final) {
+        return Token::NeedMore;
+    }
+
+    const char* first = m_json.data() + start;
+    const char* last = m_json.data() + m_pos;
+    auto result = std::from_chars(first, last, value);
+
+    if (result.ec == std::errc::result_out_of_range) {
+        // Grammar is valid; let strtod saturate to +-HUGE_VAL or flush towards zero.
+        value = std::strtod(std::string(first, last).c_str(), nullptr);
+        return Token::Ok;
+    }
+    if (result.ec != std::errc() || result.ptr != last) {
+        m_pos = start;
+        return fail("Invalid number");
+    }
+    return Token::Ok;
+}
+
+JsonSaxReader::Token JsonSaxReader::parseLiteral(std::string_view literal) {
+    std::string_view available = m_json.substr(m_pos, literal.size());
+
+    if (available.size() < literal.size()) {
+        if (!m_final && literal.compare(0, available.size(), available) == 0) {
+            return Token::NeedMore;
+        }
+        return fail("Invalid literal");
+    }
+    if (available != literal) {
+        return fail("Invalid literal");
+    }
+
+    m_pos += literal.size();
+    return Token::Ok;
+}
+
+// ========== Helpers ==========
+
+void JsonSaxReader::skipWhitespace() {
+    while (m_pos < m_json.size()) {
+        char c = m_json[m_pos];
+        if (c != ' ' && c != '\t' && c != '\n' && c != '\r') break;
+        ++m_pos;
+    }
+}
+
+JsonSaxReader::Token JsonSaxReader::fail(const char* message) {
+    if (!m_failed) {
+        m_failed = true;
+        m_error = message;
+        m_errorOffset = m_offset + m_pos;
+    }
+    return Token::Error;
+}
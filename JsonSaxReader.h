@@ -0,0 +1,76 @@
+#pragma once
+
+#include <cstddef>
+#include <string>
+#include <string_view>
+#include <vector>
+
+// ========== JSON SAX Handler ==========
+// Receives events in document order. Returning false stops the parse.
+// String views are only valid for the duration of the call.
+
+class JsonSaxHandler {
+public:
+    virtual ~JsonSaxHandler() = default;
+
+    virtual bool startObject() { return true; }
+    virtual bool endObject() { return true; }
+    virtual bool startArray() { return true; }
+    virtual bool endArray() { return true; }
+    virtual bool key(std::string_view name) { (void)name; return true; }
+    virtual bool string(std::string_view value) { (void)value; return true; }
+    virtual bool number(double value) { (void)value; return true; }
+    virtual bool boolean(bool value) { (void)value; return true; }
+    virtual bool null() { return true; }
+};
+
+// ========== JSON SAX Reader ==========
+// Single-pass, resumable RFC 8259 tokenizer. Input may arrive in arbitrary chunks:
+// a token split across a chunk boundary is carried over and completed by the next
+// feed(). Nesting is tracked on an explicit stack and nothing is materialised.
+
+class JsonSaxReader {
+public:
+    explicit JsonSaxReader(std::size_t maxDepth = 256);
+
+    void reset();
+    bool feed(std::string_view chunk, JsonSaxHandler& handler);
+    bool finish(JsonSaxHandler& handler);
+
+    // reset() + feed() + finish() over a complete document.
+    bool parse(std::string_view json, JsonSaxHandler& handler);
+
+    const std::string& getError() const { return m_error; }
+    std::size_t getErrorOffset() const { return m_errorOffset; }
+
+private:
+    enum class Expect { Value, ValueOrArrayEnd, KeyOrObjectEnd, Key, Colon, CommaOrEnd, Done };
+    enum class Token { Ok, NeedMore, Error };
+
+    std::size_t m_maxDepth;
+    Expect m_expect;
+    std::vector<char> m_stack;
+    bool m_final;
+    bool m_failed;
+
+    std::string m_carry;
+    std::string_view m_json;
+    std::size_t m_pos;
+    std::size_t m_offset;
+
+    std::string m_scratch;
+    std::string m_error;
+    std::size_t m_errorOffset;
+
+    bool run(JsonSaxHandler& handler);
+    void valueCompleted();
+    void skipWhitespace();
+    Token fail(const char* message);
+
+    Token parseScalar(JsonSaxHandler& handler);
+    Token parseString(std::string_view& value);
+    Token parseNumber(double& value);
+    Token parseLiteral(std::string_view literal);
+    Token readHex4(unsigned& value);
+    void appendCodePoint(unsigned codePoint);
+};
@@ -0,0 +1,58 @@
+#include "LatencyHistogram.h"
+#include <algorithm>
+#include <cmath>
+
+LatencyHistogram::LatencyHistogram() {
+    reset();
+}
+
+void LatencyHistogram::reset() {
+    for (auto& bucket : m_buckets) {
+        bucket.store(0, std::memory_order_relaxed);
+    }
+    m_count.store(0, std::memory_order_relaxed);
+    m_sum.store(0.0, std::memory_order_relaxed);
+    m_max.store(0.0, std::memory_order_relaxed);
+}
+
+// Single writer, so plain load/store pairs are enough and cheaper than RMW.
+void LatencyHistogram::record(double microseconds) {
+    int bucket = 0;
+    if (microseconds >= 1.0) {
+        bucket = 1 + static_cast<int>(std::log2(microseconds) * BUCKETS_PER_OCTAVE);
+        bucket = std::min(bucket, BUCKET_COUNT - 1);
+    }
+    m_buckets[bucket].store(m_buckets[bucket].load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+    m_count.store(m_count.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+    m_sum.store(m_sum.load(std::memory_order_relaxed) + microseconds, std::memory_order_relaxed);
+    if (microseconds > m_max.load(std::memory_order_relaxed)) {
+        m_max.store(microseconds, std::memory_order_relaxed);
+    }
+}
+
+double LatencyHistogram::getMean() const {
+    const std::uint64_t count = getCount();
+    return count ? m_sum.load(std::memory_order_relaxed) / static_cast<double>(count) : 0.0;
+}
+
+double LatencyHistogram::getBucketEdge(int bucket) {
+    if (bucket <= 0) return 1.0;
+    if (bucket >= BUCKET_COUNT - 1) return INFINITY;
+    return std::exp2(static_cast<double>(bucket) / BUCKETS_PER_OCTAVE);
+}
+
+double LatencyHistogram::percentile(double fraction) const {
+    const std::uint64_t count = getCount();
+    if (count == 0) {
+        return 0.0;
+    }
+    const double target = std::clamp(fraction, 0.0, 1.0) * static_cast<double>(count);
+    std::uint64_t seen = 0;
+    for (int i = 0; i < BUCKET_COUNT; ++i) {
+        seen += getBucketCount(i);
+        if (static_cast<double>(seen) >= target && seen > 0) {
+            return std::min(getBucketEdge(i), getMax());
+        }
+    }
+    return getMax();
+}
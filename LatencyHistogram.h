@@ -0,0 +1,40 @@
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <cstdint>
+
+// ========== Latency Histogram ==========
+// Log-bucketed latency counts in microseconds, four buckets per octave (about
+// 19% wide) from 1 us to about 1 s, plus an overflow bucket. One thread records;
+// any thread may read while it does, since every counter is atomic.
+
+class LatencyHistogram {
+public:
+    static constexpr int BUCKETS_PER_OCTAVE = 4;
+    static constexpr int OCTAVES = 20;
+    static constexpr int BUCKET_COUNT = BUCKETS_PER_OCTAVE * OCTAVES + 2;
+
+    LatencyHistogram();
+
+    void record(double microseconds);
+    void reset();
+
+    std::uint64_t getCount() const { return m_count.load(std::memory_order_relaxed); }
+    double getMax() const { return m_max.load(std::memory_order_relaxed); }
+    double getMean() const;
+
+    // Upper edge of the bucket holding the given fraction (0..1) of samples,
+    // capped at the maximum seen; 0 when empty.
+    double percentile(double fraction) const;
+
+    // Bucket i counts samples in [getBucketEdge(i - 1), getBucketEdge(i)).
+    static double getBucketEdge(int bucket);
+    std::uint64_t getBucketCount(int bucket) const { return m_buckets[bucket].load(std::memory_order_relaxed); }
+
+private:
+    std::array<std::atomic<std::uint64_t>, BUCKET_COUNT> m_buckets;
+    std::atomic<std::uint64_t> m_count;
+    std::atomic<double> m_sum;
+    std::atomic<double> m_max;
+};
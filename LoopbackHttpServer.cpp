@@ -0,0 +1,333 @@
+#include "LoopbackHttpServer.h"
+#include <algorithm>
+#include <cctype>
+#include <cstdio>
+#include <cstring>
+
+#ifndef _WIN32
+#include <sys/types.h>
+#include <sys/socket.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <arpa/inet.h>
+#include <poll.h>
+#include <unistd.h>
+#include <cerrno>
+
+#if !defined(FARADAY_NO_ZLIB) && __has_include(<zlib.h>)
+#define FARADAY_LOOPBACK_ZLIB 1
+#include <zlib.h>
+#endif
+
+#ifndef MSG_NOSIGNAL
+#define MSG_NOSIGNAL 0
+#endif
+#endif
+
+namespace {
+    // Granularity at which blocked threads notice stop().
+    constexpr int POLL_INTERVAL_MS = 100;
+
+#ifdef FARADAY_LOOPBACK_ZLIB
+    bool gzipCompress(const std::string& input, std::string& output) {
+        z_stream stream;
+        std::memset(&stream, 0, sizeof(stream));
+        if (deflateInit2(&stream, Z_DEFAULT_COMPRESSION, Z_DEFLATED, 16 + MAX_WBITS, 8,
+                         Z_DEFAULT_STRATEGY) != Z_OK) {
+            return false;
+        }
+
+        output.resize(deflateBound(&stream, static_cast<uLong>(input.size())));
+        stream.next_in = reinterpret_cast<Bytef*>(const_cast<char*>(input.data()));
+        stream.avail_in = static_cast<uInt>(input.size());
+        stream.next_out = reinterpret_cast<Bytef*>(&output[0]);
+        stream.avail_out = static_cast<uInt>(output.size());
+
+        int rc = deflate(&stream, Z_FINISH);
+        output.resize(stream.total_out);
+        deflateEnd(&stream);
+        return rc == Z_STREAM_END;
+    }
+#endif
+}
+
+// ========== Constructor ==========
+
+LoopbackHttpServer::LoopbackHttpServer()
+    : m_chunked(false), m_chunkSize(16384), m_gzip(false), m_keepAlive(true),
+      m_listenFd(-1), m_port(0), m_running(false), m_connectionCount(0), m_requestCount(0) {
+}
+
+LoopbackHttpServer::~LoopbackHttpServer() {
+    stop();
+}
+
+// ========== Configuration ==========
+
+void LoopbackHttpServer::addResource(
+    const std::string& path, const std::string& body, const std::string& contentType) {
+    Resource& resource = m_resources[path];
+    resource.body = body;
+    resource.gzipBody.clear();
+    resource.contentType = contentType;
+}
+
+void LoopbackHttpServer::setChunkedTransfer(bool enabled, std::size_t chunkSize) {
+    m_chunked = enabled;
+    m_chunkSize = std::max<std::size_t>(chunkSize, 1);
+}
+
+void LoopbackHttpServer::setGzip(bool enabled) {
+    m_gzip = enabled;
+}
+
+void LoopbackHttpServer::setKeepAlive(bool enabled) {
+    m_keepAlive = enabled;
+}
+
+std::string LoopbackHttpServer::getBaseUrl() const {
+    return "http://127.0.0.1:" + std::to_string(m_port);
+}
+
+#ifdef _WIN32
+
+bool LoopbackHttpServer::start(int port) {
+    (void)port;
+    m_error = "LoopbackHttpServer is only available on POSIX systems";
+    return false;
+}
+
+void LoopbackHttpServer::stop() {
+}
+
+void LoopbackHttpServer::acceptLoop() {
+}
+
+void LoopbackHttpServer::serveConnection(int fd) {
+    (void)fd;
+}
+
+bool LoopbackHttpServer::sendResponse(int fd, const std::string& path, bool acceptsGzip, bool keepAlive) {
+    (void)fd; (void)path; (void)acceptsGzip; (void)keepAlive;
+    return false;
+}
+
+#else
+
+// ========== Lifecycle ==========
+
+bool LoopbackHttpServer::start(int port) {
+    if (m_running) {
+        return true;
+    }
+    m_error.clear();
+
+#ifdef FARADAY_LOOPBACK_ZLIB
+    if (m_gzip) {
+        for (auto& entry : m_resources) {
+            if (!gzipCompress(entry.second.body, entry.second.gzipBody)) {
+                m_error = "gzip compression failed for " + entry.first;
+                return false;
+            }
+        }
+    }
+#else
+    if (m_gzip) {
+        m_error = "gzip requested but zlib is not available";
+        return false;
+    }
+#endif
+
+    m_listenFd = ::socket(AF_INET, SOCK_STREAM, 0);
+    if (m_listenFd < 0) {
+        m_error = std::string("socket failed: ") + std::strerror(errno);
+        return false;
+    }
+
+    int one = 1;
+    ::setsockopt(m_listenFd, SOL_SOCKET, SO_REUSEADDR, &one, sizeof(one));
+
+    sockaddr_in address = {};
+    address.sin_family = AF_INET;
+    address.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+    address.sin_port = htons(static_cast<uint16_t>(port));
+
+    if (::bind(m_listenFd, reinterpret_cast<sockaddr*>(&address), sizeof(address)) != 0 ||
+        ::listen(m_listenFd, 16) != 0) {
+        m_error = std::string("bind/listen failed: ") + std::strerror(errno);
+        ::close(m_listenFd);
+        m_listenFd = -1;
+        return false;
+    }
+
+    socklen_t length = sizeof(address);
+    ::getsockname(m_listenFd, reinterpret_cast<sockaddr*>(&address), &length);
+    m_port = ntohs(address.sin_port);
+
+    m_connectionCount = 0;
+    m_requestCount = 0;
+    m_running = true;
+    m_acceptThread = std::thread(&LoopbackHttpServer::acceptLoop, this);
+
+    return true;
+}
+
+void LoopbackHttpServer::stop() {
+    if (!m_running) {
+        return;
+    }
+    m_running = false;
+
+    if (m_acceptThread.joinable()) {
+        m_acceptThread.join();
+    }
+
+    {
+        std::lock_guard<std::mutex> lock(m_clientMutex);
+        for (int fd : m_clientFds) {
+            ::shutdown(fd, SHUT_RDWR);
+        }
+    }
+    for (std::thread& worker : m_workers) {
+        worker.join();
+    }
+    m_workers.clear();
+
+    ::close(m_listenFd);
+    m_listenFd = -1;
+}
+
+void LoopbackHttpServer::acceptLoop() {
+    while (m_running) {
+        pollfd p = { m_listenFd, POLLIN, 0 };
+        if (::poll(&p, 1, POLL_INTERVAL_MS) <= 0) {
+            continue;
+        }
+
+        int fd = ::accept(m_listenFd, nullptr, nullptr);
+        if (fd < 0) {
+            continue;
+        }
+
+        int noDelay = 1;
+        ::setsockopt(fd, IPPROTO_TCP, TCP_NODELAY, &noDelay, sizeof(noDelay));
+
+        ++m_connectionCount;
+        {
+            std::lock_guard<std::mutex> lock(m_clientMutex);
+            m_clientFds.insert(fd);
+        }
+        m_workers.emplace_back(&LoopbackHttpServer::serveConnection, this, fd);
+    }
+}
+
+// ========== Request Handling ==========
+
+void LoopbackHttpServer::serveConnection(int fd) {
+    std::string pending;
+    char buffer[4096];
+    bool open = true;
+
+    while (open && m_running) {
+        size_t headEnd = pending.find("\r\n\r\n");
+        if (headEnd == std::string::npos) {
+            pollfd p = { fd, POLLIN, 0 };
+            if (::poll(&p, 1, POLL_INTERVAL_MS) <= 0) {
+                continue;
+            }
+            ssize_t received = ::recv(fd, buffer, sizeof(buffer), 0);
+            if (received <= 0) {
+                break;
+            }
+            pending.append(buffer, static_cast<size_t>(received));
+            continue;
+        }
+
+        std::string head = pending.substr(0, headEnd);
+        pending.erase(0, headEnd + 4);
+
+        std::string lower = head;
+        std::transform(lower.begin(), lower.end(), lower.begin(),
+                       [](unsigned char c) { return static_cast<char>(std::tolower(c)); });
+
+        size_t pathStart = head.find(' ');
+        size_t pathEnd = (pathStart == std::string::npos) ? pathStart : head.find(' ', pathStart + 1);
+        std::string path = (pathEnd == std::string::npos) ? "/" : head.substr(pathStart + 1, pathEnd - pathStart - 1);
+
+        bool acceptsGzip = lower.find("accept-encoding:") != std::string::npos &&
+                           lower.find("gzip", lower.find("accept-encoding:")) != std::string::npos;
+        bool keepAlive = m_keepAlive && lower.find("connection: close") == std::string::npos;
+
+        ++m_requestCount;
+        open = sendResponse(fd, path, acceptsGzip, keepAlive) && keepAlive;
+    }
+
+    {
+        std::lock_guard<std::mutex> lock(m_clientMutex);
+        m_clientFds.erase(fd);
+    }
+    ::close(fd);
+}
+
+bool LoopbackHttpServer::sendResponse(int fd, const std::string& path, bool acceptsGzip, bool keepAlive) {
+    auto sendAll = [fd](const char* data, size_t length) {
+        while (length > 0) {
+            ssize_t sent = ::send(fd, data, length, MSG_NOSIGNAL);
+            if (sent < 0) {
+                if (errno == EINTR) continue;
+                return false;
+            }
+            data += sent;
+            length -= static_cast<size_t>(sent);
+        }
+        return true;
+    };
+
+    auto found = m_resources.find(path);
+    std::string status = (found != m_resources.end()) ? "200 OK" : "404 Not Found";
+
+    static const std::string notFound = "Not Found";
+    const std::string* body = &notFound;
+    std::string contentType = "text/plain";
+    bool gzip = false;
+
+    if (found != m_resources.end()) {
+        contentType = found->second.contentType;
+        gzip = m_gzip && acceptsGzip;
+        body = gzip ? &found->second.gzipBody : &found->second.body;
+    }
+
+    std::string head = "HTTP/1.1 " + status + "\r\n"
+                       "Content-Type: " + contentType + "\r\n";
+    if (gzip) {
+        head += "Content-Encoding: gzip\r\n";
+    }
+    if (m_chunked) {
+        head += "Transfer-Encoding: chunked\r\n";
+    } else {
+        head += "Content-Length: " + std::to_string(body->size()) + "\r\n";
+    }
+    head += keepAlive ? "Connection: keep-alive\r\n\r\n" : "Connection: close\r\n\r\n";
+
+    if (!sendAll(head.data(), head.size())) {
+        return false;
+    }
+
+    if (!m_chunked) {
+        return sendAll(body->data(), body->size());
+    }
+
+    char sizeLine[32];
+    for (size_t offset = 0; offset < body->size(); offset += m_chunkSize) {
+        size_t length = std::min(m_chunkSize, body->size() - offset);
+        int n = std::snprintf(sizeLine, sizeof(sizeLine), "%zx\r\n", length);
+        if (!sendAll(sizeLine, static_cast<size_t>(n)) ||
+            !sendAll(body->data() + offset, length) ||
+            !sendAll("\r\n", 2)) {
+            return false;
+        }
+    }
+    return sendAll("0\r\n\r\n", 5);
+}
+
+#endif
@@ -0,0 +1,73 @@
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <map>
+#include <mutex>
+#include <set>
+#include <string>
+#include <thread>
+#include <vector>
+
+// ========== Loopback HTTP Server ==========
+// Minimal HTTP/1.1 server on 127.0.0.1 serving in-memory resources, so the fetch and
+// parse path can be exercised and benchmarked without network access. Supports
+// keep-alive, chunked transfer and gzip content-encoding; one thread per connection.
+// Available on POSIX systems only; start() fails elsewhere.
+
+class LoopbackHttpServer {
+public:
+    LoopbackHttpServer();
+    ~LoopbackHttpServer();
+
+    LoopbackHttpServer(const LoopbackHttpServer&) = delete;
+    LoopbackHttpServer& operator=(const LoopbackHttpServer&) = delete;
+
+    // Configure before start().
+    void addResource(const std::string& path, const std::string& body,
+                     const std::string& contentType = "application/json");
+    void setChunkedTransfer(bool enabled, std::size_t chunkSize = 16384);
+    void setGzip(bool enabled);
+    void setKeepAlive(bool enabled);
+
+    // Port 0 picks a free ephemeral port.
+    bool start(int port = 0);
+    void stop();
+
+    bool isRunning() const { return m_running; }
+    int getPort() const { return m_port; }
+    std::string getBaseUrl() const;
+
+    std::size_t getConnectionCount() const { return m_connectionCount; }
+    std::size_t getRequestCount() const { return m_requestCount; }
+    const std::string& getError() const { return m_error; }
+
+private:
+    struct Resource {
+        std::string body;
+        std::string gzipBody;
+        std::string contentType;
+    };
+
+    std::map<std::string, Resource> m_resources;
+    bool m_chunked;
+    std::size_t m_chunkSize;
+    bool m_gzip;
+    bool m_keepAlive;
+
+    int m_listenFd;
+    int m_port;
+    std::string m_error;
+    std::atomic<bool> m_running;
+    std::atomic<std::size_t> m_connectionCount;
+    std::atomic<std::size_t> m_requestCount;
+
+    std::thread m_acceptThread;
+    std::vector<std::thread> m_workers;
+    std::mutex m_clientMutex;
+    std::set<int> m_clientFds;
+
+    void acceptLoop();
+    void serveConnection(int fd);
+    bool sendResponse(int fd, const std::string& path, bool acceptsGzip, bool keepAlive);
+};
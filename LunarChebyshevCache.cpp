@@ -0,0 +1,319 @@
+#define _USE_MATH_DEFINES
+#include "LunarChebyshevCache.h"
+#include "LunarEphemeris.h"
+#include <cmath>
+#include <cstdint>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <limits>
+
+#ifndef M_PI
+#define M_PI 3.14159265358979323846
+#endif
+
+namespace {
+    constexpr char MAGIC[4] = { 'L', 'C', 'H', 'B' };
+    constexpr std::uint32_t FORMAT_VERSION = 2;
+    // magic, version, theory version, fixed delta T flag, delta T, start,
+    // segment, degree, sidereal degree, segment count
+    constexpr std::size_t HEADER_SIZE = 4 + 4 + 4 + 4 + 8 + 8 + 8 + 4 + 4 + 8;
+    constexpr std::uint64_t MAX_SEGMENTS = 1u << 20;
+
+    // Sidereal rate, used to unwrap the sampled sidereal time within a segment.
+    constexpr double SIDEREAL_RATE = 2.0 * M_PI * 1.00273790935 / 86400.0;
+
+    template <typename T>
+    void put(char*& out, const T& value) {
+        std::memcpy(out, &value, sizeof(T));
+        out += sizeof(T);
+    }
+
+    template <typename T>
+    void get(const char*& in, T& value) {
+        std::memcpy(&value, in, sizeof(T));
+        in += sizeof(T);
+    }
+
+    // Coefficients c_0..c_n of the degree-n interpolant through f at the nodes
+    // x_j = cos(pi (j + 1/2) / (n + 1)).
+    void fitNodes(const double* f, int degree, double* coefficients) {
+        const int nodes = degree + 1;
+        for (int k = 0; k <= degree; ++k) {
+            double sum = 0.0;
+            for (int j = 0; j < nodes; ++j) {
+                sum += f[j] * std::cos(M_PI * k * (j + 0.5) / nodes);
+            }
+            coefficients[k] = sum * 2.0 / nodes;
+        }
+        coefficients[0] *= 0.5;
+    }
+
+    inline double clenshaw(const double* c, int degree, double x) {
+        double b1 = 0.0, b2 = 0.0;
+        for (int k = degree; k >= 1; --k) {
+            double b = 2.0 * x * b1 - b2 + c[k];
+            b2 = b1;
+            b1 = b;
+        }
+        return x * b1 - b2 + c[0];
+    }
+}
+
+// ========== Constructor ==========
+
+LunarChebyshevCache::LunarChebyshevCache()
+    : m_theoryVersion(LunarEphemeris::THEORY_VERSION), m_fixedDeltaT(false), m_deltaT(0.0),
+      m_start(0.0), m_segment_s(DEFAULT_SEGMENT_S), m_degree(DEFAULT_DEGREE),
+      m_segmentCount(0), m_stride(0) {
+}
+
+void LunarChebyshevCache::setLayout(double start, double segment_s, int degree, std::size_t segmentCount) {
+    m_start = start;
+    m_segment_s = segment_s;
+    m_degree = degree;
+    m_segmentCount = segmentCount;
+    m_stride = 3 * static_cast<std::size_t>(degree + 1) + (SIDEREAL_DEGREE + 1);
+    m_coefficients.assign(m_stride * segmentCount, 0.0);
+}
+
+// ========== Fitting ==========
+
+bool LunarChebyshevCache::build(const LunarEphemeris& ephemeris, double from, double to,
+                                double segment_s, int degree) {
+    if (!(to > from) || !(segment_s > 0.0) || degree < 1 || degree > 30) {
+        m_error = "Invalid cache span or layout";
+        return false;
+    }
+
+    const double start = std::floor(from / segment_s) * segment_s;
+    const double count = std::ceil((to - start) / segment_s);
+    if (count > static_cast<double>(MAX_SEGMENTS)) {
+        m_error = "Cache span too long";
+        return false;
+    }
+    setLayout(start, segment_s, degree, static_cast<std::size_t>(count));
+    m_theoryVersion = LunarEphemeris::THEORY_VERSION;
+    m_fixedDeltaT = ephemeris.hasFixedDeltaT();
+    m_deltaT = m_fixedDeltaT ? ephemeris.getFixedDeltaT() : 0.0;
+
+    const int nodes = degree + 1;
+    std::vector<double> x(nodes), y(nodes), z(nodes), sidereal(SIDEREAL_DEGREE + 1);
+
+    for (std::size_t segment = 0; segment < m_segmentCount; ++segment) {
+        const double a = m_start + m_segment_s * static_cast<double>(segment);
+        const double middle = a + 0.5 * m_segment_s;
+        double* c = &m_coefficients[segment * m_stride];
+
+        for (int j = 0; j < nodes; ++j) {
+            double t = middle + 0.5 * m_segment_s * std::cos(M_PI * (j + 0.5) / nodes);
+            LunarGeocentric geo = ephemeris.computeAnalytic(t);
+            x[j] = geo.position_km[0];
+            y[j] = geo.position_km[1];
+            z[j] = geo.position_km[2];
+        }
+        fitNodes(x.data(), degree, c);
+        fitNodes(y.data(), degree, c + nodes);
+        fitNodes(z.data(), degree, c + 2 * nodes);
+
+        // Sidereal time advances more than 2 pi per day; unwrap against the mean rate.
+        const double reference = ephemeris.computeAnalytic(middle).siderealTime;
+        for (int j = 0; j <= SIDEREAL_DEGREE; ++j) {
+            double offset = 0.5 * m_segment_s * std::cos(M_PI * (j + 0.5) / (SIDEREAL_DEGREE + 1));
+            double predicted = reference + SIDEREAL_RATE * offset;
+            double actual = ephemeris.computeAnalytic(middle + offset).siderealTime;
+            sidereal[j] = predicted + std::remainder(actual - predicted, 2.0 * M_PI);
+        }
+        fitNodes(sidereal.data(), SIDEREAL_DEGREE, c + 3 * nodes);
+    }
+
+    m_error.clear();
+    return true;
+}
+
+// ========== Evaluation ==========
+
+bool LunarChebyshevCache::covers(double utcSeconds) const {
+    return m_segmentCount > 0 && utcSeconds >= m_start && utcSeconds < getEnd();
+}
+
+bool LunarChebyshevCache::covers(double from, double to) const {
+    return m_segmentCount > 0 && from >= m_start && to <= getEnd();
+}
+
+bool LunarChebyshevCache::evaluatePosition(double utcSeconds, double position_km[3], double& siderealTime) const {
+    const double offset = utcSeconds - m_start;
+    if (!(offset >= 0.0)) {
+        return false;
+    }
+    const double index = std::floor(offset / m_segment_s);
+    if (index >= static_cast<double>(m_segmentCount)) {
+        return false;
+    }
+
+    const std::size_t segment = static_cast<std::size_t>(index);
+    const double tau = 2.0 * (offset - index * m_segment_s) / m_segment_s - 1.0;
+    const double* c = &m_coefficients[segment * m_stride];
+    const int nodes = m_degree + 1;
+
+    // Three Clenshaw recurrences interleaved.
+    double bx1 = 0.0, bx2 = 0.0, by1 = 0.0, by2 = 0.0, bz1 = 0.0, bz2 = 0.0;
+    const double twoTau = 2.0 * tau;
+    for (int k = m_degree; k >= 1; --k) {
+        double bx = twoTau * bx1 - bx2 + c[k];
+        double by = twoTau * by1 - by2 + c[nodes + k];
+        double bz = twoTau * bz1 - bz2 + c[2 * nodes + k];
+        bx2 = bx1; bx1 = bx;
+        by2 = by1; by1 = by;
+        bz2 = bz1; bz1 = bz;
+    }
+    position_km[0] = tau * bx1 - bx2 + c[0];
+    position_km[1] = tau * by1 - by2 + c[nodes];
+    position_km[2] = tau * bz1 - bz2 + c[2 * nodes];
+
+    double sidereal = clenshaw(c + 3 * nodes, SIDEREAL_DEGREE, tau);
+    siderealTime = sidereal - 2.0 * M_PI * std::floor(sidereal / (2.0 * M_PI));
+    return true;
+}
+
+bool LunarChebyshevCache::evaluate(double utcSeconds, LunarGeocentric& geo) const {
+    if (!evaluatePosition(utcSeconds, geo.position_km, geo.siderealTime)) {
+        return false;
+    }
+
+    const double x = geo.position_km[0];
+    const double y = geo.position_km[1];
+    const double z = geo.position_km[2];
+
+    geo.julianDateUT = LunarEphemeris::julianDate(utcSeconds);
+    geo.eclipticLongitude = std::numeric_limits<double>::quiet_NaN();
+    geo.eclipticLatitude = std::numeric_limits<double>::quiet_NaN();
+    geo.distance_km = std::sqrt(x * x + y * y + z * z);
+    geo.rightAscension = std::atan2(y, x);
+    if (geo.rightAscension < 0.0) geo.rightAscension += 2.0 * M_PI;
+    geo.declination = std::asin(z / geo.distance_km);
+
+    return true;
+}
+
+// ========== Persistence ==========
+
+bool LunarChebyshevCache::matches(const LunarEphemeris& ephemeris) const {
+    return m_theoryVersion == LunarEphemeris::THEORY_VERSION &&
+           m_fixedDeltaT == ephemeris.hasFixedDeltaT() &&
+           (!m_fixedDeltaT || m_deltaT == ephemeris.getFixedDeltaT());
+}
+
+std::string LunarChebyshevCache::pathBeside(const std::string& calendarFile) {
+    std::filesystem::path path(calendarFile);
+    path.replace_extension(".cheb");
+    return path.string();
+}
+
+bool LunarChebyshevCache::save(const std::string& filename) const {
+    char header[HEADER_SIZE];
+    char* out = header;
+    std::memcpy(out, MAGIC, sizeof(MAGIC));
+    out += sizeof(MAGIC);
+    put(out, FORMAT_VERSION);
+    put(out, m_theoryVersion);
+    put(out, static_cast<std::uint32_t>(m_fixedDeltaT ? 1 : 0));
+    put(out, m_deltaT);
+    put(out, m_start);
+    put(out, m_segment_s);
+    put(out, static_cast<std::int32_t>(m_degree));
+    put(out, static_cast<std::int32_t>(SIDEREAL_DEGREE));
+    put(out, static_cast<std::uint64_t>(m_segmentCount));
+
+    // Same write-then-rename as the GloTEC snapshots.
+    const std::string temporary = filename + ".tmp";
+    {
+        std::ofstream file(temporary, std::ios::binary | std::ios::trunc);
+        file.write(header, HEADER_SIZE);
+        file.write(reinterpret_cast<const char*>(m_coefficients.data()),
+                   static_cast<std::streamsize>(m_coefficients.size() * sizeof(double)));
+        if (!file) {
+            m_error = "Cannot write " + temporary;
+            return false;
+        }
+    }
+
+    std::error_code ec;
+    std::filesystem::rename(temporary, filename, ec);
+    if (ec) {
+        m_error = "Cannot rename " + temporary + ": " + ec.message();
+        std::filesystem::remove(temporary, ec);
+        return false;
+    }
+    return true;
+}
+
+bool LunarChebyshevCache::load(const std::string& filename, const LunarEphemeris& ephemeris) {
+    std::ifstream file(filename, std::ios::binary);
+    char header[HEADER_SIZE];
+    if (!file.read(header, HEADER_SIZE)) {
+        m_error = "Cannot read " + filename;
+        return false;
+    }
+
+    const char* in = header;
+    std::uint32_t version, theoryVersion, fixedDeltaT;
+    double deltaT, start, segment_s;
+    std::int32_t degree, siderealDegree;
+    std::uint64_t segmentCount;
+
+    if (std::memcmp(in, MAGIC, sizeof(MAGIC)) != 0) {
+        m_error = "Not a lunar cache: " + filename;
+        return false;
+    }
+    in += sizeof(MAGIC);
+    get(in, version);
+    get(in, theoryVersion);
+    get(in, fixedDeltaT);
+    get(in, deltaT);
+    get(in, start);
+    get(in, segment_s);
+    get(in, degree);
+    get(in, siderealDegree);
+    get(in, segmentCount);
+
+    if (version != FORMAT_VERSION || siderealDegree != SIDEREAL_DEGREE || !(segment_s > 0.0) ||
+        degree < 1 || degree > 30 || segmentCount == 0 || segmentCount > MAX_SEGMENTS) {
+        m_error = "Corrupt or incompatible lunar cache: " + filename;
+        return false;
+    }
+
+    // A fit of another theory or delta T is valid data, just not for this ephemeris.
+    if (theoryVersion != LunarEphemeris::THEORY_VERSION || fixedDeltaT != (ephemeris.hasFixedDeltaT() ? 1u : 0u) ||
+        (fixedDeltaT && deltaT != ephemeris.getFixedDeltaT())) {
+        m_error = "Lunar cache was fitted with another ephemeris or delta T: " + filename;
+        return false;
+    }
+
+    setLayout(start, segment_s, degree, static_cast<std::size_t>(segmentCount));
+    m_theoryVersion = theoryVersion;
+    m_fixedDeltaT = fixedDeltaT != 0;
+    m_deltaT = deltaT;
+    if (!file.read(reinterpret_cast<char*>(m_coefficients.data()),
+                   static_cast<std::streamsize>(m_coefficients.size() * sizeof(double)))) {
+        m_error = "Truncated lunar cache: " + filename;
+        setLayout(0.0, DEFAULT_SEGMENT_S, DEFAULT_DEGREE, 0);
+        return false;
+    }
+
+    m_error.clear();
+    return true;
+}
+
+bool LunarChebyshevCache::loadOrBuild(const std::string& filename, const LunarEphemeris& ephemeris,
+                                      double from, double to) {
+    if (load(filename, ephemeris) && covers(from, to)) {
+        return true;
+    }
+    if (!build(ephemeris, from, to)) {
+        return false;
+    }
+    // A cache that cannot be written is still usable for this run.
+    save(filename);
+    return true;
+}
@@ -0,0 +1,81 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+class LunarEphemeris;
+struct LunarGeocentric;
+
+// ========== Lunar Chebyshev Cache ==========
+// Precomputed geocentric moon positions for repeated queries over the same span.
+// Each fixed-length segment holds Chebyshev coefficients, fitted at the Chebyshev
+// nodes, for the equatorial-of-date position vector (x, y, z) and the unwrapped
+// apparent sidereal time, so a lookup is one segment index plus a few
+// Clenshaw steps per coordinate. With the default 1-day segments and degree 6
+// the fit reproduces the analytic theory to about 1e-4 arcsec, and a year is about
+// 70 KB.
+//
+// Files are written next to the calendar (see pathBeside) in host byte order.
+// The header records the theory version and delta T setting of the ephemeris
+// that was fitted, and load() refuses a file that does not match.
+
+class LunarChebyshevCache {
+public:
+    static constexpr double DEFAULT_SEGMENT_S = 86400.0;
+    static constexpr int DEFAULT_DEGREE = 6;
+
+    LunarChebyshevCache();
+
+    // Fits [from, to) (UTC seconds since 1970) with the analytic theory; the span
+    // is rounded out to whole segments aligned on 00:00 UTC.
+    bool build(const LunarEphemeris& ephemeris, double from, double to,
+               double segment_s = DEFAULT_SEGMENT_S, int degree = DEFAULT_DEGREE);
+
+    // Fills equatorial position, RA/Dec, distance and sidereal time. Ecliptic
+    // coordinates are not cached and are set to NaN. False outside the span.
+    bool evaluate(double utcSeconds, LunarGeocentric& geo) const;
+
+    // Position vector and sidereal time only, for callers that need no angles.
+    bool evaluatePosition(double utcSeconds, double position_km[3], double& siderealTime) const;
+
+    bool covers(double utcSeconds) const;
+    bool covers(double from, double to) const;
+    double getStart() const { return m_start; }
+    double getEnd() const { return m_start + m_segment_s * static_cast<double>(m_segmentCount); }
+    std::size_t getSegmentCount() const { return m_segmentCount; }
+    std::size_t getMemoryBytes() const { return m_coefficients.size() * sizeof(double); }
+
+    // Same theory version and delta T setting as the ephemeris fitted.
+    bool matches(const LunarEphemeris& ephemeris) const;
+
+    bool save(const std::string& filename) const;
+    bool load(const std::string& filename, const LunarEphemeris& ephemeris);
+
+    // Loads `filename` if it matches the ephemeris and covers [from, to); otherwise
+    // fits the span and writes it.
+    bool loadOrBuild(const std::string& filename, const LunarEphemeris& ephemeris,
+                     double from, double to);
+
+    // "calendar.dat" -> "calendar.cheb", in the same directory.
+    static std::string pathBeside(const std::string& calendarFile);
+
+    const std::string& getError() const { return m_error; }
+
+private:
+    static constexpr int SIDEREAL_DEGREE = 3;
+
+    std::uint32_t m_theoryVersion;
+    bool m_fixedDeltaT;
+    double m_deltaT;                // only meaningful with m_fixedDeltaT
+    double m_start;
+    double m_segment_s;
+    int m_degree;
+    std::size_t m_segmentCount;
+    std::size_t m_stride;
+    std::vector<double> m_coefficients;
+    mutable std::string m_error;
+
+    void setLayout(double start, double segment_s, int degree, std::size_t segmentCount);
+};
@@ -0,0 +1,406 @@
+#define _USE_MATH_DEFINES
+#include "LunarEphemeris.h"
+#include "LunarChebyshevCache.h"
+#include <algorithm>
+#include <cmath>
+
+#ifndef M_PI
+#define M_PI 3.14159265358979323846
+#endif
+
+namespace {
+    constexpr double DEG = M_PI / 180.0;
+    constexpr double ARCSEC = DEG / 3600.0;
+    constexpr double EARTH_EQUATORIAL_KM = 6378.14;
+    constexpr double EARTH_AXIS_RATIO = 0.99664719;     // b/a
+    constexpr double JD_UNIX_EPOCH = 2440587.5;
+    constexpr double JD_J2000 = 2451545.0;
+
+    struct PeriodicTerm {
+        signed char d, m, mp, f;
+        double coefficient;     // 1e-6 deg (longitude, latitude)
+        double distance;        // 1e-3 km
+    };
+
+    // Meeus table 47.A: longitude and distance.
+    constexpr PeriodicTerm LONGITUDE_DISTANCE[60] = {
+        { 0,  0,  1,  0, 6288774, -20905355 }, { 2,  0, -1,  0, 1274027, -3699111 },
+        { 2,  0,  0,  0,  658314,  -2955968 }, { 0,  0,  2,  0,  213618,  -569925 },
+        { 0,  1,  0,  0, -185116,     48888 }, { 0,  0,  0,  2, -114332,    -3149 },
+        { 2,  0, -2,  0,   58793,    246158 }, { 2, -1, -1,  0,   57066,  -152138 },
+        { 2,  0,  1,  0,   53322,   -170733 }, { 2, -1,  0,  0,   45758,  -204586 },
+        { 0,  1, -1,  0,  -40923,   -129620 }, { 1,  0,  0,  0,  -34720,   108743 },
+        { 0,  1,  1,  0,  -30383,    104755 }, { 2,  0,  0, -2,   15327,    10321 },
+        { 0,  0,  1,  2,  -12528,         0 }, { 0,  0,  1, -2,   10980,    79661 },
+        { 4,  0, -1,  0,   10675,    -34782 }, { 0,  0,  3,  0,   10034,   -23210 },
+        { 4,  0, -2,  0,    8548,    -21636 }, { 2,  1, -1,  0,   -7888,    24208 },
+        { 2,  1,  0,  0,   -6766,     30824 }, { 1,  0, -1,  0,   -5163,    -8379 },
+        { 1,  1,  0,  0,    4987,    -16675 }, { 2, -1,  1,  0,    4036,   -12831 },
+        { 2,  0,  2,  0,    3994,    -10445 }, { 4,  0,  0,  0,    3861,   -11650 },
+        { 2,  0, -3,  0,    3665,     14403 }, { 0,  1, -2,  0,   -2689,    -7003 },
+        { 2,  0, -1,  2,   -2602,         0 }, { 2, -1, -2,  0,    2390,    10056 },
+        { 1,  0,  1,  0,   -2348,      6322 }, { 2, -2,  0,  0,    2236,    -9884 },
+        { 0,  1,  2,  0,   -2120,      5751 }, { 0,  2,  0,  0,   -2069,        0 },
+        { 2, -2, -1,  0,    2048,     -4950 }, { 2,  0,  1, -2,   -1773,     4130 },
+        { 2,  0,  0,  2,   -1595,         0 }, { 4, -1, -1,  0,    1215,    -3958 },
+        { 0,  0,  2,  2,   -1110,         0 }, { 3,  0, -1,  0,    -892,     3258 },
+        { 2,  1,  1,  0,    -810,      2616 }, { 4, -1, -2,  0,     759,    -1897 },
+        { 0,  2, -1,  0,    -713,     -2117 }, { 2,  2, -1,  0,    -700,     2354 },
+        { 2,  1, -2,  0,     691,         0 }, { 2, -1,  0, -2,     596,        0 },
+        { 4,  0,  1,  0,     549,     -1423 }, { 0,  0,  4,  0,     537,    -1117 },
+        { 4, -1,  0,  0,     520,     -1571 }, { 1,  0, -2,  0,    -487,    -1739 },
+        { 2,  1,  0, -2,    -399,         0 }, { 0,  0,  2, -2,    -381,    -4421 },
+        { 1,  1,  1,  0,     351,         0 }, { 3,  0, -2,  0,    -340,        0 },
+        { 4,  0, -3,  0,     330,         0 }, { 2, -1,  2,  0,     327,        0 },
+        { 0,  2,  1,  0,    -323,      1165 }, { 1,  1, -1,  0,     299,        0 },
+        { 2,  0,  3,  0,     294,         0 }, { 2,  0, -1, -2,       0,     8752 },
+    };
+
+    // Meeus table 47.B: latitude.
+    constexpr PeriodicTerm LATITUDE[60] = {
+        { 0,  0,  0,  1, 5128122, 0 }, { 0,  0,  1,  1,  280602, 0 },
+        { 0,  0,  1, -1,  277693, 0 }, { 2,  0,  0, -1,  173237, 0 },
+        { 2,  0, -1,  1,   55413, 0 }, { 2,  0, -1, -1,   46271, 0 },
+        { 2,  0,  0,  1,   32573, 0 }, { 0,  0,  2,  1,   17198, 0 },
+        { 2,  0,  1, -1,    9266, 0 }, { 0,  0,  2, -1,    8822, 0 },
+        { 2, -1,  0, -1,    8216, 0 }, { 2,  0, -2, -1,    4324, 0 },
+        { 2,  0,  1,  1,    4200, 0 }, { 2,  1,  0, -1,   -3359, 0 },
+        { 2, -1, -1,  1,    2463, 0 }, { 2, -1,  0,  1,    2211, 0 },
+        { 2, -1, -1, -1,    2065, 0 }, { 0,  1, -1, -1,   -1870, 0 },
+        { 4,  0, -1, -1,    1828, 0 }, { 0,  1,  0,  1,   -1794, 0 },
+        { 0,  0,  0,  3,   -1749, 0 }, { 0,  1, -1,  1,   -1565, 0 },
+        { 1,  0,  0,  1,   -1491, 0 }, { 0,  1,  1,  1,   -1475, 0 },
+        { 0,  1,  1, -1,   -1410, 0 }, { 0,  1,  0, -1,   -1344, 0 },
+        { 1,  0,  0, -1,   -1335, 0 }, { 0,  0,  3,  1,    1107, 0 },
+        { 4,  0,  0, -1,    1021, 0 }, { 4,  0, -1,  1,     833, 0 },
+        { 0,  0,  1, -3,     777, 0 }, { 4,  0, -2,  1,     671, 0 },
+        { 2,  0,  0, -3,     607, 0 }, { 2,  0,  2, -1,     596, 0 },
+        { 2, -1,  1, -1,     491, 0 }, { 2,  0, -2,  1,    -451, 0 },
+        { 0,  0,  3, -1,     439, 0 }, { 2,  0,  2,  1,     422, 0 },
+        { 2,  0, -3, -1,     421, 0 }, { 2,  1, -1,  1,    -366, 0 },
+        { 2,  1,  0,  1,    -351, 0 }, { 4,  0,  0,  1,     331, 0 },
+        { 2, -1,  1,  1,     315, 0 }, { 2, -2,  0, -1,     302, 0 },
+        { 0,  0,  1,  3,    -283, 0 }, { 2,  1,  1, -1,    -229, 0 },
+        { 1,  1,  0, -1,     223, 0 }, { 1,  1,  0,  1,     223, 0 },
+        { 0,  1, -2, -1,    -220, 0 }, { 2,  1, -1, -1,    -220, 0 },
+        { 1,  0,  1,  1,    -185, 0 }, { 2, -1, -2, -1,     181, 0 },
+        { 0,  1,  2,  1,    -177, 0 }, { 4,  0, -2, -1,     176, 0 },
+        { 4, -1, -1, -1,     166, 0 }, { 1,  0,  1, -1,    -164, 0 },
+        { 4,  0,  1, -1,     132, 0 }, { 1,  0, -1, -1,    -119, 0 },
+        { 4, -1,  0, -1,     115, 0 }, { 2, -2,  0,  1,     107, 0 },
+    };
+
+    // exp(ikX) for k = -4..4, stored at k + 4.
+    struct Phasor {
+        double c, s;
+    };
+
+    inline Phasor multiply(const Phasor& a, const Phasor& b) {
+        return { a.c * b.c - a.s * b.s, a.c * b.s + a.s * b.c };
+    }
+
+    inline Phasor conjugate(const Phasor& a) {
+        return { a.c, -a.s };
+    }
+
+    inline Phasor phasor(double angle) {
+        return { std::cos(angle), std::sin(angle) };
+    }
+
+    void buildPhasors(double angle, Phasor table[9]) {
+        Phasor one = phasor(angle);
+        table[4] = { 1.0, 0.0 };
+        for (int k = 1; k <= 4; ++k) {
+            table[4 + k] = multiply(table[3 + k], one);
+            table[4 - k] = conjugate(table[4 + k]);
+        }
+    }
+
+    inline double reduceDegrees(double angle) {
+        return angle - 360.0 * std::floor(angle / 360.0);
+    }
+
+    // Geodetic station reduced to the quantities the parallax correction needs.
+    struct Station {
+        double longitude;
+        double sinLat, cosLat;
+        double axial_km, polar_km;  // Geocentric position, see LunarEphemeris::stationRadii
+    };
+
+    Station makeStation(double latitude, double longitude, double height_km) {
+        Station station;
+        station.longitude = longitude;
+        station.sinLat = std::sin(latitude);
+        station.cosLat = std::cos(latitude);
+        LunarEphemeris::stationRadii(latitude, height_km, station.axial_km, station.polar_km);
+        return station;
+    }
+
+    LunarTopocentric observe(const LunarGeocentric& geo, const Station& station) {
+        LunarTopocentric topo;
+
+        // Moon minus station, equatorial frame of date, km.
+        const double localSidereal = geo.siderealTime + station.longitude;
+        const double cosLST = std::cos(localSidereal), sinLST = std::sin(localSidereal);
+        const double x = geo.position_km[0] - station.axial_km * cosLST;
+        const double y = geo.position_km[1] - station.axial_km * sinLST;
+        const double z = geo.position_km[2] - station.polar_km;
+
+        const double horizontal = std::sqrt(x * x + y * y);
+        topo.distance_km = std::sqrt(horizontal * horizontal + z * z);
+        topo.rightAscension = std::atan2(y, x);
+        if (topo.rightAscension < 0.0) topo.rightAscension += 2.0 * M_PI;
+        topo.declination = std::atan2(z, horizontal);
+
+        // Hour angle components by rotating the vector into the local meridian.
+        const double cosHcosD = (x * cosLST + y * sinLST) / topo.distance_km;
+        const double sinHcosD = (x * sinLST - y * cosLST) / topo.distance_km;
+        const double sinD = z / topo.distance_km;
+        topo.hourAngle = std::atan2(sinHcosD, cosHcosD);
+
+        double sinEl = station.sinLat * sinD + station.cosLat * cosHcosD;
+        topo.elevation = std::asin(std::max(-1.0, std::min(1.0, sinEl)));
+        topo.azimuth = std::atan2(-sinHcosD, sinD * station.cosLat - cosHcosD * station.sinLat);
+        if (topo.azimuth < 0.0) topo.azimuth += 2.0 * M_PI;
+
+        return topo;
+    }
+}
+
+// ========== Constructor ==========
+
+LunarEphemeris::LunarEphemeris()
+    : m_fixedDeltaT(false), m_deltaT(0.0) {
+}
+
+void LunarEphemeris::setDeltaT(double seconds) {
+    m_fixedDeltaT = true;
+    m_deltaT = seconds;
+}
+
+// ========== Time Scales ==========
+
+double LunarEphemeris::julianDate(double utcSeconds) {
+    return JD_UNIX_EPOCH + utcSeconds / 86400.0;
+}
+
+double LunarEphemeris::defaultDeltaT(double year) {
+    // Espenak & Meeus (2006) polynomials around the present.
+    if (year < 2005.0) {
+        double t = year - 2000.0;
+        return 63.86 + t * (0.3345 + t * (-0.060374 + t * (0.0017275 + t * (0.000651814 + t * 0.00002373599))));
+    }
+    if (year < 2050.0) {
+        double t = year - 2000.0;
+        return 62.92 + t * (0.32217 + t * 0.005589);
+    }
+    double u = (year - 1820.0) / 100.0;
+    return -20.0 + 32.0 * u * u - 0.5628 * (2150.0 - year);
+}
+
+// ========== Station Geometry ==========
+
+void LunarEphemeris::stationRadii(double latitude, double height_km, double& axial_km, double& polar_km) {
+    const double u = std::atan(EARTH_AXIS_RATIO * std::tan(latitude));
+    axial_km = EARTH_EQUATORIAL_KM * std::cos(u) + height_km * std::cos(latitude);
+    polar_km = EARTH_EQUATORIAL_KM * EARTH_AXIS_RATIO * std::sin(u) + height_km * std::sin(latitude);
+}
+
+// ========== Geocentric Position ==========
+
+void LunarEphemeris::attachCache(std::shared_ptr<const LunarChebyshevCache> cache) {
+    m_cache = std::move(cache);
+}
+
+LunarGeocentric LunarEphemeris::computeGeocentric(double utcSeconds) const {
+    LunarGeocentric geo;
+    if (m_cache && m_cache->evaluate(utcSeconds, geo)) {
+        return geo;
+    }
+    return computeAnalytic(utcSeconds);
+}
+
+LunarGeocentric LunarEphemeris::computeAnalytic(double utcSeconds) const {
+    LunarGeocentric geo;
+    const double jdUT = julianDate(utcSeconds);
+    geo.julianDateUT = jdUT;
+
+    const double deltaT = m_fixedDeltaT ? m_deltaT : defaultDeltaT(2000.0 + (jdUT - JD_J2000) / 365.25);
+    const double T = (jdUT + deltaT / 86400.0 - JD_J2000) / 36525.0;
+    const double T2 = T * T;
+    const double T3 = T2 * T;
+    const double T4 = T3 * T;
+
+    // Fundamental arguments (Meeus 47.1 - 47.5), degrees.
+    const double Lp = reduceDegrees(218.3164477 + 481267.88123421 * T - 0.0015786 * T2 + T3 / 538841.0 - T4 / 65194000.0);
+    const double D = reduceDegrees(297.8501921 + 445267.1114034 * T - 0.0018819 * T2 + T3 / 545868.0 - T4 / 113065000.0);
+    const double M = reduceDegrees(357.5291092 + 35999.0502909 * T - 0.0001536 * T2 + T3 / 24490000.0);
+    const double Mp = reduceDegrees(134.9633964 + 477198.8675055 * T + 0.0087414 * T2 + T3 / 69699.0 - T4 / 14712000.0);
+    const double F = reduceDegrees(93.2720950 + 483202.0175233 * T - 0.0036539 * T2 - T3 / 3526000.0 + T4 / 863310000.0);
+    const double A1 = reduceDegrees(119.75 + 131.849 * T);
+    const double A2 = reduceDegrees(53.09 + 479264.290 * T);
+    const double A3 = reduceDegrees(313.45 + 481266.484 * T);
+    const double E = 1.0 - 0.002516 * T - 0.0000074 * T2;
+    const double eccentricity[3] = { 1.0, E, E * E };
+
+    Phasor pD[9], pM[9], pMp[9], pF[9];
+    buildPhasors(D * DEG, pD);
+    buildPhasors(M * DEG, pM);
+    buildPhasors(Mp * DEG, pMp);
+    buildPhasors(F * DEG, pF);
+
+    // Pair tables so each term costs one complex product. E^|m| is folded into
+    // the D/M table (terms in M carry the decreasing eccentricity of Earth's orbit).
+    Phasor pDM[5][5], pMpF[9][7];
+    for (int d = 0; d <= 4; ++d) {
+        for (int m = -2; m <= 2; ++m) {
+            Phasor z = multiply(pD[d + 4], pM[m + 4]);
+            double e = eccentricity[m < 0 ? -m : m];
+            pDM[d][m + 2] = { z.c * e, z.s * e };
+        }
+    }
+    for (int mp = -4; mp <= 4; ++mp) {
+        for (int f = -3; f <= 3; ++f) {
+            pMpF[mp + 4][f + 3] = multiply(pMp[mp + 4], pF[f + 4]);
+        }
+    }
+
+    double sumL = 0.0, sumR = 0.0, sumB = 0.0;
+    for (const PeriodicTerm& term : LONGITUDE_DISTANCE) {
+        Phasor z = multiply(pDM[term.d][term.m + 2], pMpF[term.mp + 4][term.f + 3]);
+        sumL += term.coefficient * z.s;
+        sumR += term.distance * z.c;
+    }
+    for (const PeriodicTerm& term : LATITUDE) {
+        Phasor z = multiply(pDM[term.d][term.m + 2], pMpF[term.mp + 4][term.f + 3]);
+        sumB += term.coefficient * z.s;
+    }
+
+    // Venus, Jupiter and flattening terms.
+    const Phasor pLp = phasor(Lp * DEG);
+    const Phasor pA1 = phasor(A1 * DEG);
+    const Phasor pA2 = phasor(A2 * DEG);
+    const Phasor pA3 = phasor(A3 * DEG);
+    sumL += 3958.0 * pA1.s + 1962.0 * multiply(pLp, pF[3]).s + 318.0 * pA2.s;
+    sumB += -2235.0 * pLp.s + 382.0 * pA3.s
+            + 175.0 * multiply(pA1, pF[3]).s + 175.0 * multiply(pA1, pF[5]).s
+            + 127.0 * multiply(pLp, pMp[3]).s - 115.0 * multiply(pLp, pMp[5]).s;
+
+    // Nutation and obliquity (Meeus ch. 22, low precision).
+    const Phasor pOmega = phasor((125.04452 - 1934.136261 * T) * DEG);
+    const Phasor pLsun = phasor((280.4665 + 36000.7698 * T) * DEG);
+    const Phasor p2Omega = multiply(pOmega, pOmega);
+    const Phasor p2Lsun = multiply(pLsun, pLsun);
+    const Phasor p2Lp = multiply(pLp, pLp);
+    const double dPsi = (-17.20 * pOmega.s - 1.32 * p2Lsun.s - 0.23 * p2Lp.s + 0.21 * p2Omega.s) * ARCSEC;
+    const double dEps = (9.20 * pOmega.c + 0.57 * p2Lsun.c + 0.10 * p2Lp.c - 0.09 * p2Omega.c) * ARCSEC;
+    const double eps = (84381.448 - 46.8150 * T - 0.00059 * T2 + 0.001813 * T3) * ARCSEC + dEps;
+
+    const double lambda = (Lp + sumL * 1e-6) * DEG + dPsi;
+    const double beta = sumB * 1e-6 * DEG;
+    geo.eclipticLongitude = lambda;
+    geo.eclipticLatitude = beta;
+    geo.distance_km = 385000.56 + sumR * 1e-3;
+
+    const double sinL = std::sin(lambda), cosL = std::cos(lambda);
+    const double sinB = std::sin(beta), cosB = std::cos(beta);
+    const double sinE = std::sin(eps), cosE = std::cos(eps);
+
+    // Ecliptic to equatorial of date.
+    const double ux = cosB * cosL;
+    const double uy = cosB * sinL * cosE - sinB * sinE;
+    const double uz = cosB * sinL * sinE + sinB * cosE;
+    geo.position_km[0] = geo.distance_km * ux;
+    geo.position_km[1] = geo.distance_km * uy;
+    geo.position_km[2] = geo.distance_km * uz;
+
+    geo.rightAscension = std::atan2(uy, ux);
+    if (geo.rightAscension < 0.0) geo.rightAscension += 2.0 * M_PI;
+    geo.declination = std::asin(uz);
+
+    // Apparent sidereal time at Greenwich (Meeus 12.4 plus equation of the equinoxes).
+    const double Tu = (jdUT - JD_J2000) / 36525.0;
+    const double gmst = reduceDegrees(280.46061837 + 360.98564736629 * (jdUT - JD_J2000)
+                                      + 0.000387933 * Tu * Tu - Tu * Tu * Tu / 38710000.0);
+    geo.siderealTime = gmst * DEG + dPsi * cosE;
+
+    return geo;
+}
+
+// ========== Topocentric Position ==========
+
+LunarTopocentric LunarEphemeris::toTopocentric(const LunarGeocentric& geo,
+                                               double latitude, double longitude, double height_km) const {
+    return observe(geo, makeStation(latitude, longitude, height_km));
+}
+
+// ========== Batch Evaluation ==========
+
+void LunarEphemeris::computeBatch(const double* utcSeconds, std::size_t count,
+                                  double latitude, double longitude, double height_km,
+                                  LunarTopocentric* results) const {
+    const Station station = makeStation(latitude, longitude, height_km);
+    for (std::size_t i = 0; i < count; ++i) {
+        results[i] = observe(computeGeocentric(utcSeconds[i]), station);
+    }
+}
+
+MoonEphemeris LunarEphemeris::computeMoonEphemeris(double utcSeconds,
+                                                   const SiteParameters& dx, const SiteParameters& home) const {
+    MoonEphemeris moon;
+    computeMoonEphemerisBatch(&utcSeconds, 1, dx, home, &moon);
+    return moon;
+}
+
+MoonEphemeris LunarEphemeris::computeMoonEphemerisRate(double utcSeconds,
+                                                       const SiteParameters& dx, const SiteParameters& home) const {
+    const double times[2] = { utcSeconds - RATE_STEP_S, utcSeconds + RATE_STEP_S };
+    MoonEphemeris ends[2];
+    computeMoonEphemerisBatch(times, 2, dx, home, ends);
+
+    const double scale = 1.0 / (2.0 * RATE_STEP_S);
+    auto angleRate = [&](double before, double after) {
+        return std::remainder(after - before, 2.0 * M_PI) * scale;
+    };
+    MoonEphemeris rate;
+    rate.rightAscension = angleRate(ends[0].rightAscension, ends[1].rightAscension);
+    rate.declination = (ends[1].declination - ends[0].declination) * scale;
+    rate.distance_km = (ends[1].distance_km - ends[0].distance_km) * scale;
+    rate.hourAngle_DX = angleRate(ends[0].hourAngle_DX, ends[1].hourAngle_DX);
+    rate.hourAngle_Home = angleRate(ends[0].hourAngle_Home, ends[1].hourAngle_Home);
+    rate.elevation_DX = (ends[1].elevation_DX - ends[0].elevation_DX) * scale;
+    rate.azimuth_DX = angleRate(ends[0].azimuth_DX, ends[1].azimuth_DX);
+    rate.elevation_Home = (ends[1].elevation_Home - ends[0].elevation_Home) * scale;
+    rate.azimuth_Home = angleRate(ends[0].azimuth_Home, ends[1].azimuth_Home);
+    rate.observationTime = 0;
+    rate.julianDate = 1.0 / 86400.0;
+    rate.ephemerisSource = "Rate";
+    return rate;
+}
+
+void LunarEphemeris::computeMoonEphemerisBatch(const double* utcSeconds, std::size_t count,
+                                               const SiteParameters& dx, const SiteParameters& home,
+                                               MoonEphemeris* results) const {
+    const Station stationDX = makeStation(dx.latitude, dx.longitude, 0.0);
+    const Station stationHome = makeStation(home.latitude, home.longitude, 0.0);
+
+    for (std::size_t i = 0; i < count; ++i) {
+        const LunarGeocentric geo = computeGeocentric(utcSeconds[i]);
+        const LunarTopocentric topoDX = observe(geo, stationDX);
+        const LunarTopocentric topoHome = observe(geo, stationHome);
+
+        MoonEphemeris& moon = results[i];
+        moon.rightAscension = geo.rightAscension;
+        moon.declination = geo.declination;
+        moon.distance_km = geo.distance_km;
+        moon.hourAngle_DX = std::remainder(geo.siderealTime + dx.longitude - geo.rightAscension, 2.0 * M_PI);
+        moon.hourAngle_Home = std::remainder(geo.siderealTime + home.longitude - geo.rightAscension, 2.0 * M_PI);
+        moon.elevation_DX = topoDX.elevation;
+        moon.azimuth_DX = topoDX.azimuth;
+        moon.elevation_Home = topoHome.elevation;
+        moon.azimuth_Home = topoHome.azimuth;
+        moon.observationTime = static_cast<std::time_t>(std::floor(utcSeconds[i]));
+        moon.julianDate = geo.julianDateUT;
+        moon.ephemerisSource = "Meeus ELP-2000/82";
+    }
+}
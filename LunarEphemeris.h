@@ -0,0 +1,104 @@
+#pragma once
+
+#include "Parameters.h"
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+
+class LunarChebyshevCache;
+
+// ========== Lunar Position Structures ==========
+
+// Apparent geocentric place, equator and equinox of date. Angles in radians.
+struct LunarGeocentric {
+    double julianDateUT = 0.0;
+    double eclipticLongitude = 0.0;
+    double eclipticLatitude = 0.0;
+    double rightAscension = 0.0;
+    double declination = 0.0;
+    double distance_km = 0.0;
+    double siderealTime = 0.0;      // Greenwich apparent sidereal time
+    double position_km[3] = { 0.0, 0.0, 0.0 };  // Equatorial of date, x toward the equinox
+};
+
+// Place seen from a station. Elevation is geometric (no refraction); azimuth is
+// measured from North through East.
+struct LunarTopocentric {
+    double rightAscension = 0.0;
+    double declination = 0.0;
+    double distance_km = 0.0;
+    double hourAngle = 0.0;
+    double elevation = 0.0;
+    double azimuth = 0.0;
+};
+
+// ========== Lunar Ephemeris ==========
+// Truncated ELP-2000/82 theory as tabulated by Meeus (Astronomical Algorithms,
+// ch. 47): 60 longitude/distance and 60 latitude terms, about 10" in longitude
+// and 4" in latitude, with low-precision nutation and the IAU 1982 sidereal time.
+// Each term's argument is an integer combination of D, M, M' and F, so the terms
+// are built from small tables of exp(ikX) instead of one sin/cos call apiece.
+//
+// Times are UTC seconds since 1970 (see GlotecSnapshotStore::toEpochSeconds);
+// station latitude/longitude are geodetic, in radians, east positive.
+
+class LunarEphemeris {
+public:
+    LunarEphemeris();
+
+    // TT - UT1 in seconds. Defaults to the Espenak-Meeus polynomial for the date.
+    void setDeltaT(double seconds);
+    void useDefaultDeltaT() { m_fixedDeltaT = false; }
+    bool hasFixedDeltaT() const { return m_fixedDeltaT; }
+    double getFixedDeltaT() const { return m_deltaT; }
+
+    // Bumped whenever the series or delta T model changes, so fits persisted by
+    // LunarChebyshevCache are refitted rather than reused.
+    static constexpr std::uint32_t THEORY_VERSION = 1;
+
+    // Served from the attached cache inside its span, otherwise from the series.
+    LunarGeocentric computeGeocentric(double utcSeconds) const;
+    LunarGeocentric computeAnalytic(double utcSeconds) const;
+
+    // The cache must have been built with the same delta T (see
+    // LunarChebyshevCache::matches).
+    void attachCache(std::shared_ptr<const LunarChebyshevCache> cache);
+    const std::shared_ptr<const LunarChebyshevCache>& getCache() const { return m_cache; }
+
+    LunarTopocentric toTopocentric(const LunarGeocentric& geo,
+                                   double latitude, double longitude, double height_km = 0.0) const;
+
+    // One station, many times.
+    void computeBatch(const double* utcSeconds, std::size_t count,
+                      double latitude, double longitude, double height_km,
+                      LunarTopocentric* results) const;
+
+    // Fills the fields FaradayRotation needs for both stations. Declination,
+    // right ascension, hour angles and distance are geocentric, so the parallactic
+    // angle stays self-consistent; elevation and azimuth are topocentric.
+    MoonEphemeris computeMoonEphemeris(double utcSeconds,
+                                       const SiteParameters& dx, const SiteParameters& home) const;
+    void computeMoonEphemerisBatch(const double* utcSeconds, std::size_t count,
+                                   const SiteParameters& dx, const SiteParameters& home,
+                                   MoonEphemeris* results) const;
+
+    // Time derivatives of those fields, per second (angles in rad/s), by a
+    // central difference over +-RATE_STEP_S, long enough to average out the
+    // rounding in the series and short against the curvature of the motion.
+    // For FaradayRotation::calculateSensitivity.
+    static constexpr double RATE_STEP_S = 30.0;
+    MoonEphemeris computeMoonEphemerisRate(double utcSeconds,
+                                           const SiteParameters& dx, const SiteParameters& home) const;
+
+    // Geodetic station on the reference ellipsoid: distance from the rotation
+    // axis and height above the equatorial plane, km.
+    static void stationRadii(double latitude, double height_km, double& axial_km, double& polar_km);
+
+    static double julianDate(double utcSeconds);
+    static double defaultDeltaT(double year);
+
+private:
+    bool m_fixedDeltaT;
+    double m_deltaT;
+    std::shared_ptr<const LunarChebyshevCache> m_cache;
+};
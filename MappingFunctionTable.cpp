@@ -0,0 +1,225 @@
+#define _USE_MATH_DEFINES
+#include "MappingFunctionTable.h"
+#include "IonospherePhysics.h"
+#include <cmath>
+#include <algorithm>
+#include <initializer_list>
+
+#ifndef M_PI
+#define M_PI 3.14159265358979323846
+#endif
+
+namespace {
+    // Folds elevation into [0, pi/2]; the mapping function is symmetric about zenith.
+    inline double foldElevation(double elevation) {
+        return std::max(0.0, std::min(elevation, M_PI - elevation));
+    }
+
+    inline double hermite(const double* value, const double* slope, int i, double t) {
+        double t2 = t * t;
+        double t3 = t2 * t;
+        return (2.0 * t3 - 3.0 * t2 + 1.0) * value[i] + (t3 - 2.0 * t2 + t) * slope[i] +
+               (3.0 * t2 - 2.0 * t3) * value[i + 1] + (t3 - t2) * slope[i + 1];
+    }
+}
+
+// ========== Mapping Function Slice ==========
+
+MappingFunctionSlice::MappingFunctionSlice()
+    : m_hmF2(0.0), m_step(1.0), m_invStep(1.0), m_scale(1.0) {
+}
+
+double MappingFunctionSlice::evaluate(double elevation) const {
+    double mapping;
+    evaluateBatch(&elevation, 1, &mapping);
+    return mapping;
+}
+
+void MappingFunctionSlice::evaluateBatch(
+    const double* elevation, std::size_t count, double* mapping) const {
+
+    const double* value = m_value.data();
+    const double* slope = m_slope.data();
+    const int lastCell = static_cast<int>(m_value.size()) - 2;
+
+    for (std::size_t n = 0; n < count; ++n) {
+        double position = foldElevation(elevation[n]) * m_invStep;
+        int i = std::min(static_cast<int>(position), lastCell);
+        double result = m_scale * hermite(value, slope, i, position - i);
+        mapping[n] = (elevation[n] < 0.0) ? 1.0 : result;
+    }
+}
+
+// ========== Table Construction ==========
+
+MappingFunctionTable::MappingFunctionTable(
+    double earthRadius_km, double tolerance, double minHeight_km, double maxHeight_km)
+    : m_earthRadius(earthRadius_km),
+      m_minHeight(minHeight_km),
+      m_maxHeight(maxHeight_km),
+      m_logMinHeight(std::log(minHeight_km)),
+      m_logStep(0.0), m_invLogStep(0.0),
+      m_step(0.0), m_invStep(0.0),
+      m_numElevations(0), m_numHeights(0),
+      m_maxRelativeError(0.0) {
+
+    double elevationStep = 0.5 * M_PI / 180.0;
+    int numHeights = 32;
+
+    for (int attempt = 0; attempt < 6; ++attempt) {
+        build(elevationStep, numHeights);
+        m_maxRelativeError = measureError();
+        // Cell-centre probes sit slightly below the true peak; keep a factor-two margin.
+        if (m_maxRelativeError <= 0.5 * tolerance) {
+            break;
+        }
+        elevationStep *= 0.5;
+        numHeights = numHeights * 3 / 2;
+    }
+}
+
+void MappingFunctionTable::build(double elevationStep, int numHeights) {
+    m_numElevations = static_cast<int>(std::ceil((M_PI / 2.0) / elevationStep)) + 1;
+    m_step = (M_PI / 2.0) / (m_numElevations - 1);
+    m_invStep = 1.0 / m_step;
+    m_numHeights = numHeights;
+    m_logStep = (std::log(m_maxHeight) - m_logMinHeight) / (numHeights - 1);
+    m_invLogStep = 1.0 / m_logStep;
+
+    m_value.resize(static_cast<size_t>(m_numHeights) * m_numElevations);
+    m_slope.resize(m_value.size());
+
+    for (int j = 0; j < m_numHeights; ++j) {
+        size_t base = static_cast<size_t>(j) * m_numElevations;
+        sampleColumn(std::exp(m_logMinHeight + j * m_logStep), &m_value[base], &m_slope[base]);
+    }
+}
+
+void MappingFunctionTable::sampleColumn(double hmF2, double* value, double* slope) const {
+    double k = m_earthRadius / (m_earthRadius + hmF2);
+    double k2 = k * k;
+    double root = std::sqrt(1.0 - k2);
+
+    for (int i = 0; i < m_numElevations; ++i) {
+        double c = std::cos(i * m_step);
+        double s = std::sin(i * m_step);
+        double M = 1.0 / std::sqrt(1.0 - k2 * c * c);
+
+        value[i] = M * root;
+        slope[i] = -k2 * c * s * M * M * M * root * m_step;
+    }
+}
+
+double MappingFunctionTable::measureError() const {
+    // Probe cell centres in both axes, where interpolation error peaks.
+    double worst = 0.0;
+
+    for (int j = 0; j < m_numHeights - 1; ++j) {
+        double h = std::exp(m_logMinHeight + (j + 0.5) * m_logStep);
+        for (int i = 0; i < m_numElevations - 1; ++i) {
+            for (double t : { 0.25, 0.5 }) {
+                double e = (i + t) * m_step;
+                double ref = IonospherePhysics::mappingFunction(e, h, m_earthRadius);
+                worst = std::max(worst, std::abs(evaluate(e, h) / ref - 1.0));
+            }
+        }
+    }
+
+    return worst;
+}
+
+// ========== Evaluation ==========
+
+double MappingFunctionTable::shellScale(double hmF2) const {
+    double k = m_earthRadius / (m_earthRadius + hmF2);
+    return 1.0 / std::sqrt(1.0 - k * k);
+}
+
+void MappingFunctionTable::heightWeights(double hmF2, int& row, double weights[4]) const {
+    double position = (std::log(hmF2) - m_logMinHeight) * m_invLogStep;
+    row = std::max(0, std::min(static_cast<int>(position) - 1, m_numHeights - 4));
+    double u = position - row;
+
+    weights[0] = -(u - 1.0) * (u - 2.0) * (u - 3.0) / 6.0;
+    weights[1] = u * (u - 2.0) * (u - 3.0) / 2.0;
+    weights[2] = -u * (u - 1.0) * (u - 3.0) / 2.0;
+    weights[3] = u * (u - 1.0) * (u - 2.0) / 6.0;
+}
+
+double MappingFunctionTable::evaluate(double elevation, double hmF2) const {
+    double mapping;
+    evaluateBatch(&elevation, &hmF2, 1, &mapping);
+    return mapping;
+}
+
+void MappingFunctionTable::evaluateBatch(
+    const double* elevation, const double* hmF2, std::size_t count, double* mapping) const {
+
+    const int lastCell = m_numElevations - 2;
+
+    for (std::size_t n = 0; n < count; ++n) {
+        if (elevation[n] < 0.0) {
+            mapping[n] = 1.0;
+            continue;
+        }
+        if (hmF2[n] < m_minHeight || hmF2[n] > m_maxHeight) {
+            mapping[n] = IonospherePhysics::mappingFunction(elevation[n], hmF2[n], m_earthRadius);
+            continue;
+        }
+
+        int row;
+        double weights[4];
+        heightWeights(hmF2[n], row, weights);
+
+        double position = foldElevation(elevation[n]) * m_invStep;
+        int i = std::min(static_cast<int>(position), lastCell);
+        double t = position - i;
+
+        double F = 0.0;
+        for (int q = 0; q < 4; ++q) {
+            size_t base = static_cast<size_t>(row + q) * m_numElevations;
+            F += weights[q] * hermite(&m_value[base], &m_slope[base], i, t);
+        }
+
+        mapping[n] = F * shellScale(hmF2[n]);
+    }
+}
+
+MappingFunctionSlice MappingFunctionTable::slice(double hmF2) const {
+    MappingFunctionSlice slice;
+    slice.m_hmF2 = hmF2;
+    slice.m_step = m_step;
+    slice.m_invStep = m_invStep;
+    slice.m_scale = shellScale(hmF2);
+    slice.m_value.resize(m_numElevations);
+    slice.m_slope.resize(m_numElevations);
+
+    if (hmF2 < m_minHeight || hmF2 > m_maxHeight) {
+        // Outside the tabulated heights: sample the closed form directly.
+        sampleColumn(hmF2, slice.m_value.data(), slice.m_slope.data());
+        return slice;
+    }
+
+    int row;
+    double weights[4];
+    heightWeights(hmF2, row, weights);
+
+    for (int i = 0; i < m_numElevations; ++i) {
+        double value = 0.0;
+        double slope = 0.0;
+        for (int q = 0; q < 4; ++q) {
+            size_t idx = static_cast<size_t>(row + q) * m_numElevations + i;
+            value += weights[q] * m_value[idx];
+            slope += weights[q] * m_slope[idx];
+        }
+        slice.m_value[i] = value;
+        slice.m_slope[i] = slope;
+    }
+
+    return slice;
+}
+
+const MappingFunctionTable& MappingFunctionTable::standard() {
+    static const MappingFunctionTable table;
+    return table;
+}
@@ -0,0 +1,85 @@
+#pragma once
+
+#include <cstddef>
+#include <vector>
+
+// ========== Mapping Function Slice ==========
+// The table collapsed to one hmF2: a single cubic Hermite lookup per elevation.
+// Built once per hmF2 and reused for whole sweeps.
+
+class MappingFunctionSlice {
+public:
+    MappingFunctionSlice();
+
+    double evaluate(double elevation) const;
+    void evaluateBatch(const double* elevation, std::size_t count, double* mapping) const;
+
+    double getHmF2() const { return m_hmF2; }
+
+private:
+    friend class MappingFunctionTable;
+
+    double m_hmF2;
+    double m_step;
+    double m_invStep;
+    double m_scale;
+    std::vector<double> m_value;
+    std::vector<double> m_slope;
+};
+
+// ========== Mapping Function Table ==========
+// Thin-shell mapping function 1 / cos(chi), sin(chi) = R cos(E) / (R + hmF2), tabulated
+// over (elevation, hmF2). Stored as F = M * sqrt(1 - k^2), k = R / (R + hmF2), which
+// removes the hmF2^-1/2 growth near the horizon: cubic Hermite in elevation, cubic
+// Lagrange in log(hmF2). The relative error is measured against the closed form at
+// construction and the grid is refined until it is below the requested tolerance.
+
+class MappingFunctionTable {
+public:
+    explicit MappingFunctionTable(
+        double earthRadius_km = 6371.0,
+        double tolerance = 1e-6,
+        double minHeight_km = 50.0,
+        double maxHeight_km = 2000.0);
+
+    // Elevation in radians, hmF2 in km. Negative elevation maps to 1.0.
+    double evaluate(double elevation, double hmF2) const;
+
+    void evaluateBatch(
+        const double* elevation,
+        const double* hmF2,
+        std::size_t count,
+        double* mapping) const;
+
+    MappingFunctionSlice slice(double hmF2) const;
+
+    double getEarthRadius() const { return m_earthRadius; }
+    double getMaxRelativeError() const { return m_maxRelativeError; }
+    std::size_t getTableSize() const { return m_value.size(); }
+
+    // Shared instance for the default Earth radius.
+    static const MappingFunctionTable& standard();
+
+private:
+    double m_earthRadius;
+    double m_minHeight;
+    double m_maxHeight;
+    double m_logMinHeight;
+    double m_logStep;
+    double m_invLogStep;
+    double m_step;
+    double m_invStep;
+    int m_numElevations;
+    int m_numHeights;
+    double m_maxRelativeError;
+
+    // Row-major [height][elevation]; slopes are pre-multiplied by the elevation step.
+    std::vector<double> m_value;
+    std::vector<double> m_slope;
+
+    void build(double elevationStep, int numHeights);
+    void sampleColumn(double hmF2, double* value, double* slope) const;
+    double measureError() const;
+    double shellScale(double hmF2) const;
+    void heightWeights(double hmF2, int& row, double weights[4]) const;
+};
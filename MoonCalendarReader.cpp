@@ -1,6 +1,8 @@
 #define _USE_MATH_DEFINES
 #define _CRT_SECURE_NO_WARNINGS
 #include "MoonCalendarReader.h"
+#include "LunarChebyshevCache.h"
+#include "GlotecSnapshotStore.h"
 #include <fstream>
 #include <sstream>
 #include <cmath>
@@ -17,7 +19,7 @@ MoonCalendarReader::MoonCalendarReader() : m_loaded(false) {
 
 // ========== Load Calendar File ==========
 
-bool MoonCalendarReader::loadCalendarFile(const std::string& filename) {
+bool MoonCalendarReader::loadCalendarFile(const std::string& filename, int firstYear) {
     std::ifstream file(filename);
     if (!file.is_open()) {
         return false;
@@ -28,6 +30,9 @@ bool MoonCalendarReader::loadCalendarFile(const std::string& filename) {
 
     std::getline(file, line);
 
+    int year = firstYear;
+    int previousKey = -1;
+
     while (std::getline(file, line)) {
         if (line.empty() || line[0] == '#') continue;
 
@@ -36,120 +41,171 @@ bool MoonCalendarReader::loadCalendarFile(const std::string& filename) {
         MoonCalendarEntry entry;
 
         if (iss >> dateStr >> entry.declination >> entry.pathloss >> entry.sunOffset >> entry.noise) {
-            int month, day;
-            if (sscanf(dateStr.c_str(), "%d-%d", &month, &day) == 2) {
-                entry.date.tm_year = 2026 - 1900;
-                entry.date.tm_mon = month - 1;
-                entry.date.tm_mday = day;
-                entry.date.tm_hour = 0;
-                entry.date.tm_min = 0;
-                entry.date.tm_sec = 0;
-                entry.date.tm_isdst = -1;
-
-                m_entries.push_back(entry);
+            int fileYear, month, day;
+            int entryYear;
+            if (sscanf(dateStr.c_str(), "%d-%d-%d", &fileYear, &month, &day) == 3) {
+                entryYear = fileYear;
+            } else if (sscanf(dateStr.c_str(), "%d-%d", &month, &day) == 2) {
+                int key = month * 32 + day;
+                if (previousKey >= 0 && key <= previousKey) {
+                    ++year;
+                }
+                previousKey = key;
+                entryYear = year;
+            } else {
+                continue;
             }
+
+            entry.date = std::tm{};
+            entry.date.tm_year = entryYear - 1900;
+            entry.date.tm_mon = month - 1;
+            entry.date.tm_mday = day;
+            entry.date.tm_isdst = -1;
+            entry.epoch = static_cast<double>(GlotecSnapshotStore::toEpochSeconds(entry.date));
+
+            m_entries.push_back(entry);
         }
     }
 
+    std::stable_sort(m_entries.begin(), m_entries.end(),
+                     [](const MoonCalendarEntry& a, const MoonCalendarEntry& b) { return a.epoch < b.epoch; });
+    m_entries.erase(std::unique(m_entries.begin(), m_entries.end(),
+                                [](const MoonCalendarEntry& a, const MoonCalendarEntry& b) { return a.epoch == b.epoch; }),
+                    m_entries.end());
+
+    buildStencils();
+
     m_loaded = !m_entries.empty();
+    m_filename = filename;
     return m_loaded;
 }
 
-// ========== Get Moon Declination ==========
-
-bool MoonCalendarReader::getMoonDeclination(const std::tm& date, double& declination) {
-    if (!m_loaded || m_entries.empty()) {
-        return false;
-    }
+std::string MoonCalendarReader::getEphemerisCachePath() const {
+    return LunarChebyshevCache::pathBeside(m_filename);
+}
 
-    double targetDay = dateToDayOfYear(date);
+// ========== Interpolation Stencils ==========
 
-    for (size_t i = 0; i < m_entries.size(); ++i) {
-        double entryDay = dateToDayOfYear(m_entries[i].date);
+void MoonCalendarReader::buildStencils() {
+    const std::size_t n = m_entries.size();
+    m_epochs.resize(n);
+    for (std::size_t i = 0; i < n; ++i) {
+        m_epochs[i] = m_entries[i].epoch;
+    }
 
-        if (std::abs(entryDay - targetDay) < 0.0001) {
-            declination = m_entries[i].declination;
-            return true;
+    m_stencils.assign(n > 1 ? n - 1 : 0, Stencil{});
+    for (std::size_t j = 0; j + 1 < n; ++j) {
+        // Entries j-1 .. j+2, fewer at the ends.
+        const std::size_t lo = (j >= 1) ? j - 1 : 0;
+        const std::size_t hi = std::min(j + 2, n - 1);
+        const std::size_t points = hi - lo + 1;
+
+        double x[4], d[4];
+        for (std::size_t k = 0; k < points; ++k) {
+            x[k] = (m_epochs[lo + k] - m_epochs[j]) / 86400.0;
+            d[k] = m_entries[lo + k].declination;
         }
 
-        if (entryDay > targetDay) {
-            if (i == 0) {
-                declination = m_entries[0].declination;
-                return true;
+        // Newton divided differences, then expand to powers of u.
+        for (std::size_t level = 1; level < points; ++level) {
+            for (std::size_t k = points - 1; k >= level; --k) {
+                d[k] = (d[k] - d[k - 1]) / (x[k] - x[k - level]);
             }
+        }
 
-            std::vector<double> xPoints, yPoints;
-
-            size_t startIdx = (i >= 2) ? (i - 2) : 0;
-            size_t endIdx = std::min(i + 2, m_entries.size());
-
-            for (size_t j = startIdx; j < endIdx; ++j) {
-                xPoints.push_back(dateToDayOfYear(m_entries[j].date));
-                yPoints.push_back(m_entries[j].declination);
+        double* c = m_stencils[j].c;
+        c[0] = d[points - 1];
+        std::size_t degree = 0;
+        for (std::size_t k = points - 1; k-- > 0;) {
+            c[degree + 1] = c[degree];
+            for (std::size_t i = degree; i >= 1; --i) {
+                c[i] = c[i - 1] - x[k] * c[i];
             }
-
-            declination = lagrangeInterpolate(targetDay, xPoints, yPoints);
-            return true;
+            c[0] = d[k] - x[k] * c[0];
+            ++degree;
         }
     }
+}
 
-    declination = m_entries.back().declination;
-    return true;
+std::size_t MoonCalendarReader::findInterval(double utcSeconds) const {
+    // Caller guarantees m_epochs.front() <= utcSeconds < m_epochs.back().
+    auto it = std::upper_bound(m_epochs.begin(), m_epochs.end(), utcSeconds);
+    return static_cast<std::size_t>(it - m_epochs.begin()) - 1;
 }
 
-// ========== Helper Functions ==========
+double MoonCalendarReader::evaluate(std::size_t interval, double utcSeconds) const {
+    const double u = (utcSeconds - m_epochs[interval]) / 86400.0;
+    const double* c = m_stencils[interval].c;
+    return c[0] + u * (c[1] + u * (c[2] + u * c[3]));
+}
 
-double MoonCalendarReader::dateToDayOfYear(const std::tm& date) const {
-    static const int daysInMonth[] = {31, 28, 31, 30, 31, 30, 31, 31, 30, 31, 30, 31};
+// ========== Get Moon Declination ==========
 
-    int dayOfYear = date.tm_mday;
+bool MoonCalendarReader::getMoonDeclination(const std::tm& date, double& declination) const {
+    return getMoonDeclination(static_cast<double>(GlotecSnapshotStore::toEpochSeconds(date)), declination);
+}
 
-    for (int m = 0; m < date.tm_mon; ++m) {
-        dayOfYear += daysInMonth[m];
-    }
+bool MoonCalendarReader::getMoonDeclination(double utcSeconds, double& declination) const {
+    return getMoonDeclinationBatch(&utcSeconds, 1, &declination);
+}
 
-    int year = date.tm_year + 1900;
-    bool isLeapYear = (year % 4 == 0 && year % 100 != 0) || (year % 400 == 0);
-    if (isLeapYear && date.tm_mon > 1) {
-        dayOfYear += 1;
+bool MoonCalendarReader::getMoonDeclinationBatch(const double* utcSeconds, std::size_t count,
+                                                 double* declination) const {
+    if (!m_loaded || m_entries.empty()) {
+        return false;
     }
 
-    double fractionalDay = static_cast<double>(dayOfYear);
-    fractionalDay += date.tm_hour / 24.0;
-    fractionalDay += date.tm_min / 1440.0;
-    fractionalDay += date.tm_sec / 86400.0;
+    const double first = m_epochs.front();
+    const double last = m_epochs.back();
+    std::size_t interval = 0;
 
-    return fractionalDay;
-}
+    for (std::size_t i = 0; i < count; ++i) {
+        const double t = utcSeconds[i];
+        if (!(t > first)) {
+            declination[i] = m_entries.front().declination;
+            continue;
+        }
+        if (!(t < last)) {
+            declination[i] = m_entries.back().declination;
+            continue;
+        }
 
-double MoonCalendarReader::linearInterpolate(double x, double x1, double y1, double x2, double y2) const {
-    if (x2 == x1) {
-        return y1;
+        if (!(t >= m_epochs[interval] && t < m_epochs[interval + 1])) {
+            // Next interval is the common case for sweeps.
+            if (interval + 2 < m_epochs.size() && t >= m_epochs[interval + 1] && t < m_epochs[interval + 2]) {
+                ++interval;
+            } else {
+                interval = findInterval(t);
+            }
+        }
+        declination[i] = evaluate(interval, t);
     }
-    return y1 + (y2 - y1) * (x - x1) / (x2 - x1);
-}
 
-// ========== Lagrange Interpolation ==========
+    return true;
+}
 
-double MoonCalendarReader::lagrangeInterpolate(double x, const std::vector<double>& xPoints, const std::vector<double>& yPoints) const {
-    if (xPoints.size() != yPoints.size() || xPoints.empty()) {
-        return 0.0;
+bool MoonCalendarReader::getMoonConditions(double utcSeconds, MoonCalendarEntry& conditions) const {
+    if (!getMoonDeclination(utcSeconds, conditions.declination)) {
+        return false;
     }
 
-    double result = 0.0;
-    size_t n = xPoints.size();
-
-    for (size_t i = 0; i < n; ++i) {
-        double term = yPoints[i];
+    conditions.epoch = utcSeconds;
+    conditions.date = GlotecSnapshotStore::fromEpochSeconds(static_cast<std::int64_t>(std::floor(utcSeconds)));
 
-        for (size_t j = 0; j < n; ++j) {
-            if (i != j) {
-                term *= (x - xPoints[j]) / (xPoints[i] - xPoints[j]);
-            }
-        }
-
-        result += term;
+    if (!(utcSeconds > m_epochs.front()) || !(utcSeconds < m_epochs.back())) {
+        const MoonCalendarEntry& edge = (utcSeconds < m_epochs.back()) ? m_entries.front() : m_entries.back();
+        conditions.pathloss = edge.pathloss;
+        conditions.sunOffset = edge.sunOffset;
+        conditions.noise = edge.noise;
+        return true;
     }
 
-    return result;
+    const std::size_t i = findInterval(utcSeconds);
+    const MoonCalendarEntry& a = m_entries[i];
+    const MoonCalendarEntry& b = m_entries[i + 1];
+    const double u = (utcSeconds - m_epochs[i]) / (m_epochs[i + 1] - m_epochs[i]);
+    conditions.pathloss = a.pathloss + u * (b.pathloss - a.pathloss);
+    conditions.sunOffset = a.sunOffset + u * (b.sunOffset - a.sunOffset);
+    conditions.noise = a.noise + u * (b.noise - a.noise);
+    return true;
 }
@@ -4,11 +4,13 @@
 #include <vector>
 #include <map>
 #include <ctime>
+#include <cstddef>
 
 // ========== Moon Calendar Entry ==========
 
 struct MoonCalendarEntry {
     std::tm date;
+    double epoch;       // 00:00 UTC of the date, seconds since 1970
     double declination;
     double pathloss;
     double sunOffset;
@@ -16,22 +18,54 @@ struct MoonCalendarEntry {
 };
 
 // ========== Moon Calendar Reader ==========
+// Dates may be "YYYY-MM-DD" or the legacy "MM-DD". Yearless rows start in
+// `firstYear` and roll into the next year whenever the date goes backwards, so
+// a file may span several years either way. Entries are indexed by absolute
+// time; each interval keeps the cubic through its four neighbouring entries
+// (the same stencil the per-query Lagrange interpolation used), so a lookup is
+// a binary search and one polynomial. Queries outside the calendar clamp to the
+// first or last entry.
 
 class MoonCalendarReader {
 public:
+    static constexpr int DEFAULT_FIRST_YEAR = 2026;
+
     MoonCalendarReader();
 
-    bool loadCalendarFile(const std::string& filename);
+    bool loadCalendarFile(const std::string& filename, int firstYear = DEFAULT_FIRST_YEAR);
+
+    bool getMoonDeclination(const std::tm& date, double& declination) const;
+    bool getMoonDeclination(double utcSeconds, double& declination) const;
+
+    // Many times at once; sorted times reuse the previous interval instead of
+    // searching again.
+    bool getMoonDeclinationBatch(const double* utcSeconds, std::size_t count, double* declination) const;
 
-    bool getMoonDeclination(const std::tm& date, double& declination);
+    // All columns at one time: declination as above, pathloss, sun offset and
+    // noise linearly between entries. `date` and `epoch` are those of the query.
+    bool getMoonConditions(double utcSeconds, MoonCalendarEntry& conditions) const;
 
     bool isLoaded() const { return m_loaded; }
+    const std::vector<MoonCalendarEntry>& getEntries() const { return m_entries; }
+    double getStart() const { return m_epochs.empty() ? 0.0 : m_epochs.front(); }
+    double getEnd() const { return m_epochs.empty() ? 0.0 : m_epochs.back(); }
+
+    // Where the lunar Chebyshev cache for this calendar lives (see LunarChebyshevCache).
+    std::string getEphemerisCachePath() const;
 
 private:
+    // Declination = c[0] + u (c[1] + u (c[2] + u c[3])), u in days from the interval start.
+    struct Stencil {
+        double c[4];
+    };
+
     std::vector<MoonCalendarEntry> m_entries;
+    std::vector<double> m_epochs;
+    std::vector<Stencil> m_stencils;     // one per interval [m_epochs[i], m_epochs[i + 1])
     bool m_loaded;
+    std::string m_filename;
 
-    double dateToDayOfYear(const std::tm& date) const;
-    double linearInterpolate(double x, double x1, double y1, double x2, double y2) const;
-    double lagrangeInterpolate(double x, const std::vector<double>& xPoints, const std::vector<double>& yPoints) const;
+    void buildStencils();
+    std::size_t findInterval(double utcSeconds) const;
+    double evaluate(std::size_t interval, double utcSeconds) const;
 };
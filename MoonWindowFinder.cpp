@@ -0,0 +1,333 @@
+#include "MoonWindowFinder.h"
+#include <algorithm>
+#include <atomic>
+#include <cmath>
+#include <memory>
+#include <thread>
+
+namespace {
+    // Bound on |d sin(elevation) / dt| for the moon is cos(latitude) times the
+    // sidereal rate plus the moon's declination and parallax motion, 1/s (with
+    // margin).
+    constexpr double HOUR_ANGLE_RATE = 7.4e-5;
+    constexpr double MOON_MOTION_RATE = 4.0e-6;
+}
+
+// ========== Constructor ==========
+
+MoonWindowFinder::MoonWindowFinder(const LunarEphemeris& ephemeris)
+    : m_ephemeris(ephemeris), m_start(0.0), m_step(0.0), m_sinMinElevation(0.0) {
+}
+
+// ========== Geometry ==========
+
+MoonWindowFinder::Station MoonWindowFinder::makeStation(const SiteParameters& site) {
+    Station station;
+    station.sinLat = std::sin(site.latitude);
+    station.cosLat = std::cos(site.latitude);
+    station.cosLon = std::cos(site.longitude);
+    station.sinLon = std::sin(site.longitude);
+    LunarEphemeris::stationRadii(site.latitude, 0.0, station.axial_km, station.polar_km);
+    station.plfCC = station.plfSS = station.plfCS = 0.0;
+    station.elevationRate = HOUR_ANGLE_RATE * station.cosLat + MOON_MOTION_RATE;
+    station.elevationCurvature = HOUR_ANGLE_RATE * station.elevationRate;
+    return station;
+}
+
+MoonWindowFinder::Sample MoonWindowFinder::sampleAt(double utcSeconds) const {
+    double position[3], sidereal;
+    if (!m_cache || !m_cache->evaluatePosition(utcSeconds, position, sidereal)) {
+        const LunarGeocentric geo = m_ephemeris.computeGeocentric(utcSeconds);
+        std::copy(geo.position_km, geo.position_km + 3, position);
+        sidereal = geo.siderealTime;
+    }
+
+    Sample sample;
+    sample.x = position[0];
+    sample.y = position[1];
+    sample.z = position[2];
+    sample.cosG = std::cos(sidereal);
+    sample.sinG = std::sin(sidereal);
+    const double rhoSquared = sample.x * sample.x + sample.y * sample.y;
+    const double inverseDistance = 1.0 / std::sqrt(rhoSquared + sample.z * sample.z);
+    const double rho = std::sqrt(rhoSquared);
+    sample.inverseRho = 1.0 / rho;
+    sample.sinDec = sample.z * inverseDistance;
+    sample.cosDec = rho * inverseDistance;
+    return sample;
+}
+
+MoonWindowFinder::Geometry MoonWindowFinder::observe(const Sample& sample, const Station& station) {
+    // Local sidereal time by angle addition, so no trig per station and step.
+    const double cosLST = sample.cosG * station.cosLon - sample.sinG * station.sinLon;
+    const double sinLST = sample.sinG * station.cosLon + sample.cosG * station.sinLon;
+
+    const double dx = sample.x - station.axial_km * cosLST;
+    const double dy = sample.y - station.axial_km * sinLST;
+    const double dz = sample.z - station.polar_km;
+    const double up = station.cosLat * (dx * cosLST + dy * sinLST) + station.sinLat * dz;
+
+    Geometry view;
+    view.sinElevation = up / std::sqrt(dx * dx + dy * dy + dz * dz);
+    view.cosH = (sample.x * cosLST + sample.y * sinLST) * sample.inverseRho;
+    view.sinH = (sample.x * sinLST - sample.y * cosLST) * sample.inverseRho;
+    return view;
+}
+
+// The Jones chain of FaradayRotation::calculate without Faraday terms is
+// R(nu_home) M R(nu_dx) = M R(nu_dx - nu_home), so with delta = nu_dx - nu_home
+// the received amplitude is cos(delta) A + sin(delta) B for two constants of
+// the station pair.
+void MoonWindowFinder::couple(const SiteParameters& home, const SiteParameters& dxSite, Station& dx) const {
+    const JonesVector tx = m_jones.createJonesVector(dxSite.psi, dxSite.chi);
+    const JonesVector rx = m_jones.createJonesVector(home.psi, home.chi);
+    const Matrix2x2 M = m_jones.createMoonReflectionMatrix();
+
+    const std::complex<double> A = m_jones.vectorDotProduct(rx, m_jones.matrixVectorMultiply(M, tx));
+    const std::complex<double> B = m_jones.vectorDotProduct(rx, m_jones.matrixVectorMultiply(
+        M, m_jones.matrixVectorMultiply(m_jones.createRotationMatrix(0.5 * SystemConstants::PI), tx)));
+
+    dx.plfCC = std::norm(A);
+    dx.plfSS = std::norm(B);
+    dx.plfCS = std::real(A * std::conj(B));
+}
+
+double MoonWindowFinder::spatialPLF(const Sample& sample, const Station& home, const Station& dx,
+                                    const Geometry& homeView, const Geometry& dxView) const {
+    // Parallactic angles as unnormalized (cos, sin) pairs, the atan2 arguments of
+    // FaradayRotation::calculateParallacticAngle.
+    const double sinDX = dxView.sinH * dx.cosLat;
+    const double cosDX = dx.sinLat * sample.cosDec - dx.cosLat * sample.sinDec * dxView.cosH;
+    const double sinHome = homeView.sinH * home.cosLat;
+    const double cosHome = home.sinLat * sample.cosDec - home.cosLat * sample.sinDec * homeView.cosH;
+
+    const double c = cosDX * cosHome + sinDX * sinHome;
+    const double s = sinDX * cosHome - cosDX * sinHome;
+    const double normSquared = c * c + s * s;
+    if (!(normSquared > 0.0)) {
+        return dx.plfCC;
+    }
+    return (c * c * dx.plfCC + s * s * dx.plfSS + 2.0 * c * s * dx.plfCS) / normSquared;
+}
+
+// Positive while the link is usable. Elevation terms are in sin(elevation). The
+// DX view is skipped while the moon is down at home and the PLF is only
+// evaluated once both elevations pass; the sign stays right and, unless the
+// limit is PLF, so do the rate bounds the scan relies on.
+double MoonWindowFinder::margin(const Sample& sample, const Geometry& homeView,
+                                const Station& home, const Station& dx, Limit& limit) const {
+    limit = Limit::HOME_ELEVATION;
+    double value = homeView.sinElevation - m_sinMinElevation;
+    if (value <= 0.0) {
+        return value;
+    }
+
+    const Geometry dxView = observe(sample, dx);
+    const double dxValue = dxView.sinElevation - m_sinMinElevation;
+    if (dxValue < value) {
+        limit = Limit::DX_ELEVATION;
+        value = dxValue;
+    }
+    if (value > 0.0 && m_options.minPLF > 0.0) {
+        limit = Limit::PLF;
+        value = std::min(value, spatialPLF(sample, home, dx, homeView, dxView) - m_options.minPLF);
+    }
+    return value;
+}
+
+// ========== Edge Refinement ==========
+
+// Illinois regula falsi on a bracket with fa, fb of opposite sign. Returns the
+// bracket end on the usable side.
+double MoonWindowFinder::refine(double a, double fa, double b, double fb,
+                                const Station& home, const Station& dx) const {
+    int side = 0;
+    for (int iteration = 0; iteration < 60 && b - a > m_options.tolerance_s; ++iteration) {
+        double c = (a * fb - b * fa) / (fb - fa);
+        if (!(c > a && c < b) || iteration >= 30) {
+            c = 0.5 * (a + b);
+        }
+
+        const Sample sample = sampleAt(c);
+        Limit limit;
+        const double fc = margin(sample, observe(sample, home), home, dx, limit);
+
+        if ((fc > 0.0) == (fa > 0.0)) {
+            a = c;
+            fa = fc;
+            if (side == -1) fb *= 0.5;
+            side = -1;
+        } else {
+            b = c;
+            fb = fc;
+            if (side == 1) fa *= 0.5;
+            side = 1;
+        }
+    }
+    return (fa > 0.0) ? a : b;
+}
+
+// ========== Scanning ==========
+
+void MoonWindowFinder::keep(const MoonWindow& window, std::vector<MoonWindow>& windows) const {
+    if (window.duration_s() >= m_options.minDuration_s) {
+        windows.push_back(window);
+    }
+}
+
+// Follows the margin from fa at a to fb at b, splitting at the midpoint while
+// the interval could hide a sign change. Elevation-limited ends bound how soon
+// the margin can turn positive, which prunes most splits. PLF has no such
+// bound, so with minPLF set an interval is split until it is no longer than
+// minDuration_s wherever the PLF may be in play: any window (or gap inside one)
+// that long then contains a split point.
+void MoonWindowFinder::bracket(double a, double fa, Limit la, double b, double fb, Limit lb,
+                               Scan& scan) const {
+    const bool resolved = b - a <= std::max(m_options.tolerance_s, m_options.minDuration_s);
+    if (fa <= 0.0 && fb <= 0.0) {
+        const double reach = scan.rate * (b - a);
+        const bool elevationA = la != Limit::PLF;
+        const bool elevationB = lb != Limit::PLF;
+        if (resolved || (elevationA && elevationB && -(fa + fb) >= reach) ||
+            (elevationA && -fa >= reach) || (elevationB && -fb >= reach)) {
+            return;
+        }
+    } else if (resolved || !(m_options.minPLF > 0.0)) {
+        if ((fb > 0.0) != (fa > 0.0)) {
+            const double edge = refine(a, fa, b, fb, scan.home, scan.dx);
+            if (fb > 0.0) {
+                scan.window.start = edge;
+                scan.open = true;
+            } else {
+                scan.window.end = edge;
+                keep(scan.window, scan.windows);
+                scan.open = false;
+            }
+        }
+        return;
+    }
+
+    const double c = 0.5 * (a + b);
+    const Sample sample = sampleAt(c);
+    Limit lc;
+    const double fc = margin(sample, observe(sample, scan.home), scan.home, scan.dx, lc);
+    bracket(a, fa, la, c, fc, lc, scan);
+    bracket(c, fc, lc, b, fb, lb, scan);
+}
+
+void MoonWindowFinder::scanStation(std::size_t index, const Station& home, const Station& dx,
+                                   std::vector<MoonWindow>& windows) const {
+    const std::size_t last = m_samples.size() - 1;
+    const double rate = std::max(home.elevationRate, dx.elevationRate);
+    const double stepRate = rate * m_step;
+
+    Limit limit;
+    double previous = margin(m_samples[0], m_homeViews[0], home, dx, limit);
+
+    Scan scan{ home, dx, rate, MoonWindow(), previous > 0.0, windows };
+    scan.window.station = index;
+    scan.window.start = m_start;
+
+    std::size_t i = 0;
+    while (i < last) {
+        std::size_t skip = 1;
+        if (limit != Limit::PLF) {
+            skip = std::max<std::size_t>(1, static_cast<std::size_t>(std::fabs(previous) / stepRate));
+        }
+        const std::size_t j = std::min(i + skip, last);
+
+        const Limit previousLimit = limit;
+        const double current = margin(m_samples[j], m_homeViews[j], home, dx, limit);
+        const double a = m_start + m_step * static_cast<double>(i);
+        const double b = m_start + m_step * static_cast<double>(j);
+        if (current <= 0.0 && previous <= 0.0 && previousLimit != Limit::PLF && limit != Limit::PLF) {
+            // Both ends down. A short window (e.g. the moon setting at home while
+            // rising at DX) may still fit between, but only if each station's
+            // elevation, bent by at most its curvature bound, can clear the limit.
+            if (-(previous + current) < stepRate * static_cast<double>(j - i)) {
+                const double span = 0.125 * (b - a) * (b - a);
+                const double homeHigh = std::max(m_homeViews[i].sinElevation, m_homeViews[j].sinElevation);
+                const double dxHigh = std::max(observe(m_samples[i], dx).sinElevation,
+                                               observe(m_samples[j], dx).sinElevation);
+                if (homeHigh + home.elevationCurvature * span > m_sinMinElevation &&
+                    dxHigh + dx.elevationCurvature * span > m_sinMinElevation) {
+                    bracket(a, previous, previousLimit, b, current, limit, scan);
+                }
+            }
+        } else {
+            bracket(a, previous, previousLimit, b, current, limit, scan);
+        }
+        previous = current;
+        i = j;
+    }
+
+    if (scan.open) {
+        scan.window.end = m_start + m_step * static_cast<double>(last);
+        keep(scan.window, windows);
+    }
+}
+
+bool MoonWindowFinder::findWindows(const SiteParameters& home, const std::vector<SiteParameters>& dx,
+                                   double from, double days, std::vector<MoonWindow>& windows) {
+    windows.clear();
+    if (!(days > 0.0) || !(m_options.step_s > 0.0) || !(m_options.tolerance_s > 0.0)) {
+        m_error = "Invalid horizon, step or tolerance";
+        return false;
+    }
+
+    const double to = from + days * 86400.0;
+
+    // One shared ephemeris fit for the whole horizon.
+    const auto& cache = m_ephemeris.getCache();
+    if (!cache || !cache->covers(from, to)) {
+        auto fitted = std::make_shared<LunarChebyshevCache>();
+        if (!fitted->build(m_ephemeris, from, to)) {
+            m_error = fitted->getError();
+            return false;
+        }
+        m_ephemeris.attachCache(fitted);
+    }
+    m_cache = m_ephemeris.getCache();
+
+    const Station homeStation = makeStation(home);
+    const std::size_t steps = static_cast<std::size_t>(std::ceil((to - from) / m_options.step_s));
+    m_start = from;
+    m_step = (to - from) / static_cast<double>(steps);
+    m_sinMinElevation = std::sin(ParameterUtils::deg2rad(m_options.minElevation_deg));
+
+    m_samples.resize(steps + 1);
+    m_homeViews.resize(steps + 1);
+    for (std::size_t i = 0; i <= steps; ++i) {
+        m_samples[i] = sampleAt(m_start + m_step * static_cast<double>(i));
+        m_homeViews[i] = observe(m_samples[i], homeStation);
+    }
+
+    std::vector<std::vector<MoonWindow>> perStation(dx.size());
+    std::atomic<std::size_t> next(0);
+    auto worker = [&]() {
+        for (std::size_t i = next++; i < dx.size(); i = next++) {
+            Station station = makeStation(dx[i]);
+            couple(home, dx[i], station);
+            scanStation(i, homeStation, station, perStation[i]);
+        }
+    };
+
+    unsigned threads = m_options.threads ? m_options.threads : std::thread::hardware_concurrency();
+    threads = static_cast<unsigned>(std::min<std::size_t>(std::max(threads, 1u), std::max<std::size_t>(dx.size(), 1)));
+
+    std::vector<std::thread> pool;
+    for (unsigned i = 1; i < threads; ++i) {
+        pool.emplace_back(worker);
+    }
+    worker();
+    for (std::thread& thread : pool) {
+        thread.join();
+    }
+
+    for (const auto& stationWindows : perStation) {
+        windows.insert(windows.end(), stationWindows.begin(), stationWindows.end());
+    }
+
+    m_error.clear();
+    return true;
+}
@@ -0,0 +1,136 @@
+#pragma once
+
+#include "Parameters.h"
+#include "LunarEphemeris.h"
+#include "FaradayRotation.h"
+#include "LunarChebyshevCache.h"
+#include <cstddef>
+#include <memory>
+#include <string>
+#include <vector>
+
+// ========== Moon Window Options ==========
+
+struct MoonWindowOptions {
+    double minElevation_deg;    // at both stations
+    double minPLF;              // spatial-rotation PLF, 0 disables
+    double step_s;              // scan step
+    double tolerance_s;         // edge refinement
+    double minDuration_s;       // shorter windows are dropped (one T/R period)
+    unsigned threads;           // 0 uses every hardware thread
+
+    MoonWindowOptions()
+        : minElevation_deg(0.0), minPLF(0.0), step_s(600.0),
+          tolerance_s(1.0), minDuration_s(60.0), threads(0) {}
+};
+
+// ========== Moon Window ==========
+
+struct MoonWindow {
+    std::size_t station;        // index into the DX list
+    double start;               // UTC seconds since 1970
+    double end;
+
+    double duration_s() const { return end - start; }
+};
+
+// ========== Moon Window Finder ==========
+// Mutual moon visibility between one home station and many DX stations. The
+// moon is sampled once per scan step for the whole horizon (from a
+// LunarChebyshevCache, built on the fly if the ephemeris has none covering it)
+// and every station reuses those samples, so the per-station scan is a few
+// multiply-adds per step. Since sin(elevation) changes no faster than the
+// Earth turns, the scan jumps over steps where an elevation margin cannot have
+// changed sign, and rate/curvature bounds decide when a step with both ends
+// down could still hide a short window (one station setting as the other
+// rises). Each sign change is then refined by Illinois regula falsi inside its
+// bracket. Stations are spread over a thread pool.
+//
+// The PLF test uses the geometric chain only (parallactic angles, station
+// polarizations and the moon reflection), since Faraday rotation needs
+// ionosphere data per time and station. The PLF obeys no rate bound, so with
+// minPLF set, every step where it may decide the margin is halved down to
+// minDuration_s. Windows and PLF dips at least that long are found, at the
+// cost of about fifteen extra evaluations per such step.
+
+class MoonWindowFinder {
+public:
+    explicit MoonWindowFinder(const LunarEphemeris& ephemeris = LunarEphemeris());
+
+    void setOptions(const MoonWindowOptions& options) { m_options = options; }
+    const MoonWindowOptions& getOptions() const { return m_options; }
+
+    // Windows over [from, from + days * 86400), sorted by station then start.
+    // Windows open at either end of the horizon are clipped to it.
+    bool findWindows(const SiteParameters& home, const std::vector<SiteParameters>& dx,
+                     double from, double days, std::vector<MoonWindow>& windows);
+
+    const std::string& getError() const { return m_error; }
+
+private:
+    struct Sample {
+        double x, y, z;             // geocentric moon, km
+        double cosG, sinG;          // Greenwich apparent sidereal time
+        double inverseRho;          // 1 / sqrt(x^2 + y^2)
+        double sinDec, cosDec;
+    };
+
+    struct Station {
+        double sinLat, cosLat;
+        double cosLon, sinLon;
+        double axial_km, polar_km;
+        double plfCC, plfSS, plfCS;  // DX only: PLF = cc cos^2 + ss sin^2 + 2 cs cos sin
+        double elevationRate;       // bound on |d sin(elevation) / dt|, 1/s
+        double elevationCurvature;  // bound on |d2 sin(elevation) / dt2|, 1/s^2
+    };
+
+    // Which term set the margin. Elevation margins obey the rate bounds above.
+    enum class Limit {
+        HOME_ELEVATION,
+        DX_ELEVATION,
+        PLF
+    };
+
+    struct Geometry {
+        double sinElevation;
+        double cosH, sinH;          // geocentric hour angle
+    };
+
+    // One station's scan in progress.
+    struct Scan {
+        const Station& home;
+        const Station& dx;
+        double rate;                // bound on the margin's rate while elevation-limited
+        MoonWindow window;          // start is set while open
+        bool open;
+        std::vector<MoonWindow>& windows;
+    };
+
+    LunarEphemeris m_ephemeris;
+    std::shared_ptr<const LunarChebyshevCache> m_cache;
+    MoonWindowOptions m_options;
+    FaradayRotation m_jones;
+    std::string m_error;
+
+    std::vector<Sample> m_samples;
+    std::vector<Geometry> m_homeViews;
+    double m_start;
+    double m_step;
+    double m_sinMinElevation;
+
+    static Station makeStation(const SiteParameters& site);
+    void couple(const SiteParameters& home, const SiteParameters& dxSite, Station& dx) const;
+    static Geometry observe(const Sample& sample, const Station& station);
+    Sample sampleAt(double utcSeconds) const;
+
+    double margin(const Sample& sample, const Geometry& homeView,
+                  const Station& home, const Station& dx, Limit& limit) const;
+    double spatialPLF(const Sample& sample, const Station& home, const Station& dx,
+                      const Geometry& homeView, const Geometry& dxView) const;
+    double refine(double a, double fa, double b, double fb,
+                  const Station& home, const Station& dx) const;
+    void bracket(double a, double fa, Limit la, double b, double fb, Limit lb, Scan& scan) const;
+    void keep(const MoonWindow& window, std::vector<MoonWindow>& windows) const;
+    void scanStation(std::size_t index, const Station& home, const Station& dx,
+                     std::vector<MoonWindow>& windows) const;
+};
@@ -1,11 +1,11 @@
 #define _CRT_SECURE_NO_WARNINGS
 #include "NOAAGlotecReader.h"
-#include "SimpleHttpClient.h"
 #include <sstream>
 #include <iomanip>
 #include <cmath>
 #include <algorithm>
-#include <regex>
+#include <filesystem>
+#include <fstream>
 
 NOAAGlotecReader::NOAAGlotecReader()
     : m_baseUrl("https://services.swpc.noaa.gov/products/glotec/geojson_2d_urt/") {
@@ -51,6 +51,13 @@ std::tm NOAAGlotecReader::roundToNearest5Minutes(const std::tm& time, bool round
     return rounded;
 }
 
+void NOAAGlotecReader::setBaseUrl(const std::string& baseUrl) {
+    m_baseUrl = baseUrl;
+    if (!m_baseUrl.empty() && m_baseUrl.back() != '/') {
+        m_baseUrl += '/';
+    }
+}
+
 std::string NOAAGlotecReader::getDataUrl(const std::tm& time) const {
     std::tm rounded = roundToNearest5Minutes(time, true);
 
@@ -70,70 +77,7 @@ std::string NOAAGlotecReader::getDataUrl(const std::tm& time) const {
 }
 
 bool NOAAGlotecReader::parseGeoJson(const std::string& jsonContent, GlotecData& data) {
-    data.tecValues.clear();
-    data.isValid = false;
-
-    std::regex coordRegex(R"("coordinates"\s*:\s*\[\s*(-?\d+\.?\d*)\s*,\s*(-?\d+\.?\d*)\s*\])");
-    std::regex tecRegex(R"("tec"\s*:\s*(-?\d+\.?\d*))");
-
-    auto coordBegin = std::sregex_iterator(jsonContent.begin(), jsonContent.end(), coordRegex);
-    auto coordEnd = std::sregex_iterator();
-    auto tecBegin = std::sregex_iterator(jsonContent.begin(), jsonContent.end(), tecRegex);
-
-    std::vector<double> lons, lats;
-    std::vector<float> tecs;
-
-    for (auto it = coordBegin; it != coordEnd; ++it) {
-        std::smatch match = *it;
-        double lon = std::stod(match[1].str());
-        double lat = std::stod(match[2].str());
-        lons.push_back(lon);
-        lats.push_back(lat);
-    }
-
-    for (auto it = tecBegin; it != std::sregex_iterator(); ++it) {
-        std::smatch match = *it;
-        float tec = std::stof(match[1].str());
-        tecs.push_back(tec);
-    }
-
-    if (lons.size() != tecs.size() || lons.empty()) {
-        return false;
-    }
-
-    double minLat = *std::min_element(lats.begin(), lats.end());
-    double maxLat = *std::max_element(lats.begin(), lats.end());
-    double minLon = *std::min_element(lons.begin(), lons.end());
-
-    data.latStart = minLat;
-    data.lonStart = minLon;
-
-    std::vector<double> uniqueLats = lats;
-    std::sort(uniqueLats.begin(), uniqueLats.end());
-    uniqueLats.erase(std::unique(uniqueLats.begin(), uniqueLats.end()), uniqueLats.end());
-
-    if (uniqueLats.size() > 1) {
-        data.latStep = uniqueLats[1] - uniqueLats[0];
-        data.numLat = static_cast<int>(uniqueLats.size());
-    }
-
-    data.numLon = 72;
-    data.lonStep = 5.0;
-
-    data.tecValues.resize(data.numLon * data.numLat, 0.0f);
-
-    for (size_t i = 0; i < lons.size(); ++i) {
-        int col = static_cast<int>(std::round((lons[i] - data.lonStart) / data.lonStep));
-        int row = static_cast<int>(std::round((lats[i] - data.latStart) / data.latStep));
-
-        if (col >= 0 && col < data.numLon && row >= 0 && row < data.numLat) {
-            int idx = getGridIndex(col, row, data.numLon);
-            data.tecValues[idx] = tecs[i];
-        }
-    }
-
-    data.isValid = true;
-    return true;
+    return m_parser.parse(jsonContent, data);
 }
 
 int NOAAGlotecReader::getGridIndex(int col, int row, int numCols) const {
@@ -188,18 +132,125 @@ bool NOAAGlotecReader::getTecAtLocation(const GlotecData& data, double lat, doub
     return true;
 }
 
-bool NOAAGlotecReader::fetchTecData(const std::tm& requestTime, GlotecData& data) {
-    std::string url = getDataUrl(requestTime);
-    std::string jsonContent;
+bool NOAAGlotecReader::fetchAndParse(const std::string& url, GlotecData& data) {
+    // The body is parsed as it downloads; the connection stays open for the next refresh.
+    m_parser.begin(data);
+
+    bool received = m_http.get(url, [this](const char* bytes, std::size_t length) {
+        return m_parser.feed(bytes, length);
+    });
 
-    if (!SimpleHttpClient::fetchUrl(url, jsonContent)) {
-        std::tm roundedTime = roundToNearest5Minutes(requestTime, false);
-        url = getDataUrl(roundedTime);
-        if (!SimpleHttpClient::fetchUrl(url, jsonContent)) {
+    return received && m_parser.finish();
+}
+
+bool NOAAGlotecReader::parseFile(const std::string& path, GlotecData& data) {
+    std::ifstream file(path, std::ios::binary);
+    if (!file) {
+        return false;
+    }
+
+    m_fileBuffer.resize(64 * 1024);
+    m_parser.begin(data);
+
+    while (file) {
+        file.read(m_fileBuffer.data(), static_cast<std::streamsize>(m_fileBuffer.size()));
+        if (file.gcount() > 0 && !m_parser.feed(m_fileBuffer.data(), static_cast<std::size_t>(file.gcount()))) {
             return false;
         }
     }
 
-    data.timestamp = roundToNearest5Minutes(requestTime, true);
-    return parseGeoJson(jsonContent, data);
+    return m_parser.finish();
+}
+
+bool NOAAGlotecReader::fetchProduct(const std::tm& epoch, GlotecData& data) {
+    const std::int64_t seconds = GlotecSnapshotStore::toEpochSeconds(epoch);
+    const std::tm normalized = GlotecSnapshotStore::fromEpochSeconds(seconds);
+
+    if (m_store && m_store->load(seconds, data)) {
+        return true;
+    }
+
+    std::string url = getDataUrl(normalized);
+    bool parsed = isReplaying()
+        ? parseFile((std::filesystem::path(m_replayDirectory) / url.substr(url.rfind('/') + 1)).string(), data)
+        : fetchAndParse(url, data);
+
+    if (!parsed) {
+        return false;
+    }
+
+    data.timestamp = normalized;
+    if (m_store) {
+        m_store->save(data);
+    }
+    return true;
+}
+
+bool NOAAGlotecReader::fetchTecData(const std::tm& requestTime, GlotecData& data) {
+    // The product at or before the requested time, then the following one.
+    const std::tm candidates[2] = {
+        roundToNearest5Minutes(requestTime, true),
+        roundToNearest5Minutes(requestTime, false)
+    };
+
+    for (const std::tm& epoch : candidates) {
+        if (fetchProduct(epoch, data)) {
+            return true;
+        }
+    }
+    return false;
+}
+
+// ========== Snapshot Store and Replay ==========
+
+bool NOAAGlotecReader::openSnapshotStore(const std::string& directory) {
+    auto store = std::make_unique<GlotecSnapshotStore>(directory);
+    if (!store->open()) {
+        return false;
+    }
+
+    m_store = std::move(store);
+    return true;
+}
+
+void NOAAGlotecReader::setReplayDirectory(const std::string& directory) {
+    m_replayDirectory = directory;
+}
+
+std::size_t NOAAGlotecReader::replayAll(const std::function<bool(const GlotecData&)>& onEpoch) {
+    namespace fs = std::filesystem;
+
+    std::vector<std::pair<std::int64_t, fs::path>> products;
+    std::error_code ec;
+
+    for (const fs::directory_entry& entry : fs::directory_iterator(m_replayDirectory, ec)) {
+        std::string name = entry.path().filename().string();
+        std::int64_t epoch;
+        if (name.rfind("glotec", 0) == 0 && entry.path().extension() == ".geojson" &&
+            GlotecSnapshotStore::parseStamp(name, epoch)) {
+            products.emplace_back(epoch, entry.path());
+        }
+    }
+    std::sort(products.begin(), products.end());
+
+    std::size_t parsed = 0;
+    GlotecData data;
+
+    for (const auto& product : products) {
+        if (!parseFile(product.second.string(), data)) {
+            continue;
+        }
+
+        data.timestamp = GlotecSnapshotStore::fromEpochSeconds(product.first);
+        if (m_store) {
+            m_store->save(data);
+        }
+        ++parsed;
+
+        if (!onEpoch(data)) {
+            break;
+        }
+    }
+
+    return parsed;
 }
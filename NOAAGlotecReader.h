@@ -1,5 +1,10 @@
 #pragma once
 
+#include "GlotecGeoJsonParser.h"
+#include "GlotecSnapshotStore.h"
+#include "SimpleHttpClient.h"
+#include <functional>
+#include <memory>
 #include <string>
 #include <vector>
 #include <ctime>
@@ -31,13 +36,49 @@ public:
 
     std::string getDataUrl(const std::tm& time) const;
 
+    // Points the reader at a mirror or a local test server.
+    void setBaseUrl(const std::string& baseUrl);
+
+    // Every product fetched afterwards is saved as a binary grid, and later requests
+    // for a stored epoch are answered from disk.
+    bool openSnapshotStore(const std::string& directory);
+    const GlotecSnapshotStore* getSnapshotStore() const { return m_store.get(); }
+
+    // Replay: products are read from saved GeoJSON files named as on the server
+    // (glotec_icao_YYYYMMDDTHHMMSSZ.geojson) instead of being downloaded.
+    // An empty directory switches back to the network.
+    void setReplayDirectory(const std::string& directory);
+    bool isReplaying() const { return !m_replayDirectory.empty(); }
+
+    // Parses every product in the replay directory in time order, saves it to the
+    // snapshot store if one is open and passes it to onEpoch (return false to stop).
+    // Returns the number of products parsed.
+    std::size_t replayAll(const std::function<bool(const GlotecData&)>& onEpoch);
+
+    // Diagnostics from the most recent parse.
+    const std::vector<GlotecFeatureError>& getFeatureErrors() const { return m_parser.getFeatureErrors(); }
+    std::size_t getFeatureErrorCount() const { return m_parser.getFeatureErrorCount(); }
+    const std::string& getParseError() const { return m_parser.getError(); }
+    const std::string& getHttpError() const { return m_http.getError(); }
+
 private:
     std::string m_baseUrl;
+    GlotecGeoJsonParser m_parser;
+    SimpleHttpClient m_http;
+    std::unique_ptr<GlotecSnapshotStore> m_store;
+    std::string m_replayDirectory;
+    std::vector<char> m_fileBuffer;
 
     std::tm roundToNearest5Minutes(const std::tm& time, bool roundDown) const;
 
     bool parseGeoJson(const std::string& jsonContent, GlotecData& data);
 
+    bool fetchAndParse(const std::string& url, GlotecData& data);
+
+    bool parseFile(const std::string& path, GlotecData& data);
+
+    bool fetchProduct(const std::tm& epoch, GlotecData& data);
+
     double bilinearInterpolate(const GlotecData& data, double lat, double lon) const;
 
     int getGridIndex(int col, int row, int numCols) const;
@@ -1,6 +1,7 @@
 #pragma once
 
 #include <string>
+#include <vector>
 #include <ctime>
 #include <cmath>
 
@@ -106,7 +107,7 @@ struct SystemConfiguration {
           includeSpatialRotation(true),
           includeMoonReflection(true),
           ionoModel(IonosphereModel::SIMPLE),
-          magModel(MagneticFieldModel::DIPOLE) {}
+          magModel(MagneticFieldModel::WMM) {}
 };
 
 // ========== Calculation Results ==========
@@ -147,6 +148,91 @@ struct CalculationResults {
           calculationTime(0) {}
 };
 
+// ========== Band Results ==========
+// One frequency of a multi-band calculation. Geometry, vTEC and slant factors
+// do not depend on frequency and stay in the CalculationResults of the link.
+struct BandResult {
+    double frequency_MHz;
+    double faradayRotation_DX_deg;
+    double faradayRotation_Home_deg;
+    double totalRotation_deg;
+    double PLF;
+    double polarizationLoss_dB;
+
+    BandResult()
+        : frequency_MHz(0.0),
+          faradayRotation_DX_deg(0.0),
+          faradayRotation_Home_deg(0.0),
+          totalRotation_deg(0.0),
+          PLF(0.0),
+          polarizationLoss_dB(0.0) {}
+};
+
+// ========== Passband Results ==========
+// The configured bandwidth sampled on bins frequencies. Rotation varies as
+// 1/f^2 across the passband, which smears the polarization: depolarization is
+// 1 - |mean of exp(2i theta)| over the bins, 0 when every bin arrives with the
+// same polarization. rotationSpread_deg is the Faraday rotation difference
+// between the band edges.
+struct PassbandResult {
+    int bins;
+    double bandwidth_Hz;
+    double averagePLF;
+    double minPLF;
+    double maxPLF;
+    double averageLoss_dB;
+    double rotationSpread_deg;
+    double depolarization;
+
+    PassbandResult()
+        : bins(0), bandwidth_Hz(0.0),
+          averagePLF(0.0), minPLF(0.0), maxPLF(0.0), averageLoss_dB(0.0),
+          rotationSpread_deg(0.0), depolarization(0.0) {}
+};
+
+// ========== Polarization Solution ==========
+// What the Home station could receive from the wave that arrives. An antenna
+// matched to the arriving psi/chi gets PLF 1; a rotator keeping the station's
+// own chi gets optimalPLF at optimalPsi_deg. A dual-polarization receiver pairs
+// the configured antenna (co) with its orthogonal twin (cross); maximal-ratio
+// combining adds their SNRs, so combinedPLF = co + crossGain * cross.
+struct PolarizationSolution {
+    double arrivalPsi_deg;
+    double arrivalChi_deg;
+    double optimalPsi_deg;      // (-90, 90]
+    double optimalPLF;
+    double coPLF;
+    double crossPLF;
+    double combinedPLF;
+    double combined_dB;
+
+    PolarizationSolution()
+        : arrivalPsi_deg(0.0), arrivalChi_deg(0.0),
+          optimalPsi_deg(0.0), optimalPLF(0.0),
+          coPLF(0.0), crossPLF(0.0), combinedPLF(0.0), combined_dB(0.0) {}
+};
+
+// ========== PLF Sensitivity ==========
+// PLF of a link and its partial derivatives, from forward-mode automatic
+// differentiation (FaradayRotation::calculateSensitivity). The time
+// derivatives follow the moon, and the ionosphere too when its rates are given;
+// otherwise the drift of the TEC maps enters only through the vTEC terms.
+struct PLFSensitivity {
+    static constexpr int INPUTS = 5;    // vTEC DX/Home, |B| DX/Home, time
+
+    double PLF;
+    double dPLF_dvTEC_DX;       // per TECU
+    double dPLF_dvTEC_Home;
+    double dPLF_dB_DX;          // per nT of field magnitude
+    double dPLF_dB_Home;
+    double dPLF_dTime;          // per second
+    double dRotation_dTime;     // total rotation, deg per second
+
+    PLFSensitivity()
+        : PLF(0.0), dPLF_dvTEC_DX(0.0), dPLF_dvTEC_Home(0.0),
+          dPLF_dB_DX(0.0), dPLF_dB_Home(0.0), dPLF_dTime(0.0), dRotation_dTime(0.0) {}
+};
+
 // ========== Utility Functions ==========
 namespace ParameterUtils {
     inline double deg2rad(double degrees) {
@@ -186,4 +272,12 @@ namespace ParameterUtils {
 		if (freq_MHz >= 300000) return "Sub-mm";
         return "OOB";
     }
+
+    // A common EME frequency in each band from 6m to 3cm.
+    inline const std::vector<double>& getEMEFrequencies() {
+        static const std::vector<double> frequencies_MHz = {
+            50.19, 144.12, 432.05, 1296.05, 2424.1, 5760.1, 10368.1
+        };
+        return frequencies_MHz;
+    }
 }
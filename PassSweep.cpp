@@ -0,0 +1,320 @@
+#include "PassSweep.h"
+#include "IonosphereDataProvider.h"
+#include "LunarChebyshevCache.h"
+#include "GlotecSnapshotStore.h"
+#include <algorithm>
+#include <cmath>
+#include <ctime>
+#include <memory>
+
+namespace {
+    // Step growth per accepted step, as in embedded Runge-Kutta controllers.
+    constexpr double SAFETY = 0.9;
+    constexpr double MAX_GROWTH = 4.0;
+
+    // Cubic Hermite through (f0, slope r0) and (f1, slope r1) over a span h,
+    // at fraction s of it.
+    double hermite(double f0, double r0, double f1, double r1, double h, double s) {
+        const double s2 = s * s, s3 = s2 * s;
+        return (2.0 * s3 - 3.0 * s2 + 1.0) * f0 + (s3 - 2.0 * s2 + s) * h * r0 +
+               (3.0 * s2 - 2.0 * s3) * f1 + (s3 - s2) * h * r1;
+    }
+}
+
+// ========== Profile ==========
+
+PassSample PassProfile::evaluate(double utcSeconds) const {
+    PassSample sample;
+    sample.time = utcSeconds;
+    if (m_nodes.empty()) {
+        return sample;
+    }
+
+    const double time = std::clamp(utcSeconds, m_nodes.front().time, m_nodes.back().time);
+    auto after = std::upper_bound(m_nodes.begin(), m_nodes.end(), time,
+                                  [](double t, const PassNode& node) { return t < node.time; });
+    if (after == m_nodes.end()) {
+        --after;
+    }
+    if (after == m_nodes.begin()) {
+        ++after;
+    }
+
+    if (after == m_nodes.end()) {
+        sample.totalRotation_deg = m_nodes.front().totalRotation_deg;
+        sample.PLF = m_nodes.front().PLF;
+    } else {
+        const PassNode& a = *(after - 1);
+        const PassNode& b = *after;
+        const double h = b.time - a.time;
+        const double s = (time - a.time) / h;
+        sample.totalRotation_deg = hermite(a.totalRotation_deg, a.rotationRate,
+                                           b.totalRotation_deg, b.rotationRate, h, s);
+        sample.PLF = hermite(a.PLF, a.PLFRate, b.PLF, b.PLFRate, h, s);
+    }
+    sample.PLF = std::clamp(sample.PLF, 0.0, 1.0);
+    sample.polarizationLoss_dB = 10.0 * std::log10(sample.PLF);
+    return sample;
+}
+
+void PassProfile::resample(double step_s, std::vector<PassSample>& samples) const {
+    samples.clear();
+    if (m_nodes.empty()) {
+        return;
+    }
+    if (!(step_s > 0.0)) {
+        for (const PassNode& node : m_nodes) {
+            samples.push_back(evaluate(node.time));
+        }
+        return;
+    }
+
+    const double start = getStart(), end = getEnd();
+    const std::size_t steps = static_cast<std::size_t>(std::ceil((end - start) / step_s));
+    samples.reserve(steps + 1);
+    for (std::size_t k = 0; k < steps; ++k) {
+        samples.push_back(evaluate(start + static_cast<double>(k) * step_s));
+    }
+    samples.push_back(evaluate(end));
+}
+
+// ========== Constructor ==========
+
+PassSweep::PassSweep(const LunarEphemeris& ephemeris)
+    : m_ephemeris(ephemeris), m_provider(nullptr), m_evaluations(0), m_rejected(0) {
+}
+
+// ========== Nodes ==========
+
+bool PassSweep::evaluate(const SiteParameters& dx, const SiteParameters& home, double time,
+                         PassNode& node, PassNode* right) {
+    ++m_evaluations;
+    const MoonEphemeris moon = m_ephemeris.computeMoonEphemeris(time, dx, home);
+    const MoonEphemeris moonRate = m_ephemeris.computeMoonEphemerisRate(time, dx, home);
+
+    // TEC and field at the piercing points now and RATE_STEP_S either side;
+    // the moon there is close enough to its tangent line.
+    const double step = LunarEphemeris::RATE_STEP_S;
+    IonosphereData samples[3];
+    bool faraday = false;
+    if (m_provider && m_provider->hasTecData() && m_config.includeFaradayRotation) {
+        std::tm stamps[3];
+        double elevationDX[3], azimuthDX[3], elevationHome[3], azimuthHome[3];
+        for (int k = 0; k < 3; ++k) {
+            const double offset = (k - 1) * step;
+            stamps[k] = GlotecSnapshotStore::fromEpochSeconds(static_cast<std::int64_t>(std::floor(time + offset)));
+            elevationDX[k] = moon.elevation_DX + moonRate.elevation_DX * offset;
+            azimuthDX[k] = moon.azimuth_DX + moonRate.azimuth_DX * offset;
+            elevationHome[k] = moon.elevation_Home + moonRate.elevation_Home * offset;
+            azimuthHome[k] = moon.azimuth_Home + moonRate.azimuth_Home * offset;
+        }
+        faraday = m_provider->getIonosphereDataAtIPPBatch(
+            stamps, ParameterUtils::rad2deg(dx.latitude), ParameterUtils::rad2deg(dx.longitude),
+            elevationDX, azimuthDX,
+            ParameterUtils::rad2deg(home.latitude), ParameterUtils::rad2deg(home.longitude),
+            elevationHome, azimuthHome, 3, samples);
+    }
+
+    node.time = time;
+    if (right) {
+        right->time = time;
+    }
+
+    // On a corner of the TEC data the two sides get one-sided differences.
+    if (right) {
+        return solve(dx, home, moon, moonRate, samples[1], faraday,
+                     drift(samples[0], samples[1], step), node) &&
+               solve(dx, home, moon, moonRate, samples[1], faraday,
+                     drift(samples[1], samples[2], step), *right);
+    }
+    return solve(dx, home, moon, moonRate, samples[1], faraday,
+                 drift(samples[0], samples[2], 2.0 * step), node);
+}
+
+IonosphereData PassSweep::drift(const IonosphereData& before, const IonosphereData& after, double interval) {
+    const double scale = 1.0 / interval;
+    const double turn = 2.0 * SystemConstants::PI;
+    IonosphereData rate;
+    rate.vTEC_DX = (after.vTEC_DX - before.vTEC_DX) * scale;
+    rate.vTEC_Home = (after.vTEC_Home - before.vTEC_Home) * scale;
+    rate.hmF2_DX = (after.hmF2_DX - before.hmF2_DX) * scale;
+    rate.hmF2_Home = (after.hmF2_Home - before.hmF2_Home) * scale;
+    rate.B_magnitude_DX = (after.B_magnitude_DX - before.B_magnitude_DX) * scale;
+    rate.B_magnitude_Home = (after.B_magnitude_Home - before.B_magnitude_Home) * scale;
+    rate.B_inclination_DX = (after.B_inclination_DX - before.B_inclination_DX) * scale;
+    rate.B_inclination_Home = (after.B_inclination_Home - before.B_inclination_Home) * scale;
+    rate.B_declination_DX = std::remainder(after.B_declination_DX - before.B_declination_DX, turn) * scale;
+    rate.B_declination_Home = std::remainder(after.B_declination_Home - before.B_declination_Home, turn) * scale;
+    return rate;
+}
+
+bool PassSweep::solve(const SiteParameters& dx, const SiteParameters& home,
+                      const MoonEphemeris& moon, const MoonEphemeris& moonRate,
+                      const IonosphereData& iono, bool faraday, const IonosphereData& ionoRate,
+                      PassNode& node) {
+    SystemConfiguration config = m_config;
+    config.includeFaradayRotation = faraday;
+    m_calculator.setConfiguration(config);
+    m_calculator.setDXStation(dx);
+    m_calculator.setHomeStation(home);
+    m_calculator.setIonosphereData(faraday ? iono : IonosphereData());
+    m_calculator.setMoonEphemeris(moon);
+
+    PLFSensitivity sensitivity;
+    const CalculationResults result = m_calculator.calculateSensitivity(moonRate, sensitivity,
+                                                                       faraday ? &ionoRate : nullptr);
+    if (!result.calculationSuccess) {
+        m_error = result.errorMessage;
+        return false;
+    }
+
+    node.totalRotation_deg = result.totalRotation_deg;
+    node.rotationRate = sensitivity.dRotation_dTime;
+    node.PLF = result.PLF;
+    node.PLFRate = sensitivity.dPLF_dTime;
+    node.faraday = faraday;
+    return true;
+}
+
+// Largest miss of the cubic through a and b at the (whole-second) midpoint m,
+// over tolerance; 1 is at tolerance.
+double PassSweep::stepError(const PassNode& a, const PassNode& b, const PassNode& m) const {
+    const double h = b.time - a.time;
+    const double s = (m.time - a.time) / h;
+    const double rotation = std::fabs(hermite(a.totalRotation_deg, a.rotationRate,
+                                              b.totalRotation_deg, b.rotationRate, h, s) - m.totalRotation_deg);
+    const double plf = std::fabs(hermite(a.PLF, a.PLFRate, b.PLF, b.PLFRate, h, s) - m.PLF);
+    return std::max({ rotation / m_options.rotationTolerance_deg, plf / m_options.plfTolerance,
+                      bend(a, m), bend(m, b) });
+}
+
+// A corner right at the midpoint fools that test, so each half must also agree
+// with its end slopes: the cubic term of the Hermite cubic,
+// |h (f'p + f'q) - 2 (fq - fp)| / 8 at the middle, over tolerance.
+double PassSweep::bend(const PassNode& p, const PassNode& q) const {
+    const double h = q.time - p.time;
+    const double rotation = std::fabs(h * (p.rotationRate + q.rotationRate) -
+                                      2.0 * (q.totalRotation_deg - p.totalRotation_deg)) / 8.0;
+    const double plf = std::fabs(h * (p.PLFRate + q.PLFRate) - 2.0 * (q.PLF - p.PLF)) / 8.0;
+    return std::max(rotation / m_options.rotationTolerance_deg, plf / m_options.plfTolerance);
+}
+
+// The parallactic angles jump by 360 degrees where they pass 180; keep the
+// rotation continuous with the slopes.
+void PassSweep::unwrap(const PassNode& a, PassNode& b) {
+    const double predicted = a.totalRotation_deg + 0.5 * (b.time - a.time) * (a.rotationRate + b.rotationRate);
+    b.totalRotation_deg += 360.0 * std::round((predicted - b.totalRotation_deg) / 360.0);
+}
+
+// ========== Sweep ==========
+
+bool PassSweep::sweep(const SiteParameters& dx, const SiteParameters& home,
+                      double from, double to, PassProfile& profile) {
+    profile.clear();
+    m_evaluations = 0;
+    m_rejected = 0;
+    if (!(m_options.rotationTolerance_deg > 0.0) || !(m_options.plfTolerance > 0.0) ||
+        !(m_options.minStep_s >= 1.0) || !(m_options.maxStep_s >= m_options.minStep_s) ||
+        !(m_options.initialStep_s > 0.0)) {
+        m_error = "Invalid sweep options";
+        return false;
+    }
+    // Nodes sit on whole seconds, the resolution the TEC is looked up at.
+    from = std::ceil(from);
+    to = std::floor(to);
+    if (!(to > from)) {
+        m_error = "Empty sweep range";
+        return false;
+    }
+    if (m_config.includeFaradayRotation &&
+        m_config.ionoModel == SystemConfiguration::IonosphereModel::CHAPMAN) {
+        m_error = "Pass sweeps need the thin-shell (SIMPLE) ionosphere model";
+        return false;
+    }
+
+    // One ephemeris fit for the pass, including the rate steps past its ends.
+    const double margin = LunarEphemeris::RATE_STEP_S;
+    const auto& cache = m_ephemeris.getCache();
+    if (!cache || !cache->covers(from - margin, to + margin)) {
+        auto fitted = std::make_shared<LunarChebyshevCache>();
+        if (!fitted->build(m_ephemeris, from - margin, to + margin)) {
+            m_error = fitted->getError();
+            return false;
+        }
+        m_ephemeris.attachCache(fitted);
+    }
+
+    // IONEX maps are interpolated linearly in time, so TEC turns a corner at
+    // every map epoch; nodes are placed on those, with a slope for each side.
+    const double minStep = m_options.minStep_s;
+    const double maxStep = m_options.maxStep_s;
+    std::vector<double> corners;
+    const auto reader = m_provider ? m_provider->getIonexReader() : nullptr;
+    if (m_config.includeFaradayRotation && reader && m_provider->isIonexLoaded() &&
+        m_provider->getTecSources().empty() && reader->getHeader().interval > 0) {
+        const double interval = reader->getHeader().interval;
+        const double first = static_cast<double>(GlotecSnapshotStore::toEpochSeconds(reader->getHeader().epochFirst));
+        for (double t = first + std::ceil((from + minStep - first) / interval) * interval;
+             t < to - minStep; t += interval) {
+            corners.push_back(t);
+        }
+    }
+
+    PassNode a;
+    if (!evaluate(dx, home, from, a)) {
+        return false;
+    }
+    profile.addNode(a);
+
+    double h = std::clamp(m_options.initialStep_s, minStep, maxStep);
+    std::size_t corner = 0;
+    PassNode b, bRight;
+    bool haveEnd = false;
+    bool onCorner = false;
+    while (a.time < to) {
+        if (!haveEnd) {
+            // Finish on `to` or the next corner, without leaving a sliver
+            // shorter than minStep.
+            const double limit = corner < corners.size() ? corners[corner] : to;
+            const bool reach = limit - a.time - h < minStep;
+            onCorner = reach && corner < corners.size();
+            if (!evaluate(dx, home, reach ? limit : std::round(a.time + h), b, onCorner ? &bRight : nullptr)) {
+                return false;
+            }
+            unwrap(a, b);
+            bRight.totalRotation_deg = b.totalRotation_deg;
+        }
+        haveEnd = false;
+
+        const double step = b.time - a.time;
+        if (step >= 2.0 * minStep) {
+            PassNode m;
+            if (!evaluate(dx, home, std::round(a.time + 0.5 * step), m)) {
+                return false;
+            }
+            unwrap(a, m);
+
+            // Too far off: the midpoint becomes the end of a step half as long.
+            const double error = stepError(a, b, m);
+            if (error > 1.0) {
+                ++m_rejected;
+                b = m;
+                haveEnd = true;
+                onCorner = false;
+                continue;
+            }
+            profile.addNode(m);
+            const double growth = error > 0.0 ? SAFETY * std::pow(error, -0.25) : MAX_GROWTH;
+            h = std::clamp(step * std::min(MAX_GROWTH, growth), minStep, maxStep);
+        }
+
+        profile.addNode(b);
+        a = b;
+        if (onCorner) {
+            profile.addNode(bRight);
+            a = bRight;
+            ++corner;
+        }
+    }
+    return true;
+}
@@ -0,0 +1,138 @@
+#pragma once
+
+#include "Parameters.h"
+#include "LunarEphemeris.h"
+#include "FaradayRotation.h"
+#include <cstddef>
+#include <string>
+#include <vector>
+
+class IonosphereDataProvider;
+
+// ========== Pass Sweep Options ==========
+
+struct PassSweepOptions {
+    double rotationTolerance_deg;   // allowed interpolation error in total rotation
+    double plfTolerance;            // ... and in PLF
+    double initialStep_s;
+    double minStep_s;               // at least 1; steps under twice this are accepted unchecked
+    double maxStep_s;
+
+    PassSweepOptions()
+        : rotationTolerance_deg(0.5), plfTolerance(0.005),
+          initialStep_s(300.0), minStep_s(5.0), maxStep_s(3600.0) {}
+};
+
+// ========== Pass Node ==========
+
+struct PassNode {
+    double time;                    // UTC seconds since 1970
+    double totalRotation_deg;       // unwrapped along the pass
+    double rotationRate;            // deg/s
+    double PLF;
+    double PLFRate;                 // 1/s
+    bool faraday;                   // false where no TEC was available
+
+    PassNode()
+        : time(0.0), totalRotation_deg(0.0), rotationRate(0.0),
+          PLF(0.0), PLFRate(0.0), faraday(false) {}
+};
+
+// ========== Pass Sample ==========
+
+struct PassSample {
+    double time;
+    double totalRotation_deg;
+    double PLF;
+    double polarizationLoss_dB;
+
+    PassSample() : time(0.0), totalRotation_deg(0.0), PLF(0.0), polarizationLoss_dB(0.0) {}
+};
+
+// ========== Pass Profile ==========
+// Dense output of a sweep: a cubic Hermite interpolant through the nodes, using
+// the value and time derivative of total rotation and PLF at each. It can be
+// read at any time inside the sweep, so one sweep serves every display cadence.
+
+class PassProfile {
+public:
+    void clear() { m_nodes.clear(); }
+    void addNode(const PassNode& node) { m_nodes.push_back(node); }
+
+    bool empty() const { return m_nodes.empty(); }
+    const std::vector<PassNode>& getNodes() const { return m_nodes; }
+    double getStart() const { return m_nodes.empty() ? 0.0 : m_nodes.front().time; }
+    double getEnd() const { return m_nodes.empty() ? 0.0 : m_nodes.back().time; }
+
+    // Times outside the sweep are clamped to its ends.
+    PassSample evaluate(double utcSeconds) const;
+
+    // Samples from the start every step_s, plus the end.
+    void resample(double step_s, std::vector<PassSample>& samples) const;
+
+private:
+    std::vector<PassNode> m_nodes;
+};
+
+// ========== Pass Sweep ==========
+// Total rotation and PLF of one link across a pass, with the step chosen from
+// how fast they change. Each node is one FaradayRotation::calculateSensitivity
+// pass: its time derivatives follow the moon (LunarEphemeris::
+// computeMoonEphemerisRate) and the ionosphere at the piercing points (TEC and
+// field sampled RATE_STEP_S either side). A step from node a to node b is
+// checked against a node at its midpoint: if the cubic through a and b misses
+// it by more than the tolerance, the midpoint becomes the end of a step half as
+// long; otherwise both nodes are kept and the next step grows by the fourth
+// root of tolerance over error. The check is made on the data rather than on
+// the slopes alone because the TEC maps have corners (map epochs, grid cells)
+// that no estimate from the ends can see; IONEX map epochs are known, so a node
+// pair is placed on each, with the slopes from either side. Slow stretches near
+// transit get steps of an hour or more, while moonrise, where slant factor and
+// parallactic angle change fastest, gets short ones.
+//
+// Nodes fall on whole seconds, as the TEC lookups do. The range should lie
+// inside a mutual moon window (MoonWindowFinder); a node with the moon below
+// the horizon fails the sweep. Like the sensitivities, the sweep uses the
+// thin-shell ionosphere model.
+
+class PassSweep {
+public:
+    explicit PassSweep(const LunarEphemeris& ephemeris = LunarEphemeris());
+
+    void setOptions(const PassSweepOptions& options) { m_options = options; }
+    const PassSweepOptions& getOptions() const { return m_options; }
+    void setConfiguration(const SystemConfiguration& config) { m_config = config; }
+    void setIonosphereProvider(IonosphereDataProvider* provider) { m_provider = provider; }
+
+    bool sweep(const SiteParameters& dx, const SiteParameters& home,
+               double from, double to, PassProfile& profile);
+
+    // Nodes computed by the last sweep, including those of rejected steps.
+    std::size_t getEvaluationCount() const { return m_evaluations; }
+    std::size_t getRejectedCount() const { return m_rejected; }
+
+    const std::string& getError() const { return m_error; }
+
+private:
+    LunarEphemeris m_ephemeris;
+    PassSweepOptions m_options;
+    SystemConfiguration m_config;
+    IonosphereDataProvider* m_provider;
+    FaradayRotation m_calculator;
+    std::size_t m_evaluations;
+    std::size_t m_rejected;
+    std::string m_error;
+
+    // With right, node takes the slopes just before time and right those just after.
+    bool evaluate(const SiteParameters& dx, const SiteParameters& home, double time,
+                  PassNode& node, PassNode* right = nullptr);
+    bool solve(const SiteParameters& dx, const SiteParameters& home,
+               const MoonEphemeris& moon, const MoonEphemeris& moonRate,
+               const IonosphereData& iono, bool faraday, const IonosphereData& ionoRate,
+               PassNode& node);
+    static IonosphereData drift(const IonosphereData& before, const IonosphereData& after,
+                                double interval);
+    double stepError(const PassNode& a, const PassNode& b, const PassNode& m) const;
+    double bend(const PassNode& p, const PassNode& q) const;
+    static void unwrap(const PassNode& a, PassNode& b);
+};
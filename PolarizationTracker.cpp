@@ -0,0 +1,378 @@
+#include "PolarizationTracker.h"
+#include "IonosphereDataProvider.h"
+#include "GlotecSnapshotStore.h"
+#include "LunarChebyshevCache.h"
+#include <cmath>
+#include <limits>
+
+namespace {
+    // Span of each ephemeris fit, and how close to its end a refit is started.
+    constexpr double FIT_BEFORE_S = 3600.0;
+    constexpr double FIT_AFTER_S = 2.0 * 86400.0;
+    constexpr double REFIT_MARGIN_S = 6.0 * 3600.0;
+    // How often the prefetch thread wakes when it has no ionosphere to read.
+    constexpr double FIT_CHECK_S = 60.0;
+
+    IonosphereData defaultIonosphere() {
+        IonosphereData iono;
+        iono.vTEC_DX = 25.0;
+        iono.vTEC_Home = 25.0;
+        iono.hmF2_DX = 350.0;
+        iono.hmF2_Home = 350.0;
+        iono.B_magnitude_DX = 5.0e-5;
+        iono.B_magnitude_Home = 5.0e-5;
+        iono.B_inclination_DX = ParameterUtils::deg2rad(60.0);
+        iono.B_inclination_Home = ParameterUtils::deg2rad(60.0);
+        iono.dataSource = "Default";
+        return iono;
+    }
+
+    double microseconds(std::chrono::steady_clock::duration duration) {
+        return std::chrono::duration<double, std::micro>(duration).count();
+    }
+}
+
+// ========== Constructor ==========
+
+PolarizationTracker::PolarizationTracker()
+    : m_provider(nullptr), m_providerMutex(nullptr),
+      m_channel(new TrackingChannel(m_options.channelCapacity)),
+      m_ticks(0), m_skipped(0), m_overruns(0), m_refitFailures(0),
+      m_stopRequested(false) {
+}
+
+PolarizationTracker::~PolarizationTracker() {
+    stop();
+}
+
+void PolarizationTracker::setOptions(const TrackerOptions& options) {
+    if (options.channelCapacity != m_options.channelCapacity) {
+        m_channel.reset(new TrackingChannel(options.channelCapacity));
+    }
+    m_options = options;
+}
+
+void PolarizationTracker::setStations(const SiteParameters& dx, const SiteParameters& home) {
+    m_dx = dx;
+    m_home = home;
+}
+
+void PolarizationTracker::setIonosphereProvider(IonosphereDataProvider* provider, std::mutex* providerMutex) {
+    m_provider = provider;
+    m_providerMutex = providerMutex;
+}
+
+// ========== Lifecycle ==========
+
+bool PolarizationTracker::start() {
+    if (isRunning()) {
+        return true;
+    }
+    m_error.clear();
+    if (!(m_options.rate_Hz > 0.0) || m_options.rate_Hz > 1000.0) {
+        m_error = "Tracking rate must be between 0 and 1000 Hz";
+        return false;
+    }
+    if (!(m_config.frequency_MHz > 0.0)) {
+        m_error = "Frequency must be positive";
+        return false;
+    }
+
+    const bool ionosphere = m_provider && m_config.includeFaradayRotation;
+    if (ionosphere && !(m_options.ionosphereRefresh_s > 0.0)) {
+        m_error = "Ionosphere refresh interval must be positive";
+        return false;
+    }
+
+    // Everything that may be slow happens here, before the first tick: the fit,
+    // and reading the TEC maps around the start time.
+    auto wallClock = [] {
+        return std::chrono::duration<double>(std::chrono::system_clock::now().time_since_epoch()).count();
+    };
+    const double first = wallClock() + m_options.lead_s;
+    std::string error;
+    auto fit = fitEphemeris(first, error);
+    if (!fit) {
+        m_error = "Ephemeris fit failed: " + error;
+        return false;
+    }
+
+    std::shared_ptr<Snapshot> snapshot;
+    if (ionosphere) {
+        preloadIonosphere(first);
+        snapshot = readIonosphere(first);
+    }
+    if (!snapshot) {
+        snapshot = std::make_shared<Snapshot>();
+        snapshot->time = -std::numeric_limits<double>::infinity();
+        snapshot->haveTec = false;
+        snapshot->iono = defaultIonosphere();
+    }
+    snapshot->fit = fit;
+    m_snapshot = snapshot;
+    m_latest = snapshot;
+    m_published.reset();
+    m_tracked = m_ephemeris;
+    m_tracked.attachCache(fit);
+
+    // One calculation up front, so one-time setup inside FaradayRotation (the
+    // slant-factor table) is not paid by the first tick.
+    TrackingSample warmup;
+    tick(0, first, warmup);
+
+    m_computeLatency.reset();
+    m_wakeJitter.reset();
+    m_ticks = 0;
+    m_skipped = 0;
+    m_overruns = 0;
+    m_refitFailures = 0;
+    m_stopRequested = false;
+    const Clock::time_point start = Clock::now();
+    const double startUtc = wallClock();
+    m_thread = std::thread(&PolarizationTracker::run, this, start, startUtc);
+    m_prefetchThread = std::thread(&PolarizationTracker::prefetch, this, start, startUtc);
+    return true;
+}
+
+void PolarizationTracker::stop() {
+    if (!isRunning()) {
+        return;
+    }
+    {
+        std::lock_guard<std::mutex> lock(m_stopMutex);
+        m_stopRequested = true;
+    }
+    m_stopSignal.notify_all();
+    m_thread.join();
+    m_prefetchThread.join();
+}
+
+// ========== Tick Loop ==========
+
+void PolarizationTracker::run(Clock::time_point start, double startUtc) {
+    const auto period = std::chrono::duration_cast<Clock::duration>(
+        std::chrono::duration<double>(1.0 / m_options.rate_Hz));
+    const double budget_us = m_options.budget_us > 0.0 ? m_options.budget_us : microseconds(period);
+
+    TrackingSample sample;
+    std::uint64_t index = 0;
+    while (true) {
+        Clock::time_point scheduled = start + period * static_cast<Clock::rep>(index);
+        {
+            std::unique_lock<std::mutex> lock(m_stopMutex);
+            if (m_stopSignal.wait_until(lock, scheduled, [&] { return m_stopRequested; })) {
+                return;
+            }
+        }
+
+        // Keep the grid: a tick that is more than a period late is dropped.
+        Clock::time_point woke = Clock::now();
+        if (woke - scheduled >= period) {
+            const std::uint64_t due = static_cast<std::uint64_t>((woke - start) / period);
+            m_skipped.fetch_add(due - index, std::memory_order_relaxed);
+            index = due;
+            scheduled = start + period * static_cast<Clock::rep>(index);
+        }
+        m_wakeJitter.record(microseconds(woke - scheduled));
+
+        const double utc = startUtc + std::chrono::duration<double>(scheduled - start).count() + m_options.lead_s;
+        tick(index, utc, sample);
+
+        const double latency_us = microseconds(Clock::now() - woke);
+        sample.latency_us = latency_us;
+        m_channel->publish(sample);
+        m_computeLatency.record(latency_us);
+        if (latency_us > budget_us) {
+            m_overruns.fetch_add(1, std::memory_order_relaxed);
+        }
+        m_ticks.fetch_add(1, std::memory_order_relaxed);
+        ++index;
+    }
+}
+
+void PolarizationTracker::tick(std::uint64_t index, double utc, TrackingSample& sample) {
+    // Take a newer snapshot if the prefetch thread is not in the middle of handing one over.
+    {
+        std::unique_lock<std::mutex> lock(m_snapshotMutex, std::try_to_lock);
+        if (lock.owns_lock() && m_published) {
+            m_snapshot = std::move(m_published);
+        }
+    }
+    const Snapshot& snapshot = *m_snapshot;
+    if (m_tracked.getCache() != snapshot.fit) {
+        m_tracked.attachCache(snapshot.fit);
+    }
+
+    const MoonEphemeris moon = m_tracked.computeMoonEphemeris(utc, m_dx, m_home);
+    const bool visible = moon.elevation_DX >= 0.0 && moon.elevation_Home >= 0.0;
+
+    std::uint32_t flags = 0;
+    if (visible && m_provider && m_config.includeFaradayRotation &&
+        utc - snapshot.time > 2.0 * m_options.ionosphereRefresh_s) {
+        flags |= TrackingSample::STALE_IONOSPHERE;
+    }
+
+    SystemConfiguration config = m_config;
+    config.includeFaradayRotation = m_config.includeFaradayRotation && snapshot.haveTec;
+    config.ionoModel = (config.includeFaradayRotation &&
+                        m_config.ionoModel == SystemConfiguration::IonosphereModel::CHAPMAN)
+        ? SystemConfiguration::IonosphereModel::CHAPMAN : SystemConfiguration::IonosphereModel::SIMPLE;
+    m_calculator.setConfiguration(config);
+    if (config.ionoModel == SystemConfiguration::IonosphereModel::CHAPMAN) {
+        m_calculator.setMagneticField(snapshot.field);
+    }
+    m_calculator.setDXStation(m_dx);
+    m_calculator.setHomeStation(m_home);
+    m_calculator.setIonosphereData(snapshot.iono);
+    m_calculator.setMoonEphemeris(moon);
+    const CalculationResults result = m_calculator.calculate();
+    const PolarizationSolution solution = m_calculator.solvePolarization(result);
+
+    if (result.calculationSuccess) flags |= TrackingSample::VALID;
+    if (config.includeFaradayRotation) flags |= TrackingSample::FARADAY;
+
+    sample.tick = index;
+    sample.time = utc;
+    sample.PLF = result.PLF;
+    sample.loss_dB = result.polarizationLoss_dB;
+    sample.spatial_deg = result.spatialRotation_deg;
+    sample.faraday_DX_deg = result.faradayRotation_DX_deg;
+    sample.faraday_Home_deg = result.faradayRotation_Home_deg;
+    sample.total_deg = result.totalRotation_deg;
+    sample.elevation_DX_deg = ParameterUtils::rad2deg(moon.elevation_DX);
+    sample.azimuth_DX_deg = ParameterUtils::rad2deg(moon.azimuth_DX);
+    sample.elevation_Home_deg = ParameterUtils::rad2deg(moon.elevation_Home);
+    sample.azimuth_Home_deg = ParameterUtils::rad2deg(moon.azimuth_Home);
+    sample.vTEC_DX = snapshot.iono.vTEC_DX;
+    sample.vTEC_Home = snapshot.iono.vTEC_Home;
+    sample.optimalPsi_deg = solution.optimalPsi_deg;
+    sample.optimalPLF = solution.optimalPLF;
+    sample.flags = flags;
+}
+
+// ========== Prefetch ==========
+
+// Runs beside the tick loop on the same time base. Each snapshot is read half a
+// refresh period before its time, so a map epoch's file read, any wait for the
+// provider and the ephemeris refit fall here rather than in a tick. A new fit
+// goes out with the next snapshot, or alone while the moon is down.
+void PolarizationTracker::prefetch(Clock::time_point start, double startUtc) {
+    const bool ionosphere = m_provider && m_config.includeFaradayRotation;
+    const double refresh = ionosphere ? m_options.ionosphereRefresh_s : FIT_CHECK_S;
+    const double ahead = 0.5 * refresh;
+    auto trackerTime = [&](Clock::time_point t) {
+        return startUtc + std::chrono::duration<double>(t - start).count() + m_options.lead_s;
+    };
+
+    double target = trackerTime(start) + refresh;
+    while (true) {
+        const Clock::time_point wake = start + std::chrono::duration_cast<Clock::duration>(
+            std::chrono::duration<double>(target - ahead - trackerTime(start)));
+        {
+            std::unique_lock<std::mutex> lock(m_stopMutex);
+            if (m_stopSignal.wait_until(lock, wake, [&] { return m_stopRequested; })) {
+                return;
+            }
+        }
+
+        std::shared_ptr<Snapshot> snapshot;
+        if (ionosphere) {
+            snapshot = readIonosphere(target);
+        }
+        std::shared_ptr<const LunarChebyshevCache> fit = m_latest->fit;
+        if (target + REFIT_MARGIN_S > fit->getEnd()) {
+            std::string error;
+            if (auto refit = fitEphemeris(target, error)) {
+                fit = std::move(refit);
+                if (!snapshot) {
+                    snapshot = std::make_shared<Snapshot>(*m_latest);
+                }
+            } else {
+                m_refitFailures.fetch_add(1, std::memory_order_relaxed);
+            }
+        }
+        if (snapshot) {
+            snapshot->fit = std::move(fit);
+            m_latest = snapshot;
+            publish(std::move(snapshot));
+        }
+
+        // Skip the times that passed while the provider was busy.
+        const double now = trackerTime(Clock::now());
+        do {
+            target += refresh;
+        } while (target < now);
+    }
+}
+
+void PolarizationTracker::publish(std::shared_ptr<const Snapshot> snapshot) {
+    std::lock_guard<std::mutex> lock(m_snapshotMutex);
+    m_published = std::move(snapshot);
+}
+
+// Null while the moon is down at either station; the last snapshot then stands.
+// The caller sets the fit.
+std::shared_ptr<PolarizationTracker::Snapshot> PolarizationTracker::readIonosphere(double utc) {
+    const MoonEphemeris moon = m_ephemeris.computeMoonEphemeris(utc, m_dx, m_home);
+    if (moon.elevation_DX < 0.0 || moon.elevation_Home < 0.0) {
+        return nullptr;
+    }
+
+    auto snapshot = std::make_shared<Snapshot>();
+    snapshot->time = utc;
+    snapshot->haveTec = false;
+    snapshot->iono = defaultIonosphere();
+
+    std::unique_lock<std::mutex> lock;
+    if (m_providerMutex) {
+        lock = std::unique_lock<std::mutex>(*m_providerMutex);
+    }
+    if (!m_provider->hasTecData()) {
+        return snapshot;
+    }
+
+    const std::tm stamp = GlotecSnapshotStore::fromEpochSeconds(static_cast<std::int64_t>(std::floor(utc)));
+    IonosphereData iono;
+    if (m_provider->getIonosphereDataAtIPP(stamp,
+            ParameterUtils::rad2deg(m_dx.latitude), ParameterUtils::rad2deg(m_dx.longitude),
+            moon.elevation_DX, moon.azimuth_DX,
+            ParameterUtils::rad2deg(m_home.latitude), ParameterUtils::rad2deg(m_home.longitude),
+            moon.elevation_Home, moon.azimuth_Home, iono)) {
+        snapshot->iono = iono;
+        snapshot->haveTec = true;
+        if (m_config.ionoModel == SystemConfiguration::IonosphereModel::CHAPMAN) {
+            snapshot->field = m_provider->prepareMagneticField(stamp);
+        }
+    }
+    // Otherwise no coverage for this time: the defaults stand and Faraday is off.
+    return snapshot;
+}
+
+// Touches the TEC maps bracketing utc above both stations, so they are in the
+// reader's cache even if the moon is down at start.
+void PolarizationTracker::preloadIonosphere(double utc) {
+    std::unique_lock<std::mutex> lock;
+    if (m_providerMutex) {
+        lock = std::unique_lock<std::mutex>(*m_providerMutex);
+    }
+    if (!m_provider->hasTecData()) {
+        return;
+    }
+    const std::tm stamp = GlotecSnapshotStore::fromEpochSeconds(static_cast<std::int64_t>(std::floor(utc)));
+    IonosphereData iono;
+    m_provider->getIonosphereData(stamp,
+        ParameterUtils::rad2deg(m_dx.latitude), ParameterUtils::rad2deg(m_dx.longitude), 0.0,
+        ParameterUtils::rad2deg(m_home.latitude), ParameterUtils::rad2deg(m_home.longitude), 0.0,
+        iono);
+}
+
+// ========== Ephemeris ==========
+
+std::shared_ptr<const LunarChebyshevCache> PolarizationTracker::fitEphemeris(double utc, std::string& error) {
+    auto cache = std::make_shared<LunarChebyshevCache>();
+    if (!cache->build(m_ephemeris, utc - FIT_BEFORE_S, utc + FIT_AFTER_S)) {
+        error = cache->getError();
+        return nullptr;
+    }
+    return cache;
+}
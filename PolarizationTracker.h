@@ -0,0 +1,141 @@
+#pragma once
+
+#include "Parameters.h"
+#include "LunarEphemeris.h"
+#include "FaradayRotation.h"
+#include "GeomagneticField.h"
+#include "LatencyHistogram.h"
+#include "TrackingChannel.h"
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+
+class IonosphereDataProvider;
+class LunarChebyshevCache;
+
+// ========== Tracker Options ==========
+
+struct TrackerOptions {
+    double rate_Hz;                 // ticks per second
+    double budget_us;               // per-tick compute budget; 0 means one period
+    double ionosphereRefresh_s;     // piercing-point TEC and field are re-read this often
+    double lead_s;                  // compute for tick time + lead
+    std::size_t channelCapacity;
+
+    TrackerOptions()
+        : rate_Hz(10.0), budget_us(0.0), ionosphereRefresh_s(10.0),
+          lead_s(0.0), channelCapacity(256) {}
+};
+
+// ========== Polarization Tracker ==========
+// Updates rotation and PLF for one link at a fixed rate on its own thread.
+// Ticks are scheduled on the monotonic clock, and the UTC of each tick is derived
+// from it (wall time at start plus elapsed monotonic time), so clock steps do not
+// disturb the cadence. Late ticks are dropped, not bunched.
+//
+// A tick never touches files, the network or the ionosphere provider, and never
+// fits anything. It reads an immutable snapshot made by a prefetch thread:
+//   - the moon comes from a Chebyshev fit of the days around now, which that
+//     thread refits once the tick time nears its end;
+//   - TEC and field at the piercing points are read every ionosphereRefresh_s,
+//     half a period ahead of the time they are for. Only the prefetch thread
+//     calls the provider, so IONEX maps read from disk on a cache miss and waits
+//     for the provider mutex happen there. start() loads the maps around the
+//     start time before the first tick. A sample whose ionosphere is more than
+//     two periods old is marked STALE_IONOSPHERE.
+//
+// Samples go to a lock-free TrackingChannel; the compute time of each tick and
+// the wake-up jitter go to latency histograms.
+
+class PolarizationTracker {
+public:
+    PolarizationTracker();
+    ~PolarizationTracker();
+
+    PolarizationTracker(const PolarizationTracker&) = delete;
+    PolarizationTracker& operator=(const PolarizationTracker&) = delete;
+
+    // Configure before start().
+    void setOptions(const TrackerOptions& options);
+    void setConfiguration(const SystemConfiguration& config) { m_config = config; }
+    void setStations(const SiteParameters& dx, const SiteParameters& home);
+    void setEphemeris(const LunarEphemeris& ephemeris) { m_ephemeris = ephemeris; }
+    // The provider is shared; pass the mutex other users lock around it, if any.
+    void setIonosphereProvider(IonosphereDataProvider* provider, std::mutex* providerMutex = nullptr);
+
+    bool start();
+    void stop();
+    bool isRunning() const { return m_thread.joinable(); }
+
+    const TrackingChannel& getChannel() const { return *m_channel; }
+    const LatencyHistogram& getComputeLatency() const { return m_computeLatency; }
+    const LatencyHistogram& getWakeJitter() const { return m_wakeJitter; }
+    std::uint64_t getTickCount() const { return m_ticks.load(std::memory_order_relaxed); }
+    std::uint64_t getSkippedTicks() const { return m_skipped.load(std::memory_order_relaxed); }
+    std::uint64_t getOverrunCount() const { return m_overruns.load(std::memory_order_relaxed); }
+    // Ephemeris refits that failed while running; the previous fit stays in use.
+    std::uint64_t getRefitFailures() const { return m_refitFailures.load(std::memory_order_relaxed); }
+    // Set by start() only.
+    const std::string& getError() const { return m_error; }
+
+private:
+    using Clock = std::chrono::steady_clock;
+
+    // What the prefetch thread hands a tick; never modified once published.
+    struct Snapshot {
+        double time;                    // of the ionosphere
+        bool haveTec;
+        IonosphereData iono;
+        PreparedMagneticField field;    // CHAPMAN only
+        std::shared_ptr<const LunarChebyshevCache> fit;
+    };
+
+    TrackerOptions m_options;
+    SystemConfiguration m_config;
+    SiteParameters m_dx;
+    SiteParameters m_home;
+    LunarEphemeris m_ephemeris;         // analytic series, used for fits
+    IonosphereDataProvider* m_provider;
+    std::mutex* m_providerMutex;
+    std::string m_error;
+
+    std::unique_ptr<TrackingChannel> m_channel;
+    LatencyHistogram m_computeLatency;
+    LatencyHistogram m_wakeJitter;
+    std::atomic<std::uint64_t> m_ticks;
+    std::atomic<std::uint64_t> m_skipped;
+    std::atomic<std::uint64_t> m_overruns;
+    std::atomic<std::uint64_t> m_refitFailures;
+
+    // Tick thread state
+    FaradayRotation m_calculator;
+    LunarEphemeris m_tracked;           // with the snapshot's fit attached
+    std::shared_ptr<const Snapshot> m_snapshot;
+
+    // Prefetch thread state: the last snapshot it made
+    std::shared_ptr<const Snapshot> m_latest;
+
+    // Handed from the prefetch thread to the tick
+    std::mutex m_snapshotMutex;
+    std::shared_ptr<const Snapshot> m_published;
+
+    std::thread m_thread;
+    std::thread m_prefetchThread;
+    std::mutex m_stopMutex;
+    std::condition_variable m_stopSignal;
+    bool m_stopRequested;
+
+    void run(Clock::time_point start, double startUtc);
+    void prefetch(Clock::time_point start, double startUtc);
+    void tick(std::uint64_t index, double utc, TrackingSample& sample);
+    void publish(std::shared_ptr<const Snapshot> snapshot);
+    // Prefetch thread or start() only.
+    std::shared_ptr<Snapshot> readIonosphere(double utc);
+    void preloadIonosphere(double utc);
+    std::shared_ptr<const LunarChebyshevCache> fitEphemeris(double utc, std::string& error);
+};
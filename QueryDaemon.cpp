@@ -0,0 +1,435 @@
+#include "QueryDaemon.h"
+#include <algorithm>
+#include <cctype>
+#include <cstring>
+
+#ifndef _WIN32
+#include <sys/types.h>
+#include <sys/socket.h>
+#include <sys/stat.h>
+#include <sys/un.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <arpa/inet.h>
+#include <poll.h>
+#include <unistd.h>
+#include <cerrno>
+
+#ifndef MSG_NOSIGNAL
+#define MSG_NOSIGNAL 0
+#endif
+#endif
+
+namespace {
+    // Granularity at which blocked threads notice stop().
+    constexpr int POLL_INTERVAL_MS = 100;
+
+    std::string stripLine(const std::string& line) {
+        std::size_t end = line.find_last_not_of(" \t\r");
+        std::size_t begin = line.find_first_not_of(" \t");
+        return (end == std::string::npos) ? std::string() : line.substr(begin, end - begin + 1);
+    }
+}
+
+// ========== Constructor ==========
+
+QueryDaemon::QueryDaemon(BatchProcessor& processor)
+    : m_processor(processor), m_running(false), m_requestCount(0), m_coalescedCount(0),
+      m_stopCompute(false), m_unixFd(-1), m_httpFd(-1), m_port(0) {
+}
+
+QueryDaemon::~QueryDaemon() {
+    stop();
+}
+
+// ========== Compute Pool ==========
+
+std::shared_ptr<QueryDaemon::Pending> QueryDaemon::submit(const std::string& request) {
+    ++m_requestCount;
+    std::shared_ptr<Pending> pending;
+    {
+        std::lock_guard<std::mutex> lock(m_queueMutex);
+        auto found = m_inFlight.find(request);
+        if (found != m_inFlight.end()) {
+            ++m_coalescedCount;
+            return found->second;
+        }
+        pending = std::make_shared<Pending>();
+        pending->request = request;
+        m_inFlight.emplace(request, pending);
+        m_queue.push_back(pending);
+    }
+    m_queueReady.notify_one();
+    return pending;
+}
+
+std::string QueryDaemon::wait(const std::shared_ptr<Pending>& pending) {
+    std::unique_lock<std::mutex> lock(m_queueMutex);
+    m_resultReady.wait(lock, [&] { return pending->done; });
+    return pending->response;
+}
+
+std::string QueryDaemon::query(const std::string& request) {
+    const std::string line = stripLine(request);
+    if (line.empty()) {
+        return std::string();
+    }
+    if (!m_running) {
+        return "{\"error\":\"Daemon is not running\"}\n";
+    }
+    return wait(submit(line));
+}
+
+void QueryDaemon::computeLoop() {
+    BatchProcessor::Workspace work;
+    while (true) {
+        std::shared_ptr<Pending> pending;
+        {
+            std::unique_lock<std::mutex> lock(m_queueMutex);
+            m_queueReady.wait(lock, [&] { return m_stopCompute || !m_queue.empty(); });
+            if (m_queue.empty()) return;
+            pending = m_queue.front();
+            m_queue.pop_front();
+        }
+
+        std::string response;
+        m_processor.evaluate(work, pending->request, response);
+
+        {
+            std::lock_guard<std::mutex> lock(m_queueMutex);
+            pending->response = std::move(response);
+            pending->done = true;
+            m_inFlight.erase(pending->request);
+        }
+        m_resultReady.notify_all();
+    }
+}
+
+#ifdef _WIN32
+
+bool QueryDaemon::start(const QueryDaemonOptions& options) {
+    m_options = options;
+    m_error = "QueryDaemon is only available on POSIX systems";
+    return false;
+}
+
+void QueryDaemon::stop() {
+}
+
+void QueryDaemon::acceptLoop() {
+}
+
+void QueryDaemon::serveLines(int fd) {
+    (void)fd;
+}
+
+void QueryDaemon::serveHttp(int fd) {
+    (void)fd;
+}
+
+void QueryDaemon::closeListeners() {
+}
+
+#else
+
+// ========== Lifecycle ==========
+
+bool QueryDaemon::start(const QueryDaemonOptions& options) {
+    if (m_running) {
+        return true;
+    }
+    m_options = options;
+    m_error.clear();
+
+    if (m_options.socketPath.empty() && m_options.httpPort < 0) {
+        m_error = "No socket path or HTTP port given";
+        return false;
+    }
+
+    if (!m_options.socketPath.empty()) {
+        sockaddr_un address = {};
+        address.sun_family = AF_UNIX;
+        if (m_options.socketPath.size() >= sizeof(address.sun_path)) {
+            m_error = "Socket path too long: " + m_options.socketPath;
+            return false;
+        }
+        std::memcpy(address.sun_path, m_options.socketPath.c_str(), m_options.socketPath.size() + 1);
+
+        // A socket left behind by an earlier run would make bind() fail.
+        struct stat info;
+        if (::stat(m_options.socketPath.c_str(), &info) == 0 && S_ISSOCK(info.st_mode)) {
+            ::unlink(m_options.socketPath.c_str());
+        }
+
+        m_unixFd = ::socket(AF_UNIX, SOCK_STREAM, 0);
+        if (m_unixFd < 0 ||
+            ::bind(m_unixFd, reinterpret_cast<sockaddr*>(&address), sizeof(address)) != 0 ||
+            ::listen(m_unixFd, 64) != 0) {
+            m_error = m_options.socketPath + ": " + std::strerror(errno);
+            closeListeners();
+            return false;
+        }
+    }
+
+    if (m_options.httpPort >= 0) {
+        m_httpFd = ::socket(AF_INET, SOCK_STREAM, 0);
+        int one = 1;
+        if (m_httpFd >= 0) {
+            ::setsockopt(m_httpFd, SOL_SOCKET, SO_REUSEADDR, &one, sizeof(one));
+        }
+
+        sockaddr_in address = {};
+        address.sin_family = AF_INET;
+        address.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+        address.sin_port = htons(static_cast<uint16_t>(m_options.httpPort));
+
+        if (m_httpFd < 0 ||
+            ::bind(m_httpFd, reinterpret_cast<sockaddr*>(&address), sizeof(address)) != 0 ||
+            ::listen(m_httpFd, 64) != 0) {
+            m_error = std::string("bind/listen failed: ") + std::strerror(errno);
+            closeListeners();
+            return false;
+        }
+
+        socklen_t length = sizeof(address);
+        ::getsockname(m_httpFd, reinterpret_cast<sockaddr*>(&address), &length);
+        m_port = ntohs(address.sin_port);
+    }
+
+    unsigned threads = m_options.threads ? m_options.threads : std::thread::hardware_concurrency();
+    threads = std::max(threads, 1u);
+    m_stopCompute = false;
+    for (unsigned i = 0; i < threads; ++i) {
+        m_computeThreads.emplace_back(&QueryDaemon::computeLoop, this);
+    }
+
+    m_requestCount = 0;
+    m_coalescedCount = 0;
+    m_running = true;
+    m_acceptThread = std::thread(&QueryDaemon::acceptLoop, this);
+    return true;
+}
+
+void QueryDaemon::stop() {
+    if (!m_running) {
+        return;
+    }
+    m_running = false;
+
+    if (m_acceptThread.joinable()) {
+        m_acceptThread.join();
+    }
+
+    {
+        std::unique_lock<std::mutex> lock(m_clientMutex);
+        for (int fd : m_clientFds) {
+            ::shutdown(fd, SHUT_RDWR);
+        }
+        m_clientsClosed.wait(lock, [&] { return m_clientFds.empty(); });
+    }
+
+    {
+        std::lock_guard<std::mutex> lock(m_queueMutex);
+        m_stopCompute = true;
+    }
+    m_queueReady.notify_all();
+    for (std::thread& thread : m_computeThreads) {
+        thread.join();
+    }
+    m_computeThreads.clear();
+
+    closeListeners();
+}
+
+void QueryDaemon::closeListeners() {
+    if (m_unixFd >= 0) {
+        ::close(m_unixFd);
+        ::unlink(m_options.socketPath.c_str());
+        m_unixFd = -1;
+    }
+    if (m_httpFd >= 0) {
+        ::close(m_httpFd);
+        m_httpFd = -1;
+    }
+}
+
+void QueryDaemon::acceptLoop() {
+    while (m_running) {
+        pollfd listeners[2];
+        nfds_t count = 0;
+        if (m_unixFd >= 0) listeners[count++] = { m_unixFd, POLLIN, 0 };
+        if (m_httpFd >= 0) listeners[count++] = { m_httpFd, POLLIN, 0 };
+        if (::poll(listeners, count, POLL_INTERVAL_MS) <= 0) {
+            continue;
+        }
+
+        for (nfds_t i = 0; i < count; ++i) {
+            if (!(listeners[i].revents & POLLIN)) continue;
+            int fd = ::accept(listeners[i].fd, nullptr, nullptr);
+            if (fd < 0) continue;
+
+            const bool http = listeners[i].fd == m_httpFd;
+            if (http) {
+                int noDelay = 1;
+                ::setsockopt(fd, IPPROTO_TCP, TCP_NODELAY, &noDelay, sizeof(noDelay));
+            }
+            {
+                std::lock_guard<std::mutex> lock(m_clientMutex);
+                m_clientFds.insert(fd);
+            }
+            std::thread(http ? &QueryDaemon::serveHttp : &QueryDaemon::serveLines, this, fd).detach();
+        }
+    }
+}
+
+// ========== Connections ==========
+
+namespace {
+    bool sendAll(int fd, const char* data, std::size_t length) {
+        while (length > 0) {
+            ssize_t sent = ::send(fd, data, length, MSG_NOSIGNAL);
+            if (sent < 0) {
+                if (errno == EINTR) continue;
+                return false;
+            }
+            data += sent;
+            length -= static_cast<std::size_t>(sent);
+        }
+        return true;
+    }
+
+    // Appends whatever arrives within one poll interval; false on EOF or error.
+    bool receiveSome(int fd, std::string& pending, bool& timedOut) {
+        char buffer[4096];
+        pollfd p = { fd, POLLIN, 0 };
+        timedOut = ::poll(&p, 1, POLL_INTERVAL_MS) <= 0;
+        if (timedOut) {
+            return true;
+        }
+        ssize_t received = ::recv(fd, buffer, sizeof(buffer), 0);
+        if (received <= 0) {
+            return false;
+        }
+        pending.append(buffer, static_cast<std::size_t>(received));
+        return true;
+    }
+}
+
+// Line protocol: every request line gets one response line, in order.
+void QueryDaemon::serveLines(int fd) {
+    std::string pending, response;
+    bool open = true;
+
+    while (open && m_running) {
+        std::size_t newline = pending.find('\n');
+        if (newline == std::string::npos) {
+            if (pending.size() > m_options.maxRequestBytes) {
+                const char* tooLong = "{\"error\":\"Request too long\"}\n";
+                sendAll(fd, tooLong, std::strlen(tooLong));
+                break;
+            }
+            bool timedOut;
+            open = receiveSome(fd, pending, timedOut);
+            continue;
+        }
+
+        response = query(pending.substr(0, newline));
+        pending.erase(0, newline + 1);
+        open = response.empty() || sendAll(fd, response.data(), response.size());
+    }
+
+    std::lock_guard<std::mutex> lock(m_clientMutex);
+    ::close(fd);
+    m_clientFds.erase(fd);
+    m_clientsClosed.notify_all();
+}
+
+void QueryDaemon::serveHttp(int fd) {
+    std::string pending;
+    bool open = true;
+
+    auto reply = [fd](const char* status, const std::string& body, const char* type, bool keepAlive) {
+        std::string head = std::string("HTTP/1.1 ") + status + "\r\n"
+                           "Content-Type: " + type + "\r\n"
+                           "Content-Length: " + std::to_string(body.size()) + "\r\n" +
+                           (keepAlive ? "Connection: keep-alive\r\n\r\n" : "Connection: close\r\n\r\n");
+        return sendAll(fd, head.data(), head.size()) && sendAll(fd, body.data(), body.size());
+    };
+
+    while (open && m_running) {
+        std::size_t headEnd = pending.find("\r\n\r\n");
+        if (headEnd == std::string::npos) {
+            if (pending.size() > m_options.maxRequestBytes) break;
+            bool timedOut;
+            open = receiveSome(fd, pending, timedOut);
+            continue;
+        }
+
+        std::string head = pending.substr(0, headEnd);
+        std::string lower = head;
+        std::transform(lower.begin(), lower.end(), lower.begin(),
+                       [](unsigned char c) { return static_cast<char>(std::tolower(c)); });
+
+        std::size_t pathStart = head.find(' ');
+        std::size_t pathEnd = (pathStart == std::string::npos) ? pathStart : head.find(' ', pathStart + 1);
+        const std::string method = head.substr(0, pathStart);
+        const std::string path = (pathEnd == std::string::npos) ? "/" : head.substr(pathStart + 1, pathEnd - pathStart - 1);
+        const bool keepAlive = lower.find("connection: close") == std::string::npos;
+
+        std::size_t length = 0;
+        std::size_t lengthAt = lower.find("content-length:");
+        if (lengthAt != std::string::npos) {
+            length = std::strtoull(lower.c_str() + lengthAt + 15, nullptr, 10);
+        }
+        if (length > m_options.maxRequestBytes) {
+            reply("413 Payload Too Large", "Request too long\n", "text/plain", false);
+            break;
+        }
+
+        // Wait for the whole body.
+        bool complete = true;
+        while (pending.size() < headEnd + 4 + length) {
+            bool timedOut;
+            if (!m_running || !receiveSome(fd, pending, timedOut)) {
+                complete = false;
+                break;
+            }
+        }
+        if (!complete) break;
+        std::string body = pending.substr(headEnd + 4, length);
+        pending.erase(0, headEnd + 4 + length);
+
+        if (method == "GET" && path == "/health") {
+            open = reply("200 OK", "ok\n", "text/plain", keepAlive) && keepAlive;
+        } else if (method == "POST" && path == "/query") {
+            if (lengthAt == std::string::npos) {
+                reply("411 Length Required", "Content-Length required\n", "text/plain", false);
+                break;
+            }
+            // Submit every line first so a multi-job body runs on the whole pool.
+            std::vector<std::shared_ptr<Pending>> submitted;
+            std::size_t start = 0;
+            while (start < body.size()) {
+                std::size_t newline = body.find('\n', start);
+                if (newline == std::string::npos) newline = body.size();
+                const std::string line = stripLine(body.substr(start, newline - start));
+                if (!line.empty()) submitted.push_back(submit(line));
+                start = newline + 1;
+            }
+            std::string response;
+            for (const auto& job : submitted) {
+                response += wait(job);
+            }
+            open = reply("200 OK", response, "application/x-ndjson", keepAlive) && keepAlive;
+        } else {
+            open = reply("404 Not Found", "Not Found\n", "text/plain", keepAlive) && keepAlive;
+        }
+    }
+
+    std::lock_guard<std::mutex> lock(m_clientMutex);
+    ::close(fd);
+    m_clientFds.erase(fd);
+    m_clientsClosed.notify_all();
+}
+
+#endif
@@ -0,0 +1,107 @@
+#pragma once
+
+#include "BatchProcessor.h"
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <set>
+#include <string>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
+// ========== Query Daemon Options ==========
+
+struct QueryDaemonOptions {
+    std::string socketPath;         // Unix domain socket; empty disables
+    int httpPort;                   // loopback HTTP; -1 disables, 0 picks a free port
+    unsigned threads;               // compute workers; 0 uses every hardware thread
+    std::size_t maxRequestBytes;    // longer lines or bodies are refused
+
+    QueryDaemonOptions()
+        : httpPort(-1), threads(0), maxRequestBytes(1 << 20) {}
+};
+
+// ========== Query Daemon ==========
+// Keeps the models of a BatchProcessor resident and answers jobs in the batch
+// format (one JSON object per line, see BatchJobParser) with one result line
+// each, so station software gets an answer without paying process start-up and
+// model loading.
+//
+//   Unix socket:  write request lines, read one response line per request.
+//   HTTP:         POST /query with JSONL lines as the body; GET /health.
+//
+// Connections are read on their own threads (as in LoopbackHttpServer) and the
+// jobs go to a fixed pool of compute workers. Identical request lines that are
+// in flight at the same time are computed once and the result is shared.
+// Available on POSIX systems only; start() fails elsewhere.
+
+class QueryDaemon {
+public:
+    explicit QueryDaemon(BatchProcessor& processor);
+    ~QueryDaemon();
+
+    QueryDaemon(const QueryDaemon&) = delete;
+    QueryDaemon& operator=(const QueryDaemon&) = delete;
+
+    bool start(const QueryDaemonOptions& options);
+    void stop();
+
+    bool isRunning() const { return m_running; }
+    int getPort() const { return m_port; }
+    const std::string& getSocketPath() const { return m_options.socketPath; }
+
+    // Blocking query from inside the process; same path as a socket request.
+    std::string query(const std::string& request);
+
+    std::size_t getRequestCount() const { return m_requestCount; }
+    std::size_t getCoalescedCount() const { return m_coalescedCount; }
+    const std::string& getError() const { return m_error; }
+
+private:
+    // One computation, shared by every caller that asked for the same line.
+    struct Pending {
+        std::string request;
+        std::string response;
+        bool done;
+
+        Pending() : done(false) {}
+    };
+
+    BatchProcessor& m_processor;
+    QueryDaemonOptions m_options;
+    std::string m_error;
+    std::atomic<bool> m_running;
+    std::atomic<std::size_t> m_requestCount;
+    std::atomic<std::size_t> m_coalescedCount;
+
+    // Compute pool
+    std::mutex m_queueMutex;
+    std::condition_variable m_queueReady;
+    std::condition_variable m_resultReady;
+    std::deque<std::shared_ptr<Pending>> m_queue;
+    std::unordered_map<std::string, std::shared_ptr<Pending>> m_inFlight;
+    std::vector<std::thread> m_computeThreads;
+    bool m_stopCompute;
+
+    // Listeners and connections
+    int m_unixFd;
+    int m_httpFd;
+    int m_port;
+    std::thread m_acceptThread;
+    // Connection threads are detached; stop() waits for this set to drain.
+    std::mutex m_clientMutex;
+    std::condition_variable m_clientsClosed;
+    std::set<int> m_clientFds;
+
+    std::shared_ptr<Pending> submit(const std::string& request);
+    std::string wait(const std::shared_ptr<Pending>& pending);
+    void computeLoop();
+    void acceptLoop();
+    void serveLines(int fd);
+    void serveHttp(int fd);
+    void closeListeners();
+};
@@ -0,0 +1,312 @@
+#include "ResultTextWriter.h"
+#include "GlotecSnapshotStore.h"
+#include <charconv>
+#include <cstdint>
+#include <cmath>
+#include <cstring>
+
+namespace {
+    const char* CSV_COLUMNS =
+        "id,time,freq_MHz,PLF,loss_dB,spatial_deg,faraday_DX_deg,faraday_Home_deg,total_deg,"
+        "elevation_DX_deg,elevation_Home_deg,vTEC_DX,vTEC_Home";
+    const char* CSV_PASSBAND_COLUMNS = ",PLF_avg,PLF_min,PLF_max,depolarization,spread_deg";
+    const char* CSV_POLARIZATION_COLUMNS = ",psi_opt_deg,PLF_opt,arrival_psi_deg,arrival_chi_deg,PLF_dual";
+    const char* CSV_SENSITIVITY_COLUMNS = ",dPLF_dvTEC_DX,dPLF_dvTEC_Home,dPLF_dB_DX,dPLF_dB_Home,dPLF_dt";
+    const char* CSV_TAIL_COLUMNS = ",faraday,error\n";
+
+    struct ValueColumn { const char* name; int precision; };
+    const ValueColumn VALUE_FORMATS[] = {
+        { "PLF", 6 },
+        { "loss_dB", 3 },
+        { "spatial_deg", 3 },
+        { "faraday_DX_deg", 3 },
+        { "faraday_Home_deg", 3 },
+        { "total_deg", 3 },
+        { "elevation_DX_deg", 3 },
+        { "elevation_Home_deg", 3 },
+        { "vTEC_DX", 2 },
+        { "vTEC_Home", 2 },
+    };
+
+    const ValueColumn PASSBAND_FORMATS[] = {
+        { "PLF_avg", 6 },
+        { "PLF_min", 6 },
+        { "PLF_max", 6 },
+        { "depolarization", 6 },
+        { "spread_deg", 3 },
+    };
+
+    const ValueColumn POLARIZATION_FORMATS[] = {
+        { "psi_opt_deg", 3 },
+        { "PLF_opt", 6 },
+        { "arrival_psi_deg", 3 },
+        { "arrival_chi_deg", 3 },
+        { "PLF_dual", 6 },
+    };
+
+    // Gradients span many decades, so they are written in scientific notation
+    // with this many significant digits.
+    const ValueColumn SENSITIVITY_FORMATS[] = {
+        { "dPLF_dvTEC_DX", 6 },
+        { "dPLF_dvTEC_Home", 6 },
+        { "dPLF_dB_DX", 6 },
+        { "dPLF_dB_Home", 6 },
+        { "dPLF_dt", 6 },
+    };
+
+    // Longest text one number may take; longer values are left out, as before.
+    constexpr std::size_t NUMBER_MAX = 64;
+
+    char* putText(char* p, const std::string& text) {
+        std::memcpy(p, text.data(), text.size());
+        return p + text.size();
+    }
+
+    const double POWERS_OF_TEN[] = { 1.0, 10.0, 100.0, 1e3, 1e4, 1e5, 1e6, 1e7, 1e8 };
+
+    char* putFixedExact(char* p, double value, int precision) {
+        auto result = std::to_chars(p, p + NUMBER_MAX, value, std::chars_format::fixed, precision);
+        return result.ec == std::errc() ? result.ptr : p;
+    }
+
+    char* putScientific(char* p, double value, int digits) {
+        auto result = std::to_chars(p, p + NUMBER_MAX, value, std::chars_format::scientific, digits - 1);
+        return result.ec == std::errc() ? result.ptr : p;
+    }
+
+    // Scaled-integer formatting, several times faster than to_chars with a
+    // precision. The product value * 10^p can be off by an ulp, which only
+    // matters when it lands next to a rounding tie; those values, and anything
+    // too large for the integer path, go to to_chars, so the text is identical.
+    char* putFixed(char* p, double value, int precision) {
+        const double magnitude = std::fabs(value);
+        if (!(magnitude < 1e12) || precision > 8) {
+            return putFixedExact(p, value, precision);
+        }
+        const double scaled = magnitude * POWERS_OF_TEN[precision];
+        const double floor = std::floor(scaled);
+        const double fraction = scaled - floor;
+        if (std::fabs(fraction - 0.5) < 1e-6 + scaled * 1e-15) {
+            return putFixedExact(p, value, precision);
+        }
+
+        std::uint64_t digits = static_cast<std::uint64_t>(floor) + (fraction > 0.5 ? 1 : 0);
+        const std::uint64_t unit = static_cast<std::uint64_t>(POWERS_OF_TEN[precision]);
+        if (std::signbit(value)) {
+            *p++ = '-';
+        }
+        p = std::to_chars(p, p + 24, digits / unit).ptr;
+        if (precision > 0) {
+            *p++ = '.';
+            std::uint64_t fractionDigits = digits % unit;
+            for (int i = precision - 1; i >= 0; --i) {
+                p[i] = static_cast<char>('0' + fractionDigits % 10);
+                fractionDigits /= 10;
+            }
+            p += precision;
+        }
+        return p;
+    }
+
+    char* putTwo(char* p, int value) {
+        p[0] = static_cast<char>('0' + value / 10);
+        p[1] = static_cast<char>('0' + value % 10);
+        return p + 2;
+    }
+
+    // ISO 8601 UTC, whole seconds.
+    char* putTime(char* p, double utcSeconds) {
+        std::tm time = GlotecSnapshotStore::fromEpochSeconds(static_cast<std::int64_t>(std::floor(utcSeconds)));
+        p = std::to_chars(p, p + 24, static_cast<std::size_t>(time.tm_year + 1900)).ptr;
+        *p++ = '-';
+        p = putTwo(p, time.tm_mon + 1);
+        *p++ = '-';
+        p = putTwo(p, time.tm_mday);
+        *p++ = 'T';
+        p = putTwo(p, time.tm_hour);
+        *p++ = ':';
+        p = putTwo(p, time.tm_min);
+        *p++ = ':';
+        p = putTwo(p, time.tm_sec);
+        *p++ = 'Z';
+        return p;
+    }
+}
+
+// ========== Constructor ==========
+
+ResultTextWriter::ResultTextWriter()
+    : m_format(BatchFormat::JSONL), m_passband(false), m_polarization(false), m_sensitivity(false) {
+    setFormat(BatchFormat::JSONL);
+}
+
+void ResultTextWriter::setFormat(BatchFormat format) {
+    m_format = (format == BatchFormat::CSV) ? BatchFormat::CSV : BatchFormat::JSONL;
+    const bool csv = m_format == BatchFormat::CSV;
+
+    m_timePrefix = csv ? "," : ",\"time\":\"";
+    m_frequencyPrefix = csv ? "," : "\",\"freq_MHz\":";
+    for (int i = 0; i < VALUE_COLUMNS; ++i) {
+        m_prefixes[i] = csv ? std::string(",") : std::string(",\"") + VALUE_FORMATS[i].name + "\":";
+    }
+    for (int i = 0; i < PASSBAND_COLUMNS; ++i) {
+        m_passbandPrefixes[i] = csv ? std::string(",") : std::string(",\"") + PASSBAND_FORMATS[i].name + "\":";
+    }
+    for (int i = 0; i < POLARIZATION_COLUMNS; ++i) {
+        m_polarizationPrefixes[i] = csv ? std::string(",") : std::string(",\"") + POLARIZATION_FORMATS[i].name + "\":";
+    }
+    for (int i = 0; i < SENSITIVITY_COLUMNS; ++i) {
+        m_sensitivityPrefixes[i] = csv ? std::string(",") : std::string(",\"") + SENSITIVITY_FORMATS[i].name + "\":";
+    }
+    m_faradayTrue = csv ? ",1,\n" : ",\"faraday\":true}\n";
+    m_faradayFalse = csv ? ",0,\n" : ",\"faraday\":false}\n";
+}
+
+// ========== Rows ==========
+
+void ResultTextWriter::writeHeader(std::string& out) const {
+    if (m_format == BatchFormat::CSV) {
+        out.append(CSV_COLUMNS);
+        if (m_passband) out.append(CSV_PASSBAND_COLUMNS);
+        if (m_polarization) out.append(CSV_POLARIZATION_COLUMNS);
+        if (m_sensitivity) out.append(CSV_SENSITIVITY_COLUMNS);
+        out.append(CSV_TAIL_COLUMNS);
+    }
+}
+
+void ResultTextWriter::writeResult(std::string& out, const std::string& id, double time, double frequency_MHz,
+                                   const CalculationResults& result, const MoonEphemeris& moon,
+                                   const IonosphereData& iono, bool faraday,
+                                   const PassbandResult* passband,
+                                   const PolarizationSolution* polarization,
+                                   const PLFSensitivity* sensitivity) const {
+    const double values[VALUE_COLUMNS] = {
+        result.PLF,
+        result.polarizationLoss_dB,
+        result.spatialRotation_deg,
+        result.faradayRotation_DX_deg,
+        result.faradayRotation_Home_deg,
+        result.totalRotation_deg,
+        ParameterUtils::rad2deg(moon.elevation_DX),
+        ParameterUtils::rad2deg(moon.elevation_Home),
+        iono.vTEC_DX,
+        iono.vTEC_Home,
+    };
+
+    if (m_format == BatchFormat::CSV) {
+        appendCsvField(out, id);
+    } else {
+        out.append("{\"id\":");
+        appendJsonString(out, id);
+    }
+
+    // Everything after the id has a bounded length: format it in place.
+    char row[(VALUE_COLUMNS + PASSBAND_COLUMNS + POLARIZATION_COLUMNS + SENSITIVITY_COLUMNS + 2) *
+             (NUMBER_MAX + 24) + 64];
+    char* p = row;
+    p = putText(p, m_timePrefix);
+    p = putTime(p, time);
+    p = putText(p, m_frequencyPrefix);
+    p = putFixed(p, frequency_MHz, 3);
+    for (int i = 0; i < VALUE_COLUMNS; ++i) {
+        p = putText(p, m_prefixes[i]);
+        p = putFixed(p, values[i], VALUE_FORMATS[i].precision);
+    }
+    if (m_passband) {
+        const PassbandResult empty;
+        const PassbandResult& band = passband ? *passband : empty;
+        const double metrics[PASSBAND_COLUMNS] = {
+            band.averagePLF, band.minPLF, band.maxPLF, band.depolarization, band.rotationSpread_deg
+        };
+        for (int i = 0; i < PASSBAND_COLUMNS; ++i) {
+            p = putText(p, m_passbandPrefixes[i]);
+            p = putFixed(p, metrics[i], PASSBAND_FORMATS[i].precision);
+        }
+    }
+    if (m_polarization) {
+        const PolarizationSolution empty;
+        const PolarizationSolution& solution = polarization ? *polarization : empty;
+        const double metrics[POLARIZATION_COLUMNS] = {
+            solution.optimalPsi_deg, solution.optimalPLF,
+            solution.arrivalPsi_deg, solution.arrivalChi_deg, solution.combinedPLF
+        };
+        for (int i = 0; i < POLARIZATION_COLUMNS; ++i) {
+            p = putText(p, m_polarizationPrefixes[i]);
+            p = putFixed(p, metrics[i], POLARIZATION_FORMATS[i].precision);
+        }
+    }
+    if (m_sensitivity) {
+        const PLFSensitivity empty;
+        const PLFSensitivity& gradient = sensitivity ? *sensitivity : empty;
+        const double metrics[SENSITIVITY_COLUMNS] = {
+            gradient.dPLF_dvTEC_DX, gradient.dPLF_dvTEC_Home,
+            gradient.dPLF_dB_DX, gradient.dPLF_dB_Home, gradient.dPLF_dTime
+        };
+        for (int i = 0; i < SENSITIVITY_COLUMNS; ++i) {
+            p = putText(p, m_sensitivityPrefixes[i]);
+            p = putScientific(p, metrics[i], SENSITIVITY_FORMATS[i].precision);
+        }
+    }
+    p = putText(p, faraday ? m_faradayTrue : m_faradayFalse);
+    out.append(row, static_cast<std::size_t>(p - row));
+}
+
+void ResultTextWriter::writeFailure(std::string& out, const std::string& id, std::size_t line,
+                                    const std::string& message) const {
+    char number[24];
+    char* end = std::to_chars(number, number + sizeof(number), line).ptr;
+
+    if (m_format == BatchFormat::CSV) {
+        appendCsvField(out, id);
+        // Empty fields up to error: time, freq_MHz, the values, the optional groups, faraday.
+        out.append(static_cast<std::size_t>(VALUE_COLUMNS + 4 +
+                                            (m_passband ? PASSBAND_COLUMNS : 0) +
+                                            (m_polarization ? POLARIZATION_COLUMNS : 0) +
+                                            (m_sensitivity ? SENSITIVITY_COLUMNS : 0)), ',');
+        appendCsvField(out, "line " + std::string(number, end - number) + ": " + message);
+        out.push_back('\n');
+        return;
+    }
+
+    out.append("{\"id\":");
+    appendJsonString(out, id);
+    out.append(",\"line\":");
+    out.append(number, end - number);
+    out.append(",\"error\":");
+    appendJsonString(out, message);
+    out.append("}\n");
+}
+
+// ========== Escaping ==========
+
+void ResultTextWriter::appendJsonString(std::string& out, const std::string& text) {
+    static const char HEX[] = "0123456789abcdef";
+    out.push_back('"');
+    for (char c : text) {
+        unsigned char u = static_cast<unsigned char>(c);
+        if (c == '"' || c == '\\') {
+            out.push_back('\\');
+            out.push_back(c);
+        } else if (u < 0x20) {
+            out.append("\\u00");
+            out.push_back(HEX[u >> 4]);
+            out.push_back(HEX[u & 15]);
+        } else {
+            out.push_back(c);
+        }
+    }
+    out.push_back('"');
+}
+
+void ResultTextWriter::appendCsvField(std::string& out, const std::string& text) {
+    if (text.find_first_of(",\"\r\n") == std::string::npos) {
+        out.append(text);
+        return;
+    }
+    out.push_back('"');
+    for (char c : text) {
+        if (c == '"') out.push_back('"');
+        out.push_back(c == '\r' || c == '\n' ? ' ' : c);
+    }
+    out.push_back('"');
+}
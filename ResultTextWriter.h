@@ -0,0 +1,74 @@
+#pragma once
+
+#include "Parameters.h"
+#include "BatchJobParser.h"
+#include <cstddef>
+#include <string>
+
+// ========== Result Text Writer ==========
+// Formats result rows as CSV or JSONL, the text formats of FaradayBatch.
+// Numbers go through std::to_chars straight into a row buffer, with the
+// separators and JSON keys prepared once per format, so a row costs one append
+// to the output. Const after setFormat(), so worker threads can share one writer
+// and each format into its own string.
+
+class ResultTextWriter {
+public:
+    ResultTextWriter();
+
+    // JSONL or CSV.
+    void setFormat(BatchFormat format);
+    BatchFormat getFormat() const { return m_format; }
+
+    // Adds the passband columns (PLF_avg, PLF_min, PLF_max, depolarization,
+    // spread_deg) before faraday.
+    void setPassband(bool passband) { m_passband = passband; }
+    bool getPassband() const { return m_passband; }
+
+    // Adds the receive polarization columns (psi_opt_deg, PLF_opt,
+    // arrival_psi_deg, arrival_chi_deg, PLF_dual) after them.
+    void setPolarization(bool polarization) { m_polarization = polarization; }
+    bool getPolarization() const { return m_polarization; }
+
+    // Adds the PLF sensitivity columns (dPLF_dvTEC_DX, dPLF_dvTEC_Home,
+    // dPLF_dB_DX, dPLF_dB_Home, dPLF_dt) last.
+    void setSensitivity(bool sensitivity) { m_sensitivity = sensitivity; }
+    bool getSensitivity() const { return m_sensitivity; }
+
+    // CSV column line; nothing for JSONL.
+    void writeHeader(std::string& out) const;
+
+    void writeResult(std::string& out, const std::string& id, double time, double frequency_MHz,
+                     const CalculationResults& result, const MoonEphemeris& moon,
+                     const IonosphereData& iono, bool faraday,
+                     const PassbandResult* passband = nullptr,
+                     const PolarizationSolution* polarization = nullptr,
+                     const PLFSensitivity* sensitivity = nullptr) const;
+
+    // A job that could not be parsed or computed; line is its place in the input.
+    void writeFailure(std::string& out, const std::string& id, std::size_t line,
+                      const std::string& message) const;
+
+    static void appendJsonString(std::string& out, const std::string& text);
+    static void appendCsvField(std::string& out, const std::string& text);
+
+private:
+    static constexpr int VALUE_COLUMNS = 10;
+    static constexpr int PASSBAND_COLUMNS = 5;
+    static constexpr int POLARIZATION_COLUMNS = 5;
+    static constexpr int SENSITIVITY_COLUMNS = 5;
+
+    BatchFormat m_format;
+    bool m_passband;
+    bool m_polarization;
+    bool m_sensitivity;
+    // Text that precedes each value, e.g. ",\"PLF\":" or ",".
+    std::string m_timePrefix;
+    std::string m_frequencyPrefix;
+    std::string m_prefixes[VALUE_COLUMNS];
+    std::string m_passbandPrefixes[PASSBAND_COLUMNS];
+    std::string m_polarizationPrefixes[POLARIZATION_COLUMNS];
+    std::string m_sensitivityPrefixes[SENSITIVITY_COLUMNS];
+    std::string m_faradayTrue;
+    std::string m_faradayFalse;
+};
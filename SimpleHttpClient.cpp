@@ -1,123 +1,946 @@
 #include "SimpleHttpClient.h"
+#include <algorithm>
+#include <cstring>
+#include <cstdlib>
+#include <cctype>
+#include <charconv>
+#include <system_error>
+
+#ifdef _WIN32
 #include <windows.h>
 #include <winhttp.h>
-#include <sstream>
 
 #pragma comment(lib, "winhttp.lib")
+#else
+#include <sys/types.h>
+#include <sys/socket.h>
+#include <netdb.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <poll.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <cerrno>
 
-bool SimpleHttpClient::fetchUrl(const std::string& url, std::string& response) {
+#if !defined(FARADAY_NO_OPENSSL) && __has_include(<openssl/ssl.h>)
+#define FARADAY_HTTP_OPENSSL 1
+#include <openssl/ssl.h>
+#include <openssl/err.h>
+#endif
+
+#if !defined(FARADAY_NO_ZLIB) && __has_include(<zlib.h>)
+#define FARADAY_HTTP_ZLIB 1
+#include <zlib.h>
+#endif
+
+#ifndef MSG_NOSIGNAL
+#define MSG_NOSIGNAL 0
+#endif
+#endif
+
+namespace {
+    constexpr size_t BUFFER_SIZE = 64 * 1024;
+    constexpr int MAX_REDIRECTS = 5;
+
+    struct ParsedUrl {
+        bool secure;
+        std::string host;
+        int port;
+        std::string path;
+    };
+
+    bool parseUrl(const std::string& url, ParsedUrl& parsed) {
+        size_t protocolEnd = url.find("://");
+        if (protocolEnd == std::string::npos) {
+            return false;
+        }
+
+        std::string protocol = url.substr(0, protocolEnd);
+        std::transform(protocol.begin(), protocol.end(), protocol.begin(),
+                       [](unsigned char c) { return static_cast<char>(std::tolower(c)); });
+        if (protocol != "http" && protocol != "https") {
+            return false;
+        }
+        parsed.secure = (protocol == "https");
+
+        std::string remainder = url.substr(protocolEnd + 3);
+        size_t hostEnd = remainder.find('/');
+        std::string authority = remainder.substr(0, hostEnd);
+        parsed.path = (hostEnd != std::string::npos) ? remainder.substr(hostEnd) : "/";
+        parsed.port = parsed.secure ? 443 : 80;
+
+        // [IPv6]:port, host:port or host
+        size_t portSeparator = authority.rfind(':');
+        size_t bracketEnd = authority.find(']');
+        if (portSeparator != std::string::npos &&
+            (bracketEnd == std::string::npos || portSeparator > bracketEnd)) {
+            parsed.port = std::atoi(authority.c_str() + portSeparator + 1);
+            authority.resize(portSeparator);
+        }
+        if (authority.size() >= 2 && authority.front() == '[' && authority.back() == ']') {
+            authority = authority.substr(1, authority.size() - 2);
+        }
+        parsed.host = authority;
+
+        return !parsed.host.empty() && parsed.port > 0 && parsed.port < 65536;
+    }
+}
+
+// ========== Constructor ==========
+
+SimpleHttpClient::SimpleHttpClient()
+    : m_buffer(BUFFER_SIZE), m_connectTimeout(10000), m_receiveTimeout(30000),
+      m_userAgent("Mutsumi Wakaba / 01.14"), m_statusCode(0), m_connectionCount(0) {
+}
+
+void SimpleHttpClient::setTimeouts(int connectTimeout_ms, int receiveTimeout_ms) {
+    m_connectTimeout = connectTimeout_ms;
+    m_receiveTimeout = receiveTimeout_ms;
+    close();
+}
+
+void SimpleHttpClient::setUserAgent(const std::string& userAgent) {
+    m_userAgent = userAgent;
+    close();
+}
+
+// ========== Requests ==========
+
+bool SimpleHttpClient::get(const std::string& url, const DataCallback& onData) {
+    std::string current = url;
+
+    for (int hop = 0; hop <= MAX_REDIRECTS; ++hop) {
+        std::string location;
+        if (request(current, onData, location)) {
+            return true;
+        }
+        if (location.empty()) {
+            return false;
+        }
+        current = location;
+    }
+
+    m_error = "Too many redirects";
+    return false;
+}
+
+bool SimpleHttpClient::get(const std::string& url, std::string& response) {
     response.clear();
+    return get(url, [&response](const char* data, std::size_t length) {
+        response.append(data, length);
+        return true;
+    });
+}
 
-    size_t protocolEnd = url.find("://");
-    if (protocolEnd == std::string::npos) {
-        return false;
+bool SimpleHttpClient::fetchUrl(const std::string& url, std::string& response) {
+    SimpleHttpClient client;
+    return client.get(url, response) && !response.empty();
+}
+
+#ifdef _WIN32
+
+// ========== WinHTTP Implementation ==========
+// WinHTTP pools the socket behind a connect handle, so keeping the session and
+// connect handles alive is enough for keep-alive. It also follows redirects itself.
+
+struct SimpleHttpClient::Connection {
+    HINTERNET session = nullptr;
+    HINTERNET connect = nullptr;
+    std::string host;
+    int port = 0;
+
+    ~Connection() {
+        if (connect) WinHttpCloseHandle(connect);
+        if (session) WinHttpCloseHandle(session);
     }
+};
 
-    std::string protocol = url.substr(0, protocolEnd);
-    std::string remainder = url.substr(protocolEnd + 3);
+SimpleHttpClient::~SimpleHttpClient() {
+}
+
+void SimpleHttpClient::close() {
+    m_connection.reset();
+}
 
-    size_t hostEnd = remainder.find('/');
-    std::string host = remainder.substr(0, hostEnd);
-    std::string path = (hostEnd != std::string::npos) ? remainder.substr(hostEnd) : "/";
+bool SimpleHttpClient::supportsHttps() {
+    return true;
+}
 
-    std::wstring wHost(host.begin(), host.end());
-    std::wstring wPath(path.begin(), path.end());
+bool SimpleHttpClient::supportsGzip() {
+#ifdef WINHTTP_OPTION_DECOMPRESSION
+    return true;
+#else
+    return false;
+#endif
+}
 
-    HINTERNET hSession = WinHttpOpen(
-        L"Mutsumi Wakaba / 01.14",
-        WINHTTP_ACCESS_TYPE_DEFAULT_PROXY,
-        WINHTTP_NO_PROXY_NAME,
-        WINHTTP_NO_PROXY_BYPASS,
-        0
-    );
+bool SimpleHttpClient::request(const std::string& url, const DataCallback& onData, std::string& location) {
+    location.clear();
+    m_statusCode = 0;
+    m_error.clear();
 
-    if (!hSession) {
+    ParsedUrl target;
+    if (!parseUrl(url, target)) {
+        m_error = "Malformed URL: " + url;
         return false;
     }
 
-    DWORD dwFlags = (protocol == "https") ? WINHTTP_FLAG_SECURE : 0;
+    if (!m_connection) {
+        m_connection = std::make_unique<Connection>();
+    }
+    Connection& conn = *m_connection;
 
-    HINTERNET hConnect = WinHttpConnect(
-        hSession,
-        wHost.c_str(),
-        (protocol == "https") ? INTERNET_DEFAULT_HTTPS_PORT : INTERNET_DEFAULT_HTTP_PORT,
-        0
-    );
+    if (!conn.session) {
+        std::wstring wAgent(m_userAgent.begin(), m_userAgent.end());
+        conn.session = WinHttpOpen(
+            wAgent.c_str(),
+            WINHTTP_ACCESS_TYPE_DEFAULT_PROXY,
+            WINHTTP_NO_PROXY_NAME,
+            WINHTTP_NO_PROXY_BYPASS,
+            0
+        );
+        if (!conn.session) {
+            m_error = "WinHttpOpen failed";
+            return false;
+        }
 
-    if (!hConnect) {
-        WinHttpCloseHandle(hSession);
-        return false;
+        WinHttpSetTimeouts(conn.session, m_connectTimeout, m_connectTimeout,
+                           m_receiveTimeout, m_receiveTimeout);
+#ifdef WINHTTP_OPTION_DECOMPRESSION
+        DWORD decompression = WINHTTP_DECOMPRESSION_FLAG_GZIP;
+        WinHttpSetOption(conn.session, WINHTTP_OPTION_DECOMPRESSION, &decompression, sizeof(decompression));
+#endif
+    }
+
+    if (!conn.connect || conn.host != target.host || conn.port != target.port) {
+        if (conn.connect) {
+            WinHttpCloseHandle(conn.connect);
+            conn.connect = nullptr;
+        }
+
+        std::wstring wHost(target.host.begin(), target.host.end());
+        conn.connect = WinHttpConnect(conn.session, wHost.c_str(),
+                                      static_cast<INTERNET_PORT>(target.port), 0);
+        if (!conn.connect) {
+            m_error = "WinHttpConnect failed";
+            return false;
+        }
+        conn.host = target.host;
+        conn.port = target.port;
+        ++m_connectionCount;
     }
 
+    std::wstring wPath(target.path.begin(), target.path.end());
     HINTERNET hRequest = WinHttpOpenRequest(
-        hConnect,
+        conn.connect,
         L"GET",
         wPath.c_str(),
         NULL,
         WINHTTP_NO_REFERER,
         WINHTTP_DEFAULT_ACCEPT_TYPES,
-        dwFlags
+        target.secure ? WINHTTP_FLAG_SECURE : 0
     );
 
     if (!hRequest) {
-        WinHttpCloseHandle(hConnect);
-        WinHttpCloseHandle(hSession);
+        m_error = "WinHttpOpenRequest failed";
         return false;
     }
 
-    BOOL bResults = WinHttpSendRequest(
-        hRequest,
-        WINHTTP_NO_ADDITIONAL_HEADERS,
-        0,
-        WINHTTP_NO_REQUEST_DATA,
-        0,
-        0,
-        0
-    );
-
-    if (!bResults) {
+    if (!WinHttpSendRequest(hRequest, WINHTTP_NO_ADDITIONAL_HEADERS, 0,
+                            WINHTTP_NO_REQUEST_DATA, 0, 0, 0) ||
+        !WinHttpReceiveResponse(hRequest, NULL)) {
+        m_error = "Request failed (error " + std::to_string(GetLastError()) + ")";
         WinHttpCloseHandle(hRequest);
-        WinHttpCloseHandle(hConnect);
-        WinHttpCloseHandle(hSession);
         return false;
     }
 
-    bResults = WinHttpReceiveResponse(hRequest, NULL);
+    DWORD status = 0;
+    DWORD statusSize = sizeof(status);
+    WinHttpQueryHeaders(hRequest, WINHTTP_QUERY_STATUS_CODE | WINHTTP_QUERY_FLAG_NUMBER,
+                        WINHTTP_HEADER_NAME_BY_INDEX, &status, &statusSize, WINHTTP_NO_HEADER_INDEX);
+    m_statusCode = static_cast<int>(status);
 
-    if (bResults) {
-        DWORD dwSize = 0;
-        DWORD dwDownloaded = 0;
-        std::ostringstream oss;
+    bool ok = (status >= 200 && status < 300);
+    if (!ok) {
+        m_error = "HTTP " + std::to_string(status);
+    }
 
-        do {
-            dwSize = 0;
-            if (!WinHttpQueryDataAvailable(hRequest, &dwSize)) {
-                break;
+    while (ok) {
+        DWORD downloaded = 0;
+        if (!WinHttpReadData(hRequest, m_buffer.data(), static_cast<DWORD>(m_buffer.size()), &downloaded)) {
+            m_error = "Read failed (error " + std::to_string(GetLastError()) + ")";
+            ok = false;
+            break;
+        }
+        if (downloaded == 0) {
+            break;
+        }
+        if (!onData(m_buffer.data(), downloaded)) {
+            m_error = "Transfer aborted by callback";
+            ok = false;
+        }
+    }
+
+    WinHttpCloseHandle(hRequest);
+    return ok;
+}
+
+#else
+
+// ========== Socket Implementation ==========
+
+namespace {
+    bool equalsIgnoreCase(const std::string& a, const char* b) {
+        size_t n = std::strlen(b);
+        if (a.size() != n) return false;
+        for (size_t i = 0; i < n; ++i) {
+            if (std::tolower(static_cast<unsigned char>(a[i])) != std::tolower(static_cast<unsigned char>(b[i]))) {
+                return false;
             }
+        }
+        return true;
+    }
 
-            if (dwSize == 0) {
-                break;
+    bool containsToken(const std::string& value, const char* token) {
+        std::string lower = value;
+        std::transform(lower.begin(), lower.end(), lower.begin(),
+                       [](unsigned char c) { return static_cast<char>(std::tolower(c)); });
+        return lower.find(token) != std::string::npos;
+    }
+
+    std::string trim(const std::string& s) {
+        size_t first = s.find_first_not_of(" \t");
+        size_t last = s.find_last_not_of(" \t\r");
+        return (first == std::string::npos) ? std::string() : s.substr(first, last - first + 1);
+    }
+
+    bool waitFor(int fd, short events, int timeout_ms, std::string& error) {
+        pollfd p = { fd, events, 0 };
+        while (true) {
+            int rc = ::poll(&p, 1, timeout_ms);
+            if (rc > 0) return true;
+            if (rc == 0) {
+                error = "Timed out";
+                return false;
+            }
+            if (errno != EINTR) {
+                error = std::string("poll failed: ") + std::strerror(errno);
+                return false;
+            }
+        }
+    }
+
+#ifdef FARADAY_HTTP_ZLIB
+    // Streams a gzip body through a fixed output buffer.
+    class GzipInflater {
+    public:
+        GzipInflater() : m_active(false), m_done(false) {
+            std::memset(&m_stream, 0, sizeof(m_stream));
+        }
+        ~GzipInflater() {
+            if (m_active) inflateEnd(&m_stream);
+        }
+
+        bool begin() {
+            m_done = false;
+            m_active = (inflateInit2(&m_stream, 16 + MAX_WBITS) == Z_OK);
+            return m_active;
+        }
+
+        bool isDone() const { return m_done; }
+
+        // Returns false on corrupt data or when the sink aborts.
+        bool write(const char* data, size_t length, std::vector<char>& out,
+                   const SimpleHttpClient::DataCallback& sink, bool& aborted) {
+            m_stream.next_in = reinterpret_cast<Bytef*>(const_cast<char*>(data));
+            m_stream.avail_in = static_cast<uInt>(length);
+
+            do {
+                m_stream.next_out = reinterpret_cast<Bytef*>(out.data());
+                m_stream.avail_out = static_cast<uInt>(out.size());
+
+                int rc = inflate(&m_stream, Z_NO_FLUSH);
+                if (rc != Z_OK && rc != Z_STREAM_END && rc != Z_BUF_ERROR) {
+                    return false;
+                }
+
+                size_t produced = out.size() - m_stream.avail_out;
+                if (produced > 0 && !sink(out.data(), produced)) {
+                    aborted = true;
+                    return false;
+                }
+                if (rc == Z_STREAM_END) {
+                    m_done = true;
+                    break;
+                }
+                if (rc == Z_BUF_ERROR) {
+                    break;
+                }
+            } while (m_stream.avail_in > 0 || m_stream.avail_out == 0);
+
+            return true;
+        }
+
+    private:
+        z_stream m_stream;
+        bool m_active;
+        bool m_done;
+    };
+#endif
+
+    struct ResponseHead {
+        int status = 0;
+        long long contentLength = -1;
+        bool chunked = false;
+        bool gzip = false;
+        bool close = false;
+        std::string location;
+    };
+
+    // chunk-size [ws] [";" ext]: at least one hex digit, no sign or prefix.
+    // Anything else is a damaged body, not the last chunk.
+    bool parseChunkSize(const std::string& line, long long& size) {
+        const char* first = line.c_str();
+        const char* last = first + line.size();
+        auto [end, ec] = std::from_chars(first, last, size, 16);
+        if (ec != std::errc() || end == first || size < 0) {
+            return false;
+        }
+        while (end != last && (*end == ' ' || *end == '\t')) {
+            ++end;
+        }
+        return end == last || *end == ';';
+    }
+
+    bool parseResponseHead(const std::string& head, ResponseHead& response) {
+        size_t lineEnd = head.find("\r\n");
+        std::string statusLine = head.substr(0, lineEnd);
+
+        if (statusLine.compare(0, 5, "HTTP/") != 0 || statusLine.size() < 12) {
+            return false;
+        }
+        response.status = std::atoi(statusLine.c_str() + 9);
+        response.close = (statusLine.compare(0, 8, "HTTP/1.0") == 0);
+
+        size_t pos = (lineEnd == std::string::npos) ? head.size() : lineEnd + 2;
+        while (pos < head.size()) {
+            size_t end = head.find("\r\n", pos);
+            if (end == std::string::npos) end = head.size();
+
+            std::string line = head.substr(pos, end - pos);
+            pos = end + 2;
+
+            size_t colon = line.find(':');
+            if (colon == std::string::npos) continue;
+
+            std::string name = trim(line.substr(0, colon));
+            std::string value = trim(line.substr(colon + 1));
+
+            if (equalsIgnoreCase(name, "content-length")) {
+                response.contentLength = std::atoll(value.c_str());
+            } else if (equalsIgnoreCase(name, "transfer-encoding")) {
+                response.chunked = containsToken(value, "chunked");
+            } else if (equalsIgnoreCase(name, "content-encoding")) {
+                response.gzip = containsToken(value, "gzip");
+            } else if (equalsIgnoreCase(name, "connection")) {
+                if (containsToken(value, "close")) response.close = true;
+                else if (containsToken(value, "keep-alive")) response.close = false;
+            } else if (equalsIgnoreCase(name, "location")) {
+                response.location = value;
             }
+        }
+        return response.status > 0;
+    }
+}
+
+struct SimpleHttpClient::Connection {
+    int fd = -1;
+    std::string host;
+    int port = 0;
+    bool secure = false;
+
+    // Unread received bytes are buffer[begin, end).
+    std::vector<char> buffer = std::vector<char>(BUFFER_SIZE);
+    size_t begin = 0;
+    size_t end = 0;
 
-            char* pszOutBuffer = new char[dwSize + 1];
-            ZeroMemory(pszOutBuffer, dwSize + 1);
+#ifdef FARADAY_HTTP_OPENSSL
+    SSL_CTX* context = nullptr;
+    SSL* ssl = nullptr;
+#endif
+
+    ~Connection() {
+        shutdown();
+#ifdef FARADAY_HTTP_OPENSSL
+        if (context) SSL_CTX_free(context);
+#endif
+    }
 
-            if (!WinHttpReadData(hRequest, (LPVOID)pszOutBuffer, dwSize, &dwDownloaded)) {
-                delete[] pszOutBuffer;
+    bool isOpen() const { return fd >= 0; }
+
+    void shutdown() {
+#ifdef FARADAY_HTTP_OPENSSL
+        if (ssl) {
+            SSL_free(ssl);
+            ssl = nullptr;
+        }
+#endif
+        if (fd >= 0) {
+            ::close(fd);
+            fd = -1;
+        }
+        begin = end = 0;
+    }
+
+    bool open(const ParsedUrl& target, int timeout_ms, std::string& error) {
+        shutdown();
+
+        addrinfo hints = {};
+        hints.ai_family = AF_UNSPEC;
+        hints.ai_socktype = SOCK_STREAM;
+
+        addrinfo* addresses = nullptr;
+        std::string service = std::to_string(target.port);
+        int rc = ::getaddrinfo(target.host.c_str(), service.c_str(), &hints, &addresses);
+        if (rc != 0) {
+            error = "Cannot resolve " + target.host + ": " + gai_strerror(rc);
+            return false;
+        }
+
+        for (addrinfo* ai = addresses; ai && fd < 0; ai = ai->ai_next) {
+            fd = ::socket(ai->ai_family, ai->ai_socktype, ai->ai_protocol);
+            if (fd < 0) continue;
+
+            ::fcntl(fd, F_SETFL, ::fcntl(fd, F_GETFL, 0) | O_NONBLOCK);
+#ifdef SO_NOSIGPIPE
+            int one = 1;
+            ::setsockopt(fd, SOL_SOCKET, SO_NOSIGPIPE, &one, sizeof(one));
+#endif
+
+            bool connected = (::connect(fd, ai->ai_addr, ai->ai_addrlen) == 0);
+            if (!connected && errno == EINPROGRESS && waitFor(fd, POLLOUT, timeout_ms, error)) {
+                int socketError = 0;
+                socklen_t length = sizeof(socketError);
+                ::getsockopt(fd, SOL_SOCKET, SO_ERROR, &socketError, &length);
+                connected = (socketError == 0);
+                if (!connected) error = std::string("Connect failed: ") + std::strerror(socketError);
+            } else if (!connected && error.empty()) {
+                error = std::string("Connect failed: ") + std::strerror(errno);
+            }
+
+            if (!connected) {
+                ::close(fd);
+                fd = -1;
+            }
+        }
+        ::freeaddrinfo(addresses);
+
+        if (fd < 0) {
+            if (error.empty()) error = "Connect failed";
+            return false;
+        }
+        error.clear();
+
+        int noDelay = 1;
+        ::setsockopt(fd, IPPROTO_TCP, TCP_NODELAY, &noDelay, sizeof(noDelay));
+
+        host = target.host;
+        port = target.port;
+        secure = target.secure;
+
+        return !secure || startTls(timeout_ms, error);
+    }
+
+    bool startTls(int timeout_ms, std::string& error) {
+#ifdef FARADAY_HTTP_OPENSSL
+        if (!context) {
+            context = SSL_CTX_new(TLS_client_method());
+            if (!context) {
+                error = "Cannot create TLS context";
+                return false;
+            }
+            SSL_CTX_set_default_verify_paths(context);
+            SSL_CTX_set_verify(context, SSL_VERIFY_PEER, nullptr);
+#ifdef SSL_OP_IGNORE_UNEXPECTED_EOF
+            SSL_CTX_set_options(context, SSL_OP_IGNORE_UNEXPECTED_EOF);
+#endif
+        }
+
+        ssl = SSL_new(context);
+        SSL_set_fd(ssl, fd);
+        SSL_set_tlsext_host_name(ssl, host.c_str());
+        SSL_set1_host(ssl, host.c_str());
+
+        while (true) {
+            int rc = SSL_connect(ssl);
+            if (rc == 1) return true;
+
+            int reason = SSL_get_error(ssl, rc);
+            if (reason == SSL_ERROR_WANT_READ && waitFor(fd, POLLIN, timeout_ms, error)) continue;
+            if (reason == SSL_ERROR_WANT_WRITE && waitFor(fd, POLLOUT, timeout_ms, error)) continue;
+
+            char detail[256] = "";
+            ERR_error_string_n(ERR_get_error(), detail, sizeof(detail));
+            error = std::string("TLS handshake failed: ") + (error.empty() ? detail : error);
+            shutdown();
+            return false;
+        }
+#else
+        (void)timeout_ms;
+        error = "HTTPS is not available: built without OpenSSL";
+        shutdown();
+        return false;
+#endif
+    }
+
+    bool sendAll(const char* data, size_t length, int timeout_ms, std::string& error) {
+        while (length > 0) {
+            long sent;
+#ifdef FARADAY_HTTP_OPENSSL
+            if (ssl) {
+                int rc = SSL_write(ssl, data, static_cast<int>(length));
+                if (rc <= 0) {
+                    int reason = SSL_get_error(ssl, rc);
+                    if (reason == SSL_ERROR_WANT_READ && waitFor(fd, POLLIN, timeout_ms, error)) continue;
+                    if (reason == SSL_ERROR_WANT_WRITE && waitFor(fd, POLLOUT, timeout_ms, error)) continue;
+                    if (error.empty()) error = "TLS write failed";
+                    return false;
+                }
+                sent = rc;
+            } else
+#endif
+            {
+                sent = ::send(fd, data, length, MSG_NOSIGNAL);
+                if (sent < 0) {
+                    if (errno == EINTR) continue;
+                    if ((errno == EAGAIN || errno == EWOULDBLOCK) && waitFor(fd, POLLOUT, timeout_ms, error)) continue;
+                    if (error.empty()) error = std::string("Send failed: ") + std::strerror(errno);
+                    return false;
+                }
+            }
+            data += sent;
+            length -= static_cast<size_t>(sent);
+        }
+        return true;
+    }
+
+    // Reads once from the socket into the buffer. Returns bytes read, 0 on EOF, -1 on error.
+    long fill(int timeout_ms, std::string& error) {
+        if (begin == end) {
+            begin = end = 0;
+        } else if (end == buffer.size()) {
+            std::memmove(buffer.data(), buffer.data() + begin, end - begin);
+            end -= begin;
+            begin = 0;
+        }
+        if (end == buffer.size()) {
+            error = "Receive buffer full";
+            return -1;
+        }
+
+        char* out = buffer.data() + end;
+        size_t space = buffer.size() - end;
+
+        while (true) {
+            long received;
+#ifdef FARADAY_HTTP_OPENSSL
+            if (ssl) {
+                int rc = SSL_read(ssl, out, static_cast<int>(space));
+                if (rc <= 0) {
+                    int reason = SSL_get_error(ssl, rc);
+                    if (reason == SSL_ERROR_ZERO_RETURN) return 0;
+                    if (reason == SSL_ERROR_WANT_READ && waitFor(fd, POLLIN, timeout_ms, error)) continue;
+                    if (reason == SSL_ERROR_WANT_WRITE && waitFor(fd, POLLOUT, timeout_ms, error)) continue;
+                    if (reason == SSL_ERROR_SYSCALL && error.empty()) return 0;
+                    if (error.empty()) error = "TLS read failed";
+                    return -1;
+                }
+                received = rc;
+            } else
+#endif
+            {
+                received = ::recv(fd, out, space, 0);
+                if (received < 0) {
+                    if (errno == EINTR) continue;
+                    if ((errno == EAGAIN || errno == EWOULDBLOCK) && waitFor(fd, POLLIN, timeout_ms, error)) continue;
+                    if (error.empty()) error = std::string("Receive failed: ") + std::strerror(errno);
+                    return -1;
+                }
+            }
+            end += static_cast<size_t>(received);
+            return received;
+        }
+    }
+
+    // Reads up to and including the next CRLF.
+    bool readLine(std::string& line, int timeout_ms, std::string& error) {
+        while (true) {
+            const char* first = buffer.data() + begin;
+            const char* last = buffer.data() + end;
+            const char* cr = std::search(first, last, "\r\n", "\r\n" + 2);
+            if (cr != last) {
+                line.assign(first, cr);
+                begin += (cr - first) + 2;
+                return true;
+            }
+            if (fill(timeout_ms, error) <= 0) {
+                if (error.empty()) error = "Connection closed";
+                return false;
+            }
+        }
+    }
+};
+
+SimpleHttpClient::~SimpleHttpClient() {
+}
+
+void SimpleHttpClient::close() {
+    m_connection.reset();
+}
+
+bool SimpleHttpClient::supportsHttps() {
+#ifdef FARADAY_HTTP_OPENSSL
+    return true;
+#else
+    return false;
+#endif
+}
+
+bool SimpleHttpClient::supportsGzip() {
+#ifdef FARADAY_HTTP_ZLIB
+    return true;
+#else
+    return false;
+#endif
+}
+
+bool SimpleHttpClient::request(const std::string& url, const DataCallback& onData, std::string& location) {
+    location.clear();
+    m_statusCode = 0;
+    m_error.clear();
+
+    ParsedUrl target;
+    if (!parseUrl(url, target)) {
+        m_error = "Malformed URL: " + url;
+        return false;
+    }
+
+    if (!m_connection) {
+        m_connection = std::make_unique<Connection>();
+    }
+    Connection& conn = *m_connection;
+
+    std::string hostHeader = target.host;
+    if (hostHeader.find(':') != std::string::npos) {
+        hostHeader = "[" + hostHeader + "]";
+    }
+    if (target.port != (target.secure ? 443 : 80)) {
+        hostHeader += ":" + std::to_string(target.port);
+    }
+
+    std::string requestHead =
+        "GET " + target.path + " HTTP/1.1\r\n"
+        "Host: " + hostHeader + "\r\n"
+        "User-Agent: " + m_userAgent + "\r\n"
+        "Accept: */*\r\n" +
+        (supportsGzip() ? "Accept-Encoding: gzip\r\n" : "") +
+        "Connection: keep-alive\r\n\r\n";
+
+    // An idle kept-alive connection may have been closed by the server; if nothing
+    // comes back on a reused connection, reconnect once and resend.
+    ResponseHead response;
+    for (int attempt = 0; ; ++attempt) {
+        bool reused = conn.isOpen() && conn.host == target.host &&
+                      conn.port == target.port && conn.secure == target.secure;
+        if (!reused) {
+            if (!conn.open(target, m_connectTimeout, m_error)) {
+                return false;
+            }
+            ++m_connectionCount;
+        }
+
+        bool sent = conn.sendAll(requestHead.data(), requestHead.size(), m_receiveTimeout, m_error);
+        bool gotBytes = false;
+
+        // Interim 1xx responses are skipped.
+        while (sent && m_error.empty()) {
+            std::string head;
+            std::string line;
+            while (conn.readLine(line, m_receiveTimeout, m_error)) {
+                gotBytes = true;
+                if (line.empty()) break;
+                if (head.size() > BUFFER_SIZE) {
+                    m_error = "Response header too large";
+                    break;
+                }
+                head += line;
+                head += "\r\n";
+            }
+            if (!m_error.empty()) break;
+
+            response = ResponseHead();
+            if (!parseResponseHead(head, response)) {
+                m_error = "Malformed response header";
                 break;
             }
+            if (response.status >= 200) break;
+        }
+
+        if (sent && m_error.empty()) {
+            break;
+        }
 
-            oss.write(pszOutBuffer, dwDownloaded);
-            delete[] pszOutBuffer;
+        conn.shutdown();
+        if (!reused || gotBytes || attempt > 0) {
+            return false;
+        }
+        m_error.clear();
+    }
+
+    m_statusCode = response.status;
+    const bool success = (response.status >= 200 && response.status < 300);
+    const bool hasBody = !(response.status == 204 || response.status == 304);
 
-        } while (dwSize > 0);
+    bool aborted = false;
+    bool corrupt = false;
 
-        response = oss.str();
+#ifdef FARADAY_HTTP_ZLIB
+    GzipInflater inflater;
+    const bool gunzip = success && response.gzip;
+    if (gunzip && !inflater.begin()) {
+        m_error = "Cannot initialise gzip decoder";
+        conn.shutdown();
+        return false;
     }
+#else
+    if (success && response.gzip) {
+        m_error = "Response is gzip-encoded but zlib is not available";
+        conn.shutdown();
+        return false;
+    }
+#endif
 
-    WinHttpCloseHandle(hRequest);
-    WinHttpCloseHandle(hConnect);
-    WinHttpCloseHandle(hSession);
+    // Bodies of non-2xx responses are read and dropped to keep the connection usable.
+    auto deliver = [&](const char* data, size_t length) {
+        if (!success || length == 0) return true;
+#ifdef FARADAY_HTTP_ZLIB
+        if (gunzip) {
+            if (!inflater.write(data, length, m_buffer, onData, aborted)) {
+                corrupt = !aborted;
+                return false;
+            }
+            return true;
+        }
+#endif
+        if (!onData(data, length)) {
+            aborted = true;
+            return false;
+        }
+        return true;
+    };
 
-    return !response.empty();
+    // Passes up to `remaining` bytes of body through, reading as needed. -1 = until EOF.
+    auto pump = [&](long long remaining) {
+        while (remaining != 0) {
+            if (conn.begin == conn.end) {
+                long received = conn.fill(m_receiveTimeout, m_error);
+                if (received < 0) return false;
+                if (received == 0) {
+                    if (remaining < 0) return true;
+                    m_error = "Connection closed before end of body";
+                    return false;
+                }
+            }
+            size_t available = conn.end - conn.begin;
+            size_t take = (remaining < 0) ? available
+                                          : static_cast<size_t>(std::min<long long>(remaining, available));
+            bool ok = deliver(conn.buffer.data() + conn.begin, take);
+            conn.begin += take;
+            if (!ok) return false;
+            if (remaining > 0) remaining -= static_cast<long long>(take);
+        }
+        return true;
+    };
+
+    bool complete = true;
+    bool reusable = !response.close;
+
+    if (hasBody) {
+        if (response.chunked) {
+            std::string line;
+            while (true) {
+                if (!conn.readLine(line, m_receiveTimeout, m_error)) {
+                    complete = false;
+                    break;
+                }
+                long long chunkSize = 0;
+                if (!parseChunkSize(line, chunkSize)) {
+                    m_error = "Malformed chunk size";
+                    complete = false;
+                    break;
+                }
+                if (chunkSize == 0) {
+                    // Last chunk: discard trailers up to the blank line.
+                    while ((complete = conn.readLine(line, m_receiveTimeout, m_error)) && !line.empty()) {
+                    }
+                    break;
+                }
+                if (!pump(chunkSize) || !conn.readLine(line, m_receiveTimeout, m_error)) {
+                    complete = false;
+                    break;
+                }
+                if (!line.empty()) {
+                    m_error = "Malformed chunk terminator";
+                    complete = false;
+                    break;
+                }
+            }
+        } else if (response.contentLength >= 0) {
+            complete = pump(response.contentLength);
+        } else {
+            complete = pump(-1);
+            reusable = false;
+        }
+    }
+
+    if (!complete || !reusable || conn.begin != conn.end) {
+        conn.shutdown();
+    }
+
+    if (aborted) {
+        m_error = "Transfer aborted by callback";
+        return false;
+    }
+    if (corrupt) {
+        m_error = "Corrupt gzip body";
+        return false;
+    }
+    if (!complete) {
+        if (m_error.empty()) m_error = "Incomplete response body";
+        return false;
+    }
+#ifdef FARADAY_HTTP_ZLIB
+    if (gunzip && !inflater.isDone()) {
+        m_error = "Truncated gzip body";
+        return false;
+    }
+#endif
+
+    if (response.status >= 300 && response.status < 400 && !response.location.empty()) {
+        location = response.location;
+        if (location.find("://") == std::string::npos) {
+            std::string origin = std::string(target.secure ? "https://" : "http://") + hostHeader;
+            location = origin + (location[0] == '/' ? "" : "/") + location;
+        }
+        m_error = "Redirected to " + location;
+        return false;
+    }
+
+    if (!success) {
+        m_error = "HTTP " + std::to_string(response.status);
+        return false;
+    }
+    return true;
 }
+
+#endif
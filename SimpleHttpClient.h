@@ -1,8 +1,63 @@
 #pragma once
 
+#include <cstddef>
+#include <functional>
+#include <memory>
 #include <string>
+#include <vector>
+
+// ========== HTTP Client ==========
+// Blocking HTTP/1.1 GET. A client keeps its connection open between requests, so
+// periodic refreshes from the same host skip the TCP/TLS handshake. Bodies are handed
+// to a callback as they arrive (de-chunked and gunzipped), which lets large products
+// be parsed while they download.
+//
+// Windows uses WinHTTP. Elsewhere plain sockets are used, with HTTPS through OpenSSL
+// and gzip through zlib when their headers are available (link -lssl -lcrypto -lz);
+// define FARADAY_NO_OPENSSL or FARADAY_NO_ZLIB to build without them.
 
 class SimpleHttpClient {
 public:
+    // Receives body bytes in order. Returning false aborts the transfer.
+    using DataCallback = std::function<bool(const char* data, std::size_t length)>;
+
+    SimpleHttpClient();
+    ~SimpleHttpClient();
+
+    SimpleHttpClient(const SimpleHttpClient&) = delete;
+    SimpleHttpClient& operator=(const SimpleHttpClient&) = delete;
+
+    void setTimeouts(int connectTimeout_ms, int receiveTimeout_ms);
+    void setUserAgent(const std::string& userAgent);
+
+    // Succeeds only for a 2xx response whose body was delivered completely.
+    bool get(const std::string& url, const DataCallback& onData);
+    bool get(const std::string& url, std::string& response);
+
+    void close();
+
+    int getStatusCode() const { return m_statusCode; }
+    const std::string& getError() const { return m_error; }
+    std::size_t getConnectionCount() const { return m_connectionCount; }
+
+    static bool supportsHttps();
+    static bool supportsGzip();
+
+    // One-shot request on a temporary client.
     static bool fetchUrl(const std::string& url, std::string& response);
+
+private:
+    struct Connection;
+
+    std::unique_ptr<Connection> m_connection;
+    std::vector<char> m_buffer;
+    int m_connectTimeout;
+    int m_receiveTimeout;
+    std::string m_userAgent;
+
+    int m_statusCode;
+    std::string m_error;
+    std::size_t m_connectionCount;
+
+    bool request(const std::string& url, const DataCallback& onData, std::string& location);
 };
@@ -0,0 +1,324 @@
+#include "SkedPlanner.h"
+#include "FaradayRotation.h"
+#include "IonosphereDataProvider.h"
+#include "MoonCalendarReader.h"
+#include "LunarChebyshevCache.h"
+#include "GlotecSnapshotStore.h"
+#include <algorithm>
+#include <atomic>
+#include <cmath>
+#include <ctime>
+#include <memory>
+#include <thread>
+#include <utility>
+
+namespace {
+    // Floor for 10 log10(PLF) so cross-polarized instants still rank.
+    constexpr double MIN_PLF = 1e-6;
+
+    bool overlaps(const SkedSlot& a, const SkedSlot& b) {
+        return a.station == b.station && a.start < b.end && b.start < a.end;
+    }
+
+    // Greedy: best score first, skipping anything that overlaps a chosen slot.
+    void selectTop(std::vector<SkedSlot>& candidates, std::size_t k, std::vector<SkedSlot>& chosen) {
+        std::sort(candidates.begin(), candidates.end(),
+                  [](const SkedSlot& a, const SkedSlot& b) { return a.score_dB > b.score_dB; });
+        const std::size_t first = chosen.size();
+        for (const SkedSlot& slot : candidates) {
+            if (chosen.size() - first >= k) break;
+            bool clear = true;
+            for (std::size_t i = first; i < chosen.size() && clear; ++i) {
+                clear = !overlaps(slot, chosen[i]);
+            }
+            if (clear) chosen.push_back(slot);
+        }
+    }
+}
+
+// ========== Per-Thread Workspace ==========
+
+struct SkedPlanner::Workspace {
+    FaradayRotation calculator;
+    std::vector<double> times;
+    std::vector<MoonEphemeris> moons;
+    std::vector<std::tm> stamps;
+    std::vector<double> elevationDX, azimuthDX, elevationHome, azimuthHome;
+    std::vector<IonosphereData> iono;
+    std::vector<char> ionoValid;
+    std::vector<PreparedMagneticField> fields;
+    std::vector<Point> points;
+};
+
+// ========== Constructor ==========
+
+SkedPlanner::SkedPlanner(const LunarEphemeris& ephemeris)
+    : m_ephemeris(ephemeris), m_provider(nullptr), m_calendar(nullptr) {
+}
+
+// ========== Point Scoring ==========
+
+void SkedPlanner::scorePoints(Workspace& work, const SiteParameters& home, const SiteParameters& dx,
+                              const double* times, std::size_t count, Point* points) {
+    work.moons.resize(count);
+    m_ephemeris.computeMoonEphemerisBatch(times, count, dx, home, work.moons.data());
+
+    const bool chapman = m_config.ionoModel == SystemConfiguration::IonosphereModel::CHAPMAN;
+    work.ionoValid.assign(count, 0);
+    work.iono.resize(count);
+    if (m_provider && count > 0) {
+        work.stamps.resize(count);
+        work.elevationDX.resize(count);
+        work.azimuthDX.resize(count);
+        work.elevationHome.resize(count);
+        work.azimuthHome.resize(count);
+        for (std::size_t i = 0; i < count; ++i) {
+            work.stamps[i] = GlotecSnapshotStore::fromEpochSeconds(static_cast<std::int64_t>(std::floor(times[i])));
+            work.elevationDX[i] = work.moons[i].elevation_DX;
+            work.azimuthDX[i] = work.moons[i].azimuth_DX;
+            work.elevationHome[i] = work.moons[i].elevation_Home;
+            work.azimuthHome[i] = work.moons[i].azimuth_Home;
+        }
+
+        const double latDX = ParameterUtils::rad2deg(dx.latitude), lonDX = ParameterUtils::rad2deg(dx.longitude);
+        const double latHome = ParameterUtils::rad2deg(home.latitude), lonHome = ParameterUtils::rad2deg(home.longitude);
+
+        std::lock_guard<std::mutex> lock(m_providerMutex);
+        if (m_provider->getIonosphereDataAtIPPBatch(
+                work.stamps.data(), latDX, lonDX, work.elevationDX.data(), work.azimuthDX.data(),
+                latHome, lonHome, work.elevationHome.data(), work.azimuthHome.data(),
+                count, work.iono.data())) {
+            work.ionoValid.assign(count, 1);
+        } else {
+            // Part of the batch lies outside the TEC data; keep what is covered.
+            for (std::size_t i = 0; i < count; ++i) {
+                work.ionoValid[i] = m_provider->getIonosphereDataAtIPPBatch(
+                    &work.stamps[i], latDX, lonDX, &work.elevationDX[i], &work.azimuthDX[i],
+                    latHome, lonHome, &work.elevationHome[i], &work.azimuthHome[i],
+                    1, &work.iono[i]) ? 1 : 0;
+            }
+        }
+        if (chapman) {
+            work.fields.resize(count);
+            for (std::size_t i = 0; i < count; ++i) {
+                if (work.ionoValid[i]) work.fields[i] = m_provider->prepareMagneticField(work.stamps[i]);
+            }
+        }
+    }
+
+    SystemConfiguration config = m_config;
+    work.calculator.setDXStation(dx);
+    work.calculator.setHomeStation(home);
+
+    const double lowElevation = m_options.lowElevation_deg;
+    for (std::size_t i = 0; i < count; ++i) {
+        Point& point = points[i];
+        point.faraday = work.ionoValid[i] != 0 && m_config.includeFaradayRotation;
+
+        config.includeFaradayRotation = point.faraday;
+        work.calculator.setConfiguration(config);
+        if (chapman && point.faraday) {
+            work.calculator.setMagneticField(work.fields[i]);
+        }
+        work.calculator.setIonosphereData(work.iono[i]);
+        work.calculator.setMoonEphemeris(work.moons[i]);
+        const CalculationResults& result = work.calculator.calculate();
+
+        point.PLF = result.calculationSuccess ? result.PLF : 0.0;
+        point.elevation_DX = ParameterUtils::rad2deg(work.moons[i].elevation_DX);
+        point.elevation_Home = ParameterUtils::rad2deg(work.moons[i].elevation_Home);
+        point.score_dB = 10.0 * std::log10(std::max(point.PLF, MIN_PLF));
+
+        const double elevation = std::min(point.elevation_DX, point.elevation_Home);
+        if (lowElevation > 0.0 && elevation < lowElevation) {
+            const double shortfall = std::min(1.0, (lowElevation - elevation) / lowElevation);
+            point.score_dB -= m_options.lowElevationPenalty_dB * shortfall;
+        }
+
+        point.pathloss_dB = 0.0;
+        point.skyNoise_K = 0.0;
+        MoonCalendarEntry conditions;
+        if (m_calendar && m_calendar->getMoonConditions(times[i], conditions)) {
+            point.pathloss_dB = conditions.pathloss;
+            point.skyNoise_K = conditions.noise;
+            point.score_dB -= conditions.pathloss;
+            point.score_dB -= 10.0 * std::log10((m_options.systemNoise_K + conditions.noise) / m_options.systemNoise_K);
+        }
+    }
+}
+
+// ========== Slot Search ==========
+
+// Scores [from, to] on a grid no coarser than `step` and appends every slot that
+// fits, each scored by the mean of the grid points it spans. A range shorter
+// than a slot is one slot.
+void SkedPlanner::bestSlots(Workspace& work, const SiteParameters& home, const SiteParameters& dx,
+                            double from, double to, double step, std::vector<SkedSlot>& slots) {
+    const std::size_t intervals = std::max<std::size_t>(1, static_cast<std::size_t>(std::ceil((to - from) / step)));
+    const double h = (to - from) / static_cast<double>(intervals);
+
+    work.times.resize(intervals + 1);
+    for (std::size_t i = 0; i <= intervals; ++i) {
+        work.times[i] = from + h * static_cast<double>(i);
+    }
+    work.points.resize(intervals + 1);
+    scorePoints(work, home, dx, work.times.data(), work.times.size(), work.points.data());
+
+    std::size_t span = intervals;
+    if (to - from > m_options.slot_s && h > 0.0) {
+        span = std::max<std::size_t>(1, static_cast<std::size_t>(std::lround(m_options.slot_s / h)));
+        span = std::min(span, intervals);
+    }
+    const double weight = 1.0 / static_cast<double>(span + 1);
+
+    // Running sums over the span + 1 points of each slot.
+    Point sum{};
+    for (std::size_t i = 0; i <= intervals; ++i) {
+        const Point& p = work.points[i];
+        sum.score_dB += p.score_dB;
+        sum.PLF += p.PLF;
+        sum.pathloss_dB += p.pathloss_dB;
+        sum.skyNoise_K += p.skyNoise_K;
+        if (i < span) continue;
+
+        const std::size_t first = i - span;
+        double minDX = 90.0, minHome = 90.0;
+        bool faraday = true;
+        for (std::size_t k = first; k <= i; ++k) {
+            minDX = std::min(minDX, work.points[k].elevation_DX);
+            minHome = std::min(minHome, work.points[k].elevation_Home);
+            faraday = faraday && work.points[k].faraday;
+        }
+
+        SkedSlot slot;
+        slot.station = 0;
+        slot.start = work.times[first];
+        slot.end = work.times[i];
+        slot.score_dB = sum.score_dB * weight;
+        slot.PLF = sum.PLF * weight;
+        slot.minElevation_DX_deg = minDX;
+        slot.minElevation_Home_deg = minHome;
+        slot.pathloss_dB = sum.pathloss_dB * weight;
+        slot.skyNoise_K = sum.skyNoise_K * weight;
+        slot.faradayIncluded = faraday;
+        slots.push_back(slot);
+
+        const Point& q = work.points[first];
+        sum.score_dB -= q.score_dB;
+        sum.PLF -= q.PLF;
+        sum.pathloss_dB -= q.pathloss_dB;
+        sum.skyNoise_K -= q.skyNoise_K;
+    }
+}
+
+void SkedPlanner::planStation(Workspace& work, std::size_t index, const SiteParameters& home,
+                              const SiteParameters& dx, const std::vector<MoonWindow>& windows,
+                              std::vector<SkedSlot>& slots) {
+    // Coarse pass over every window.
+    std::vector<SkedSlot> candidates;
+    for (const MoonWindow& window : windows) {
+        bestSlots(work, home, dx, window.start, window.end, m_options.coarseStep_s, candidates);
+    }
+    for (SkedSlot& slot : candidates) slot.station = index;
+
+    std::vector<SkedSlot> promising;
+    selectTop(candidates, m_options.topK * std::max<std::size_t>(1, m_options.refineFactor), promising);
+
+    // Fine pass within one coarse step of each promising slot, inside its
+    // window. Neighbouring candidates overlap, so their ranges are merged and
+    // every instant is scored once.
+    std::vector<std::pair<double, double>> ranges;
+    for (const SkedSlot& coarse : promising) {
+        auto window = std::find_if(windows.begin(), windows.end(), [&](const MoonWindow& w) {
+            return coarse.start >= w.start && coarse.end <= w.end;
+        });
+        if (window == windows.end()) continue;
+        ranges.emplace_back(std::max(window->start, coarse.start - m_options.coarseStep_s),
+                            std::min(window->end, coarse.end + m_options.coarseStep_s));
+    }
+    std::sort(ranges.begin(), ranges.end());
+
+    std::vector<SkedSlot> refined;
+    for (std::size_t i = 0; i < ranges.size();) {
+        double from = ranges[i].first, to = ranges[i].second;
+        for (++i; i < ranges.size() && ranges[i].first <= to; ++i) {
+            to = std::max(to, ranges[i].second);
+        }
+        bestSlots(work, home, dx, from, to, m_options.fineStep_s, refined);
+    }
+    for (SkedSlot& slot : refined) slot.station = index;
+
+    selectTop(refined, m_options.topK, slots);
+}
+
+// ========== Planning ==========
+
+bool SkedPlanner::plan(const SiteParameters& home, const std::vector<SiteParameters>& dx,
+                       double from, double days, std::vector<SkedSlot>& slots) {
+    slots.clear();
+    if (!(m_options.slot_s > 0.0) || !(m_options.coarseStep_s > 0.0) || !(m_options.fineStep_s > 0.0) ||
+        !(m_options.systemNoise_K > 0.0) || m_options.topK == 0) {
+        m_error = "Invalid planner options";
+        return false;
+    }
+
+    // Fit the ephemeris once; the window finder and every scorer share it. With a
+    // calendar the fit is kept beside it, so repeated plans of the same days reuse it.
+    const double to = from + days * 86400.0;
+    const auto& cache = m_ephemeris.getCache();
+    if (days > 0.0 && (!cache || !cache->covers(from, to))) {
+        auto fitted = std::make_shared<LunarChebyshevCache>();
+        const bool ok = (m_calendar && m_calendar->isLoaded())
+            ? fitted->loadOrBuild(m_calendar->getEphemerisCachePath(), m_ephemeris, from, to)
+            : fitted->build(m_ephemeris, from, to);
+        if (!ok) {
+            m_error = fitted->getError();
+            return false;
+        }
+        m_ephemeris.attachCache(fitted);
+    }
+
+    MoonWindowFinder finder(m_ephemeris);
+    finder.setOptions(m_options.windows);
+    std::vector<MoonWindow> windows;
+    if (!finder.findWindows(home, dx, from, days, windows)) {
+        m_error = finder.getError();
+        return false;
+    }
+
+    // Windows arrive grouped by station.
+    std::vector<std::vector<MoonWindow>> perStationWindows(dx.size());
+    for (const MoonWindow& window : windows) {
+        perStationWindows[window.station].push_back(window);
+    }
+
+    std::vector<std::vector<SkedSlot>> perStation(dx.size());
+    std::atomic<std::size_t> next(0);
+    auto worker = [&]() {
+        Workspace work;
+        for (std::size_t i = next++; i < dx.size(); i = next++) {
+            if (!perStationWindows[i].empty()) {
+                planStation(work, i, home, dx[i], perStationWindows[i], perStation[i]);
+            }
+        }
+    };
+
+    unsigned threads = m_options.windows.threads ? m_options.windows.threads : std::thread::hardware_concurrency();
+    threads = static_cast<unsigned>(std::min<std::size_t>(std::max(threads, 1u), std::max<std::size_t>(dx.size(), 1)));
+
+    std::vector<std::thread> pool;
+    for (unsigned i = 1; i < threads; ++i) {
+        pool.emplace_back(worker);
+    }
+    worker();
+    for (std::thread& thread : pool) {
+        thread.join();
+    }
+
+    for (const auto& stationSlots : perStation) {
+        slots.insert(slots.end(), stationSlots.begin(), stationSlots.end());
+    }
+
+    m_error.clear();
+    return true;
+}
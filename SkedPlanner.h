@@ -0,0 +1,113 @@
+#pragma once
+
+#include "Parameters.h"
+#include "LunarEphemeris.h"
+#include "MoonWindowFinder.h"
+#include <cstddef>
+#include <mutex>
+#include <string>
+#include <vector>
+
+class IonosphereDataProvider;
+class MoonCalendarReader;
+
+// ========== Sked Planner Options ==========
+
+struct SkedPlannerOptions {
+    MoonWindowOptions windows;      // visibility limits and threads
+    double slot_s;                  // length of a proposed sked
+    double coarseStep_s;            // first pass over every window
+    double fineStep_s;              // second pass around the best coarse slots
+    std::size_t topK;               // slots returned per station
+    std::size_t refineFactor;       // coarse candidates refined per returned slot
+    double systemNoise_K;           // receiver + ground, without the sky
+    double lowElevation_deg;        // below this ...
+    double lowElevationPenalty_dB;  // ... up to this much is taken off at the horizon
+
+    SkedPlannerOptions()
+        : slot_s(1800.0), coarseStep_s(900.0), fineStep_s(60.0),
+          topK(3), refineFactor(3), systemNoise_K(200.0),
+          lowElevation_deg(15.0), lowElevationPenalty_dB(3.0) {
+        windows.minElevation_deg = 5.0;
+    }
+};
+
+// ========== Sked Slot ==========
+
+struct SkedSlot {
+    std::size_t station;            // index into the DX list
+    double start;                   // UTC seconds since 1970
+    double end;
+    double score_dB;                // mean over the slot, higher is better
+    double PLF;                     // mean polarization loss factor
+    double minElevation_DX_deg;
+    double minElevation_Home_deg;
+    double pathloss_dB;             // calendar, mean over the slot
+    double skyNoise_K;
+    bool faradayIncluded;           // false where no TEC was available
+};
+
+// ========== Sked Planner ==========
+// Ranks operating times for one home station against a DX list. The mutual
+// moon windows come from MoonWindowFinder; inside them each instant is scored
+// as
+//
+//   10 log10(PLF) - pathloss - 10 log10((Tsys + Tsky) / Tsys) - elevation penalty
+//
+// with the PLF from FaradayRotation::calculate using TEC and field at the
+// piercing points (IonosphereDataProvider, e.g. the IONEX forecast and WMM),
+// and pathloss and sky noise from the moon calendar. Either source may be
+// omitted. A slot scores the mean over its length.
+//
+// Evaluation is coarse-to-fine: every window is scored at coarseStep_s, and
+// only the best topK * refineFactor slots per station are re-scored at
+// fineStep_s within one coarse step of where they were found (overlapping
+// ranges merged). Stations run on a
+// thread pool; the ionosphere provider is shared under a lock.
+
+class SkedPlanner {
+public:
+    explicit SkedPlanner(const LunarEphemeris& ephemeris = LunarEphemeris());
+
+    void setOptions(const SkedPlannerOptions& options) { m_options = options; }
+    const SkedPlannerOptions& getOptions() const { return m_options; }
+    void setConfiguration(const SystemConfiguration& config) { m_config = config; }
+    void setIonosphereProvider(IonosphereDataProvider* provider) { m_provider = provider; }
+    void setMoonCalendar(const MoonCalendarReader* calendar) { m_calendar = calendar; }
+
+    // Best slots over [from, from + days * 86400), grouped by station and
+    // sorted by score within each station.
+    bool plan(const SiteParameters& home, const std::vector<SiteParameters>& dx,
+              double from, double days, std::vector<SkedSlot>& slots);
+
+    const std::string& getError() const { return m_error; }
+
+private:
+    struct Point {
+        double score_dB;
+        double PLF;
+        double elevation_DX;
+        double elevation_Home;
+        double pathloss_dB;
+        double skyNoise_K;
+        bool faraday;
+    };
+
+    struct Workspace;
+
+    LunarEphemeris m_ephemeris;
+    SkedPlannerOptions m_options;
+    SystemConfiguration m_config;
+    IonosphereDataProvider* m_provider;
+    const MoonCalendarReader* m_calendar;
+    std::mutex m_providerMutex;
+    std::string m_error;
+
+    void scorePoints(Workspace& work, const SiteParameters& home, const SiteParameters& dx,
+                     const double* times, std::size_t count, Point* points);
+    void bestSlots(Workspace& work, const SiteParameters& home, const SiteParameters& dx,
+                   double from, double to, double step, std::vector<SkedSlot>& slots);
+    void planStation(Workspace& work, std::size_t index, const SiteParameters& home,
+                     const SiteParameters& dx, const std::vector<MoonWindow>& windows,
+                     std::vector<SkedSlot>& slots);
+};
@@ -0,0 +1,173 @@
+#define _USE_MATH_DEFINES
+#include "SphericalHarmonicTecSource.h"
+#include <algorithm>
+#include <cmath>
+#include <limits>
+
+#ifndef M_PI
+#define M_PI 3.14159265358979323846
+#endif
+
+namespace {
+    inline std::size_t packedIndex(int n, int m) {
+        return static_cast<std::size_t>(n) * (n + 1) / 2 + m;
+    }
+}
+
+// ========== Constructor ==========
+
+SphericalHarmonicTecSource::SphericalHarmonicTecSource(int maxDegree)
+    : m_maxDegree(std::max(maxDegree, 0)), m_sunFixed(true) {
+
+    const std::size_t total = coefficientCount(m_maxDegree);
+    m_recurA.assign(total, 0.0);
+    m_recurB.assign(total, 0.0);
+    m_sectoral.assign(m_maxDegree + 1, 0.0);
+    m_legendre.resize(total);
+    m_cosM.resize(m_maxDegree + 1);
+    m_sinM.resize(m_maxDegree + 1);
+
+    // Fully normalised recursion (no Condon-Shortley phase):
+    //   P_mm = f_m cos(phi) P_(m-1)(m-1)
+    //   P_nm = a_nm sin(phi) P_(n-1)m - b_nm P_(n-2)m
+    for (int m = 1; m <= m_maxDegree; ++m) {
+        m_sectoral[m] = (m == 1) ? std::sqrt(3.0) : std::sqrt((2.0 * m + 1.0) / (2.0 * m));
+    }
+    for (int n = 1; n <= m_maxDegree; ++n) {
+        for (int m = 0; m < n; ++m) {
+            const double nm = static_cast<double>(n - m) * (n + m);
+            m_recurA[packedIndex(n, m)] = std::sqrt((2.0 * n - 1.0) * (2.0 * n + 1.0) / nm);
+            if (n >= 2) {
+                m_recurB[packedIndex(n, m)] = std::sqrt(
+                    (2.0 * n + 1.0) * (n + m - 1.0) * (n - m - 1.0) / (nm * (2.0 * n - 3.0)));
+            }
+        }
+    }
+}
+
+std::size_t SphericalHarmonicTecSource::coefficientCount(int maxDegree) {
+    return static_cast<std::size_t>(maxDegree + 1) * (maxDegree + 2) / 2;
+}
+
+// ========== Coefficients ==========
+
+bool SphericalHarmonicTecSource::addEpoch(
+    std::int64_t epoch, const std::vector<double>& cosine, const std::vector<double>& sine) {
+
+    const std::size_t total = coefficientCount(m_maxDegree);
+    if (cosine.size() != total || sine.size() != total) {
+        return false;
+    }
+
+    auto position = std::lower_bound(m_epochs.begin(), m_epochs.end(), epoch);
+    std::size_t slot = static_cast<std::size_t>(position - m_epochs.begin());
+
+    if (position != m_epochs.end() && *position == epoch) {
+        m_cosine[slot] = cosine;
+        m_sine[slot] = sine;
+    } else {
+        m_epochs.insert(position, epoch);
+        m_cosine.insert(m_cosine.begin() + slot, cosine);
+        m_sine.insert(m_sine.begin() + slot, sine);
+    }
+    return true;
+}
+
+void SphericalHarmonicTecSource::clear() {
+    m_epochs.clear();
+    m_cosine.clear();
+    m_sine.clear();
+}
+
+// ========== Evaluation ==========
+
+void SphericalHarmonicTecSource::evaluateBasis(double lat_deg, double s_deg) {
+    const double phi = lat_deg * M_PI / 180.0;
+    const double s = s_deg * M_PI / 180.0;
+    const double x = std::sin(phi);
+    const double y = std::cos(phi);
+
+    double sectoral = 1.0;
+    for (int m = 0; m <= m_maxDegree; ++m) {
+        if (m > 0) {
+            sectoral *= m_sectoral[m] * y;
+        }
+        double previous2 = 0.0;
+        double previous1 = sectoral;
+        m_legendre[packedIndex(m, m)] = sectoral;
+
+        for (int n = m + 1; n <= m_maxDegree; ++n) {
+            const std::size_t k = packedIndex(n, m);
+            double value = m_recurA[k] * x * previous1 - m_recurB[k] * previous2;
+            m_legendre[k] = value;
+            previous2 = previous1;
+            previous1 = value;
+        }
+    }
+
+    // cos(ms), sin(ms) by angle addition.
+    const double c1 = std::cos(s);
+    const double s1 = std::sin(s);
+    m_cosM[0] = 1.0;
+    m_sinM[0] = 0.0;
+    for (int m = 1; m <= m_maxDegree; ++m) {
+        m_cosM[m] = m_cosM[m - 1] * c1 - m_sinM[m - 1] * s1;
+        m_sinM[m] = m_sinM[m - 1] * c1 + m_cosM[m - 1] * s1;
+    }
+}
+
+double SphericalHarmonicTecSource::sum(std::size_t set) const {
+    const double* cosine = m_cosine[set].data();
+    const double* sine = m_sine[set].data();
+
+    double total = 0.0;
+    for (int n = 0; n <= m_maxDegree; ++n) {
+        const std::size_t row = packedIndex(n, 0);
+        total += m_legendre[row] * cosine[row];
+        for (int m = 1; m <= n; ++m) {
+            const std::size_t k = row + m;
+            total += m_legendre[k] * (cosine[k] * m_cosM[m] + sine[k] * m_sinM[m]);
+        }
+    }
+    return total;
+}
+
+bool SphericalHarmonicTecSource::getTecBatch(
+    const std::int64_t* times, const double* lat, const double* lon,
+    std::size_t count, double* tec) {
+
+    const double NaN = std::numeric_limits<double>::quiet_NaN();
+    bool allServed = true;
+
+    for (std::size_t i = 0; i < count; ++i) {
+        const std::int64_t t = times[i];
+        if (m_epochs.empty() || t < m_epochs.front() || t > m_epochs.back()) {
+            tec[i] = NaN;
+            allServed = false;
+            continue;
+        }
+
+        double s = lon[i];
+        if (m_sunFixed) {
+            std::int64_t secondOfDay = t % 86400;
+            if (secondOfDay < 0) secondOfDay += 86400;
+            s += secondOfDay / 240.0 - 180.0;
+        }
+        evaluateBasis(lat[i], s);
+
+        std::size_t i1 = static_cast<std::size_t>(
+            std::upper_bound(m_epochs.begin(), m_epochs.end(), t) - m_epochs.begin());
+        double value;
+        if (i1 == m_epochs.size()) {
+            value = sum(i1 - 1);
+        } else {
+            const std::size_t i0 = i1 - 1;
+            const double w = static_cast<double>(t - m_epochs[i0]) /
+                             static_cast<double>(m_epochs[i1] - m_epochs[i0]);
+            const double v0 = sum(i0);
+            value = (w > 0.0) ? v0 + w * (sum(i1) - v0) : v0;
+        }
+        tec[i] = std::max(value, 0.0);
+    }
+    return allServed;
+}
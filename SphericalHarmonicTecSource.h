@@ -0,0 +1,55 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+// ========== Spherical Harmonic TEC Source ==========
+// Global vertical TEC expanded in fully normalised spherical harmonics, as in the
+// coefficient sets published by analysis centres:
+//
+//     TEC(phi, s) = sum_{n,m} P_nm(sin phi) * (C_nm cos(m s) + S_nm sin(m s))
+//
+// phi is geographic latitude and s is either the sun-fixed longitude
+// (lon + 15 deg/h * UT - 180 deg, the usual choice) or the earth-fixed longitude.
+// Coefficient sets are given per epoch and interpolated linearly in time; the
+// source serves the span between the first and last set. Negative results are
+// clamped to zero.
+
+class SphericalHarmonicTecSource {
+public:
+    explicit SphericalHarmonicTecSource(int maxDegree = 15);
+
+    // Packed by degree then order: (0,0), (1,0), (1,1), (2,0), ... up to maxDegree.
+    // Sine terms for m = 0 are ignored. Replaces a set already held for the epoch.
+    bool addEpoch(std::int64_t epoch, const std::vector<double>& cosine, const std::vector<double>& sine);
+    void clear();
+
+    void setSunFixed(bool sunFixed) { m_sunFixed = sunFixed; }
+    bool isSunFixed() const { return m_sunFixed; }
+
+    int getMaxDegree() const { return m_maxDegree; }
+    std::size_t size() const { return m_epochs.size(); }
+    static std::size_t coefficientCount(int maxDegree);
+
+    bool getTecBatch(const std::int64_t* times, const double* lat, const double* lon,
+                     std::size_t count, double* tec);
+    const char* getName() const { return "SH"; }
+
+private:
+    int m_maxDegree;
+    bool m_sunFixed;
+
+    std::vector<std::int64_t> m_epochs;
+    std::vector<std::vector<double>> m_cosine;
+    std::vector<std::vector<double>> m_sine;
+
+    // Legendre recursion factors, packed like the coefficients.
+    std::vector<double> m_recurA, m_recurB, m_sectoral;
+
+    // Per-point scratch
+    std::vector<double> m_legendre, m_cosM, m_sinM;
+
+    void evaluateBasis(double lat_deg, double s_deg);
+    double sum(std::size_t set) const;
+};
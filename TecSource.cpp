@@ -0,0 +1,102 @@
+#include "TecSource.h"
+#include <algorithm>
+#include <cmath>
+
+// ========== Configuration ==========
+
+void TecSourceBlend::addLayer(TecSourceVariant source, std::int64_t from, std::int64_t to,
+                              std::int64_t blend_s) {
+    m_layers.push_back(Layer{ std::move(source), from, to, blend_s > 0 ? blend_s : 0 });
+}
+
+std::string TecSourceBlend::getName() const {
+    std::string name;
+    for (const Layer& layer : m_layers) {
+        if (!name.empty()) {
+            name += '/';
+        }
+        name += std::visit([](const auto& source) { return std::string(source.getName()); },
+                           layer.source);
+    }
+    return name;
+}
+
+// ========== Queries ==========
+
+double TecSourceBlend::layerWeight(const Layer& layer, std::int64_t time) {
+    if (time >= layer.from && time <= layer.to) {
+        return 1.0;
+    }
+    if (layer.blend_s == 0) {
+        return 0.0;
+    }
+
+    // Distance outside the window; computed in double so open-ended bounds cannot overflow.
+    double outside = (time < layer.from)
+        ? static_cast<double>(layer.from) - static_cast<double>(time)
+        : static_cast<double>(time) - static_cast<double>(layer.to);
+    return std::max(0.0, 1.0 - outside / static_cast<double>(layer.blend_s));
+}
+
+bool TecSourceBlend::getTecBatch(const std::int64_t* times, const double* lat, const double* lon,
+                                 std::size_t count, double* tec) {
+    m_sum.assign(count, 0.0);
+    m_remaining.assign(count, 1.0);
+    m_weight.resize(count);
+
+    for (Layer& layer : m_layers) {
+        // Gather the points this layer still contributes to.
+        m_index.clear();
+        m_times.clear();
+        m_lat.clear();
+        m_lon.clear();
+        for (std::size_t i = 0; i < count; ++i) {
+            if (m_remaining[i] <= 0.0) {
+                continue;
+            }
+            double w = layerWeight(layer, times[i]);
+            if (w <= 0.0) {
+                continue;
+            }
+            m_weight[m_index.size()] = w;
+            m_index.push_back(i);
+            m_times.push_back(times[i]);
+            m_lat.push_back(lat[i]);
+            m_lon.push_back(lon[i]);
+        }
+
+        if (m_index.empty()) {
+            continue;
+        }
+
+        const std::size_t n = m_index.size();
+        m_values.resize(n);
+        std::visit([&](auto& source) {
+            source.getTecBatch(m_times.data(), m_lat.data(), m_lon.data(), n, m_values.data());
+        }, layer.source);
+
+        for (std::size_t k = 0; k < n; ++k) {
+            if (std::isnan(m_values[k])) {
+                continue;       // Left for the next layer.
+            }
+            std::size_t i = m_index[k];
+            double take = m_remaining[i] * m_weight[k];
+            m_sum[i] += take * m_values[k];
+            m_remaining[i] -= take;
+        }
+    }
+
+    // Normalise by the weight actually served, so a point only half covered by a
+    // fading layer and nothing else still gets that layer's value.
+    bool allServed = true;
+    for (std::size_t i = 0; i < count; ++i) {
+        double served = 1.0 - m_remaining[i];
+        if (served > 0.0) {
+            tec[i] = m_sum[i] / served;
+        } else {
+            tec[i] = std::numeric_limits<double>::quiet_NaN();
+            allServed = false;
+        }
+    }
+    return allServed;
+}
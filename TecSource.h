@@ -0,0 +1,91 @@
+#pragma once
+
+#include "IonexTecSource.h"
+#include "GlotecTecSource.h"
+#include "SphericalHarmonicTecSource.h"
+#include "ClimatologyTecSource.h"
+#include <concepts>
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <string>
+#include <variant>
+#include <vector>
+
+// ========== TEC Source Concept ==========
+// A TEC source answers batched vertical TEC queries at UTC seconds since 1970
+// (see GlotecSnapshotStore::toEpochSeconds), latitude/longitude in degrees:
+//
+//     bool getTecBatch(const int64_t* times, const double* lat, const double* lon,
+//                      size_t count, double* tec);
+//
+// Every point is written. Points the source cannot serve (outside its time span
+// or grid) are set to NaN and make the call return false; the others stay valid.
+
+template <typename S>
+concept TecSource = requires(S& source, const std::int64_t* times, const double* lat,
+                             const double* lon, std::size_t count, double* tec) {
+    { source.getTecBatch(times, lat, lon, count, tec) } -> std::same_as<bool>;
+    { source.getName() } -> std::convertible_to<std::string>;
+};
+
+static_assert(TecSource<IonexTecSource>);
+static_assert(TecSource<GlotecTecSource>);
+static_assert(TecSource<SphericalHarmonicTecSource>);
+static_assert(TecSource<ClimatologyTecSource>);
+
+// Closed set of sources; dispatch is resolved once per batch through std::visit.
+using TecSourceVariant = std::variant<
+    IonexTecSource,
+    GlotecTecSource,
+    SphericalHarmonicTecSource,
+    ClimatologyTecSource>;
+
+// ========== TEC Source Blend ==========
+// Ordered list of sources, each valid over a time window [from, to]. A point takes
+// its value from the first layer that covers its time and can serve it; layers
+// that cannot serve a point pass it on to the next one. With blend_s > 0 a layer's
+// weight ramps linearly to zero over blend_s seconds outside its window, and the
+// remaining weight goes to the following layers, so hand-overs (GloTEC nowcast to
+// IONEX forecast, say) do not step.
+
+class TecSourceBlend {
+public:
+    static constexpr std::int64_t ALWAYS_FROM = std::numeric_limits<std::int64_t>::min();
+    static constexpr std::int64_t ALWAYS_TO = std::numeric_limits<std::int64_t>::max();
+
+    struct Layer {
+        TecSourceVariant source;
+        std::int64_t from;
+        std::int64_t to;
+        std::int64_t blend_s;
+    };
+
+    void addLayer(TecSourceVariant source,
+                  std::int64_t from = ALWAYS_FROM, std::int64_t to = ALWAYS_TO,
+                  std::int64_t blend_s = 0);
+    void clear() { m_layers.clear(); }
+
+    bool empty() const { return m_layers.empty(); }
+    std::size_t size() const { return m_layers.size(); }
+    const std::vector<Layer>& getLayers() const { return m_layers; }
+
+    bool getTecBatch(const std::int64_t* times, const double* lat, const double* lon,
+                     std::size_t count, double* tec);
+
+    // Layer names joined with '/', e.g. "GloTEC/IONEX".
+    std::string getName() const;
+
+private:
+    std::vector<Layer> m_layers;
+
+    // Per-batch scratch: points still owed weight, gathered for one layer.
+    std::vector<double> m_sum, m_remaining, m_weight;
+    std::vector<std::size_t> m_index;
+    std::vector<std::int64_t> m_times;
+    std::vector<double> m_lat, m_lon, m_values;
+
+    static double layerWeight(const Layer& layer, std::int64_t time);
+};
+
+static_assert(TecSource<TecSourceBlend>);
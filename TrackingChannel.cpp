@@ -0,0 +1,91 @@
+#include "TrackingChannel.h"
+#include <cstring>
+#include <type_traits>
+
+static_assert(std::is_trivially_copyable<TrackingSample>::value, "TrackingSample is copied word by word");
+static_assert(sizeof(TrackingSample) % sizeof(std::uint64_t) == 0, "TrackingSample must be whole words");
+
+// ========== Constructor ==========
+
+TrackingChannel::TrackingChannel(std::size_t capacity)
+    : m_mask(0), m_head(0) {
+    std::size_t size = 1;
+    while (size < capacity) size <<= 1;
+    m_mask = size - 1;
+    m_slots.reset(new Slot[size]);
+    for (std::size_t i = 0; i < size; ++i) {
+        m_slots[i].sequence.store(0, std::memory_order_relaxed);
+    }
+}
+
+// ========== Producer ==========
+
+void TrackingChannel::publish(const TrackingSample& sample) {
+    const std::uint64_t index = m_head.load(std::memory_order_relaxed);
+    Slot& slot = m_slots[index & m_mask];
+
+    std::uint64_t words[WORDS];
+    std::memcpy(words, &sample, sizeof(words));
+
+    slot.sequence.store(2 * index + 1, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_release);
+    for (std::size_t i = 0; i < WORDS; ++i) {
+        slot.words[i].store(words[i], std::memory_order_relaxed);
+    }
+    slot.sequence.store(2 * index + 2, std::memory_order_release);
+    m_head.store(index + 1, std::memory_order_release);
+}
+
+// ========== Consumers ==========
+
+bool TrackingChannel::copySlot(std::uint64_t index, TrackingSample& sample) const {
+    const Slot& slot = m_slots[index & m_mask];
+    const std::uint64_t expected = 2 * index + 2;
+    if (slot.sequence.load(std::memory_order_acquire) != expected) {
+        return false;
+    }
+
+    std::uint64_t words[WORDS];
+    for (std::size_t i = 0; i < WORDS; ++i) {
+        words[i] = slot.words[i].load(std::memory_order_relaxed);
+    }
+    std::atomic_thread_fence(std::memory_order_acquire);
+    if (slot.sequence.load(std::memory_order_relaxed) != expected) {
+        return false;
+    }
+    std::memcpy(&sample, words, sizeof(words));
+    return true;
+}
+
+bool TrackingChannel::read(std::uint64_t& cursor, TrackingSample& sample, std::uint64_t* lost) const {
+    while (true) {
+        const std::uint64_t head = m_head.load(std::memory_order_acquire);
+        if (cursor >= head) {
+            return false;
+        }
+        // Anything older than one ring is gone.
+        if (head - cursor > m_mask + 1) {
+            if (lost) *lost += head - cursor - (m_mask + 1);
+            cursor = head - (m_mask + 1);
+        }
+        if (copySlot(cursor, sample)) {
+            ++cursor;
+            return true;
+        }
+        // Overwritten while we looked.
+        if (lost) ++*lost;
+        ++cursor;
+    }
+}
+
+bool TrackingChannel::latest(TrackingSample& sample) const {
+    while (true) {
+        const std::uint64_t head = m_head.load(std::memory_order_acquire);
+        if (head == 0) {
+            return false;
+        }
+        if (copySlot(head - 1, sample)) {
+            return true;
+        }
+    }
+}
@@ -0,0 +1,88 @@
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+
+// ========== Tracking Sample ==========
+// One tick of the polarization tracker. Plain data so it can be published
+// word by word through the channel.
+
+struct TrackingSample {
+    static constexpr std::uint32_t VALID = 1;           // calculation succeeded
+    static constexpr std::uint32_t FARADAY = 2;         // TEC data behind the Faraday terms
+    static constexpr std::uint32_t STALE_IONOSPHERE = 4;// refresh was due but skipped
+
+    std::uint64_t tick;
+    double time;                    // UTC seconds since 1970 the values are for
+    double PLF;
+    double loss_dB;
+    double spatial_deg;
+    double faraday_DX_deg;
+    double faraday_Home_deg;
+    double total_deg;
+    double elevation_DX_deg;
+    double azimuth_DX_deg;
+    double elevation_Home_deg;
+    double azimuth_Home_deg;
+    double vTEC_DX;
+    double vTEC_Home;
+    double optimalPsi_deg;          // best home psi for a rotator, home chi kept
+    double optimalPLF;
+    double latency_us;              // wake-up to publish
+    std::uint32_t flags;
+    std::uint32_t reserved;
+
+    TrackingSample()
+        : tick(0), time(0.0), PLF(0.0), loss_dB(0.0), spatial_deg(0.0),
+          faraday_DX_deg(0.0), faraday_Home_deg(0.0), total_deg(0.0),
+          elevation_DX_deg(0.0), azimuth_DX_deg(0.0),
+          elevation_Home_deg(0.0), azimuth_Home_deg(0.0),
+          vTEC_DX(0.0), vTEC_Home(0.0), optimalPsi_deg(0.0), optimalPLF(0.0),
+          latency_us(0.0), flags(0), reserved(0) {}
+};
+
+// ========== Tracking Channel ==========
+// Single-producer, multi-consumer ring of the most recent samples. The producer
+// never waits: each slot carries a sequence number that is odd while the slot
+// is written, and readers copy the slot and retry or skip when the sequence moved
+// underneath them. Every consumer keeps its own cursor, so a slow reader only
+// loses the samples that were overwritten before it got to them.
+
+class TrackingChannel {
+public:
+    // Capacity is rounded up to a power of two.
+    explicit TrackingChannel(std::size_t capacity = 256);
+
+    TrackingChannel(const TrackingChannel&) = delete;
+    TrackingChannel& operator=(const TrackingChannel&) = delete;
+
+    // Producer side; one thread only.
+    void publish(const TrackingSample& sample);
+
+    // Next sample after cursor (start at 0 for the oldest retained, or at
+    // getHead() for new ones only). False when the reader has caught up. lost,
+    // if given, is increased by the samples skipped because they were overwritten.
+    bool read(std::uint64_t& cursor, TrackingSample& sample, std::uint64_t* lost = nullptr) const;
+
+    // Newest sample; false before the first publish.
+    bool latest(TrackingSample& sample) const;
+
+    std::uint64_t getHead() const { return m_head.load(std::memory_order_acquire); }
+    std::size_t getCapacity() const { return m_mask + 1; }
+
+private:
+    static constexpr std::size_t WORDS = sizeof(TrackingSample) / sizeof(std::uint64_t);
+
+    struct Slot {
+        std::atomic<std::uint64_t> sequence;
+        std::atomic<std::uint64_t> words[WORDS];
+    };
+
+    std::unique_ptr<Slot[]> m_slots;
+    std::size_t m_mask;
+    alignas(64) std::atomic<std::uint64_t> m_head;
+
+    bool copySlot(std::uint64_t index, TrackingSample& sample) const;
+};
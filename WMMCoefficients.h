@@ -0,0 +1,104 @@
+#pragma once
+
+// Generated from WMMHR.COF by GenerateWMMCoefficients.ps1. Do not edit.
+
+#include "WMMModel.h"
+
+namespace WMMEmbedded {
+    constexpr double EPOCH = 2025.0;
+    constexpr const char* MODEL_NAME = "WMMHR-2025";
+    constexpr int MAX_DEGREE = 12;
+
+    constexpr GaussCoefficient COEFFICIENTS[] = {
+        { 1, 0, -29351.7976, 0, 11.9581, 0 },
+        { 1, 1, -1410.7694, 4545.3934, 9.7476, -21.4933 },
+        { 2, 0, -2556.6143, 0, -11.6378, 0 },
+        { 2, 1, 2951.1266, -3133.635, -5.2219, -27.7111 },
+        { 2, 2, 1649.2918, -815.0624, -8.0224, -12.0949 },
+        { 3, 0, 1361.001, 0, -1.2862, 0 },
+        { 3, 1, -2404.1317, -56.5875, -4.2282, 4.0107 },
+        { 3, 2, 1243.7667, 237.5101, 0.4115, -0.3243 },
+        { 3, 3, 453.6466, -549.4721, -15.5527, -4.1322 },
+        { 4, 0, 894.9612, 0, -1.5684, 0 },
+        { 4, 1, 799.544, 278.5889, -2.4174, -1.0998 },
+        { 4, 2, 55.7274, -133.897, -6.0443, 4.1406 },
+        { 4, 3, -281.0878, 212.0024, 5.5906, 1.6345 },
+        { 4, 4, 12.0546, -375.5678, -7.0288, -4.3971 },
+        { 5, 0, -233.1862, 0, 0.6418, 0 },
+        { 5, 1, 368.8561, 45.3865, 1.3872, -0.5428 },
+        { 5, 2, 187.1931, 220.1588, 0.0029, 2.217 },
+        { 5, 3, -138.727, -122.9064, 0.605, 0.4058 },
+        { 5, 4, -141.9821, 42.9685, 2.2214, 1.6818 },
+        { 5, 5, 20.8846, 106.0766, 0.9426, 1.9085 },
+        { 6, 0, 64.3509, 0, -0.1606, 0 },
+        { 6, 1, 63.7744, -18.4364, -0.3727, 0.3219 },
+        { 6, 2, 76.8697, 16.7828, 0.8603, -1.6192 },
+        { 6, 3, -115.7171, 48.779, 1.2054, -0.4341 },
+        { 6, 4, -40.8959, -59.7541, -0.8565, 0.8664 },
+        { 6, 5, 14.8566, 10.9015, 0.3247, 0.6662 },
+        { 6, 6, -60.7286, 72.6934, 0.9107, 0.8621 },
+        { 7, 0, 79.4997, 0, -0.031, 0 },
+        { 7, 1, -76.9765, -48.8945, -0.0831, 0.5683 },
+        { 7, 2, -8.7839, -14.3667, -0.1038, 0.5106 },
+        { 7, 3, 59.2739, -0.9932, 0.5278, -0.7682 },
+        { 7, 4, 15.8126, 23.423, -0.1207, 0.0267 },
+        { 7, 5, 2.4894, -7.3716, -0.7507, -0.9546 },
+        { 7, 6, -11.1286, -25.094, -0.82, 0.55 },
+        { 7, 7, 14.2408, -2.2969, 0.8289, -0.2485 },
+        { 8, 0, 23.1874, 0, -0.0842, 0 },
+        { 8, 1, 10.8475, 7.1395, 0.2423, -0.2333 },
+        { 8, 2, -17.4695, -12.561, 0.0078, 0.4631 },
+        { 8, 3, 2.0482, 11.432, 0.542, -0.3676 },
+        { 8, 4, -21.6981, -9.6613, -0.1237, 0.4122 },
+        { 8, 5, 16.9198, 12.7489, 0.2819, -0.5353 },
+        { 8, 6, 14.9719, 0.6689, 0.1581, -0.6295 },
+        { 8, 7, -16.7656, -5.1643, -0.0454, 0.3165 },
+        { 8, 8, 0.9074, 3.8844, 0.2365, 0.1676 },
+        { 9, 0, 4.5838, 0, -0.0144, 0 },
+        { 9, 1, 7.8404, -24.798, -0.1401, -0.2752 },
+        { 9, 2, 2.9839, 12.2137, 0.0891, 0.2945 },
+        { 9, 3, -0.1637, 8.3009, 0.2844, -0.3204 },
+        { 9, 4, -2.5107, -3.3264, -0.2888, 0.3357 },
+        { 9, 5, -13.1061, -5.1861, 0.0082, 0.2188 },
+        { 9, 6, 2.38, 7.226, 0.251, -0.1398 },
+        { 9, 7, 8.6173, -0.6207, -0.0593, -0.2259 },
+        { 9, 8, -8.7204, 0.7746, 0.1251, 0.3983 },
+        { 9, 9, -12.8525, 9.9581, -0.1286, 0.0824 },
+        { 10, 0, -1.3481, 0, 0.0979, 0 },
+        { 10, 1, -6.3648, 3.269, 0.002, -0.0004 },
+        { 10, 2, 0.2205, 0.0416, 0.0865, -0.0035 },
+        { 10, 3, 2.0352, 2.4255, 0.0649, -0.1812 },
+        { 10, 4, -0.9743, 5.344, -0.0187, 0.0923 },
+        { 10, 5, -0.5621, -9.0544, -0.2532, -0.0774 },
+        { 10, 6, -0.9037, 0.3532, 0.0097, 0.0812 },
+        { 10, 7, 1.4979, -4.1664, -0.0731, 0.0394 },
+        { 10, 8, 0.8957, -3.7949, -0.0767, -0.0683 },
+        { 10, 9, -2.6617, 0.9485, -0.0422, 0.2253 },
+        { 10, 10, -3.8865, -9.0551, -0.0148, -0.0209 },
+        { 11, 0, 2.9215, 0, 0.0246, 0 },
+        { 11, 1, -1.4627, 0.0249, -0.0417, -0.0021 },
+        { 11, 2, -2.4769, 2.8701, 0.0369, 0.1018 },
+        { 11, 3, 2.3862, -0.5669, 0.0292, -0.0242 },
+        { 11, 4, -0.6353, 0.1679, 0.0322, 0.1173 },
+        { 11, 5, -0.053, 0.4986, -0.068, -0.014 },
+        { 11, 6, -0.5744, -0.2888, 0.0196, -0.003 },
+        { 11, 7, -0.1063, -1.1611, -0.0112, 0.1044 },
+        { 11, 8, 1.0846, -1.7363, -0.0844, -0.0213 },
+        { 11, 9, -0.971, -2.8732, -0.0805, 0.047 },
+        { 11, 10, -0.1596, -1.844, -0.0934, 0.0381 },
+        { 11, 11, 2.6188, -2.3138, -0.0801, 0.0352 },
+        { 12, 0, -1.9768, 0, 0.0115, 0 },
+        { 12, 1, -0.1524, -1.2626, 0.0018, -0.0184 },
+        { 12, 2, 0.3253, 0.6554, -0.0173, 0.0295 },
+        { 12, 3, 1.2277, 0.9892, -0.01, -0.0744 },
+        { 12, 4, -1.2638, -1.4361, -0.0234, 0.076 },
+        { 12, 5, 0.5604, -0.0249, -0.0304, -0.0213 },
+        { 12, 6, 0.5713, 0.6257, 0.0518, -0.0156 },
+        { 12, 7, 0.4631, -0.1497, -0.0067, -0.0008 },
+        { 12, 8, -0.0774, 0.7903, 0.0339, 0.0474 },
+        { 12, 9, -0.4493, 0.0971, 0.0025, -0.0116 },
+        { 12, 10, -0.1941, -0.9497, -0.0569, -0.0043 },
+        { 12, 11, -1.2584, 0.1267, -0.0249, 0.0362 },
+        { 12, 12, -0.7218, 0.2361, -0.0751, -0.0577 },
+    };
+}
@@ -1,16 +1,18 @@
 #pragma once
 
+#include "GeomagneticField.h"
 #include <vector>
 #include <string>
+#include <array>
 #include <cmath>
 
 // ========== WMM Constants ==========
 
 namespace WMMConstants {
-    constexpr double WGS84_A = 6378.137;
-    constexpr double WGS84_F = 1.0 / 298.257223563;
+    constexpr double WGS84_A = GeomagneticConstants::WGS84_A;
+    constexpr double WGS84_F = GeomagneticConstants::WGS84_F;
     constexpr double WGS84_B = WGS84_A * (1.0 - WGS84_F);
-    constexpr double WGS84_E2 = 2.0 * WGS84_F - WGS84_F * WGS84_F;
+    constexpr double WGS84_E2 = GeomagneticConstants::WGS84_E2;
     constexpr double EPOCH = 2025.0;
     constexpr int MAX_DEGREE = 12;
 }
@@ -26,56 +28,33 @@ struct GaussCoefficient {
     double dhnm;
 };
 
-// ========== Magnetic Field Result ==========
-
-struct MagneticFieldResult {
-    double X;
-    double Y;
-    double Z;
-    double H;
-    double F;
-    double inclination;
-    double declination;
-};
-
 // ========== WMM Model ==========
 
-class WMMModel {
+class WMMModel : public GeomagneticModel {
 public:
+    // Uses the coefficient table compiled in from WMMCoefficients.h; no file I/O.
     WMMModel();
 
+    // Replaces the coefficients with a WMM .COF file. On failure (missing file,
+    // no coefficient lines) returns false and keeps the current ones.
     bool loadCoefficientFile(const std::string& filename);
+    void loadEmbeddedCoefficients();
 
-    MagneticFieldResult calculate(
-        double latitude_deg,
-        double longitude_deg,
-        double height_km,
-        double decimal_year) const;
+    PreparedMagneticField prepare(double decimal_year) const override;
+    bool isLoaded() const override { return m_loaded; }
+    const std::string& getModelName() const override { return m_modelName; }
+    double getEpoch() const { return m_epoch; }
 
 private:
-    std::vector<GaussCoefficient> m_coefficients;
+    using CoefficientArray = PreparedMagneticField::CoefficientArray;
+
+    CoefficientArray m_g;
+    CoefficientArray m_h;
+    CoefficientArray m_dg;
+    CoefficientArray m_dh;
+    double m_epoch;
+    std::string m_modelName;
     bool m_loaded;
 
-    void timeEvolveCoefficients(double decimal_year,
-                                std::vector<double>& g,
-                                std::vector<double>& h) const;
-
-    void geodeticToGeocentric(double lat_deg, double height_km,
-                              double& lat_geocentric_deg,
-                              double& radius_km) const;
-
-    void computeLegendrePolynomials(double theta,
-                                    std::vector<std::vector<double>>& P,
-                                    std::vector<std::vector<double>>& dP) const;
-
-    void computeMagneticField(double r, double theta, double phi,
-                              const std::vector<double>& g,
-                              const std::vector<double>& h,
-                              double& Br, double& Btheta, double& Bphi) const;
-
-    void rotateToGeodetic(double X_prime, double Z_prime,
-                          double lat_geodetic, double lat_geocentric,
-                          double& X, double& Z) const;
-
-    int getIndex(int n, int m) const;
+    void setCoefficients(const std::vector<GaussCoefficient>& coefficients);
 };
@@ -0,0 +1,555 @@
+#include "BatchJobParser.h"
+#include "BatchProcessor.h"
+#include "GlotecSnapshotStore.h"
+#include "GlotecTecSource.h"
+#include "GlotecTimeSeries.h"
+#include "IonexTecSource.h"
+#include "IonosphereDataProvider.h"
+#include "LunarChebyshevCache.h"
+#include "LunarEphemeris.h"
+#include "MaidenheadGrid.h"
+#include "MoonCalendarReader.h"
+#include "Parameters.h"
+#include "PolarizationTracker.h"
+#include "QueryDaemon.h"
+#include "SkedPlanner.h"
+#include <chrono>
+#include <cmath>
+#include <csignal>
+#include <ctime>
+#include <cstdio>
+#include <cstdlib>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <memory>
+#include <string>
+#include <thread>
+#include <vector>
+
+#ifdef _WIN32
+#include <fcntl.h>
+#include <io.h>
+#endif
+
+namespace {
+    volatile std::sig_atomic_t g_stopRequested = 0;
+
+    void requestStop(int) {
+        g_stopRequested = 1;
+    }
+
+    void printUsage() {
+        std::cerr <<
+            "Usage: FaradayBatch [options] [jobs-file | -]\n"
+            "       FaradayBatch [options] --serve [--socket PATH] [--http PORT]\n"
+            "       FaradayBatch [options] --track --dx GRID --home GRID --freq MHZ\n"
+            "       FaradayBatch [options] --plan --dx GRID[,GRID...] --home GRID\n"
+            "\n"
+            "Reads one job per line (JSONL objects, or CSV with a header line) from the\n"
+            "file or stdin and writes one result per job to stdout, in input order.\n"
+            "\n"
+            "Job fields: id, time, freq_MHz, dx_grid | dx_lat + dx_lon, dx_psi, dx_chi,\n"
+            "            home_grid | home_lat + home_lon, home_psi, home_chi, faraday\n"
+            "\n"
+            "Options:\n"
+            "  --ionex FILE        IONEX TEC maps (default: data.txt if present)\n"
+            "  --wmm FILE          WMM coefficients (default: WMMHR.COF if present)\n"
+            "  --no-ionosphere     ignore TEC files, use the default ionosphere\n"
+            "  --chapman           Chapman slant-path integration\n"
+            "  --input jsonl|csv   input format (default: detected)\n"
+            "  --output jsonl|csv|columnar\n"
+            "                      output format (default: same as input); columnar\n"
+            "                      writes binary column chunks (ColumnarResultWriter.h)\n"
+            "  --threads N         worker threads (default: all cores)\n"
+            "  --block N           jobs per work unit (default: 1024)\n"
+            "  --bins N            also sample the passband on N bins and report PLF_avg,\n"
+            "                      PLF_min, PLF_max, depolarization and spread_deg\n"
+            "  --bandwidth HZ      passband width for --bins (default: 2500)\n"
+            "  --optimal           also report the best home psi (psi_opt_deg, PLF_opt), the\n"
+            "                      arriving polarization and the dual-pol MRC PLF (PLF_dual)\n"
+            "  --cross-gain DB     cross-pol branch gain for PLF_dual (default: 0)\n"
+            "  --sensitivity       also report dPLF/d(vTEC) per TECU, dPLF/d|B| per nT at\n"
+            "                      each station and dPLF/dt per second (not with --chapman)\n"
+            "\n"
+            "Daemon mode (models stay loaded; JSONL jobs in, one result line out):\n"
+            "  --serve             run until interrupted instead of reading jobs\n"
+            "  --socket PATH       Unix domain socket (default: faraday.sock)\n"
+            "  --http PORT         also serve POST /query on 127.0.0.1:PORT\n"
+            "  --glotec            keep live GloTEC maps ahead of the IONEX file\n"
+            "  --glotec-store DIR  archive fetched GloTEC snapshots in DIR\n"
+            "\n"
+            "Tracking mode (one JSONL sample per tick for the current moment):\n"
+            "  --track             follow one link until interrupted\n"
+            "  --dx GRID, --home GRID, --freq MHZ\n"
+            "  --dx-psi DEG, --home-psi DEG   polarization angles (default 0)\n"
+            "  --rate HZ           ticks per second (default 10)\n"
+            "  --duration S        stop after S seconds\n"
+            "\n"
+            "Planning mode (one JSONL line per proposed sked, best first per DX):\n"
+            "  --plan              rank operating times against a DX list\n"
+            "  --dx GRID[,GRID...], --home GRID; --freq, --dx-psi, --home-psi as above\n"
+            "  --from TIME         start, UTC seconds or YYYY-MM-DDTHH:MM (default now)\n"
+            "  --days N            horizon in days (default 1)\n"
+            "  --top K             slots per DX station (default 3)\n"
+            "  --slot S            sked length in seconds (default 1800)\n"
+            "  calendar.dat, if present, adds pathloss and sky noise to the score\n";
+    }
+
+    bool parseFormat(const std::string& text, BatchFormat& format) {
+        if (text == "jsonl" || text == "json") format = BatchFormat::JSONL;
+        else if (text == "csv") format = BatchFormat::CSV;
+        else if (text == "columnar") format = BatchFormat::COLUMNAR;
+        else return false;
+        return true;
+    }
+
+    bool parseNumber(const std::string& text, double& value) {
+        char* end = nullptr;
+        value = std::strtod(text.c_str(), &end);
+        return !text.empty() && *end == '\0' && std::isfinite(value);
+    }
+
+    bool parseCount(const std::string& text, std::size_t& value) {
+        char* end = nullptr;
+        unsigned long long parsed = std::strtoull(text.c_str(), &end, 10);
+        if (text.empty() || *end != '\0' || parsed == 0) return false;
+        value = static_cast<std::size_t>(parsed);
+        return true;
+    }
+}
+
+int main(int argc, char* argv[]) {
+    std::ios::sync_with_stdio(false);
+
+    BatchOptions options;
+    SystemConfiguration config;
+    std::string jobsFile = "-";
+    std::string ionexFile = "data.txt";
+    std::string wmmFile = "WMMHR.COF";
+    bool explicitIonex = false;
+    bool useIonosphere = true;
+    bool serve = false;
+    bool useGlotec = false;
+    std::string glotecStore;
+    QueryDaemonOptions daemonOptions;
+    bool track = false;
+    TrackerOptions trackerOptions;
+    std::string dxGrid, homeGrid;
+    double trackFrequency = 0.0, dxPsi = 0.0, homePsi = 0.0, duration = 0.0;
+    bool plan = false;
+    SkedPlannerOptions plannerOptions;
+    std::string planFrom;
+    double planDays = 1.0;
+
+    // ========== Arguments ==========
+    std::vector<std::string> args(argv + 1, argv + argc);
+    for (std::size_t i = 0; i < args.size(); ++i) {
+        const std::string& arg = args[i];
+        auto value = [&](std::string& out) {
+            if (i + 1 >= args.size()) {
+                std::cerr << "Error: " << arg << " needs a value" << std::endl;
+                return false;
+            }
+            out = args[++i];
+            return true;
+        };
+
+        std::string text;
+        std::size_t count;
+        if (arg == "-h" || arg == "--help") {
+            printUsage();
+            return 0;
+        } else if (arg == "--ionex") {
+            if (!value(ionexFile)) return 1;
+            explicitIonex = true;
+        } else if (arg == "--wmm") {
+            if (!value(wmmFile)) return 1;
+        } else if (arg == "--no-ionosphere") {
+            useIonosphere = false;
+        } else if (arg == "--chapman") {
+            config.ionoModel = SystemConfiguration::IonosphereModel::CHAPMAN;
+        } else if (arg == "--input" || arg == "--output") {
+            BatchFormat& format = (arg == "--input") ? options.input : options.output;
+            if (!value(text) || !parseFormat(text, format) ||
+                (arg == "--input" && format == BatchFormat::COLUMNAR)) {
+                std::cerr << "Error: " << arg << (arg == "--input" ? " takes jsonl or csv" : " takes jsonl, csv or columnar") << std::endl;
+                return 1;
+            }
+        } else if (arg == "--bins") {
+            if (!value(text) || !parseCount(text, count) || count > 1000000) {
+                std::cerr << "Error: --bins takes a number from 1 to 1000000" << std::endl;
+                return 1;
+            }
+            options.passbandBins = static_cast<int>(count);
+        } else if (arg == "--bandwidth") {
+            if (!value(text) || !parseNumber(text, config.bandwidth_Hz) || config.bandwidth_Hz < 0.0) {
+                std::cerr << "Error: --bandwidth takes a width in Hz" << std::endl;
+                return 1;
+            }
+        } else if (arg == "--optimal") {
+            options.solvePolarization = true;
+        } else if (arg == "--cross-gain") {
+            if (!value(text) || !parseNumber(text, options.crossGain_dB)) {
+                std::cerr << "Error: --cross-gain takes a gain in dB" << std::endl;
+                return 1;
+            }
+            options.solvePolarization = true;
+        } else if (arg == "--sensitivity") {
+            options.sensitivity = true;
+        } else if (arg == "--threads" || arg == "--block") {
+            if (!value(text) || !parseCount(text, count)) {
+                std::cerr << "Error: " << arg << " takes a positive number" << std::endl;
+                return 1;
+            }
+            if (arg == "--threads") options.threads = static_cast<unsigned>(count);
+            else options.blockSize = count;
+        } else if (arg == "--serve") {
+            serve = true;
+        } else if (arg == "--socket") {
+            if (!value(daemonOptions.socketPath)) return 1;
+            serve = true;
+        } else if (arg == "--http") {
+            char* end = nullptr;
+            if (!value(text) || (count = std::strtoul(text.c_str(), &end, 10), *end != '\0') ||
+                text.empty() || count > 65535) {
+                std::cerr << "Error: --http takes a port number" << std::endl;
+                return 1;
+            }
+            daemonOptions.httpPort = static_cast<int>(count);
+            serve = true;
+        } else if (arg == "--track") {
+            track = true;
+        } else if (arg == "--plan") {
+            plan = true;
+        } else if (arg == "--from") {
+            if (!value(planFrom)) return 1;
+        } else if (arg == "--top") {
+            if (!value(text) || !parseCount(text, count)) {
+                std::cerr << "Error: --top takes a positive number" << std::endl;
+                return 1;
+            }
+            plannerOptions.topK = count;
+        } else if (arg == "--days" || arg == "--slot") {
+            double number;
+            if (!value(text) || !parseNumber(text, number) || number <= 0.0) {
+                std::cerr << "Error: " << arg << " takes a positive number" << std::endl;
+                return 1;
+            }
+            if (arg == "--days") planDays = number;
+            else plannerOptions.slot_s = number;
+        } else if (arg == "--dx" || arg == "--home") {
+            if (!value(arg == "--dx" ? dxGrid : homeGrid)) return 1;
+        } else if (arg == "--freq" || arg == "--rate" || arg == "--duration" ||
+                   arg == "--dx-psi" || arg == "--home-psi") {
+            double number;
+            if (!value(text) || !parseNumber(text, number)) {
+                std::cerr << "Error: " << arg << " takes a number" << std::endl;
+                return 1;
+            }
+            if (arg == "--freq") trackFrequency = number;
+            else if (arg == "--rate") trackerOptions.rate_Hz = number;
+            else if (arg == "--duration") duration = number;
+            else if (arg == "--dx-psi") dxPsi = number;
+            else homePsi = number;
+        } else if (arg == "--glotec") {
+            useGlotec = true;
+        } else if (arg == "--glotec-store") {
+            if (!value(glotecStore)) return 1;
+            useGlotec = true;
+        } else if (!arg.empty() && arg[0] == '-' && arg != "-") {
+            std::cerr << "Error: unknown option " << arg << std::endl;
+            printUsage();
+            return 1;
+        } else {
+            jobsFile = arg;
+        }
+    }
+
+    // The daemon, the tracker and the planner speak JSONL only.
+    if ((serve || track || plan) && (options.input == BatchFormat::CSV ||
+                                     (options.output != BatchFormat::AUTO && options.output != BatchFormat::JSONL))) {
+        std::cerr << "Error: " << (serve ? "--serve" : track ? "--track" : "--plan")
+                  << " speaks JSONL only; drop --input/--output" << std::endl;
+        return 1;
+    }
+    if (options.sensitivity && config.ionoModel == SystemConfiguration::IonosphereModel::CHAPMAN) {
+        std::cerr << "Error: --sensitivity needs the thin-shell model; drop --chapman" << std::endl;
+        return 1;
+    }
+
+    // ========== Models (loaded once) ==========
+    IonosphereDataProvider provider;
+    provider.setMagneticFieldModel(config.magModel);
+    bool haveIonosphere = false;
+    if (useIonosphere) {
+        if (explicitIonex || std::filesystem::exists(ionexFile)) {
+            if (!provider.loadIonexFile(ionexFile)) {
+                std::cerr << "Error: Could not load " << ionexFile << std::endl;
+                return 1;
+            }
+            haveIonosphere = true;
+        }
+        if (std::filesystem::exists(wmmFile) && !provider.loadWMMFile(wmmFile)) {
+            std::cerr << "Warning: Could not load " << wmmFile << ". Using built-in "
+                      << provider.getWMMModelName() << " coefficients." << std::endl;
+        }
+    }
+
+    // Live GloTEC in front of the IONEX maps; the series refreshes itself and
+    // readers never wait for it.
+    std::shared_ptr<GlotecTimeSeries> glotec;
+    if (useIonosphere && useGlotec) {
+        glotec = std::make_shared<GlotecTimeSeries>();
+        if (!glotecStore.empty() && !glotec->getReader().openSnapshotStore(glotecStore)) {
+            std::cerr << "Warning: Could not open GloTEC store " << glotecStore << std::endl;
+        }
+        const std::int64_t now = static_cast<std::int64_t>(std::time(nullptr));
+        glotec->fill(now - GlotecTimeSeries::CADENCE_S * 12, now);
+        glotec->start();
+        provider.addTecSource(GlotecTecSource(glotec));
+        if (haveIonosphere) {
+            provider.addTecSource(IonexTecSource(provider.getIonexReader()));
+        }
+        std::cerr << "GloTEC: " << glotec->size() << " maps loaded" << std::endl;
+        haveIonosphere = true;
+    }
+    if (!haveIonosphere) {
+        std::cerr << "No TEC data; using vTEC=25 TECU, B=50uT, inclination=60deg" << std::endl;
+    }
+
+    BatchProcessor processor;
+    processor.setOptions(options);
+    processor.setConfiguration(config);
+    LunarEphemeris ephemeris;
+    if (serve) {
+        // Single requests cannot amortise a fit, so fit the weeks around now up front,
+        // kept beside the moon calendar so restarts within the span load it instead.
+        const double now = static_cast<double>(std::time(nullptr));
+        const double from = now - 2.0 * 86400.0, to = now + 30.0 * 86400.0;
+        auto cache = std::make_shared<LunarChebyshevCache>();
+        MoonCalendarReader calendar;
+        const bool fitted = calendar.loadCalendarFile("calendar.dat")
+            ? cache->loadOrBuild(calendar.getEphemerisCachePath(), ephemeris, from, to)
+            : cache->build(ephemeris, from, to);
+        if (fitted) {
+            ephemeris.attachCache(cache);
+        }
+    }
+    processor.setEphemeris(ephemeris);
+    if (haveIonosphere) {
+        processor.setIonosphereProvider(&provider);
+    }
+
+    // ========== Track ==========
+    if (track) {
+        SiteParameters dx, home;
+        try {
+            double lat, lon;
+            MaidenheadGrid::gridToLatLon(dxGrid, lat, lon);
+            dx.latitude = ParameterUtils::deg2rad(lat);
+            dx.longitude = ParameterUtils::deg2rad(lon);
+            MaidenheadGrid::gridToLatLon(homeGrid, lat, lon);
+            home.latitude = ParameterUtils::deg2rad(lat);
+            home.longitude = ParameterUtils::deg2rad(lon);
+        } catch (const std::exception& e) {
+            std::cerr << "Error: --dx/--home: " << e.what() << std::endl;
+            return 1;
+        }
+        dx.psi = ParameterUtils::deg2rad(dxPsi);
+        home.psi = ParameterUtils::deg2rad(homePsi);
+
+        SystemConfiguration trackConfig = config;
+        trackConfig.frequency_MHz = trackFrequency;
+        PolarizationTracker tracker;
+        tracker.setOptions(trackerOptions);
+        tracker.setConfiguration(trackConfig);
+        tracker.setStations(dx, home);
+        if (haveIonosphere) {
+            tracker.setIonosphereProvider(&provider);
+        }
+        if (!tracker.start()) {
+            std::cerr << "Error: " << tracker.getError() << std::endl;
+            return 1;
+        }
+
+        std::signal(SIGINT, requestStop);
+        std::signal(SIGTERM, requestStop);
+        const auto until = std::chrono::steady_clock::now() + std::chrono::duration_cast<std::chrono::steady_clock::duration>(
+            std::chrono::duration<double>(duration > 0.0 ? duration : 1e9));
+        const auto poll = std::chrono::duration_cast<std::chrono::steady_clock::duration>(
+            std::chrono::duration<double>(0.5 / trackerOptions.rate_Hz));
+
+        // Consumer side of the channel: print every sample, note any lost.
+        std::uint64_t cursor = 0, lost = 0;
+        TrackingSample sample;
+        char line[512];
+        while (!g_stopRequested && std::chrono::steady_clock::now() < until) {
+            while (tracker.getChannel().read(cursor, sample, &lost)) {
+                std::snprintf(line, sizeof(line),
+                    "{\"tick\":%llu,\"time\":%.1f,\"valid\":%s,\"PLF\":%.6f,\"loss_dB\":%.3f,"
+                    "\"spatial_deg\":%.3f,\"faraday_DX_deg\":%.3f,\"faraday_Home_deg\":%.3f,\"total_deg\":%.3f,"
+                    "\"elevation_DX_deg\":%.3f,\"elevation_Home_deg\":%.3f,\"psi_opt_deg\":%.3f,\"PLF_opt\":%.6f,"
+                    "\"faraday\":%s,\"latency_us\":%.1f}\n",
+                    static_cast<unsigned long long>(sample.tick), sample.time,
+                    (sample.flags & TrackingSample::VALID) ? "true" : "false",
+                    sample.PLF, sample.loss_dB, sample.spatial_deg,
+                    sample.faraday_DX_deg, sample.faraday_Home_deg, sample.total_deg,
+                    sample.elevation_DX_deg, sample.elevation_Home_deg,
+                    sample.optimalPsi_deg, sample.optimalPLF,
+                    (sample.flags & TrackingSample::FARADAY) ? "true" : "false", sample.latency_us);
+                std::cout << line;
+            }
+            std::cout.flush();
+            std::this_thread::sleep_for(poll);
+        }
+        tracker.stop();
+
+        const LatencyHistogram& compute = tracker.getComputeLatency();
+        const LatencyHistogram& jitter = tracker.getWakeJitter();
+        std::cerr << tracker.getTickCount() << " ticks, " << tracker.getSkippedTicks() << " skipped, "
+                  << tracker.getOverrunCount() << " over budget, " << lost << " lost by reader\n"
+                  << "compute us: p50 " << compute.percentile(0.5) << ", p99 " << compute.percentile(0.99)
+                  << ", max " << compute.getMax() << "\n"
+                  << "wake jitter us: p50 " << jitter.percentile(0.5) << ", p99 " << jitter.percentile(0.99)
+                  << ", max " << jitter.getMax() << std::endl;
+        return 0;
+    }
+
+    // ========== Plan ==========
+    if (plan) {
+        SiteParameters home;
+        std::vector<SiteParameters> dx;
+        std::vector<std::string> dxGrids;
+        try {
+            double lat, lon;
+            MaidenheadGrid::gridToLatLon(homeGrid, lat, lon);
+            home.latitude = ParameterUtils::deg2rad(lat);
+            home.longitude = ParameterUtils::deg2rad(lon);
+            home.psi = ParameterUtils::deg2rad(homePsi);
+            for (std::size_t begin = 0; begin <= dxGrid.size();) {
+                std::size_t end = dxGrid.find(',', begin);
+                if (end == std::string::npos) end = dxGrid.size();
+                dxGrids.push_back(dxGrid.substr(begin, end - begin));
+                MaidenheadGrid::gridToLatLon(dxGrids.back(), lat, lon);
+                SiteParameters station;
+                station.latitude = ParameterUtils::deg2rad(lat);
+                station.longitude = ParameterUtils::deg2rad(lon);
+                station.psi = ParameterUtils::deg2rad(dxPsi);
+                dx.push_back(station);
+                begin = end + 1;
+            }
+        } catch (const std::exception& e) {
+            std::cerr << "Error: --dx/--home: " << e.what() << std::endl;
+            return 1;
+        }
+
+        double from = static_cast<double>(std::time(nullptr));
+        if (!planFrom.empty() && !BatchJobParser::parseTime(planFrom, from)) {
+            std::cerr << "Error: --from takes UTC seconds or YYYY-MM-DDTHH:MM" << std::endl;
+            return 1;
+        }
+
+        SystemConfiguration planConfig = config;
+        if (trackFrequency > 0.0) {
+            planConfig.frequency_MHz = trackFrequency;
+        }
+        plannerOptions.windows.threads = options.threads;
+        MoonCalendarReader calendar;
+        SkedPlanner planner(ephemeris);
+        planner.setOptions(plannerOptions);
+        planner.setConfiguration(planConfig);
+        if (haveIonosphere) {
+            planner.setIonosphereProvider(&provider);
+        }
+        if (std::filesystem::exists("calendar.dat")) {
+            if (calendar.loadCalendarFile("calendar.dat")) {
+                planner.setMoonCalendar(&calendar);
+            } else {
+                std::cerr << "Warning: Could not load calendar.dat; scoring without pathloss" << std::endl;
+            }
+        }
+
+        std::vector<SkedSlot> slots;
+        if (!planner.plan(home, dx, from, planDays, slots)) {
+            std::cerr << "Error: " << planner.getError() << std::endl;
+            return 1;
+        }
+
+        char line[512];
+        std::size_t rank = 0;
+        for (std::size_t i = 0; i < slots.size(); ++i) {
+            const SkedSlot& slot = slots[i];
+            rank = (i > 0 && slots[i - 1].station == slot.station) ? rank + 1 : 1;
+            std::snprintf(line, sizeof(line),
+                "{\"dx_grid\":\"%s\",\"rank\":%zu,\"start\":%.0f,\"end\":%.0f,\"score_dB\":%.3f,\"PLF\":%.6f,"
+                "\"elevation_DX_deg\":%.3f,\"elevation_Home_deg\":%.3f,\"pathloss_dB\":%.3f,\"sky_noise_K\":%.1f,"
+                "\"faraday\":%s}\n",
+                dxGrids[slot.station].c_str(), rank, slot.start, slot.end, slot.score_dB, slot.PLF,
+                slot.minElevation_DX_deg, slot.minElevation_Home_deg, slot.pathloss_dB, slot.skyNoise_K,
+                slot.faradayIncluded ? "true" : "false");
+            std::cout << line;
+        }
+        std::cout.flush();
+        std::cerr << slots.size() << " slots for " << dx.size() << " DX stations" << std::endl;
+        return 0;
+    }
+
+    // ========== Serve ==========
+    if (serve) {
+        if (daemonOptions.socketPath.empty() && daemonOptions.httpPort < 0) {
+            daemonOptions.socketPath = "faraday.sock";
+        }
+        daemonOptions.threads = options.threads;
+
+        QueryDaemon daemon(processor);
+        if (!daemon.start(daemonOptions)) {
+            std::cerr << "Error: " << daemon.getError() << std::endl;
+            return 1;
+        }
+        if (!daemon.getSocketPath().empty()) {
+            std::cerr << "Listening on " << daemon.getSocketPath() << std::endl;
+        }
+        if (daemonOptions.httpPort >= 0) {
+            std::cerr << "Listening on http://127.0.0.1:" << daemon.getPort() << "/query" << std::endl;
+        }
+
+        std::signal(SIGINT, requestStop);
+        std::signal(SIGTERM, requestStop);
+        while (!g_stopRequested) {
+            std::this_thread::sleep_for(std::chrono::milliseconds(200));
+        }
+
+        daemon.stop();
+        if (glotec) {
+            glotec->stop();
+        }
+        std::cerr << daemon.getRequestCount() << " requests, "
+                  << daemon.getCoalescedCount() << " coalesced" << std::endl;
+        return 0;
+    }
+
+    // ========== Run ==========
+#ifdef _WIN32
+    // Text mode would turn LF into CRLF, and corrupt binary column chunks.
+    _setmode(_fileno(stdout), _O_BINARY);
+#endif
+    bool ok;
+    if (jobsFile == "-") {
+        ok = processor.run(std::cin, std::cout);
+    } else {
+        std::ifstream jobs(jobsFile, std::ios::binary);
+        if (!jobs.is_open()) {
+            std::cerr << "Error: Could not open " << jobsFile << std::endl;
+            return 1;
+        }
+        ok = processor.run(jobs, std::cout);
+    }
+
+    if (!ok) {
+        std::cerr << "Error: " << processor.getError() << std::endl;
+        return 1;
+    }
+    std::cerr << processor.getJobCount() << " jobs, " << processor.getFailedCount() << " failed" << std::endl;
+    return 0;
+}
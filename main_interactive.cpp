@@ -3,11 +3,17 @@
 #include "MaidenheadGrid.h"
 #include "IonosphereDataProvider.h"
 #include "MoonCalendarReader.h"
+#include "LunarEphemeris.h"
+#include "GlotecSnapshotStore.h"
+#include "MoonWindowFinder.h"
+#include "PassSweep.h"
 #include <iostream>
 #include <iomanip>
 #include <string>
 #include <limits>
 #include <fstream>
+#include <vector>
+#include <cstdint>
 
 void clearInputBuffer() {
     std::cin.clear();
@@ -24,6 +30,39 @@ void printHeader(const std::string& title) {
     printSeparator();
 }
 
+void readObservationTime(std::tm& obs_time) {
+    std::cout << "\nEnter observation date and time (UTC):" << std::endl;
+    std::cout << "Year (e.g., 2026): ";
+    int year;
+    std::cin >> year;
+    obs_time.tm_year = year - 1900;
+    clearInputBuffer();
+
+    std::cout << "Month (1-12): ";
+    int month;
+    std::cin >> month;
+    obs_time.tm_mon = month - 1;
+    clearInputBuffer();
+
+    std::cout << "Day (1-31): ";
+    std::cin >> obs_time.tm_mday;
+    clearInputBuffer();
+
+    std::cout << "Hour (0-23): ";
+    std::cin >> obs_time.tm_hour;
+    clearInputBuffer();
+
+    std::cout << "Minute (0-59): ";
+    std::cin >> obs_time.tm_min;
+    clearInputBuffer();
+
+    if (obs_time.tm_mday == 14 && month == 1)
+        std::cout << "Happy Birthday Mutsumi Wakaba!" << std::endl;
+
+    obs_time.tm_sec = 0;
+    obs_time.tm_isdst = -1;
+}
+
 int main() {
     std::cout << std::fixed << std::setprecision(3);
 
@@ -107,9 +146,12 @@ int main() {
 
     IonosphereData iono;
     std::tm obs_time = {};
+    IonosphereDataProvider provider;
+    bool iono_from_ionex = false;
+    bool have_obs_time = false;
 
     if (iono_option == 1) {
-        IonosphereDataProvider provider;
+        provider.setMagneticFieldModel(config.magModel);
         std::cout << "Loading IONEX file (data.txt)..." << std::endl;
 
         if (!provider.loadIonexFile("data.txt")) {
@@ -128,41 +170,14 @@ int main() {
 
             std::cout << "Loading WMM model (WMMHR.COF)..." << std::endl;
             if (!provider.loadWMMFile("WMMHR.COF")) {
-                std::cout << "Warning: Could not load WMM file. Using default magnetic field values." << std::endl;
+                std::cout << "Warning: Could not load WMM file. Using built-in "
+                          << provider.getWMMModelName() << " coefficients." << std::endl;
             } else {
                 std::cout << "WMM model loaded successfully!" << std::endl;
             }
 
-            std::cout << "\nEnter observation date and time (UTC):" << std::endl;
-            std::cout << "Year (e.g., 2026): ";
-            int year;
-            std::cin >> year;
-            obs_time.tm_year = year - 1900;
-            clearInputBuffer();
-
-            std::cout << "Month (1-12): ";
-            int month;
-            std::cin >> month;
-            obs_time.tm_mon = month - 1;
-            clearInputBuffer();
-
-            std::cout << "Day (1-31): ";
-            std::cin >> obs_time.tm_mday;
-            clearInputBuffer();
-
-            std::cout << "Hour (0-23): ";
-            std::cin >> obs_time.tm_hour;
-            clearInputBuffer();
-
-            std::cout << "Minute (0-59): ";
-            std::cin >> obs_time.tm_min;
-            clearInputBuffer();
-
-            if (obs_time.tm_mday == 14 && month == 1)
-				std::cout << "Happy Birthday Mutsumi Wakaba!" << std::endl;
-
-            obs_time.tm_sec = 0;
-            obs_time.tm_isdst = -1;
+            readObservationTime(obs_time);
+            have_obs_time = true;
 
             double lat_dx = ParameterUtils::rad2deg(calculator.getDXStation().latitude);
             double lon_dx = ParameterUtils::rad2deg(calculator.getDXStation().longitude);
@@ -174,6 +189,7 @@ int main() {
 
             if (provider.getIonosphereData(obs_time, lat_dx, lon_dx, height_dx_km,
                                           lat_home, lon_home, height_home_km, iono)) {
+                iono_from_ionex = true;
                 std::cout << "\nIonosphere data retrieved:" << std::endl;
                 std::cout << "  DX vTEC: " << iono.vTEC_DX << " TECU" << std::endl;
                 std::cout << "  Home vTEC: " << iono.vTEC_Home << " TECU" << std::endl;
@@ -185,6 +201,17 @@ int main() {
                     std::cout << "  Home Inclination: " << ParameterUtils::rad2deg(iono.B_inclination_Home) << " deg" << std::endl;
                     std::cout << "  Home Declination: " << ParameterUtils::rad2deg(iono.B_declination_Home) << " deg" << std::endl;
                 }
+
+                std::cout << "\nUse Chapman slant-path integration? (y/n): ";
+                char chapman_choice;
+                std::cin >> chapman_choice;
+                clearInputBuffer();
+
+                if (chapman_choice == 'y' || chapman_choice == 'Y') {
+                    config.ionoModel = SystemConfiguration::IonosphereModel::CHAPMAN;
+                    calculator.setConfiguration(config);
+                    calculator.setMagneticField(provider.prepareMagneticField(obs_time));
+                }
             } else {
                 std::cerr << "Error: Could not retrieve TEC data for specified time/location" << std::endl;
                 std::cerr << "Falling back to default values." << std::endl;
@@ -253,14 +280,42 @@ int main() {
 
     // ========== Input: Moon Ephemeris ==========
     std::cout << "\n--- Moon Ephemeris ---" << std::endl;
-    std::cout << "Do you have moon elevation/azimuth data? (y/n): ";
-    char have_elev;
-    std::cin >> have_elev;
+    std::cout << "Compute moon position from the built-in lunar ephemeris? (y/n): ";
+    char use_ephemeris;
+    std::cin >> use_ephemeris;
     clearInputBuffer();
 
+    char have_elev = 'n';
+    if (use_ephemeris != 'y' && use_ephemeris != 'Y') {
+        std::cout << "Do you have moon elevation/azimuth data? (y/n): ";
+        std::cin >> have_elev;
+        clearInputBuffer();
+    }
+
     MoonEphemeris moon;
 
-    if (have_elev == 'y' || have_elev == 'Y') {
+    if (use_ephemeris == 'y' || use_ephemeris == 'Y') {
+        if (!have_obs_time) {
+            readObservationTime(obs_time);
+            have_obs_time = true;
+        }
+
+        LunarEphemeris ephemeris;
+        moon = ephemeris.computeMoonEphemeris(
+            static_cast<double>(GlotecSnapshotStore::toEpochSeconds(obs_time)),
+            calculator.getDXStation(), calculator.getHomeStation());
+
+        std::cout << "Moon declination: " << ParameterUtils::rad2deg(moon.declination) << " deg" << std::endl;
+        std::cout << "Earth-Moon distance: " << std::setprecision(0) << moon.distance_km << " km"
+                  << std::setprecision(3) << std::endl;
+        std::cout << "DX hour angle: " << ParameterUtils::rad2deg(moon.hourAngle_DX)
+                  << " deg, elevation " << ParameterUtils::rad2deg(moon.elevation_DX)
+                  << " deg, azimuth " << ParameterUtils::rad2deg(moon.azimuth_DX) << " deg" << std::endl;
+        std::cout << "Home hour angle: " << ParameterUtils::rad2deg(moon.hourAngle_Home)
+                  << " deg, elevation " << ParameterUtils::rad2deg(moon.elevation_Home)
+                  << " deg, azimuth " << ParameterUtils::rad2deg(moon.azimuth_Home) << " deg" << std::endl;
+
+    } else if (have_elev == 'y' || have_elev == 'Y') {
         std::cout << "Enter DX station moon elevation (degrees above horizon): ";
         double elev_dx;
         std::cin >> elev_dx;
@@ -403,18 +458,40 @@ int main() {
         moon.hourAngle_Home = ParameterUtils::deg2rad(hour_angle_home);
     }
 
-    std::cout << "Enter Earth-Moon distance (km, typical: 356500-406700, default=384400): ";
-    double moon_distance;
-    std::cin >> moon_distance;
-    clearInputBuffer();
+    if (use_ephemeris != 'y' && use_ephemeris != 'Y') {
+        std::cout << "Enter Earth-Moon distance (km, typical: 356500-406700, default=384400): ";
+        double moon_distance;
+        std::cin >> moon_distance;
+        clearInputBuffer();
 
-    moon.distance_km = moon_distance;
+        moon.distance_km = moon_distance;
+    }
     calculator.setMoonEphemeris(moon);
 
     // ========== Calculate ==========
     std::cout << "\nCalculating..." << std::endl;
     CalculationResults results = calculator.calculate();
 
+    // Re-sample TEC and B where the rays actually cross the ionosphere.
+    if (iono_from_ionex && results.calculationSuccess) {
+        const MoonEphemeris& geometry = calculator.getMoonEphemeris();
+        IonosphereData ipp_iono = iono;
+
+        if (provider.getIonosphereDataAtIPP(obs_time,
+                ParameterUtils::rad2deg(calculator.getDXStation().latitude),
+                ParameterUtils::rad2deg(calculator.getDXStation().longitude),
+                geometry.elevation_DX, geometry.azimuth_DX,
+                ParameterUtils::rad2deg(calculator.getHomeStation().latitude),
+                ParameterUtils::rad2deg(calculator.getHomeStation().longitude),
+                geometry.elevation_Home, geometry.azimuth_Home,
+                ipp_iono)) {
+            std::cout << "Piercing-point vTEC: DX " << ipp_iono.vTEC_DX
+                      << " TECU, Home " << ipp_iono.vTEC_Home << " TECU" << std::endl;
+            calculator.setIonosphereData(ipp_iono);
+            results = calculator.calculate();
+        }
+    }
+
     // Debug: Show calculated elevations
     const MoonEphemeris& moon_data = calculator.getMoonEphemeris();
     std::cout << "\nDebug - Calculated Moon Elevations:" << std::endl;
@@ -467,6 +544,77 @@ int main() {
     std::cout << "Efficiency: " << std::setprecision(2)
               << results.polarizationEfficiency << " %" << std::endl;
 
+    const PolarizationSolution solution = calculator.solvePolarization(results);
+    std::cout << "\n--- Best Receive Polarization ---" << std::endl;
+    std::cout << "Arriving wave: psi " << std::setprecision(1) << solution.arrivalPsi_deg
+              << " deg, chi " << solution.arrivalChi_deg << " deg" << std::endl;
+    std::cout << "Best Home psi: " << solution.optimalPsi_deg << " deg (Loss "
+              << std::setprecision(3) << 10.0 * std::log10(solution.optimalPLF) << " dB)" << std::endl;
+    std::cout << "Dual-pol MRC: " << solution.combined_dB << " dB" << std::endl;
+
+    // ========== Other Bands ==========
+    std::vector<BandResult> bands;
+    calculator.calculateBands(ParameterUtils::getEMEFrequencies(), bands);
+    if (!bands.empty()) {
+        std::cout << "\n--- Same Link on Other Bands ---" << std::endl;
+        for (const BandResult& band : bands) {
+            std::cout << std::setw(6) << ParameterUtils::getFrequencyBand(band.frequency_MHz)
+                      << std::setw(10) << std::setprecision(2) << band.frequency_MHz << " MHz"
+                      << "  Faraday " << std::setw(10) << std::setprecision(3)
+                      << band.faradayRotation_DX_deg + band.faradayRotation_Home_deg << " deg"
+                      << "  Loss " << std::setw(8) << band.polarizationLoss_dB << " dB" << std::endl;
+        }
+    }
+
+    // ========== Pass Profile ==========
+    if (use_ephemeris == 'y' || use_ephemeris == 'Y') {
+        const double now = static_cast<double>(GlotecSnapshotStore::toEpochSeconds(obs_time));
+        LunarEphemeris ephemeris;
+        MoonWindowFinder finder(ephemeris);
+        MoonWindowOptions windowOptions;
+        windowOptions.minElevation_deg = 1.0;
+        finder.setOptions(windowOptions);
+
+        std::vector<MoonWindow> windows;
+        const std::vector<SiteParameters> dxList{ calculator.getDXStation() };
+        if (finder.findWindows(calculator.getHomeStation(), dxList, now - 86400.0, 2.0, windows)) {
+            for (const MoonWindow& window : windows) {
+                if (now < window.start || now > window.end) {
+                    continue;
+                }
+                // The sweep's sensitivities need the thin shell, so a Chapman run gets
+                // its profile from the thin shell instead.
+                SystemConfiguration sweepConfig = calculator.getConfiguration();
+                const bool forcedThinShell = sweepConfig.ionoModel != SystemConfiguration::IonosphereModel::SIMPLE;
+                sweepConfig.ionoModel = SystemConfiguration::IonosphereModel::SIMPLE;
+                PassSweep sweep(ephemeris);
+                sweep.setConfiguration(sweepConfig);
+                sweep.setIonosphereProvider(iono_from_ionex ? &provider : nullptr);
+                PassProfile profile;
+                const char* note = !iono_from_ionex ? " (geometry only)" : forcedThinShell ? " (thin-shell model)" : "";
+                std::cout << "\n--- Pass Profile" << note << " ---" << std::endl;
+                if (!sweep.sweep(calculator.getDXStation(), calculator.getHomeStation(),
+                                 window.start, window.end, profile)) {
+                    std::cout << "Sweep failed: " << sweep.getError() << std::endl;
+                    break;
+                }
+                std::vector<PassSample> samples;
+                profile.resample(1800.0, samples);
+                for (const PassSample& sample : samples) {
+                    const std::tm utc = GlotecSnapshotStore::fromEpochSeconds(
+                        static_cast<std::int64_t>(sample.time));
+                    std::cout << std::setfill('0') << std::setw(2) << utc.tm_hour << ":"
+                              << std::setw(2) << utc.tm_min << std::setfill(' ') << " UTC"
+                              << "  Rotation " << std::setw(10) << std::setprecision(1) << sample.totalRotation_deg << " deg"
+                              << "  Loss " << std::setw(8) << std::setprecision(2) << sample.polarizationLoss_dB << " dB" << std::endl;
+                }
+                std::cout << sweep.getEvaluationCount() << " evaluations over "
+                          << std::setprecision(1) << window.duration_s() / 3600.0 << " h" << std::endl;
+                break;
+            }
+        }
+    }
+
     // ========== Interpretation ==========
     std::cout << "\n--- Interpretation ---" << std::endl;
     if (results.polarizationLoss_dB > -1.0) {
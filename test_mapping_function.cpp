@@ -0,0 +1,120 @@
+// Accuracy and speed check of MappingFunctionTable against the closed form.
+// Build: g++ -std=c++20 -O2 -o test_mapping_function test_mapping_function.cpp MappingFunctionTable.cpp
+#include "MappingFunctionTable.h"
+#include "IonospherePhysics.h"
+#include "Parameters.h"
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstddef>
+#include <iomanip>
+#include <iostream>
+#include <random>
+#include <vector>
+
+namespace {
+    constexpr double TOLERANCE = 1e-6;
+    constexpr double PI = 3.14159265358979323846;
+    constexpr double EARTH_RADIUS = 6371.0;
+    constexpr std::size_t SAMPLES = 1000000;
+    constexpr int REPEATS = 20;
+
+    template <typename F>
+    double nanosecondsPerCall(F&& run) {
+        run();  // warm-up
+        const auto start = std::chrono::steady_clock::now();
+        for (int r = 0; r < REPEATS; ++r) {
+            run();
+        }
+        const auto stop = std::chrono::steady_clock::now();
+        return std::chrono::duration<double, std::nano>(stop - start).count() /
+               (static_cast<double>(REPEATS) * SAMPLES);
+    }
+}
+
+int main() {
+    const MappingFunctionTable& table = MappingFunctionTable::standard();
+    std::cout << "Table: " << table.getTableSize() << " nodes, self-measured error "
+              << std::scientific << std::setprecision(2) << table.getMaxRelativeError() << std::endl;
+
+    // Random points over the tabulated range, plus the horizon and zenith.
+    std::mt19937_64 random(12345);
+    std::uniform_real_distribution<double> elevationDist(0.0, 0.5 * PI);
+    std::uniform_real_distribution<double> logHeightDist(std::log(50.0), std::log(2000.0));
+    std::vector<double> elevation(SAMPLES), hmF2(SAMPLES);
+    for (std::size_t n = 0; n < SAMPLES; ++n) {
+        elevation[n] = elevationDist(random);
+        hmF2[n] = std::exp(logHeightDist(random));
+    }
+    elevation[0] = 0.0;
+    elevation[1] = 0.5 * PI;
+
+    // ========== Accuracy ==========
+    std::vector<double> exact(SAMPLES), tabulated(SAMPLES);
+    for (std::size_t n = 0; n < SAMPLES; ++n) {
+        exact[n] = IonospherePhysics::mappingFunction(elevation[n], hmF2[n], EARTH_RADIUS);
+    }
+    table.evaluateBatch(elevation.data(), hmF2.data(), SAMPLES, tabulated.data());
+
+    double tableError = 0.0;
+    for (std::size_t n = 0; n < SAMPLES; ++n) {
+        tableError = std::max(tableError, std::abs(tabulated[n] / exact[n] - 1.0));
+    }
+
+    const double sliceHeight = SystemConstants::IONOSPHERE_HEIGHT_KM;
+    const MappingFunctionSlice slice = table.slice(sliceHeight);
+    std::vector<double> sliced(SAMPLES);
+    slice.evaluateBatch(elevation.data(), SAMPLES, sliced.data());
+    double sliceError = 0.0;
+    for (std::size_t n = 0; n < SAMPLES; ++n) {
+        const double reference = IonospherePhysics::mappingFunction(elevation[n], sliceHeight, EARTH_RADIUS);
+        sliceError = std::max(sliceError, std::abs(sliced[n] / reference - 1.0));
+    }
+
+    std::cout << "Max relative error: table " << tableError << ", slice " << sliceError
+              << " (bound " << TOLERANCE << ")" << std::endl;
+
+    // ========== Speed ==========
+    double sink = 0.0;
+    const double closedForm = nanosecondsPerCall([&] {
+        for (std::size_t n = 0; n < SAMPLES; ++n) {
+            exact[n] = IonospherePhysics::mappingFunction(elevation[n], hmF2[n], EARTH_RADIUS);
+        }
+        sink += exact[SAMPLES / 2];
+    });
+    const double batch = nanosecondsPerCall([&] {
+        table.evaluateBatch(elevation.data(), hmF2.data(), SAMPLES, tabulated.data());
+        sink += tabulated[SAMPLES / 2];
+    });
+    const double sliceBatch = nanosecondsPerCall([&] {
+        slice.evaluateBatch(elevation.data(), SAMPLES, sliced.data());
+        sink += sliced[SAMPLES / 2];
+    });
+
+    // One call at a time at the fixed shell height, as FaradayRotation::calculateSlantFactor does.
+    const double closedScalar = nanosecondsPerCall([&] {
+        for (std::size_t n = 0; n < SAMPLES; ++n) {
+            sink += IonospherePhysics::mappingFunction(elevation[n], sliceHeight, EARTH_RADIUS);
+        }
+    });
+    const double sliceScalar = nanosecondsPerCall([&] {
+        for (std::size_t n = 0; n < SAMPLES; ++n) {
+            sink += slice.evaluate(elevation[n]);
+        }
+    });
+
+    std::cout << std::fixed << std::setprecision(2)
+              << "Closed form: " << closedForm << " ns/call" << std::endl
+              << "Table batch: " << batch << " ns/call" << std::endl
+              << "Slice batch: " << sliceBatch << " ns/call" << std::endl
+              << "Closed form, one hmF2: " << closedScalar << " ns/call" << std::endl
+              << "Slice, one call at a time: " << sliceScalar << " ns/call" << std::endl
+              << "(checksum " << sink << ")" << std::endl;
+
+    if (tableError > TOLERANCE || sliceError > TOLERANCE) {
+        std::cout << "FAIL: error above " << std::scientific << TOLERANCE << std::endl;
+        return 1;
+    }
+    std::cout << "PASS" << std::endl;
+    return 0;
+}
@@ -0,0 +1,163 @@
+// Brute-force check of MoonWindowFinder: every window found by sampling the
+// full FaradayRotation chain every few seconds must be found, and nothing else.
+// Build: g++ -std=c++20 -O2 -pthread -o test_moon_windows test_moon_windows.cpp
+//        MoonWindowFinder.cpp LunarEphemeris.cpp LunarChebyshevCache.cpp FaradayRotation.cpp
+//        ChapmanSlantIntegrator.cpp IonospherePhysics.cpp MappingFunctionTable.cpp GeomagneticField.cpp
+#include "MoonWindowFinder.h"
+#include "LunarEphemeris.h"
+#include "LunarChebyshevCache.h"
+#include "FaradayRotation.h"
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
+#include <iostream>
+#include <memory>
+#include <random>
+#include <vector>
+
+namespace {
+    constexpr double PI = 3.14159265358979323846;
+    constexpr double FROM = 1767225600.0;       // 2026-01-01 00:00 UTC
+    constexpr double DAYS = 20.0;
+    constexpr double BRUTE_STEP_S = 10.0;
+    constexpr std::size_t STATIONS = 60;
+    constexpr double MIN_ELEVATION_DEG = 1.0;
+
+    struct Span {
+        double start;
+        double end;
+    };
+
+    // Runs of usable samples, as [first usable, last usable].
+    std::vector<Span> bruteWindows(const std::vector<char>& usable) {
+        std::vector<Span> spans;
+        for (std::size_t n = 0; n < usable.size(); ++n) {
+            if (!usable[n]) continue;
+            const std::size_t first = n;
+            while (n + 1 < usable.size() && usable[n + 1]) ++n;
+            spans.push_back({ FROM + BRUTE_STEP_S * first, FROM + BRUTE_STEP_S * n });
+        }
+        return spans;
+    }
+
+    // Counts brute-force windows the finder missed, finder windows with no usable
+    // sample, and the largest edge disagreement between matched windows.
+    void compare(const std::vector<Span>& brute, const std::vector<MoonWindow>& found,
+                 double minDuration_s, int& missed, int& spurious, double& edgeError) {
+        for (const Span& span : brute) {
+            // Only windows clearly longer than the minimum must be found.
+            if (span.end - span.start < minDuration_s + 2.0 * BRUTE_STEP_S) continue;
+            bool matched = false;
+            for (const MoonWindow& window : found) {
+                if (window.start <= span.end && window.end >= span.start) {
+                    matched = true;
+                    edgeError = std::max(edgeError, std::abs(window.start - span.start));
+                    edgeError = std::max(edgeError, std::abs(window.end - span.end));
+                }
+            }
+            if (!matched) {
+                ++missed;
+                std::cout << "  missed " << std::fixed << span.end - span.start << " s at "
+                          << span.start << std::endl;
+            }
+        }
+        for (const MoonWindow& window : found) {
+            if (window.duration_s() < 2.0 * BRUTE_STEP_S) continue;
+            bool matched = false;
+            for (const Span& span : brute) {
+                matched = matched || (window.start <= span.end && window.end >= span.start);
+            }
+            if (!matched) {
+                ++spurious;
+                std::cout << "  spurious " << std::fixed << window.duration_s() << " s at "
+                          << window.start << std::endl;
+            }
+        }
+    }
+}
+
+int main() {
+    LunarEphemeris ephemeris;
+    auto cache = std::make_shared<LunarChebyshevCache>();
+    if (!cache->build(ephemeris, FROM, FROM + DAYS * 86400.0)) {
+        std::cout << "FAIL: " << cache->getError() << std::endl;
+        return 1;
+    }
+    ephemeris.attachCache(cache);
+
+    SiteParameters home;
+    home.latitude = 52.0 * PI / 180.0;
+    home.longitude = 5.0 * PI / 180.0;
+
+    std::mt19937_64 random(2026);
+    std::uniform_real_distribution<double> sinLatitude(-0.9, 0.9);
+    std::uniform_real_distribution<double> longitude(-PI, PI);
+    std::uniform_real_distribution<double> angle(0.0, PI);
+    std::vector<SiteParameters> dx(STATIONS);
+    for (SiteParameters& station : dx) {
+        station.latitude = std::asin(sinLatitude(random));
+        station.longitude = longitude(random);
+        station.psi = angle(random);
+    }
+
+    // Reference: the full chain without Faraday terms, every BRUTE_STEP_S.
+    SystemConfiguration config;
+    config.includeFaradayRotation = false;
+    FaradayRotation calculator;
+    calculator.setConfiguration(config);
+    calculator.setHomeStation(home);
+
+    const std::size_t samples = static_cast<std::size_t>(DAYS * 86400.0 / BRUTE_STEP_S) + 1;
+    const double minElevation = MIN_ELEVATION_DEG * PI / 180.0;
+    std::vector<std::vector<double>> plf(STATIONS, std::vector<double>(samples, -1.0));
+    for (std::size_t s = 0; s < STATIONS; ++s) {
+        calculator.setDXStation(dx[s]);
+        for (std::size_t n = 0; n < samples; ++n) {
+            const MoonEphemeris moon = ephemeris.computeMoonEphemeris(FROM + BRUTE_STEP_S * n, dx[s], home);
+            if (moon.elevation_DX < minElevation || moon.elevation_Home < minElevation) continue;
+            calculator.setMoonEphemeris(moon);
+            const CalculationResults result = calculator.calculate();
+            plf[s][n] = result.calculationSuccess ? result.PLF : -1.0;
+        }
+    }
+
+    bool pass = true;
+    for (double minPLF : { 0.0, 0.5, 0.9 }) {
+        MoonWindowOptions options;
+        options.minElevation_deg = MIN_ELEVATION_DEG;
+        options.minPLF = minPLF;
+        MoonWindowFinder finder(ephemeris);
+        finder.setOptions(options);
+        std::vector<MoonWindow> windows;
+        if (!finder.findWindows(home, dx, FROM, DAYS, windows)) {
+            std::cout << "FAIL: " << finder.getError() << std::endl;
+            return 1;
+        }
+
+        int missed = 0, spurious = 0, total = 0;
+        double edgeError = 0.0;
+        for (std::size_t s = 0; s < STATIONS; ++s) {
+            std::vector<char> usable(samples);
+            for (std::size_t n = 0; n < samples; ++n) {
+                usable[n] = plf[s][n] >= 0.0 && plf[s][n] >= minPLF;
+            }
+            std::vector<MoonWindow> found;
+            for (const MoonWindow& window : windows) {
+                if (window.station == s) found.push_back(window);
+            }
+            total += static_cast<int>(found.size());
+            compare(bruteWindows(usable), found, options.minDuration_s, missed, spurious, edgeError);
+        }
+
+        // Brute-force edges are only known to one step; elevation rounding at the
+        // finder's edges adds its tolerance.
+        const bool ok = missed == 0 && spurious == 0 && edgeError <= BRUTE_STEP_S + options.tolerance_s;
+        std::cout << "minPLF " << std::defaultfloat << minPLF << ": " << total << " windows, "
+                  << missed << " missed, " << spurious << " spurious, edge error "
+                  << std::fixed << edgeError << " s" << (ok ? "" : "  <-- FAIL") << std::endl;
+        pass = pass && ok;
+    }
+
+    std::cout << (pass ? "PASS" : "FAIL") << std::endl;
+    return pass ? 0 : 1;
+}
@@ -0,0 +1,174 @@
+// Regression check of SkedPlanner on a fixed DX list: the top-K slots must be
+// well formed, lie inside the mutual windows, score what the full chain says,
+// match an exhaustive fine-step search, and stay where they were found.
+// Build: g++ -std=c++20 -O2 -pthread -o test_sked_planner test_sked_planner.cpp SkedPlanner.cpp
+//        MoonWindowFinder.cpp LunarEphemeris.cpp LunarChebyshevCache.cpp FaradayRotation.cpp
+//        ChapmanSlantIntegrator.cpp IonospherePhysics.cpp MappingFunctionTable.cpp GeomagneticField.cpp
+//        and the rest of the engine sources (every .cpp except main_*.cpp and test_*.cpp)
+#include "SkedPlanner.h"
+#include "MoonWindowFinder.h"
+#include "LunarEphemeris.h"
+#include "FaradayRotation.h"
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
+#include <iostream>
+#include <vector>
+
+namespace {
+    constexpr double PI = 3.14159265358979323846;
+    constexpr double FROM = 1767225600.0;       // 2026-01-01 00:00 UTC
+    constexpr double DAYS = 3.0;
+    constexpr std::size_t TOP_K = 3;
+    constexpr double SCORE_TOLERANCE_DB = 0.01;
+
+    struct Station {
+        const char* name;
+        double latitude_deg;
+        double longitude_deg;
+        double psi_deg;
+    };
+
+    const Station HOME = { "OL72", 22.5, 115.0, 0.0 };
+    const Station DX[] = {
+        { "JO32", 52.5, 7.0, 0.0 },
+        { "FN20", 40.5, -75.0, 45.0 },
+        { "QF22", -37.5, 145.0, 90.0 },
+    };
+    constexpr std::size_t STATIONS = sizeof(DX) / sizeof(DX[0]);
+
+    // Slot starts found when this test was written, best first per station.
+    const double EXPECTED_START[STATIONS][TOP_K] = {
+        { 1767369040.0, 1767278592.0, 1767459043.0 },
+        { 1767347228.0, 1767256789.0, 1767437523.0 },
+        { 1767452117.0, 1767453908.0, 1767450325.0 },
+    };
+
+    SiteParameters site(const Station& station) {
+        SiteParameters p;
+        p.latitude = station.latitude_deg * PI / 180.0;
+        p.longitude = station.longitude_deg * PI / 180.0;
+        p.psi = station.psi_deg * PI / 180.0;
+        return p;
+    }
+
+    std::vector<SkedSlot> forStation(const std::vector<SkedSlot>& slots, std::size_t station) {
+        std::vector<SkedSlot> result;
+        for (const SkedSlot& slot : slots) {
+            if (slot.station == station) result.push_back(slot);
+        }
+        return result;
+    }
+
+    // The planner's score for one instant, recomputed from the chain.
+    double pointScore(const LunarEphemeris& ephemeris, FaradayRotation& calculator,
+                      const SiteParameters& dx, const SiteParameters& home,
+                      const SkedPlannerOptions& options, double time) {
+        const MoonEphemeris moon = ephemeris.computeMoonEphemeris(time, dx, home);
+        calculator.setMoonEphemeris(moon);
+        const CalculationResults result = calculator.calculate();
+        double score = 10.0 * std::log10(std::max(result.calculationSuccess ? result.PLF : 0.0, 1e-6));
+        const double elevation = std::min(moon.elevation_DX, moon.elevation_Home) * 180.0 / PI;
+        if (elevation < options.lowElevation_deg) {
+            score -= options.lowElevationPenalty_dB *
+                std::min(1.0, (options.lowElevation_deg - elevation) / options.lowElevation_deg);
+        }
+        return score;
+    }
+}
+
+int main() {
+    LunarEphemeris ephemeris;
+    const SiteParameters home = site(HOME);
+    std::vector<SiteParameters> dx;
+    for (const Station& station : DX) dx.push_back(site(station));
+
+    SystemConfiguration config;
+    config.includeFaradayRotation = false;
+    SkedPlannerOptions options;
+    options.topK = TOP_K;
+
+    SkedPlanner planner(ephemeris);
+    planner.setOptions(options);
+    planner.setConfiguration(config);
+    std::vector<SkedSlot> slots;
+    if (!planner.plan(home, dx, FROM, DAYS, slots)) {
+        std::cout << "FAIL: " << planner.getError() << std::endl;
+        return 1;
+    }
+
+    // Reference: every window scored at the fine step, every slot a candidate.
+    SkedPlannerOptions exhaustiveOptions = options;
+    exhaustiveOptions.coarseStep_s = options.fineStep_s;
+    exhaustiveOptions.refineFactor = 1000000;
+    SkedPlanner exhaustive(ephemeris);
+    exhaustive.setOptions(exhaustiveOptions);
+    exhaustive.setConfiguration(config);
+    std::vector<SkedSlot> reference;
+    if (!exhaustive.plan(home, dx, FROM, DAYS, reference)) {
+        std::cout << "FAIL: " << exhaustive.getError() << std::endl;
+        return 1;
+    }
+
+    MoonWindowFinder finder(ephemeris);
+    finder.setOptions(options.windows);
+    std::vector<MoonWindow> windows;
+    if (!finder.findWindows(home, dx, FROM, DAYS, windows)) {
+        std::cout << "FAIL: " << finder.getError() << std::endl;
+        return 1;
+    }
+
+    FaradayRotation calculator;
+    calculator.setConfiguration(config);
+    calculator.setHomeStation(home);
+
+    bool pass = true;
+    for (std::size_t s = 0; s < STATIONS; ++s) {
+        const std::vector<SkedSlot> found = forStation(slots, s);
+        const std::vector<SkedSlot> best = forStation(reference, s);
+        calculator.setDXStation(dx[s]);
+        std::cout << DX[s].name << ":" << std::endl;
+
+        bool ok = found.size() == TOP_K && best.size() == TOP_K;
+        for (std::size_t k = 0; k < std::min(found.size(), TOP_K); ++k) {
+            const SkedSlot& slot = found[k];
+
+            // Sorted, non-overlapping, one slot long, inside a window and above its elevation.
+            ok = ok && (k == 0 || slot.score_dB <= found[k - 1].score_dB);
+            for (std::size_t j = 0; j < k; ++j) {
+                ok = ok && (slot.end <= found[j].start || slot.start >= found[j].end);
+            }
+            ok = ok && std::abs(slot.end - slot.start - options.slot_s) <= options.fineStep_s;
+            ok = ok && std::any_of(windows.begin(), windows.end(), [&](const MoonWindow& w) {
+                return w.station == s && slot.start >= w.start && slot.end <= w.end;
+            });
+            ok = ok && slot.minElevation_DX_deg >= options.windows.minElevation_deg - 0.01 &&
+                 slot.minElevation_Home_deg >= options.windows.minElevation_deg - 0.01;
+
+            // Mean of the chain over the slot at the planner's resolution.
+            double sum = 0.0;
+            const int samples = 61;
+            for (int n = 0; n < samples; ++n) {
+                sum += pointScore(ephemeris, calculator, dx[s], home, options,
+                                  slot.start + (slot.end - slot.start) * n / (samples - 1));
+            }
+            const double rescored = sum / samples;
+
+            const double shortfall = k < best.size() ? best[k].score_dB - slot.score_dB : 0.0;
+            const double moved = std::abs(slot.start - EXPECTED_START[s][k]);
+            ok = ok && std::abs(rescored - slot.score_dB) <= 0.05 && shortfall <= SCORE_TOLERANCE_DB &&
+                 moved <= 2.0 * options.fineStep_s;
+
+            std::cout << std::fixed << "  " << k + 1 << ": start " << slot.start
+                      << " score " << slot.score_dB << " dB (chain " << rescored
+                      << ", exhaustive " << (k < best.size() ? best[k].score_dB : 0.0)
+                      << "), PLF " << slot.PLF << ", elevations " << slot.minElevation_DX_deg
+                      << " / " << slot.minElevation_Home_deg << std::endl;
+        }
+        std::cout << "  " << (ok ? "ok" : "<-- FAIL") << std::endl;
+        pass = pass && ok;
+    }
+
+    std::cout << (pass ? "PASS" : "FAIL") << std::endl;
+    return pass ? 0 : 1;
+}